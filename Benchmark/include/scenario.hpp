@@ -0,0 +1,72 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "actors/actor_utils.hpp"
+
+/// <summary>
+/// Something a scenario does to the world at a given tick, see Scenario.
+/// </summary>
+struct ScenarioEvent
+{
+    enum class Type
+    {
+        SpawnUnits,       // count units of the template around center
+        SpawnStructures,  // count structures of the template around center, on free tiles
+        MoveOrder         // sends the units of the team (and template, if set) to target
+    };
+
+    Type type = Type::SpawnUnits;
+    int tick = 0;      // first tick the event happens on
+    int repeat = 1;    // times it happens, so a wave sequence is one event
+    int interval = 0;  // ticks between repeats
+
+    std::string templateName;
+    Team team = Team::Ally;
+    int count = 1;
+    glm::vec2 center = glm::vec2(0.0f);
+    float spread = 0.0f;  // radius around center or target the positions are picked from
+    glm::vec2 target = glm::vec2(0.0f);
+
+    bool HappensOn(int currentTick) const;
+};
+
+/// <summary>
+/// A scripted run of the simulation, loaded from a json file in assets/benchmarks. The runner loads the level, steps
+/// the world ticks times with a fixed dt, plays the events at their ticks and times every tick. Ticks before
+/// warmupTicks are run but not measured.
+/// </summary>
+struct Scenario
+{
+    std::string name;
+    std::string level = "testLevel";
+    unsigned int seed = 1;
+    int ticks = 600;
+    int warmupTicks = 30;
+    float dt = 1.0f / 30.0f;  // the ECS clamps it to 1/30
+    bool parallel = false;    // runs the systems with EntityComponentSystem::Scheduling::Parallel
+
+    // The run fails when this percentile of the tick time, or of the update of a system, goes over its budget.
+    // A budget of 0 is no budget.
+    float budgetPercentile = 95.0f;
+    float budgetMilliseconds = 0.0f;
+    std::unordered_map<std::string, float> systemBudgets;  // by system title
+
+    // The camera decides the simulation level of detail of the units, see bee::SimulationLODSystem. By default it looks
+    // down on the whole of the test level, a smaller field of view zooms in.
+    glm::vec3 cameraPosition = glm::vec3(0.0f, 0.0f, 100.0f);
+    glm::vec2 cameraTarget = glm::vec2(0.0f);
+    float cameraFov = 25.0f;  // degrees
+
+    std::vector<ScenarioEvent> events;
+};
+
+/// <summary>
+/// Loads a scenario from the asset directory. Logs what is wrong and returns nothing when the file is missing or
+/// malformed.
+/// </summary>
+std::optional<Scenario> LoadScenario(const std::string& path);
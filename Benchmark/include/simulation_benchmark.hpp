@@ -0,0 +1,70 @@
+#pragma once
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/ecs.hpp"
+#include "scenario.hpp"
+
+/// <summary>
+/// Percentiles of a series of times, in milliseconds.
+/// </summary>
+struct TimingSummary
+{
+    std::string name;  // "tick" for the whole tick, the title of the system otherwise
+    float mean = 0.0f;
+    float p50 = 0.0f;
+    float p90 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+    float max = 0.0f;
+    float budget = 0.0f;  // 0 when there is none
+    float budgetValue = 0.0f;  // the percentile the budget is checked against
+    bool overBudget = false;
+
+    static TimingSummary FromSamples(const std::string& name, std::vector<float> samples, float percentile);
+};
+
+struct BenchmarkResult
+{
+    std::string scenario;
+    int measuredTicks = 0;
+    int units = 0;       // alive at the end of the run
+    int structures = 0;  // alive at the end of the run
+    float budgetPercentile = 95.0f;
+    std::vector<TimingSummary> timings;  // the tick first, then the systems in update order
+
+    bool OverBudget() const;
+};
+
+/// <summary>
+/// Runs a scenario on a headless engine. The world is what the game builds (terrain, navigation, physics, actors and
+/// their behaviours) minus what needs a window or a player: rendering, UI, input, selection and orders. Everything
+/// random is seeded from the scenario, so two runs of a scenario simulate the same thing.
+///
+/// The engine must be initialized headless before Run, and shut down after it.
+/// </summary>
+class SimulationBenchmark
+{
+public:
+    explicit SimulationBenchmark(const Scenario& scenario);
+
+    /// <summary>
+    /// Builds the world, steps it through the scenario and summarizes the times.
+    /// </summary>
+    BenchmarkResult Run();
+
+private:
+    void CreateWorld();
+    void ApplyEvents(int tick);
+    void SpawnUnits(const ScenarioEvent& event);
+    void SpawnStructures(const ScenarioEvent& event);
+    void MoveUnits(const ScenarioEvent& event);
+    glm::vec2 RandomPoint(const glm::vec2& center, float radius);
+
+    const Scenario& m_scenario;
+    std::mt19937 m_random;
+};
+
+std::string ToCsv(const std::vector<BenchmarkResult>& results);
+std::string ToJson(const std::vector<BenchmarkResult>& results);
@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/engine.hpp"
+#include "core/fileio.hpp"
+#include "scenario.hpp"
+#include "simulation_benchmark.hpp"
+#include "tools/log.hpp"
+
+using namespace bee;
+
+namespace
+{
+
+enum ExitCode
+{
+    Success = 0,
+    OverBudget = 1,
+    Failure = 2
+};
+
+void PrintUsage()
+{
+    std::cout << "Benchmark [--format csv|json] [--out file] [scenario.json ...]\n"
+                 "Runs the scenarios (paths in the asset directory, all of benchmarks/ by default) on a headless engine\n"
+                 "and reports the tick times. Exits with 1 when a scenario goes over its budget, 2 when one fails to load.\n";
+}
+
+std::vector<std::string> DefaultScenarios()
+{
+    std::vector<std::string> scenarios;
+    std::error_code error;
+    const auto directory = Engine.FileIO().GetPath(FileIO::Directory::Asset, "benchmarks");
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+        if (entry.path().extension() == ".json") scenarios.push_back("benchmarks/" + entry.path().filename().string());
+    std::sort(scenarios.begin(), scenarios.end());
+    return scenarios;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string format = "csv";
+    std::string outPath;
+    std::vector<std::string> scenarioPaths;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--format" && i + 1 < argc)
+            format = argv[++i];
+        else if (argument == "--out" && i + 1 < argc)
+            outPath = argv[++i];
+        else if (argument.rfind("--", 0) == 0)
+        {
+            PrintUsage();
+            return Failure;
+        }
+        else
+            scenarioPaths.push_back(argument);
+    }
+    if (format != "csv" && format != "json")
+    {
+        PrintUsage();
+        return Failure;
+    }
+
+    if (scenarioPaths.empty())
+    {
+        Engine.InitializeHeadless();
+        scenarioPaths = DefaultScenarios();
+        Engine.Shutdown();
+        if (scenarioPaths.empty())
+        {
+            std::cerr << "No scenarios found in the benchmarks directory\n";
+            return Failure;
+        }
+    }
+
+    // every scenario gets a fresh engine, so one run cannot warm up or slow down the next
+    std::vector<BenchmarkResult> results;
+    bool failed = false;
+    for (const auto& path : scenarioPaths)
+    {
+        Engine.InitializeHeadless();
+        if (const auto scenario = LoadScenario(path))
+        {
+            Log::Info("Benchmark: running {} for {} ticks", scenario->name, scenario->ticks);
+            SimulationBenchmark benchmark(*scenario);
+            results.push_back(benchmark.Run());
+        }
+        else
+        {
+            failed = true;
+        }
+        Engine.Shutdown();
+    }
+
+    const std::string report = format == "json" ? ToJson(results) : ToCsv(results);
+    if (outPath.empty())
+    {
+        std::cout << report;
+    }
+    else
+    {
+        std::ofstream file(outPath);
+        file << report;
+        if (!file)
+        {
+            std::cerr << "Could not write " << outPath << "\n";
+            return Failure;
+        }
+    }
+
+    bool overBudget = false;
+    for (const auto& result : results)
+    {
+        for (const auto& timing : result.timings)
+        {
+            if (!timing.overBudget) continue;
+            std::cerr << result.scenario << ": " << timing.name << " took " << timing.budgetValue << " ms at p"
+                      << result.budgetPercentile << ", the budget is " << timing.budget << " ms\n";
+            overBudget = true;
+        }
+    }
+
+    if (failed) return Failure;
+    return overBudget ? OverBudget : Success;
+}
@@ -0,0 +1,147 @@
+#include "scenario.hpp"
+
+#include <tinygltf/json.hpp>
+
+#include "core/engine.hpp"
+#include "core/fileio.hpp"
+#include "level_editor/terrain_binary.hpp"
+#include "tools/log.hpp"
+
+namespace
+{
+
+std::optional<ScenarioEvent::Type> ParseEventType(const std::string& type)
+{
+    if (type == "spawnUnits") return ScenarioEvent::Type::SpawnUnits;
+    if (type == "spawnStructures") return ScenarioEvent::Type::SpawnStructures;
+    if (type == "moveOrder") return ScenarioEvent::Type::MoveOrder;
+    return std::nullopt;
+}
+
+std::optional<Team> ParseTeam(const std::string& team)
+{
+    if (team == "ally") return Team::Ally;
+    if (team == "enemy") return Team::Enemy;
+    if (team == "neutral") return Team::Neutral;
+    return std::nullopt;
+}
+
+glm::vec2 ParseVec2(const nlohmann::json& json, const char* key)
+{
+    if (!json.contains(key)) return glm::vec2(0.0f);
+    const auto& value = json.at(key);
+    return glm::vec2(value.at(0).get<float>(), value.at(1).get<float>());
+}
+
+glm::vec3 ParseVec3(const nlohmann::json& json, const char* key, const glm::vec3& fallback)
+{
+    if (!json.contains(key)) return fallback;
+    const auto& value = json.at(key);
+    return glm::vec3(value.at(0).get<float>(), value.at(1).get<float>(), value.at(2).get<float>());
+}
+
+}  // namespace
+
+bool ScenarioEvent::HappensOn(const int currentTick) const
+{
+    if (currentTick < tick) return false;
+    if (interval <= 0) return currentTick == tick;
+    const int since = currentTick - tick;
+    return since % interval == 0 && since / interval < repeat;
+}
+
+std::optional<Scenario> LoadScenario(const std::string& path)
+{
+    const std::string text = bee::Engine.FileIO().ReadTextFile(bee::FileIO::Directory::Asset, path);
+    if (text.empty())
+    {
+        bee::Log::Error("Benchmark: could not read scenario {}", path);
+        return std::nullopt;
+    }
+
+    const nlohmann::json json = nlohmann::json::parse(text, nullptr, false);
+    if (json.is_discarded() || !json.is_object())
+    {
+        bee::Log::Error("Benchmark: scenario {} is not a json object", path);
+        return std::nullopt;
+    }
+
+    Scenario scenario;
+    try
+    {
+        scenario.name = json.value("name", path);
+        scenario.level = json.value("level", scenario.level);
+        scenario.seed = json.value("seed", scenario.seed);
+        scenario.ticks = json.value("ticks", scenario.ticks);
+        scenario.warmupTicks = json.value("warmupTicks", scenario.warmupTicks);
+        scenario.dt = json.value("dt", scenario.dt);
+        scenario.parallel = json.value("parallel", scenario.parallel);
+
+        if (json.contains("budget"))
+        {
+            const auto& budget = json.at("budget");
+            scenario.budgetPercentile = budget.value("percentile", scenario.budgetPercentile);
+            scenario.budgetMilliseconds = budget.value("tick", scenario.budgetMilliseconds);
+            if (budget.contains("systems"))
+                for (const auto& [system, milliseconds] : budget.at("systems").items())
+                    scenario.systemBudgets[system] = milliseconds.get<float>();
+        }
+
+        if (json.contains("camera"))
+        {
+            const auto& camera = json.at("camera");
+            scenario.cameraPosition = ParseVec3(camera, "position", scenario.cameraPosition);
+            if (camera.contains("target")) scenario.cameraTarget = ParseVec2(camera, "target");
+            scenario.cameraFov = camera.value("fov", scenario.cameraFov);
+        }
+
+        for (const auto& element : json.value("events", nlohmann::json::array()))
+        {
+            ScenarioEvent event;
+            const auto type = ParseEventType(element.value("type", std::string()));
+            if (!type.has_value())
+            {
+                bee::Log::Error("Benchmark: scenario {} has an event of unknown type {}", path, element.value("type", std::string()));
+                return std::nullopt;
+            }
+            const auto team = ParseTeam(element.value("team", std::string("ally")));
+            if (!team.has_value())
+            {
+                bee::Log::Error("Benchmark: scenario {} has an event for unknown team {}", path, element.value("team", std::string()));
+                return std::nullopt;
+            }
+
+            event.type = type.value();
+            event.team = team.value();
+            event.tick = element.value("tick", event.tick);
+            event.repeat = element.value("repeat", event.repeat);
+            event.interval = element.value("interval", event.interval);
+            event.templateName = element.value("template", event.templateName);
+            event.count = element.value("count", event.count);
+            event.center = ParseVec2(element, "center");
+            event.spread = element.value("spread", event.spread);
+            event.target = ParseVec2(element, "target");
+            scenario.events.push_back(event);
+        }
+    }
+    catch (const nlohmann::json::exception& exception)
+    {
+        bee::Log::Error("Benchmark: scenario {} is malformed: {}", path, exception.what());
+        return std::nullopt;
+    }
+
+    if (scenario.ticks <= scenario.warmupTicks || scenario.dt <= 0.0f)
+    {
+        bee::Log::Error("Benchmark: scenario {} has no ticks to measure", path);
+        return std::nullopt;
+    }
+
+    auto& fileIO = bee::Engine.FileIO();
+    if (!fileIO.Exists(bee::FileIO::Directory::Terrain, scenario.level + ".json") &&
+        !fileIO.Exists(bee::FileIO::Directory::Terrain, scenario.level + lvle::TerrainBinaryExtension))
+    {
+        bee::Log::Error("Benchmark: scenario {} is set in level {}, which does not exist", path, scenario.level);
+        return std::nullopt;
+    }
+    return scenario;
+}
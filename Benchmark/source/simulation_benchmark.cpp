@@ -0,0 +1,335 @@
+#include "simulation_benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <numeric>
+#include <typeinfo>
+
+#include <fmt/format.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <tinygltf/json.hpp>
+
+#include "actors/actor_wrapper.hpp"
+#include "actors/attributes.hpp"
+#include "actors/buff_system.hpp"
+#include "actors/projectile_system/projectile_system.hpp"
+#include "actors/structures/structure_manager_system.hpp"
+#include "actors/units/unit_manager_system.hpp"
+#include "ai/ai_behavior_selection_system.hpp"
+#include "ai/grid_navigation_system.hpp"
+#include "ai/navigation_grid.hpp"
+#include "ai_behaviors/behavior_access.hpp"
+#include "core/engine.hpp"
+#include "core/simulation_lod.hpp"
+#include "core/transform.hpp"
+#include "level_editor/terrain_system.hpp"
+#include "material_system/material_system.hpp"
+#include "particle_system/particle_system.hpp"
+#include "physics/world.hpp"
+#include "rendering/render_components.hpp"
+#include "tools/debug_metric.hpp"
+#include "tools/frame_arena.hpp"
+#include "tools/log.hpp"
+
+namespace
+{
+
+// tries per structure to find free tiles before the spawn is skipped
+constexpr int kStructurePlacementTries = 16;
+
+float Milliseconds(const std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration<float, std::milli>(duration).count();
+}
+
+std::string SystemName(const bee::System& system)
+{
+    if (!system.Title.empty()) return system.Title;
+    std::string name = typeid(system).name();
+    if (name.rfind("class ", 0) == 0) name.erase(0, 6);
+    return name;
+}
+
+}  // namespace
+
+TimingSummary TimingSummary::FromSamples(const std::string& name, std::vector<float> samples, const float percentile)
+{
+    TimingSummary summary;
+    summary.name = name;
+    if (samples.empty()) return summary;
+
+    std::sort(samples.begin(), samples.end());
+    // nearest rank
+    const auto at = [&samples](const float p)
+    {
+        const auto rank = static_cast<size_t>(std::ceil(p / 100.0f * static_cast<float>(samples.size())));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0f) / static_cast<float>(samples.size());
+    summary.p50 = at(50.0f);
+    summary.p90 = at(90.0f);
+    summary.p95 = at(95.0f);
+    summary.p99 = at(99.0f);
+    summary.max = samples.back();
+    summary.budgetValue = at(percentile);
+    return summary;
+}
+
+bool BenchmarkResult::OverBudget() const
+{
+    return std::any_of(timings.begin(), timings.end(), [](const TimingSummary& timing) { return timing.overBudget; });
+}
+
+SimulationBenchmark::SimulationBenchmark(const Scenario& scenario) : m_scenario(scenario), m_random(scenario.seed) {}
+
+BenchmarkResult SimulationBenchmark::Run()
+{
+    // the behaviours roll their dice with rand
+    srand(m_scenario.seed);
+    CreateWorld();
+
+    auto& ecs = bee::Engine.ECS();
+    if (m_scenario.parallel) ecs.SetScheduling(bee::EntityComponentSystem::Scheduling::Parallel);
+
+    const auto systems = ecs.GetSystems<bee::System>();
+    const int measuredTicks = m_scenario.ticks - m_scenario.warmupTicks;
+    std::vector<float> tickTimes;
+    std::vector<float> eventTimes;
+    std::vector<std::vector<float>> systemTimes(systems.size());
+    tickTimes.reserve(measuredTicks);
+    eventTimes.reserve(measuredTicks);
+    for (auto& times : systemTimes) times.reserve(measuredTicks);
+
+    for (int tick = 0; tick < m_scenario.ticks; tick++)
+    {
+        // events stand in for the player and the game, so they count towards the tick
+        const auto start = std::chrono::steady_clock::now();
+        ApplyEvents(tick);
+        const auto eventsDone = std::chrono::steady_clock::now();
+        ecs.UpdateSystems(m_scenario.dt);
+        ecs.PlaybackCommands();
+        ecs.RemovedDeleted();
+        const auto end = std::chrono::steady_clock::now();
+        bee::ResetFrameArenas();
+
+        if (tick < m_scenario.warmupTicks) continue;
+        tickTimes.push_back(Milliseconds(end - start));
+        eventTimes.push_back(Milliseconds(eventsDone - start));
+        for (size_t i = 0; i < systems.size(); i++)
+            systemTimes[i].push_back(systems[i]->IsPause() ? 0.0f : systems[i]->GetUpdateTime());
+    }
+
+    BenchmarkResult result;
+    result.scenario = m_scenario.name;
+    result.measuredTicks = measuredTicks;
+    result.budgetPercentile = m_scenario.budgetPercentile;
+    const auto units = ecs.Registry.view<bee::ai::GridAgent, AttributesComponent>();
+    result.units = static_cast<int>(std::distance(units.begin(), units.end()));
+    result.structures = static_cast<int>(ecs.Registry.view<StructureModelTag>().size());
+
+    const float percentile = m_scenario.budgetPercentile;
+    auto& total = result.timings.emplace_back(TimingSummary::FromSamples("tick", std::move(tickTimes), percentile));
+    total.budget = m_scenario.budgetMilliseconds;
+    result.timings.push_back(TimingSummary::FromSamples("scenario events", std::move(eventTimes), percentile));
+    for (size_t i = 0; i < systems.size(); i++)
+    {
+        auto& timing = result.timings.emplace_back(
+            TimingSummary::FromSamples(SystemName(*systems[i]), std::move(systemTimes[i]), percentile));
+        const auto budget = m_scenario.systemBudgets.find(timing.name);
+        if (budget != m_scenario.systemBudgets.end()) timing.budget = budget->second;
+    }
+    for (auto& timing : result.timings) timing.overBudget = timing.budget > 0.0f && timing.budgetValue > timing.budget;
+
+    return result;
+}
+
+void SimulationBenchmark::CreateWorld()
+{
+    auto& ecs = bee::Engine.ECS();
+
+    // what Starcraft::Init sets up, without rendering, UI, input, the player's orders and the level's props
+    ecs.CreateSystem<bee::MaterialSystem>();
+    ecs.CreateSystem<bee::ParticleSystem>();
+    ecs.CreateSystem<bee::SimulationLODSystem>();
+
+    {  // Terrain
+        auto& terrainSystem = ecs.CreateSystem<lvle::TerrainSystem>();
+        terrainSystem.LoadLevel(m_scenario.level);
+        terrainSystem.UpdateTerrainDataComponent();
+        terrainSystem.CalculateTerrainColliders();
+    }
+
+    {  // Grid Navigation System
+        auto view = ecs.Registry.view<lvle::TerrainDataComponent>();
+        for (auto entity : view)
+        {
+            auto [data] = view.get(entity);
+            bee::ai::NavigationGrid navGrid(data.m_tiles[0].centralPos, data.m_step, data.m_width, data.m_height);
+            auto& gridNavSystem = ecs.CreateSystem<bee::ai::GridNavigationSystem>(0.1f, navGrid);
+            gridNavSystem.UpdateFromTerrain();
+        }
+    }
+
+    ecs.CreateSystem<bee::physics::World>(0.02f);
+    ecs.CreateSystem<ProjectileSystem>();
+    bee::actors::CreateActorSystems();
+    auto& aiSystem = ecs.CreateSystem<bee::ai::AIBehaviorSelectionSystem>(1.0f / 6.0f);
+    // units in parallel-safe states change their own path and look at the paths of others
+    aiSystem.GetSnapshot().Capture<bee::ai::GridAgent>();
+    DeclareBehaviorAccess(aiSystem);
+    ecs.CreateSystem<BuffSystem>();
+
+    ecs.GetSystem<UnitManager>().LoadUnitTemplates(m_scenario.level);
+    ecs.GetSystem<StructureManager>().LoadStructureTemplates(m_scenario.level);
+
+    {  // units are placed on the terrain as seen from the camera
+        const auto camera = ecs.CreateEntity();
+        auto& transform = ecs.CreateComponent<bee::Transform>(camera);
+        transform.Translation = m_scenario.cameraPosition;
+        transform.Name = "Benchmark Camera";
+        auto& cameraComponent = ecs.CreateComponent<bee::Camera>(camera);
+        cameraComponent.Projection = glm::perspective(glm::radians(m_scenario.cameraFov), 16.0f / 9.0f, 0.5f, 600.0f);
+        cameraComponent.View = glm::lookAt(m_scenario.cameraPosition, glm::vec3(m_scenario.cameraTarget, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        cameraComponent.VP = cameraComponent.Projection * cameraComponent.View;
+    }
+
+    ecs.CreateComponent<bee::DebugMetricData>(ecs.CreateEntity());
+}
+
+void SimulationBenchmark::ApplyEvents(const int tick)
+{
+    for (const auto& event : m_scenario.events)
+    {
+        if (!event.HappensOn(tick)) continue;
+        switch (event.type)
+        {
+            case ScenarioEvent::Type::SpawnUnits:
+                SpawnUnits(event);
+                break;
+            case ScenarioEvent::Type::SpawnStructures:
+                SpawnStructures(event);
+                break;
+            case ScenarioEvent::Type::MoveOrder:
+                MoveUnits(event);
+                break;
+        }
+    }
+}
+
+void SimulationBenchmark::SpawnUnits(const ScenarioEvent& event)
+{
+    auto& unitManager = bee::Engine.ECS().GetSystem<UnitManager>();
+    for (int i = 0; i < event.count; i++)
+    {
+        const glm::vec2 position = RandomPoint(event.center, event.spread);
+        unitManager.SpawnUnit(event.templateName, glm::vec3(position, 0.0f), event.team);
+    }
+}
+
+void SimulationBenchmark::SpawnStructures(const ScenarioEvent& event)
+{
+    auto& structureManager = bee::Engine.ECS().GetSystem<StructureManager>();
+    auto& terrainSystem = bee::Engine.ECS().GetSystem<lvle::TerrainSystem>();
+    if (structureManager.GetStructures().find(event.templateName) == structureManager.GetStructures().end())
+    {
+        bee::Log::Warn("Benchmark: there is no structure template {}", event.templateName);
+        return;
+    }
+    const glm::ivec2 dimensions = structureManager.GetStructureTemplate(event.templateName).tileDimensions;
+
+    std::vector<int> tiles;
+    for (int i = 0; i < event.count; i++)
+    {
+        for (int attempt = 0; attempt < kStructurePlacementTries; attempt++)
+        {
+            const glm::vec3 position(RandomPoint(event.center, event.spread), 0.0f);
+            const int smallGridIndex = terrainSystem.GetSmallGridIndexFromPosition(position, dimensions.x, dimensions.y);
+            tiles.clear();
+            terrainSystem.GetOccupiedTilesFromObject(smallGridIndex, dimensions.x, dimensions.y, false, tiles);
+            if (tiles.empty() || !std::all_of(tiles.begin(), tiles.end(),
+                                              [&terrainSystem](const int tile) { return terrainSystem.CanBuildOnTile(tile); }))
+                continue;
+
+            structureManager.SpawnStructure(event.templateName, position, smallGridIndex, false, event.team);
+            break;
+        }
+    }
+}
+
+void SimulationBenchmark::MoveUnits(const ScenarioEvent& event)
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    const auto order = [&](const bee::Entity entity)
+    {
+        if (!event.templateName.empty() && registry.get<AttributesComponent>(entity).GetEntityType() != event.templateName)
+            return;
+        registry.get<bee::ai::GridAgent>(entity).SetGoal(RandomPoint(event.target, event.spread));
+    };
+
+    switch (event.team)
+    {
+        case Team::Ally:
+            for (const auto entity : registry.view<bee::ai::GridAgent, AttributesComponent, AllyUnit>()) order(entity);
+            break;
+        case Team::Enemy:
+            for (const auto entity : registry.view<bee::ai::GridAgent, AttributesComponent, EnemyUnit>()) order(entity);
+            break;
+        case Team::Neutral:
+            for (const auto entity : registry.view<bee::ai::GridAgent, AttributesComponent, NeutralUnit>()) order(entity);
+            break;
+    }
+}
+
+glm::vec2 SimulationBenchmark::RandomPoint(const glm::vec2& center, const float radius)
+{
+    if (radius <= 0.0f) return center;
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    glm::vec2 offset;
+    do offset = glm::vec2(unit(m_random), unit(m_random));
+    while (glm::dot(offset, offset) > 1.0f);
+    return center + offset * radius;
+}
+
+std::string ToCsv(const std::vector<BenchmarkResult>& results)
+{
+    std::string csv = "scenario,series,ticks,mean_ms,p50_ms,p90_ms,p95_ms,p99_ms,max_ms,budget_ms,budget_percentile,over_budget\n";
+    for (const auto& result : results)
+    {
+        for (const auto& timing : result.timings)
+        {
+            csv += fmt::format("\"{}\",\"{}\",{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{},{}\n", result.scenario,
+                               timing.name, result.measuredTicks, timing.mean, timing.p50, timing.p90, timing.p95,
+                               timing.p99, timing.max, timing.budget, result.budgetPercentile, timing.overBudget ? 1 : 0);
+        }
+    }
+    return csv;
+}
+
+std::string ToJson(const std::vector<BenchmarkResult>& results)
+{
+    nlohmann::json json = nlohmann::json::array();
+    for (const auto& result : results)
+    {
+        nlohmann::json timings = nlohmann::json::array();
+        for (const auto& timing : result.timings)
+        {
+            nlohmann::json entry = {{"name", timing.name}, {"mean", timing.mean}, {"p50", timing.p50},
+                                    {"p90", timing.p90},   {"p95", timing.p95},   {"p99", timing.p99},
+                                    {"max", timing.max},   {"overBudget", timing.overBudget}};
+            if (timing.budget > 0.0f) entry["budget"] = timing.budget;
+            timings.push_back(entry);
+        }
+        json.push_back({{"scenario", result.scenario},
+                        {"ticks", result.measuredTicks},
+                        {"units", result.units},
+                        {"structures", result.structures},
+                        {"budgetPercentile", result.budgetPercentile},
+                        {"overBudget", result.OverBudget()},
+                        {"timings", timings}});
+    }
+    return json.dump(4);
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "props/prop_manager_system.hpp"
 #include "structures/structure_manager_system.hpp"
+#include "targeting_system.hpp"
 #include "units/unit_manager_system.hpp"
 
 // This class is provides some utility functions for when you need all actors at the same time.
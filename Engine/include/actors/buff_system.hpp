@@ -1,25 +1,85 @@
 #pragma once
+#include <vector>
+
 #include "actors/attributes.hpp"
 #include "actors/structures/structure_manager_system.hpp"
 #include "actors/units/unit_manager_system.hpp"
 #include "core/ecs.hpp"
 #include "core/engine.hpp"
 #include "core/transform.hpp"
+#include "tools/bucket_grid.hpp"
 
+/// <summary>
+/// The auras (BuffStructures) an ally unit is in, kept by the BuffSystem.
+/// </summary>
+struct AuraBuffs
+{
+    std::vector<bee::Entity> auras;    // every aura the unit is in
+    std::vector<bee::Entity> applied;  // the ones whose buff the unit has, the strongest of every attribute
+};
 
+/// <summary>
+/// Buffs the ally units in the auras of BuffStructures. Membership is worked out on a fixed tick, with the units bucketed
+/// in a grid so an aura only looks at the units near it, and buffs are only added when a unit enters an aura and removed
+/// when it leaves. A unit leaves a little further out than it enters, so units at the edge do not flicker in and out.
+///
+/// Auras of different attributes stack, those of the same attribute do not: a unit has the buff of the strongest one it
+/// is in, and gets the next strongest when it leaves that one. Units and structures that are destroyed leave their auras
+/// right away.
+/// </summary>
 class BuffSystem : public bee::System
 {
 public:
-    BuffSystem();
+    /// <summary>
+    /// Works out the auras every period seconds. Units leave an aura when they are more than hysteresis outside of it.
+    /// </summary>
+    BuffSystem(float period = 0.1f, float hysteresis = 0.5f);
+    ~BuffSystem() override;
+
     void AddBuff(AttributesComponent& attributes, const BuffStructure& buffStructure);
     void RemoveBuff(AttributesComponent& attributes, const BuffStructure& buffStructure, const StatModifier& modifier)const;
-    void HandleBuffAddition(entt::entity entity, BuffStructure& buffStructure);
-    void RemoveBuff(entt::entity entity, BuffStructure& buffStructure) const;
-    void HandleBuffs(BuffStructure& allyStructure, const AttributesComponent& attributes,
-                     const bee::Transform& structureTransform);
     void Update(float dt) override;
 #ifdef BEE_INSPECTOR
     void Inspect() override;
 #endif
     bool m_seeAllRangeCircles = false;
+
+    /// <summary>
+    /// Works out the auras right away.
+    /// </summary>
+    void Tick();
+
+    float GetPeriod() const { return m_period; }
+
+    /// <summary>
+    /// How many units entered and left auras on the last tick.
+    /// </summary>
+    int GetEnterCount() const { return m_enters; }
+    int GetExitCount() const { return m_exits; }
+
+private:
+    struct Unit
+    {
+        bee::Entity entity = entt::null;
+        glm::vec3 position = {};
+    };
+
+    void Enter(bee::Entity unit, bee::Entity aura);
+
+    void Exit(bee::Entity unit, bee::Entity aura);
+
+    // the strongest of the auras of the unit for the attribute, null if it is in none
+    bee::Entity FindStrongest(const AuraBuffs& buffs, BaseAttributes type) const;
+
+    void OnAuraDestroyed(entt::registry& registry, bee::Entity aura);
+    void OnUnitDestroyed(entt::registry& registry, bee::Entity unit);
+
+    float m_period;
+    float m_hysteresis;
+    float m_time = 0.0f;
+    uint32_t m_tick = 0;
+    int m_enters = 0;
+    int m_exits = 0;
+    bee::BucketGrid<Unit> m_units;
+    std::vector<bee::Entity> m_leaving;  // scratch space for Tick
 };
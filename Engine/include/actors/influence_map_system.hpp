@@ -0,0 +1,108 @@
+#pragma once
+#include <optional>
+#include <vector>
+
+#include "actors/actor_utils.hpp"
+#include "ai/influence_map.hpp"
+#include "core/ecs.hpp"
+
+/// <summary>
+/// What an actor or resource has stamped onto the InfluenceMapSystem, so the same can be taken off again when it moves
+/// or goes away.
+/// </summary>
+struct InfluenceSource
+{
+    int cell = -1;  // -1 when it is off the map
+    int threatRadius = 0;
+    int sightRadius = -1;  // -1 when it does not explore
+    float threat = 0.0f;
+    float density = 0.0f;
+    float resources = 0.0f;
+    Team team = Team::Neutral;
+    uint32_t tick = 0;  // the last sync that saw it
+};
+
+/// <summary>
+/// Keeps an influence map of the terrain for the enemy AI: threat and unit density of both teams, resource value, and
+/// how long ago the enemy last saw every cell. The cells are those of the small grid the structures snap to, half a
+/// tile wide.
+///
+/// Every period it looks up the cell of every actor and resource, and only restamps the ones that moved to another
+/// cell or changed, so the map follows the units at the cost of those that moved. Actors that are destroyed are taken
+/// off right away. The queries cost as much as the map, not as the number of units.
+/// </summary>
+class InfluenceMapSystem : public bee::System
+{
+public:
+    /// <summary>
+    /// Syncs every period seconds. The enemy sees sightRange around its units and structures.
+    /// </summary>
+    InfluenceMapSystem(float period = 0.5f, float sightRange = 8.0f);
+    ~InfluenceMapSystem() override;
+    void Update(float dt) override;
+#ifdef BEE_INSPECTOR
+    void Inspect() override;
+#endif
+
+    /// <summary>
+    /// Covers the terrain, if there is an entity with a TerrainDataComponent.
+    /// </summary>
+    void UpdateFromTerrain();
+
+    /// <summary>
+    /// Covers width by height cells of cellSize, starting at origin. Everything is stamped again on the next sync.
+    /// </summary>
+    void SetBounds(const glm::vec2& origin, float cellSize, int width, int height);
+
+    /// <summary>
+    /// Brings the map up to date right away.
+    /// </summary>
+    void Sync();
+
+    const bee::ai::InfluenceMap& GetMap() const { return m_map; }
+    float GetPeriod() const { return m_period; }
+    float GetTime() const { return m_time; }
+
+    /// <summary>
+    /// How many sources were stamped again on the last sync.
+    /// </summary>
+    int GetRestampCount() const { return m_restamps; }
+
+    /// <summary>
+    /// The weakest group of units of the team, see InfluenceMap::FindWeakestCluster.
+    /// </summary>
+    std::optional<glm::vec2> FindWeakestCluster(Team team) const;
+
+    /// <summary>
+    /// The resources the team that is not threatOf can gather with the least danger, closest to from.
+    /// </summary>
+    std::optional<glm::vec2> FindSafestResource(Team threatOf, const glm::vec2& from) const;
+
+    /// <summary>
+    /// Where the enemy has not looked for the longest, closest to from.
+    /// </summary>
+    std::optional<glm::vec2> FindLeastExplored(const glm::vec2& from) const;
+
+private:
+    template <typename Tag>
+    void SyncActors(Team team, bool unit);
+    void SyncResources();
+
+    // updates the source of the entity to next, restamping it when it changed
+    void Apply(bee::Entity entity, InfluenceSource next);
+
+    // stamps the source onto the map with sign 1, or takes it off with sign -1
+    void Put(const InfluenceSource& source, int sign);
+
+    int ToCells(float range) const;
+    void OnSourceDestroyed(entt::registry& registry, bee::Entity entity);
+
+    float m_period;
+    float m_sightRange;
+    float m_time = 0.0f;
+    float m_sinceSync = 0.0f;
+    uint32_t m_tick = 0;
+    int m_restamps = 0;
+    bee::ai::InfluenceMap m_map;
+    std::vector<bee::Entity> m_gone;  // scratch space for Sync
+};
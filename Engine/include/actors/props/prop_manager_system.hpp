@@ -33,7 +33,11 @@ struct PropModelTag
 class PropManager : public bee::System
 {
 public:
-    PropManager() = default;
+    PropManager()
+    {
+        Title = "Prop Manager";
+        ReadsNothing();
+    }
 
     const std::unordered_map<std::string, PropTemplate>& GetProps() { return m_Props; }
 
@@ -44,9 +44,12 @@ struct SpawningStructure
     bee::Entity flagEntity = entt::null;
 };
 
+// An aura that buffs the ally units around the structure, kept up by the BuffSystem.
 struct BuffStructure
 {
-    std::vector<bee::Entity> buffedEntities{};
+    // the ally units in the aura, with the BuffSystem tick that last saw them in it. Auras of the same attribute do not
+    // stack, so only the members for which this is the strongest aura have its buff.
+    std::unordered_map<bee::Entity, uint32_t> members{};
     BaseAttributes buffType;
     StatModifier buffModifier;
 };
@@ -67,7 +70,7 @@ struct HurtBuildingVFX
 class StructureManager : public bee::System
 {
 public:
-    StructureManager() = default;
+    StructureManager();
 
     const std::unordered_map<std::string, StructureTemplate>& GetStructures() const { return m_Structures; }
 
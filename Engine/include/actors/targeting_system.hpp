@@ -0,0 +1,117 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+#include "core/ecs.hpp"
+#include "glm/glm.hpp"
+#include "tools/bucket_grid.hpp"
+
+/// <summary>
+/// The enemies a unit should go after, as picked by the TargetingSystem on its last run. The combat states read this
+/// instead of looking at every enemy themselves. A target may have died since, so check it is still valid.
+/// </summary>
+struct CombatTarget
+{
+    bee::Entity unit = entt::null;             // the best enemy unit within interception range, null if there is none
+    bee::Entity unitOrStructure = entt::null;  // the same, with the structures the unit may attack counted as well
+};
+
+/// <summary>
+/// An enemy within interception range of a unit, as given to the TargetScoring of the TargetingSystem.
+/// </summary>
+struct TargetCandidate
+{
+    bee::Entity entity = entt::null;
+    float distance2 = 0.0f;        // the squared distance to the unit that is choosing
+    float hitPoints = 0.0f;        // zero for candidates without attributes
+    float damagePerSecond = 0.0f;  // what it deals, zero for candidates that do not attack
+    int attackers = 0;             // how many units had it as target after the last run
+    bool structure = false;
+};
+
+/// <summary>
+/// How much a unit wants to attack the candidate, the highest score wins. Candidates with the same score are picked in
+/// no particular order.
+/// </summary>
+using TargetScoring = std::function<float(const TargetCandidate& candidate)>;
+
+namespace TargetScorings
+{
+
+/// <summary>
+/// The closest enemy, which is what the combat states always went after.
+/// </summary>
+TargetScoring Closest();
+
+/// <summary>
+/// The enemy that deals the most damage per second for how far away it is.
+/// </summary>
+TargetScoring Threat();
+
+/// <summary>
+/// The enemy most of the team already attacks, and of those the one with the fewest hit points, so enemies die quicker.
+/// </summary>
+TargetScoring FocusFire();
+
+}  // namespace TargetScorings
+
+/// <summary>
+/// Picks the targets of all units at once, every period, and writes them into their CombatTarget. Allies go after enemy
+/// units, enemies after ally units and structures, within the interception range of the unit. Enemies hidden by the
+/// fog of war are left alone.
+///
+/// The enemies are bucketed by position in a coarse grid first, so a unit only looks at the enemies in the cells its
+/// range overlaps instead of at every enemy, and reads its own interception range once per run.
+/// Create it before the AIBehaviorSelectionSystem, so the targets are fresh when the states look at them.
+/// </summary>
+class TargetingSystem : public bee::System
+{
+public:
+    /// <summary>
+    /// Runs every period seconds, the tick of the AI by default. The grid has cells of about cellSize, best about the
+    /// interception range of the units.
+    /// </summary>
+    TargetingSystem(float period = 1.0f / 6.0f, float cellSize = 8.0f);
+    void Update(float dt) override;
+#ifdef BEE_INSPECTOR
+    void Inspect() override;
+#endif
+
+    /// <summary>
+    /// Picks the targets of all units right away.
+    /// </summary>
+    void Run();
+
+    void SetScoring(TargetScoring scoring) { m_scoring = std::move(scoring); }
+    float GetPeriod() const { return m_period; }
+
+    /// <summary>
+    /// How many units had a target after the last run.
+    /// </summary>
+    int GetTargetingCount() const { return m_targetingCount; }
+
+private:
+    struct Candidate
+    {
+        bee::Entity entity = entt::null;
+        glm::vec3 position = {};
+        float hitPoints = 0.0f;
+        float damagePerSecond = 0.0f;
+        bool structure = false;
+    };
+
+    template <typename... Tags>
+    void AddCandidates(bee::BucketGrid<Candidate>& grid, bool structure);
+
+    template <typename Tag>
+    void PickTargets(const bee::BucketGrid<Candidate>& grid);
+
+    float m_period;
+    float m_cellSize;
+    float m_time = 0.0f;
+    int m_targetingCount = 0;
+    TargetScoring m_scoring;
+    bee::BucketGrid<Candidate> m_enemies;  // what allies go after
+    bee::BucketGrid<Candidate> m_allies;   // what enemies go after
+    std::vector<int> m_attackers;          // by entity index, how many units had the entity as target after the last run
+};
@@ -1,5 +1,6 @@
 #pragma once
 #include <core/fwd.hpp>
+#include <map>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -8,6 +9,7 @@
 #include "actors/actor_utils.hpp"
 #include "actors/units/unit_template.hpp"
 #include "core/ecs.hpp"
+#include "core/prefab.hpp"
 #include "glm/glm.hpp"
 
 struct EnemyUnit
@@ -47,7 +49,7 @@ struct UnitPropTagL
 class UnitManager : public bee::System
 {
 public:
-    UnitManager() = default;
+    UnitManager();
 
     const std::unordered_map<std::string, UnitTemplate> GetUnits() const { return m_Units; }
 
@@ -67,8 +69,18 @@ public:
 
     void ReloadUnitsFromTemplate(const std::string& unitHandle);
 
+    /// <summary>
+    /// Spawns a unit of the template. The first unit of every template and team is built from scratch and recorded as a
+    /// prefab, the ones after it are copies of that prefab with their position patched. A headless engine spawns units
+    /// without model, animations, props and effects, only what the simulation needs.
+    /// </summary>
     std::optional<bee::Entity> SpawnUnit(const std::string& unitTemplateHandle, const glm::vec3& position,
                                          Team team = Team::Ally);
+
+    /// <summary>
+    /// Builds a unit from its template, without prefabs. What SpawnUnit does for the first unit of a template and team.
+    /// </summary>
+    bee::Entity BuildUnit(const std::string& unitTemplateHandle, const glm::vec3& position, Team team);
     void InitAnimators(const std::string& unitTemplateHandle);
     std::vector<bee::Entity> SpawnUnits(std::vector<std::string> unitTemplateHandles, std::vector<glm::vec3> positions,
                                         std::vector<Team> teams);
@@ -80,14 +92,35 @@ public:
     void RemoveUnitsOfTemplate(const std::string& unitHandle);
     void RemoveUnit(bee::Entity unit);
 
+    /// <summary>
+    /// Tells bee::Prefab how to copy the components units are made of. Called by the constructor.
+    /// </summary>
+    static void RegisterPrefabComponents();
+
 private:
+    /// <summary>
+    /// Moves the position onto the terrain, as seen from the camera.
+    /// </summary>
+    void PlaceOnTerrain(glm::vec3& position) const;
+
+    void CountSpawnedUnit(const std::string& unitTemplateHandle, Team team);
+
+    /// <summary>
+    /// Gives the animation agent above the mesh renderer the skeleton of the renderer.
+    /// </summary>
+    void LinkSkeleton(bee::Entity entity, const bee::MeshRenderer& renderer);
+
+    /// <summary>
+    /// Drops the prefabs of a template, so changes to the template show up in the next units.
+    /// </summary>
+    void ForgetPrefabs(const std::string& unitHandle);
 
     /// <summary>
     /// Called inside the spawn unit function. Creates and attaches 
     /// </summary>
     void AttachProp(bee::Entity parentEntity, const bee::Transform& parentTransform);
-    void ConfigureMage(bee::Entity parentEntity, const bee::Transform& parentTransform);
-    void ConfigureWarrior(bee::Entity parentEntity, const bee::Transform& parentTransform);
+    void ConfigureMage(bee::Entity parentEntity);
+    void ConfigureWarrior(bee::Entity parentEntity);
     void InstantiateProp(bee::Entity parentEntity, const bee::Model& model, const std::string& fileName);
 
     /// <summary>
@@ -97,4 +130,5 @@ private:
 
     UnitTemplate defaultUnitTemplate;
     std::unordered_map<std::string, UnitTemplate> m_Units;
+    std::map<std::pair<std::string, Team>, bee::Prefab> m_prefabs;
 };
\ No newline at end of file
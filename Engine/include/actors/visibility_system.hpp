@@ -0,0 +1,108 @@
+#pragma once
+#include <array>
+#include <vector>
+
+#include "actors/actor_utils.hpp"
+#include "core/ecs.hpp"
+#include "tools/visibility_grid.hpp"
+
+/// <summary>
+/// Where an actor sees from on the VisibilitySystem, so the same stamp can be taken off again when it moves or goes
+/// away.
+/// </summary>
+struct VisibilitySource
+{
+    int cell = -1;  // -1 when it is off the grid
+    int radius = 0;
+    Team team = Team::Neutral;
+    uint32_t tick = 0;  // the last sync that saw it
+};
+
+/// <summary>
+/// The fog of war: a VisibilityGrid per team over the terrain tiles, seen by the units and structures of the team.
+///
+/// Every period it looks up the cell of every actor and only restamps the ones that moved to another cell, actors that
+/// are destroyed are taken off right away. Afterwards the enemy units the player cannot see, and the enemy structures
+/// the player has not explored yet, get bee::Hidden, along with their whole hierarchy, so children attached since the
+/// last sync follow on the next one. Rendering does not draw them, and targeting and the mouse skip them, without
+/// looking at the grid themselves.
+/// </summary>
+class VisibilitySystem : public bee::System
+{
+public:
+    /// <summary>
+    /// Syncs every period seconds. Actors see sightRange around them, or their interception range when it is further.
+    /// With lineOfSight, they do not see up cliffs.
+    /// </summary>
+    VisibilitySystem(float period = 0.1f, float sightRange = 8.0f, bool lineOfSight = true);
+    ~VisibilitySystem() override;
+    void Update(float dt) override;
+#ifdef BEE_INSPECTOR
+    void Inspect() override;
+#endif
+
+    /// <summary>
+    /// Covers the tiles of the terrain, if there is an entity with a TerrainDataComponent, with their heights for line
+    /// of sight.
+    /// </summary>
+    void UpdateFromTerrain();
+
+    /// <summary>
+    /// Covers width by height cells of cellSize, starting at origin, with the ground height of every cell for line of
+    /// sight. Nothing is explored afterwards, and everything is stamped again on the next sync.
+    /// </summary>
+    void SetBounds(const glm::vec2& origin, float cellSize, int width, int height, std::vector<float> heights = {});
+
+    /// <summary>
+    /// Brings the grids up to date right away.
+    /// </summary>
+    void Sync();
+
+    /// <summary>
+    /// What the team sees. There is none for Team::Neutral, which gets what the player sees.
+    /// </summary>
+    const bee::VisibilityGrid& GetGrid(Team team) const { return m_grids[GridIndex(team)]; }
+    bool IsVisible(Team team, const glm::vec2& position) const { return GetGrid(team).IsVisible(position); }
+
+    /// <summary>
+    /// Whether enemies the player cannot see get bee::Hidden, on by default.
+    /// </summary>
+    void SetHideEnemies(bool hide) { m_hideEnemies = hide; }
+    float GetPeriod() const { return m_period; }
+
+    /// <summary>
+    /// How many actors were stamped again on the last sync.
+    /// </summary>
+    int GetRestampCount() const { return m_restamps; }
+
+    /// <summary>
+    /// How many enemies were hidden after the last sync.
+    /// </summary>
+    int GetHiddenCount() const { return m_hidden; }
+
+private:
+    template <typename Tag>
+    void SyncObservers(Team team);
+
+    template <typename Tag>
+    void SyncHidden(bool structure);
+
+    // updates the source of the entity to next, restamping it when it moved
+    void Apply(bee::Entity entity, VisibilitySource next);
+    void Put(const VisibilitySource& source, int count);
+
+    static size_t GridIndex(Team team) { return team == Team::Enemy ? 0 : 1; }
+    int ToCells(float range) const;
+    void OnSourceDestroyed(entt::registry& registry, bee::Entity entity);
+
+    float m_period;
+    float m_sightRange;
+    bool m_lineOfSight;
+    bool m_hideEnemies = true;
+    float m_time = 0.0f;
+    uint32_t m_tick = 0;
+    int m_restamps = 0;
+    int m_hidden = 0;
+    std::array<bee::VisibilityGrid, 2> m_grids;  // by GridIndex
+    std::vector<bee::Entity> m_gone;             // scratch space for Sync
+};
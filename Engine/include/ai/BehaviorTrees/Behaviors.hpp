@@ -32,6 +32,7 @@ struct BehaviorTreeContext;
         float deltaTime = 0.0f;
         std::unique_ptr<Blackboard> blackboard = std::make_unique<Blackboard>();
         std::unordered_map<int, ai::Status> statuses;
+        std::vector<ai::Status> compiledStatuses;  // by node of a compiled tree, see BehaviorTree::Compile
     };
 
 
@@ -224,6 +225,9 @@ struct BehaviorTreeContext;
         {
             json["comparator"]= m_comparator.ToString();
         }
+
+        const Comparator<T>& GetComparator() const { return m_comparator; }
+        bool IsNegation() const { return m_isNegation; }
     private:
         Comparator<T> m_comparator;
         bool m_isNegation = false;
@@ -245,6 +249,12 @@ struct BehaviorTreeContext;
             m_function = tempFunction;
         }
         Status Tick(BehaviorTreeContext& context) override;
+
+        /**
+         * \brief Call the condition function, without executing the child
+         */
+        bool Check() const { return m_function(); }
+        bool IsNegation() const { return m_isNegation; }
     private:
         bool m_isNegation = false;
         std::function<bool()> m_function;
@@ -308,6 +318,8 @@ struct BehaviorTreeContext;
         {
             json["num-repeats"] = m_numRepeats;
         }
+
+        int GetNumRepeats() const { return m_numRepeats; }
     private:
         int m_numRepeats = 0;
     };
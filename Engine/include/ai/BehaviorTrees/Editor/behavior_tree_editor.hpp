@@ -32,7 +32,7 @@ namespace bee::ai
         std::unique_ptr<BehaviorTreeAction> underlyingAction{};
         std::optional<std::string> action{};
 
-        void DrawNode(size_t transitionIndex, const BehaviorTreeContext& context);
+        void DrawNode(size_t transitionIndex, const BehaviorTree& bt, const BehaviorTreeContext& context);
         void DrawNode(size_t transitionIndex);
         void AddChild(BehaviorWrapper child)
         {
@@ -64,7 +64,7 @@ namespace bee::ai
         void DrawChildMenu(ai::BehaviorWrapper& selected);
         void CheckSelectedNode(BehaviorWrapper& behavior);
         void DrawNodes();
-        void DrawNodesPreview(const BehaviorTreeContext& context);
+        void DrawNodesPreview(const BehaviorTree& bt, const BehaviorTreeContext& context);
         void DrawUpperMenu();
 
         void LoadBehavior(nlohmann::json& json, BehaviorWrapper& behavior, int& idToSet);
@@ -1,9 +1,40 @@
 #pragma once
+#include <cstdint>
 #include <memory>
+#include <vector>
 #include "behaviors.hpp"
 
 namespace bee::ai
 {
+/**
+ * \brief A behavior as stored in a compiled behavior tree (see BehaviorTree::Compile). The behaviors are stored in
+ * pre-order, so the children of a behavior follow it and a behavior with all of its descendants is one range of the
+ * array.
+ */
+struct CompiledBehavior
+{
+    enum class Type : uint8_t
+    {
+        Sequence,
+        Selector,
+        Repeater,
+        Inverter,
+        AlwaysSucceed,
+        UntilFail,
+        Comparison,
+        Condition,
+        Leaf
+    };
+
+    Type type = Type::Leaf;
+    bool isNegation = false;
+    uint32_t size = 1;             // this behavior and its descendants
+    uint32_t comparator = 0;       // comparisons: index into the comparators of the tree
+    int numRepeats = 0;            // repeaters
+    int id = 0;                    // of the behavior this was compiled from
+    Behavior* behavior = nullptr;  // leaves: the behavior to call, conditions: the condition to check
+};
+
 /**
  * \brief A class for a behavior tree. It can be executed using an Execute() function and a
  * behavior tree execution context.
@@ -17,16 +48,50 @@ class BehaviorTree
          * \param context - A behavior tree execution context
          */
         void Execute(BehaviorTreeContext& context) const;
+
         /**
-         * \brief A getter for the root 
+         * \brief Flatten the tree into one array of behaviors, in pre-order, with the comparators of the comparisons
+         * looked up once. Execute then runs a loop over the array instead of the virtual calls of the behaviors, and
+         * keeps the statuses in BehaviorTreeContext::compiledStatuses; actions are still called as they are. Building
+         * and loading a tree compiles it. Trees with behaviors of other types than the builder makes, or decorators
+         * without a child, are not compiled and run as they are.
+         * \return - whether the tree was compiled
+         */
+        bool Compile();
+
+        bool IsCompiled() const { return m_compiled; }
+
+        /**
+         * \brief The status of a behavior after the last Execute with the context, whether the tree is compiled or not
+         * \param id - the id of the behavior
+         * \return - the status, INVALID when the behavior has not run
+         */
+        Status GetStatus(const BehaviorTreeContext& context, int id) const;
+        const std::vector<CompiledBehavior>& GetCompiledBehaviors() const { return m_compiledBehaviors; }
+
+        /**
+         * \brief A getter for the root. The root may be edited through it, which undoes Compile.
          * \return - a pointer to the root behavior
          */
-        std::unique_ptr<Behavior>& GetRoot()  { return m_root; }
+        std::unique_ptr<Behavior>& GetRoot()
+        {
+            m_compiled = false;
+            return m_root;
+        }
 
         std::stringstream Serialize() const;
         static std::unique_ptr<BehaviorTree> Deserialize(std::stringstream& stringstream);
     private:
+        bool CompileBehavior(Behavior& behavior);
+        Status ExecuteCompiled(uint32_t index, BehaviorTreeContext& context) const;
+        Status TickCompiled(uint32_t index, Status previous, BehaviorTreeContext& context) const;
+        static void ResetCompiled(uint32_t first, uint32_t last, BehaviorTreeContext& context);
+
         std::unique_ptr<Behavior> m_root = {};
+
+        bool m_compiled = false;
+        std::vector<CompiledBehavior> m_compiledBehaviors;
+        std::vector<CompiledComparator> m_compiledComparators;
     };
 }
 
@@ -86,9 +86,10 @@ public:
     /**
      * \brief Finish building of the tree, return a unique_ptr to the tree that was created as a result
      * of previously ran builder functions
+     * \param compile - whether to compile the tree, see BehaviorTree::Compile
      * \return - a unique_ptr to the behavior tree
      */
-    std::unique_ptr<ai::BehaviorTree> End();
+    std::unique_ptr<ai::BehaviorTree> End(bool compile = true);
     /**
      * \brief Given a root node of a behavior tree. Return a string stream that is a serialized version
      * of the given behavior tree.
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <vector>
 #include <cassert>
 #include <sstream>
 #include <nlohmann/json.hpp>
@@ -37,6 +40,23 @@ namespace bee::ai
         static constexpr bool value = decltype(Test<T>(0))::value;
     };
 
+    /**
+     * \brief A blackboard key that is looked up by name once. Every name gets one id for the whole program, blackboards
+     * remember where they keep the value of an id, so later lookups with the key skip hashing and comparing the name.
+     */
+    class BlackboardKey
+    {
+    public:
+        explicit BlackboardKey(const std::string& name);
+
+        const std::string& GetName() const { return *m_name; }
+        uint32_t GetId() const { return m_id; }
+
+    private:
+        uint32_t m_id;
+        const std::string* m_name;
+    };
+
     class Blackboard
     {
     public:
@@ -52,16 +72,39 @@ namespace bee::ai
         {
             assert(!std::is_reference<TValueType>());
 
-            if (m_Map.find(key) != m_Map.end())
+            const auto it = m_Map.find(key);
+            if (it != m_Map.end())
             {
-                static_cast<Handle<TValueType>*>(m_Map[key].get())->SetData(value);
+                auto* handle = static_cast<Handle<TValueType>*>(it->second.get());
+                if (handle->SetData(value)) handle->stamp = ++m_stamp;
             }
             else
             {
-                m_Map[key] = std::make_unique<Handle<TValueType>>(Handle<TValueType>(std::move(value)));
+                auto handle = std::make_unique<Handle<TValueType>>(Handle<TValueType>(std::move(value)));
+                handle->stamp = ++m_stamp;
+                m_Map[key] = std::move(handle);
+                m_generation++;  // keys that were missing may be here now
             }
         }
 
+        /**
+         * \brief The change stamp of the last change to any value. Stamps only go up, so a value changed since a moment
+         * if its stamp is higher than the stamp of the blackboard was then. Setting a value to what it already is does
+         * not count as a change for numbers, strings and enums; changing a value through the reference of GetData or
+         * the pointer of TryGet never counts.
+         */
+        uint32_t GetChangeStamp() const { return m_stamp; }
+
+        /**
+         * \brief The change stamp of the last change to the value of the key: setting it, adding it, or clearing the
+         * blackboard while it is missing
+         */
+        uint32_t GetChangeStamp(const BlackboardKey& key) const
+        {
+            const IHandle* handle = FindHandle(key);
+            return handle != nullptr ? handle->stamp : m_clearStamp;
+        }
+
         /**
          * \brief Get reference to an element of a key 'key'
          * \tparam TValueType - The type of value that is set for the key
@@ -105,6 +148,23 @@ namespace bee::ai
             return handle->get();
         }
 
+        /**
+         * \brief TryGet with a key that was looked up before, which only hashes the name the first time this
+         * blackboard is asked for it (and again after keys were added, while it is missing)
+         * \tparam TValueType - The type of value that is set for the key
+         * \param key - key of the value
+         * \return - a pointer to element or nullptr
+         */
+        template <typename TValueType>
+        TValueType* const TryGet(const BlackboardKey& key) const
+        {
+            IHandle* handle = FindHandle(key);
+
+            if (handle == nullptr || handle->type != TypeTag<TValueType>()) return nullptr;
+
+            return static_cast<Handle<TValueType>*>(handle)->get();
+        }
+
         /**
          * \brief A check method if a given key has a value set
          * \param key - the key to check
@@ -130,6 +190,9 @@ namespace bee::ai
         void Clear()
         {
             m_Map.clear();
+            m_slots.clear();
+            m_generation++;
+            m_clearStamp = ++m_stamp;
         }
 
         std::vector<std::pair<std::string, std::string>> PreviewToString();
@@ -138,8 +201,26 @@ namespace bee::ai
         {
             virtual std::string ToString() const { return ""; };
             virtual ~IHandle() = default;
+            const void* type = nullptr;  // TypeTag of the value, checked instead of a dynamic_cast
+            uint32_t stamp = 0;          // of the last change, see GetChangeStamp
         };
 
+        template <typename T>
+        static const void* TypeTag()
+        {
+            static const char tag = 0;
+            return &tag;
+        }
+
+        // Where the value of a BlackboardKey is. A missing value is remembered until a key is added.
+        struct Slot
+        {
+            IHandle* handle = nullptr;
+            uint32_t generation = 0;
+        };
+
+        IHandle* FindHandle(const BlackboardKey& key) const;
+
         struct HandleToStringStream
         {
             std::stringstream stream;
@@ -153,16 +234,29 @@ namespace bee::ai
         template <typename T>
         struct Handle : IHandle
         {
-            Handle(T data) : m_Data(std::move(data)) {}
+            Handle(T data) : m_Data(std::move(data)) { type = TypeTag<T>(); }
             T* get() { return &(m_Data); }
 
             std::string ToString() const override;
-            void SetData(T& t) { m_Data = t; }
+            // whether the value changed, assumed for types that are not cheap to compare
+            bool SetData(T& t)
+            {
+                if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_same_v<T, std::string>)
+                {
+                    if (m_Data == t) return false;
+                }
+                m_Data = t;
+                return true;
+            }
         private:
             T m_Data;
         };
 
         std::unordered_map<std::string, std::unique_ptr<IHandle>> m_Map;
+        mutable std::vector<Slot> m_slots;  // by BlackboardKey id
+        uint32_t m_generation = 1;          // changes whenever keys are added or cleared
+        uint32_t m_stamp = 0;               // of the last change to any value
+        uint32_t m_clearStamp = 0;          // of the last Clear
     };
 
     template <typename T>
@@ -1,4 +1,5 @@
 #pragma once
+#include <optional>
 #include <sstream>
 #include <string>
 #include <type_traits>
@@ -191,4 +192,40 @@ bool Comparator<T>::Evaluate(const Blackboard& blackboard) const
             return false;
     }
 }
+
+/**
+ * \brief A comparator as stored in compiled state machines and behavior trees (see FiniteStateMachine::Compile and
+ * BehaviorTree::Compile). The blackboard key is looked up once and the value is kept by type, so evaluating it takes no
+ * virtual call and no dynamic_cast. Comparators of types other than the ones the editor makes keep their virtual
+ * Evaluate.
+ */
+struct CompiledComparator
+{
+    enum class ValueType
+    {
+        Float,
+        Double,
+        Bool,
+        Int,
+        String,
+        Other
+    };
+
+    explicit CompiledComparator(const IComparator& comparator);
+
+    /**
+     * \brief Same as IComparator::Evaluate on the comparator this was compiled from
+     */
+    bool Evaluate(const Blackboard& blackboard) const;
+
+    ValueType type = ValueType::Other;
+    ComparisonType comparison = ComparisonType::EQUAL;
+    std::optional<BlackboardKey> key;
+    float floatValue = 0.0f;
+    double doubleValue = 0.0;
+    bool boolValue = false;
+    int intValue = 0;
+    std::string stringValue;
+    const IComparator* other = nullptr;
+};
 }  // namespace bee::ai
\ No newline at end of file
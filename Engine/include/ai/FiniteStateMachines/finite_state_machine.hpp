@@ -1,11 +1,20 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <optional>
+#include <string>
 #include <typeindex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include <nlohmann/json.hpp>
 
 #include "ai/Blackboards/comparator.hpp"
 #include "ai/Utils/execution_context.hpp"
+#include "ai/world_snapshot.hpp"
+#include "core/ecs.hpp"
 #include "core/engine.hpp"
 #include "core/fwd.hpp"
 #include "core/resource.hpp"
@@ -14,6 +23,7 @@
 
 namespace bee::ai
 {
+class AIBehaviorSelectionSystem;
 class EditorVariable;
 class State;
 
@@ -27,9 +37,74 @@ struct StateMachineContext : AIExecutionContext
     std::unique_ptr<Blackboard> blackboard = std::make_unique<Blackboard>();
     std::optional<size_t> GetCurrentState() const { return currentState; }
 
+    /**
+     * \brief The components of the other agents as they were before the agents started running, set while this agent
+     * runs in parallel with them (see AIBehaviorSelectionSystem). Null when it runs on its own.
+     */
+    const WorldSnapshot* snapshot = nullptr;
+
+    /**
+     * \brief Read a component of another entity. While running in parallel, the copy in the snapshot if it has one, so
+     * the result does not depend on which agents ran first; the component in the registry otherwise.
+     * \return - the component, or nullptr if the entity does not exist or has none
+     */
+    template <typename T>
+    const T* Read(Entity other) const
+    {
+        if (snapshot != nullptr)
+        {
+            if (const T* copy = snapshot->Find<T>(other)) return copy;
+        }
+        const auto& registry = std::as_const(Engine.ECS().Registry);
+        return registry.valid(other) ? registry.try_get<T>(other) : nullptr;
+    }
+
+    /**
+     * \brief Make a change that reaches beyond this agent: function(target) is called right away when running on its
+     * own, and recorded in the command buffer of the thread when running in parallel, to be called when the engine
+     * plays the commands back. Either way, it is not called if the target no longer exists.
+     */
+    template <typename F>
+    void Defer(Entity target, F&& function) const
+    {
+        if (snapshot != nullptr)
+        {
+            Engine.ECS().Commands().Call(target, std::forward<F>(function));
+            return;
+        }
+        const auto& registry = Engine.ECS().Registry;
+        if (registry.valid(target) && !registry.all_of<Delete>(target)) function(target);
+    }
+
+    /**
+     * \brief Have an event-driven state machine (see FiniteStateMachine::TransitionEvaluation) check all transitions of
+     * the current state on the first Execute after this many seconds of deltaTime were passed to the Executes that
+     * followed this one, whether or not their blackboard values changed. That is when a timer set to the same time and
+     * counted down in Update runs out. For transitions that wait on time, or on values changed through the reference
+     * GetData returns. The earliest wake-up asked for wins, it is forgotten once it happened.
+     */
+    void WakeUpIn(float seconds) { wakeUpIn = std::min(wakeUpIn, seconds); }
+
+    /**
+     * \brief Have AIBehaviorSelectionSystem stop ticking the agent after this Execute, until the seconds have passed,
+     * its blackboard changes (see Blackboard::GetChangeStamp), its state is set from outside, its time slice is
+     * prioritized, or the system is asked to Wake it. Without a time it sleeps until one of the others. For states that
+     * only wait: the first tick after waking gets all the time slept as deltaTime.
+     */
+    void Suspend(float seconds = std::numeric_limits<float>::infinity()) { suspendFor = seconds; }
+
 private:
     std::optional<size_t> currentState;
+    std::optional<float> suspendFor;  // asked for by the last Execute, taken by AIBehaviorSelectionSystem
+
+    // event-driven evaluation: the state whose transitions were all found false, the blackboard and its change stamp
+    // when they were, and the time until a wake-up
+    std::optional<size_t> quietState;
+    const Blackboard* quietBlackboard = nullptr;
+    uint32_t quietSince = 0;
+    float wakeUpIn = std::numeric_limits<float>::infinity();
     friend class FiniteStateMachine;
+    friend class AIBehaviorSelectionSystem;
 };
 
 struct TransitionData
@@ -54,6 +129,16 @@ private:
 };
 
 
+/**
+ * \brief A transition in a compiled transition table: its comparators are a range of the table's comparators
+ */
+struct CompiledTransition
+{
+    uint32_t firstComparator = 0;
+    uint32_t comparatorCount = 0;
+    size_t stateToGoTo = 0;
+};
+
 /**
  * \brief Base class for the state machine state
  */
@@ -92,6 +177,14 @@ public:
     }
 
     std::unordered_map<std::string, EditorVariable*> editorVariables{};
+
+    /**
+     * \brief Whether agents in this state may run in parallel with each other. A parallel-safe state only writes the
+     * components and blackboard of its own agent, reads other entities through StateMachineContext::Read, makes every
+     * other change through StateMachineContext::Defer, and keeps no per-agent data in the state object itself, which
+     * the agents of a state machine share. Set it in the constructor of the state.
+     */
+    bool parallelSafe = false;
 };
 
 /**
@@ -122,6 +215,19 @@ private:
 class FiniteStateMachine : public Resource
 {
 public:
+    /**
+     * \brief How a compiled state machine checks the transitions of the current state of an agent.
+     * Polling checks all of them on every Execute. EventDriven only checks the ones with a blackboard value that
+     * changed (see Blackboard::GetChangeStamp) since they were all found false, or all of them after a state change or
+     * a wake-up (see StateMachineContext::WakeUpIn). Both take the same transitions as long as the values transitions
+     * look at are set with SetData, and the states that wait on anything else ask for wake-ups.
+     */
+    enum class TransitionEvaluation
+    {
+        Polling,
+        EventDriven
+    };
+
     FiniteStateMachine(): Resource(ResourceType::FiniteStateMachine)
     {
 
@@ -144,6 +250,7 @@ public:
 
         if (!DeserializeStates(json["states"], *this)) return;
         DeserializeTransitionData(json["transition-data"], *this);
+        Compile();
     }
 
     /**
@@ -163,6 +270,8 @@ public:
         }
 
         m_states.push_back(std::move(std::make_unique<T>(args...)));
+        m_compiled = false;
+        IndexState(m_states.size() - 1);
         return m_states.size() - 1;
     }
 
@@ -180,6 +289,7 @@ public:
     {
         assert(from < m_states.size());
         assert(to < m_states.size());
+        m_compiled = false;
 
         for (auto&& transitionData : m_transitions[from])
         {
@@ -221,6 +331,7 @@ public:
     {
         assert(from < m_states.size());
         assert(to < m_states.size());
+        m_compiled = false;
 
         for (auto& transitionData : m_transitions[from])
         {
@@ -243,6 +354,7 @@ public:
     void RemoveState(size_t i)
     {
         if (i >= m_states.size()) return;
+        m_compiled = false;
         m_states.erase(m_states.begin() + i);
         m_transitions.erase(i);
 
@@ -251,6 +363,7 @@ public:
         {
             auto& transitions = element.second;transitions.erase(std::remove_if(transitions.begin(), transitions.end(),[i](const TransitionData& data) { return data.StateToGoTo() == i; }),transitions.end());
         }
+        IndexStates();
     }
 
     /**
@@ -259,6 +372,28 @@ public:
      */
     void Execute(StateMachineContext& context);
 
+    /**
+     * \brief Flatten the transitions into one table, in state order, and look up the blackboard keys of the comparators
+     * once. Execute then goes through the table instead of the transitions. Loading a state machine compiles it; adding
+     * or removing states and transitions undoes it, call Compile again after editing.
+     */
+    void Compile();
+
+    bool IsCompiled() const { return m_compiled; }
+
+    /**
+     * \brief Opt in to event-driven transitions. Only applies while the state machine is compiled.
+     */
+    void SetTransitionEvaluation(TransitionEvaluation evaluation) { m_transitionEvaluation = evaluation; }
+    TransitionEvaluation GetTransitionEvaluation() const { return m_transitionEvaluation; }
+
+    /**
+     * \brief Whether the agent with this context may run in parallel with others this tick: the state machine is
+     * compiled, and its current state and the states of the transitions that would be taken now are parallel safe
+     * (see State::parallelSafe).
+     */
+    bool CanRunInParallel(const StateMachineContext& context) const;
+
     /**
      * \brief Given a state Id and a state machine execution context
      * end the current state and set it to 'stateToSet'
@@ -276,32 +411,23 @@ public:
 
     /**
      * \brief Get a vector of IDs of states of a given type. If no states like this exist,
-     * an empty vector is returned.
+     * an empty vector is returned. The IDs are kept by type whenever states are loaded, added or removed, so this
+     * neither scans the states nor allocates.
      * \tparam T - the type of the state
      * \return - a vector of ids of states of type T
      */
     template<typename T>
-    std::vector<size_t> GetStateIDsOfType()
+    const std::vector<size_t>& GetStateIDsOfType() const
     {
-        std::vector<size_t> toReturn{};
+        static const std::vector<size_t> none{};
 
-        size_t id = 0;
-        for (const auto& state : m_states)
-        {
-            if (typeid(*state) == typeid(T))
-            {
-                toReturn.push_back(id);
-            } 
-            id++;
-        }
-
-        return toReturn;
+        const uint32_t type = GetStateTypeId<T>();
+        return type < m_statesOfType.size() ? m_statesOfType[type] : none;
     }
     template<typename T>
-    bool StateExists()
+    bool StateExists() const
     {
-        std::vector<size_t> stateVec = GetStateIDsOfType<T>();
-        return !stateVec.empty();
+        return !GetStateIDsOfType<T>().empty();
     }
 
     std::type_index GetStateType(size_t index)
@@ -313,12 +439,33 @@ public:
      * \brief - Given a stringstream, return a unique ptr to a finitestatemachine created by deserializing
      * them from the string stream.
      * \param stream - a string stream with states and transitions to them
+     * \param compile - whether to Compile the state machine
      * \return - a unique ptr to a finite state machine
      */
-    static std::unique_ptr<FiniteStateMachine> DeserializeFromStringStream(std::stringstream& stream);
+    static std::unique_ptr<FiniteStateMachine> DeserializeFromStringStream(std::stringstream& stream, bool compile = true);
 
     static std::string GetPath(const std::string& path) { return Resource::GetPath(path); }
 private:
+    /**
+     * \brief A small number for every state type, handed out the first time the type is asked for, which indexes
+     * m_statesOfType
+     */
+    static uint32_t GetStateTypeId(const std::type_index& type);
+
+    template <typename T>
+    static uint32_t GetStateTypeId()
+    {
+        static const uint32_t id = GetStateTypeId(typeid(T));
+        return id;
+    }
+
+    void IndexState(size_t index);
+    void IndexStates();
+
+    bool CanTransition(const CompiledTransition& transition, const Blackboard& blackboard) const;
+    bool InputsChanged(const CompiledTransition& transition, const Blackboard& blackboard, uint32_t since) const;
+    void Transition(size_t from, size_t to, StateMachineContext& context) const;
+
     static bool DeserializeStates(nlohmann::json& json, FiniteStateMachine& stateMachine);
     static void DeserializeTransitions(nlohmann::json json, ai::TransitionData& tempData);
     static void DeserializeTransitionData(nlohmann::json json, FiniteStateMachine& stateMachine);
@@ -326,6 +473,14 @@ private:
     std::optional<size_t> m_defaultState = {};
     std::vector<std::unique_ptr<State>> m_states;
     std::unordered_map<size_t, std::vector<TransitionData>> m_transitions;
+
+    // the compiled transition table, the transitions of state i are m_compiledStates[i] up to m_compiledStates[i + 1]
+    bool m_compiled = false;
+    std::vector<uint32_t> m_compiledStates;
+    std::vector<CompiledTransition> m_compiledTransitions;
+    std::vector<CompiledComparator> m_compiledComparators;
+    TransitionEvaluation m_transitionEvaluation = TransitionEvaluation::Polling;
+    std::vector<std::vector<size_t>> m_statesOfType;  // the ids of the states of every type, by state type id
     friend class FiniteStateMachine;
     nlohmann::json m_editorData;
     friend class FiniteStateMachine;
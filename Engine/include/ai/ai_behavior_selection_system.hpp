@@ -6,23 +6,110 @@
 #include "FiniteStateMachines/finite_state_machine.hpp"
 #include "FiniteStateMachines/Editor/finite_state_machine_editor.hpp"
 #include "Utils/blackboard_inspector.hpp"
+#include "ai/time_slicer.hpp"
+#include "ai/timer_wheel.hpp"
+#include "ai/world_snapshot.hpp"
 
 namespace bee::ai
 {
+    class StateMachineAgent;
+
+    /// <summary>
+    /// Ticks the behaviour trees and state machines every fixedDeltaTime. The agents are time sliced (see TimeSlicer),
+    /// so each frame ticks a share of them; call TimeSlice::Prioritize on an agent to tick it on the next frame.
+    ///
+    /// State machine agents that can not run in parallel (see FiniteStateMachine::CanRunInParallel) tick first, one
+    /// after another. The others tick after that, against a snapshot of the components captured with GetSnapshot, and
+    /// their deferred changes are made when the engine plays the commands back. They are ordered by entity, so the
+    /// result is the same whether they ran in parallel or serially.
+    ///
+    /// State machine agents whose state suspended them (see StateMachineContext::Suspend) are skipped until they wake.
+    /// Their timers are kept in a TimerWheel; an agent whose timer ran out ticks on the same frame.
+    ///
+    /// What the agents touch depends on their states, so the system only declares its access (see System::Reads) once
+    /// told with StatesRead and StatesWrite. Until then it runs on its own.
+    /// </summary>
     class AIBehaviorSelectionSystem : public bee::System
     {
     public:
-        AIBehaviorSelectionSystem(float fixedDeltaTime);
+        /// <summary>
+        /// How the parallel-safe state machine agents tick. Both give the same result, Serial is for comparing and
+        /// debugging.
+        /// </summary>
+        enum class StateMachineExecution
+        {
+            Serial,
+            Parallel
+        };
+
+        AIBehaviorSelectionSystem(float fixedDeltaTime, int bucketCount = 0);
+        ~AIBehaviorSelectionSystem() override;
         void Update(float dt) override;
         void Render() override;
     #ifdef BEE_INSPECTOR
         void Inspect() override;
         void Inspect(bee::Entity e) override;
     #endif
+        const TimeSlicer& GetTimeSlicer() const { return m_slicer; }
+
+        void SetStateMachineExecution(StateMachineExecution execution) { m_execution = execution; }
+        StateMachineExecution GetStateMachineExecution() const { return m_execution; }
+
+        /// <summary>
+        /// The snapshot the parallel-safe agents read other entities from. Capture the components parallel-safe states
+        /// read of other entities and write of their own.
+        /// </summary>
+        WorldSnapshot& GetSnapshot() { return m_snapshot; }
+
+        /// <summary>
+        /// How many state machine agents ticked in parallel on the last update.
+        /// </summary>
+        size_t GetParallelAgentCount() const { return m_parallelAgents.size(); }
+
+        /// <summary>
+        /// Wakes a suspended state machine agent, which then ticks when its time slice is due. Prioritize its slice as
+        /// well to tick it on the next update.
+        /// </summary>
+        void Wake(Entity entity);
+
+        /// <summary>
+        /// How many state machine agents were suspended after the last update.
+        /// </summary>
+        size_t GetSuspendedAgentCount() const { return m_suspendedAgents; }
+        const TimerWheel& GetTimerWheel() const { return m_timers; }
+
+        /// <summary>
+        /// Declares the types the states and trees of the agents read or write, besides the agents themselves. Units
+        /// and projectiles they spawn count as well, with bee::Entity for the creating.
+        /// </summary>
+        template <typename... T>
+        void StatesRead()
+        {
+            DeclareAgentAccess();
+            Reads<T...>();
+        }
+        template <typename... T>
+        void StatesWrite()
+        {
+            DeclareAgentAccess();
+            Writes<T...>();
+        }
     private:
-       float m_fixedDeltaTime = 0.1f;
-       float m_timeSinceLastFrame = 0.0f;
-       bool m_hasExecutedFrame = false;
+       void DeclareAgentAccess();
+       void ExecuteParallelAgents();
+
+       // takes the suspension the last Execute of the agent asked for
+       void Suspend(Entity entity, StateMachineAgent& agent);
+       void Resume(Entity entity, StateMachineAgent& agent);
+       void OnAgentDestroyed(entt::registry& registry, Entity entity);
+
+       TimeSlicer m_slicer;
+       StateMachineExecution m_execution = StateMachineExecution::Parallel;
+       WorldSnapshot m_snapshot;
+       std::vector<Entity> m_parallelAgents;
+       TimerWheel m_timers;
+       std::vector<Entity> m_expiredTimers;
+       size_t m_suspendedAgents = 0;
     };
 
     class StateMachineAgent
@@ -41,7 +128,7 @@ namespace bee::ai
         template<typename StateType>
         void SetStateOfType()
         {
-            const std::vector<size_t> ids = fsm.GetStateIDsOfType<StateType>();
+            const std::vector<size_t>& ids = fsm.GetStateIDsOfType<StateType>();
 
             if (ids.empty()) return;
 
@@ -51,6 +138,19 @@ namespace bee::ai
 
         ai::FiniteStateMachine& fsm;
         ai::StateMachineContext context;
+        TimeSlice slice;
+
+        /// <summary>
+        /// Whether a state suspended the agent, and the state and blackboard change stamp it was suspended with. Kept by
+        /// AIBehaviorSelectionSystem.
+        /// </summary>
+        struct Suspension
+        {
+            bool suspended = false;
+            std::optional<size_t> state;
+            uint32_t blackboardStamp = 0;
+        };
+        Suspension suspension;
     };
 
     class BTAgent
@@ -60,6 +160,7 @@ namespace bee::ai
 
         ai::BehaviorTree& bt;
         ai::BehaviorTreeContext context;
+        TimeSlice slice;
     };
 
 }
@@ -1,5 +1,8 @@
 #pragma once
+#include <atomic>
+
 #include "ai/navigation_path.hpp"
+#include "ai/time_slicer.hpp"
 #include "core/ecs.hpp"
 #include "navigation_grid.hpp"
 
@@ -27,12 +30,18 @@ struct GridAgent
     float verticalPosition = 0;
     bool recomputePath = false;
     bee::ai::NavigationPath path = {};
+    TimeSlice slice;  // prioritized, the agent steers on the next frame after its goal changes
 };
 
+/// <summary>
+/// Moves the grid agents along their paths. Path finding and steering run every fixedDeltaTime per agent, time sliced
+/// (see TimeSlicer) and less often for agents out of view (see SimulationLOD); following the path and handing the
+/// velocity to physics happen every frame.
+/// </summary>
 class GridNavigationSystem : public bee::System
 {
 public:
-    GridNavigationSystem(float fixedDeltaTime, const bee::ai::NavigationGrid& grid);
+    GridNavigationSystem(float fixedDeltaTime, const bee::ai::NavigationGrid& grid, int bucketCount = 0);
     ~GridNavigationSystem() override{};
     void Update(float dt) override;
     bee::ai::NavigationGrid& GetGrid() { return m_grid; }
@@ -41,11 +50,18 @@ public:
     // This function will work as intended if there is an entity with a TerrainDataComponent that exists.
     void UpdateFromTerrain();
 
+    /// <summary>
+    /// How many agents steered, and how many had their height on the terrain updated, on the last update.
+    /// </summary>
+    int GetSteeredAgentCount() const { return m_steeredAgents; }
+    int GetVerticalUpdateCount() const { return m_verticalUpdates; }
+
 private:
     void Separation(const float detectionRadius, const glm::vec2& currentPos, const glm::vec2& otherAgentPos, glm::vec2& prefferedVelocity) const;
 
     bee::ai::NavigationGrid m_grid{{0, 0}, 0, 0, 0};
-    float m_fixedDeltaTime = 1.0f;
-    float m_timeSinceLastFrame = 0.0f;
+    TimeSlicer m_slicer;
+    int m_steeredAgents = 0;
+    std::atomic<int> m_verticalUpdates = 0;
 };
 }  // namespace bee::ai
\ No newline at end of file
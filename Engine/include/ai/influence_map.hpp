@@ -0,0 +1,119 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace bee::ai
+{
+
+/// <summary>
+/// The layers of an InfluenceMap.
+/// </summary>
+enum class InfluenceLayer
+{
+    AllyThreat,    // damage per second the player can deal in a cell
+    EnemyThreat,   // the same for the enemy
+    AllyDensity,   // how many units of the player stand in a cell
+    EnemyDensity,  // the same for the enemy
+    Resources,     // what the resources in a cell are worth
+    Count
+};
+
+/// <summary>
+/// What is where on the terrain, in a uniform grid of cells: threat and unit density per team, and resource value,
+/// plus how long ago a cell was last in sight. Things are stamped onto the map when they arrive in a cell and the same
+/// stamp is taken off again when they leave, so keeping the map up to date costs as much as the things that moved.
+/// The queries look at every cell once, however many things there are.
+///
+/// The values are kept in fixed point, so taking a stamp off leaves exactly what was there before it.
+/// </summary>
+class InfluenceMap
+{
+public:
+    /// <summary>
+    /// Covers width by height cells of cellSize, starting at origin. Clears the map.
+    /// </summary>
+    void Resize(const glm::vec2& origin, float cellSize, int width, int height);
+
+    /// <summary>
+    /// The cell the position is in, -1 when it is outside of the map.
+    /// </summary>
+    int GetCell(const glm::vec2& position) const;
+    glm::vec2 GetCellCenter(int cell) const;
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetCellCount() const { return m_width * m_height; }
+    float GetCellSize() const { return m_cellSize; }
+
+    /// <summary>
+    /// Adds value to the cells within radius cells of cell, falling off linearly to nothing at radius + 1 cells. Stamp
+    /// -value with the same radius to take it off again. Does nothing for cell -1.
+    /// </summary>
+    void Stamp(InfluenceLayer layer, int cell, int radius, float value);
+    float Get(InfluenceLayer layer, int cell) const;
+
+    /// <summary>
+    /// Adds (count 1) or takes away (count -1) an observer that sees the cells within radius cells of cell. Cells that
+    /// no observer sees any more remember the time.
+    /// </summary>
+    void See(int cell, int radius, int count, float time);
+    bool IsInSight(int cell) const { return m_observers[cell] > 0; }
+
+    /// <summary>
+    /// How long ago the cell was last in sight: zero while it is, infinity when it never was.
+    /// </summary>
+    float GetExploredAge(int cell, float time) const;
+
+    /// <summary>
+    /// The center of the cell with units on the density layer whose neighbourhood of radius cells has the least
+    /// threat, of those with as little threat the one with the most units. Nothing when there are no units.
+    /// </summary>
+    std::optional<glm::vec2> FindWeakestCluster(InfluenceLayer density, InfluenceLayer threat, int radius = 1) const;
+
+    /// <summary>
+    /// The center of the cell with resources with the least threat, of those with as little threat the closest to
+    /// from. Nothing when there are no resources.
+    /// </summary>
+    std::optional<glm::vec2> FindSafestResource(InfluenceLayer threat, const glm::vec2& from) const;
+
+    /// <summary>
+    /// The center of the cell that was out of sight for the longest, of those the closest to from. Nothing when every
+    /// cell is in sight.
+    /// </summary>
+    std::optional<glm::vec2> FindLeastExplored(const glm::vec2& from, float time) const;
+
+    // The largest radius of a stamp, larger ones are cut off.
+    static constexpr int MaxRadius = 16;
+
+    // The smallest step of the values.
+    static constexpr float Resolution = 1.0f / 64.0f;
+
+private:
+    struct KernelCell
+    {
+        int x = 0;
+        int y = 0;
+        float weight = 0.0f;
+    };
+
+    const std::vector<KernelCell>& GetKernel(int radius);
+
+    // calls function(cell, weight) for the cells of the kernel around cell that are on the map
+    template <typename F>
+    void ForEachInKernel(int cell, int radius, F&& function);
+
+    glm::vec2 m_origin = {};
+    float m_cellSize = 1.0f;
+    int m_width = 0;
+    int m_height = 0;
+    std::vector<std::vector<int32_t>> m_layers;  // by InfluenceLayer, by cell
+    std::vector<int32_t> m_observers;            // by cell, how many observers see it
+    std::vector<float> m_lastSeen;               // by cell, when the last observer stopped seeing it
+    std::vector<std::vector<KernelCell>> m_kernels;  // by radius, built when first used
+    mutable std::vector<int64_t> m_sums;             // scratch space for FindWeakestCluster
+};
+
+}  // namespace bee::ai
@@ -0,0 +1,68 @@
+#pragma once
+#include "core/ecs.hpp"
+
+namespace bee::ai
+{
+
+/// <summary>
+/// The time slicing state of one agent, kept in the agent component. See TimeSlicer.
+/// </summary>
+struct TimeSlice
+{
+    double lastTick = -1.0;  // clock of the slicer at the last tick, negative before the first
+    bool priority = false;   // tick on the next frame instead of waiting for the bucket
+
+    /// <summary>
+    /// Lets the agent jump the queue, for example when the player gave it an order.
+    /// </summary>
+    void Prioritize() { priority = true; }
+};
+
+/// <summary>
+/// Spreads a fixed rate update of many agents over frames. Agents are put in buckets by entity id and the buckets take
+/// turns, one every period / bucketCount seconds, so every agent still ticks once per period but every frame does about
+/// the same amount of work, instead of all of it every period.
+///
+/// An agent is handed the time since its own last tick, so it keeps its nominal rate whatever the frame rate is and
+/// when it jumped the queue in between. An agent that needs less attention, like one far from the camera (see
+/// SimulationLOD), can tick only every few periods, and is then handed all of that time.
+/// </summary>
+class TimeSlicer
+{
+public:
+    /// <summary>
+    /// A bucket count of 0 picks one bucket per 1/60 s of the period, so at 60 frames per second one bucket updates
+    /// every frame.
+    /// </summary>
+    explicit TimeSlicer(float period, int bucketCount = 0);
+
+    /// <summary>
+    /// Moves the clock forward and works out which buckets are due this frame. Call once per frame, before Tick.
+    /// </summary>
+    void Advance(float dt);
+
+    /// <summary>
+    /// Whether the agent ticks this frame: its bucket is due and interval periods passed since its last tick, or it
+    /// jumps the queue. If so, dt is set to the time since its last tick (the period for its first one) and the
+    /// priority of the slice is cleared.
+    /// Agents are independent, so this may be called for different agents at the same time.
+    /// </summary>
+    bool Tick(Entity entity, TimeSlice& slice, float& dt, bool jumpQueue, int interval = 1) const;
+
+    float GetPeriod() const { return m_period; }
+    int GetBucketCount() const { return m_bucketCount; }
+    double GetTime() const { return m_time; }
+
+private:
+    bool IsBucketDue(int bucket) const;
+
+    float m_period;
+    int m_bucketCount;
+    double m_time = 0.0;
+    float m_sinceLastBucket = 0.0f;
+    int m_nextBucket = 0;
+    int m_firstDueBucket = 0;
+    int m_dueBuckets = 0;  // starting at m_firstDueBucket, wrapping around
+};
+
+}  // namespace bee::ai
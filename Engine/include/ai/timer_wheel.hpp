@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "core/ecs.hpp"
+
+namespace bee::ai
+{
+
+/// <summary>
+/// Timers of entities, kept in a hierarchical timer wheel: four levels of 64 slots, each level covering 64 times the
+/// span of the one below it, at the given resolution. Scheduling and cancelling a timer take constant time, and moving
+/// the clock forward only looks at the slots the clock passes, however many timers there are. A timer moves down a
+/// level whenever the clock reaches the slot it is in, until it is due.
+///
+/// Timers expire on the first Advance that takes the clock to or past their deadline, not rounded to the resolution.
+/// An entity has one timer at most.
+/// </summary>
+class TimerWheel
+{
+public:
+    explicit TimerWheel(float resolution = 1.0f / 60.0f);
+
+    /// <summary>
+    /// Sets the timer of the entity to expire delay seconds from now, replacing the one it had. An infinite delay only
+    /// cancels the timer it had.
+    /// </summary>
+    void Schedule(Entity entity, float delay);
+
+    /// <summary>
+    /// Removes the timer of the entity. Returns whether it had one.
+    /// </summary>
+    bool Cancel(Entity entity);
+
+    bool IsScheduled(Entity entity) const { return FindTimer(entity) != None; }
+
+    /// <summary>
+    /// Moves the clock forward and adds the entities whose timers expired to expired, in no particular order. Their
+    /// timers are removed.
+    /// </summary>
+    void Advance(float dt, std::vector<Entity>& expired);
+
+    double GetTime() const { return m_time; }
+    size_t GetCount() const { return m_count; }
+
+private:
+    static constexpr uint32_t SlotBits = 6;
+    static constexpr uint32_t SlotCount = 1u << SlotBits;
+    static constexpr uint32_t LevelCount = 4;
+    static constexpr uint32_t DueList = LevelCount * SlotCount;  // timers in the current tick, checked every Advance
+    static constexpr uint32_t FarList = DueList + 1;              // timers beyond the last level
+    static constexpr uint32_t None = UINT32_MAX;
+
+    struct Timer
+    {
+        Entity entity = entt::null;
+        double deadline = 0.0;
+        uint64_t tick = 0;  // the tick the deadline is in
+        uint32_t list = None;
+        uint32_t previous = None;
+        uint32_t next = None;
+    };
+
+    uint32_t FindTimer(Entity entity) const;
+
+    // puts the timer in the list for its tick, as seen from the current tick
+    void Insert(uint32_t timer);
+    void Link(uint32_t timer, uint32_t list);
+    void Unlink(uint32_t timer);
+    void Free(uint32_t timer);
+
+    // inserts the timers of the list again, which moves them down a level
+    void Cascade(uint32_t list);
+
+    float m_resolution;
+    double m_time = 0.0;
+    uint64_t m_tick = 0;
+    size_t m_count = 0;
+    std::vector<Timer> m_timers;
+    std::vector<uint32_t> m_freeTimers;
+    std::vector<uint32_t> m_lists;          // the first timer of every list, by level and slot, then DueList and FarList
+    std::vector<uint32_t> m_timerOfEntity;  // by entity index, None for entities without a timer
+    std::vector<uint32_t> m_cascade;        // scratch space for Cascade
+};
+
+}  // namespace bee::ai
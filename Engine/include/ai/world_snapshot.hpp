@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "core/ecs.hpp"
+
+namespace bee::ai
+{
+
+namespace internal
+{
+size_t NextSnapshotTypeId();
+}
+
+/// <summary>
+/// Copies of components of the agents that run in parallel, taken right before they run. Such an agent only writes its
+/// own components, so reading the others through the snapshot (see StateMachineContext::Read) gives what they were at
+/// the start of the phase, whichever thread ran them and in whatever order.
+///
+/// Only the component types registered with Capture are copied. Components no parallel agent writes need no copy.
+/// </summary>
+class WorldSnapshot
+{
+public:
+    /// <summary>
+    /// Copies the T of the agents from the next Take on. Call when setting up the system.
+    /// </summary>
+    template <typename T>
+    void Capture();
+
+    /// <summary>
+    /// Replaces the copies with those of the given entities, as the registry has them now.
+    /// </summary>
+    void Take(const entt::registry& registry, const std::vector<Entity>& entities);
+
+    /// <summary>
+    /// The copy of the T of the entity. Null if the entity was not in the snapshot, had no T, or T is not captured.
+    /// </summary>
+    template <typename T>
+    const T* Find(Entity entity) const;
+
+    /// <summary>
+    /// Whether the entity was in the snapshot.
+    /// </summary>
+    bool Contains(Entity entity) const { return FindEntity(entity) != NotFound; }
+
+    size_t GetEntityCount() const { return m_entities.size(); }
+
+private:
+    static constexpr uint32_t NotFound = UINT32_MAX;
+
+    struct IStorage
+    {
+        virtual ~IStorage() = default;
+        virtual void Take(const entt::registry& registry, const std::vector<Entity>& entities) = 0;
+    };
+
+    template <typename T>
+    struct Storage : IStorage
+    {
+        void Take(const entt::registry& registry, const std::vector<Entity>& entities) override
+        {
+            copies.clear();
+            for (const auto entity : entities)
+            {
+                if (const T* component = registry.try_get<T>(entity))
+                    copies.emplace_back(*component);
+                else
+                    copies.emplace_back();
+            }
+        }
+
+        std::vector<std::optional<T>> copies;  // in the order of the entities of the snapshot
+    };
+
+    template <typename T>
+    static size_t GetTypeId()
+    {
+        static const size_t id = internal::NextSnapshotTypeId();
+        return id;
+    }
+
+    // the position of the entity in m_entities
+    uint32_t FindEntity(Entity entity) const;
+
+    std::vector<Entity> m_entities;
+    std::vector<uint32_t> m_positions;                  // by entity index, NotFound for entities not in the snapshot
+    std::vector<std::unique_ptr<IStorage>> m_storages;  // by type id, null for types that are not captured
+};
+
+template <typename T>
+void WorldSnapshot::Capture()
+{
+    const size_t type = GetTypeId<T>();
+    if (type >= m_storages.size()) m_storages.resize(type + 1);
+    if (m_storages[type] == nullptr) m_storages[type] = std::make_unique<Storage<T>>();
+}
+
+template <typename T>
+const T* WorldSnapshot::Find(const Entity entity) const
+{
+    const size_t type = GetTypeId<T>();
+    if (type >= m_storages.size() || m_storages[type] == nullptr) return nullptr;
+
+    const uint32_t position = FindEntity(entity);
+    if (position == NotFound) return nullptr;
+
+    const auto& copy = static_cast<const Storage<T>&>(*m_storages[type]).copies[position];
+    return copy.has_value() ? &*copy : nullptr;
+}
+
+}  // namespace bee::ai
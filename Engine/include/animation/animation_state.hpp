@@ -20,7 +20,7 @@ public:
     template <typename StateType>
     void SetStateOfType()
     {
-        const std::vector<size_t> ids = fsm->GetStateIDsOfType<StateType>();
+        const std::vector<size_t>& ids = fsm->GetStateIDsOfType<StateType>();
 
         if (ids.empty()) return;
 
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <type_traits>
+#include <typeindex>
 #include <vector>
 
+#include "core/entity_command_buffer.hpp"
 #include "core/fwd.hpp"
 
 #if defined(PLATFORM_WINDOWS)
@@ -20,9 +26,40 @@
 
 namespace bee
 {
+class ThreadPool;
+class System;
+
+namespace internal
+{
+void RunSystem(System& system, float dt);
+}
+
 struct Delete
 {
 };  // Tag component for entities to be deleted
+
+/// <summary>
+/// The data a system touches in its Update, as declared with System::Reads and System::Writes. Mostly component types,
+/// but any type can stand for shared state. bee::Entity stands for creating and destroying entities.
+/// </summary>
+struct SystemAccess
+{
+    std::vector<std::type_index> ReadTypes;
+    std::vector<std::type_index> WriteTypes;
+    bool Declared = false;
+
+    void AddRead(const std::type_index& type);
+    void AddWrite(const std::type_index& type);
+    bool CanRead(const std::type_index& type) const;
+    bool CanWrite(const std::type_index& type) const;
+
+    /// <summary>
+    /// True if the systems can not run at the same time: one writes what the other reads or writes.
+    /// A system that declared nothing conflicts with every other system.
+    /// </summary>
+    bool ConflictsWith(const SystemAccess& other) const;
+};
+
 class System
 {
 public:
@@ -42,15 +79,66 @@ public:
         return m_paused;
     }
     void SetIsPausable(bool isPausable) { m_isPausable = isPausable; }
+    const SystemAccess& GetAccess() const { return m_access; }
+
+    /// <summary>
+    /// How long the last Update took, in milliseconds, as measured by EntityComponentSystem::UpdateSystems.
+    /// </summary>
+    float GetUpdateTime() const { return m_updateTime; }
 #ifdef BEE_INSPECTOR
     virtual void Inspect() {}
     virtual void Inspect(Entity e) {}
 #endif
+
+protected:
+    /// <summary>
+    /// Declares the types Update only reads, call from the constructor. A system that declares its access may run at the
+    /// same time as other declared systems it does not conflict with, see EntityComponentSystem::SetScheduling.
+    /// </summary>
+    template <typename... T>
+    void Reads()
+    {
+        (m_access.AddRead(typeid(T)), ...);
+    }
+
+    /// <summary>
+    /// Declares the types Update writes (and reads), call from the constructor. See Reads.
+    /// </summary>
+    template <typename... T>
+    void Writes()
+    {
+        (m_access.AddWrite(typeid(T)), ...);
+    }
+
+    /// <summary>
+    /// Declares that Update touches nothing, for systems that only render or only work when called. See Reads.
+    /// </summary>
+    void ReadsNothing() { m_access.Declared = true; }
+
 private:
+    friend void internal::RunSystem(System& system, float dt);
+
     bool m_paused = false;
     bool m_isPausable = true;
+    SystemAccess m_access;
+    float m_updateTime = 0.0f;
 };
 
+namespace internal
+{
+size_t NextSystemTypeId();
+}
+
+/// <summary>
+/// A dense id for every type systems are created or looked up as, handed out on first use.
+/// </summary>
+template <typename T>
+size_t SystemTypeId()
+{
+    static const size_t id = internal::NextSystemTypeId();
+    return id;
+}
+
 class ThreadSafeEntityFactory
 {
 public:
@@ -69,18 +157,87 @@ private:
 class EntityComponentSystem
 {
 public:
+    /// <summary>
+    /// How UpdateSystems runs the systems. Serial runs them one after another in priority order. Parallel runs systems
+    /// that declared their access on worker threads, at the same time as other declared systems they do not conflict
+    /// with. Conflicting systems, and every system that declared nothing, keep their priority order.
+    /// </summary>
+    enum class Scheduling
+    {
+        Serial,
+        Parallel
+    };
+
     entt::registry Registry;
-    Entity CreateEntity() { return Registry.create(); }
+    Entity CreateEntity()
+    {
+        CheckAccess<Entity>(true);
+        return Registry.create();
+    }
     void DeleteEntity(Entity e);
+
+    /// <summary>
+    /// Works out the WorldTransform of every entity from its Transform and those of its parents, parents first.
+    /// UpdateSystems does so before the systems run, and the engine again before rendering, so both gameplay and the
+    /// renderers only read the world transforms.
+    /// </summary>
+    void UpdateWorldTransforms();
+
     void UpdateSystems(float dt);
+    void SetScheduling(Scheduling scheduling);
+    Scheduling GetScheduling() const { return m_scheduling; }
+
+    /// <summary>
+    /// Registry.view, checked against the access the running system declared (in debug builds). Ask for const components
+    /// to only read them.
+    /// </summary>
+    template <typename... T>
+    decltype(auto) View();
+
+    /// <summary>
+    /// In debug builds, reports an access violation if the running system declared its access and T is not part of it.
+    /// </summary>
+    template <typename T>
+    void CheckAccess(bool write);
+
+    /// <summary>
+    /// The access violations reported since the last clear. Always empty in release builds.
+    /// </summary>
+    std::vector<std::string> GetAccessViolations();
+    void ClearAccessViolations();
+
+    /// <summary>
+    /// The command buffer of the calling thread, for structural changes that can not be made right away because other
+    /// threads use the registry. Safe to call from any thread, including systems running in parallel and std::execution
+    /// loops. The commands take effect at the next PlaybackCommands.
+    /// </summary>
+    EntityCommandBuffer& Commands();
+
+    /// <summary>
+    /// Plays back the commands of all threads, ordered by sort key (see EntityCommandBuffer::SetSortKey), and empties the
+    /// buffers. Commands for entities that no longer exist, or are marked for deletion, are dropped. Call from the main
+    /// thread while no other thread records; the engine does so after the game update and after the systems update.
+    /// </summary>
+    void PlaybackCommands();
+
     void RenderSystems();
     void RemovedDeleted();
     template <typename T, typename... Args>
     decltype(auto) CreateComponent(Entity entity, Args&&... args);
     template <typename T, typename... Args>
     T& CreateSystem(Args&&... args);
+    /// <summary>
+    /// The first system, in priority order, that is a T (or derives from it). Asserts there is one.
+    /// Lookups are cached per type, so after the first call this is an array access.
+    /// </summary>
     template <typename T>
     T& GetSystem();
+
+    /// <summary>
+    /// Like GetSystem, but returns null if there is no such system.
+    /// </summary>
+    template <typename T>
+    T* TryGetSystem();
     template <typename T>
     std::vector<T*> GetSystems();
     template <typename T>
@@ -99,35 +256,124 @@ private:
     EntityComponentSystem(const EntityComponentSystem&) = delete;             // non construction-copyable
     EntityComponentSystem& operator=(const EntityComponentSystem&) = delete;  // non copyable
 
+    void CheckAccess(const std::type_index& type, bool write);
+
+    template <typename T>
+    void* FindSystem(std::atomic<void*>& slot);
+    void ClearSystemLookup();
+
     std::vector<std::unique_ptr<System>> m_systems;
+    // The result of the last lookup per system type id: null if it has to be looked up again, m_missingSystem if there
+    // is no such system. Fixed size, so lookups from worker threads never see it move.
+    static constexpr size_t MaxSystemTypes = 1024;
+    std::unique_ptr<std::atomic<void*>[]> m_systemLookup;
+    inline static char m_missingSystem = 0;
+    Scheduling m_scheduling = Scheduling::Serial;
+    std::unique_ptr<ThreadPool> m_workers;
+    std::vector<std::string> m_accessViolations;
+    std::mutex m_accessViolationsMutex;
+
+    const uint64_t m_id;  // tells the command buffers cached by threads apart from those of a previous ECS
+    std::vector<std::unique_ptr<EntityCommandBuffer>> m_commandBuffers;
+    std::mutex m_commandBuffersMutex;
+    std::vector<std::pair<EntityCommandBuffer*, size_t>> m_playbackOrder;
+    bool m_playingBack = false;
+
+    std::vector<Entity> m_deleteSubtree;   // scratch space of DeleteEntity
+    std::vector<Entity> m_transformStack;  // scratch space of UpdateWorldTransforms
+    std::vector<Entity> m_deleteBatch;     // scratch space of RemovedDeleted
 };
 
 template <typename T, typename... Args>
 decltype(auto) EntityComponentSystem::CreateComponent(Entity entity, Args&&... args)
 {
+    CheckAccess<T>(true);
     return Registry.emplace<T>(entity, args...);  // TODO: std::move this
 }
 
+template <typename T, EntityCommandBuffer::CommandType Type>
+void EntityCommandBuffer::Apply(EntityComponentSystem* ecs, Entity entity, void* payload)
+{
+    T* component = static_cast<T*>(payload);
+    if (ecs != nullptr)
+    {
+        if constexpr (Type == CommandType::Emplace)
+        {
+            if (!ecs->Registry.all_of<T>(entity)) ecs->Registry.emplace<T>(entity, std::move(*component));
+        }
+        else if constexpr (Type == CommandType::Replace)
+        {
+            ecs->Registry.emplace_or_replace<T>(entity, std::move(*component));
+        }
+        else
+        {
+            ecs->Registry.remove<T>(entity);
+        }
+    }
+    if constexpr (Type != CommandType::Remove) component->~T();
+}
+
+template <typename... T>
+decltype(auto) EntityComponentSystem::View()
+{
+    (CheckAccess<std::remove_const_t<T>>(!std::is_const_v<T>), ...);
+    return Registry.view<T...>();
+}
+
+template <typename T>
+void EntityComponentSystem::CheckAccess(bool write)
+{
+#ifdef _DEBUG
+    CheckAccess(typeid(T), write);
+#endif
+}
+
 template <typename T, typename... Args>
 T& EntityComponentSystem::CreateSystem(Args&&... args)
 {
+    SystemTypeId<T>();
     T* system = new T(std::forward<Args>(args)...);
     m_systems.push_back(std::unique_ptr<System>(system));
-    std::sort(m_systems.begin(), m_systems.end(),
-              [](const std::unique_ptr<System>& sl, const std::unique_ptr<System>& sr) { return sl->Priority > sr->Priority; });
+    std::stable_sort(m_systems.begin(), m_systems.end(),
+                     [](const std::unique_ptr<System>& sl, const std::unique_ptr<System>& sr) { return sl->Priority > sr->Priority; });
+    ClearSystemLookup();
     return *system;
 }
 
 template <typename T>
 T& EntityComponentSystem::GetSystem()
 {
+    T* system = TryGetSystem<T>();
+    assert(system != nullptr);
+    return *system;
+}
+
+template <typename T>
+T* EntityComponentSystem::TryGetSystem()
+{
+    const size_t id = SystemTypeId<T>();
+    assert(id < MaxSystemTypes);
+    auto& slot = m_systemLookup[id];
+    void* system = slot.load(std::memory_order_acquire);
+    if (system == nullptr) system = FindSystem<T>(slot);
+    return system == &m_missingSystem ? nullptr : static_cast<T*>(system);
+}
+
+template <typename T>
+void* EntityComponentSystem::FindSystem(std::atomic<void*>& slot)
+{
+    // threads that miss at the same time all find the same system
+    void* system = &m_missingSystem;
     for (auto& s : m_systems)
     {
-        T* found = dynamic_cast<T*>(s.get());
-        if (found) return *found;
+        if (T* found = dynamic_cast<T*>(s.get()))
+        {
+            system = found;
+            break;
+        }
     }
-    assert(false);
-    return *dynamic_cast<T*>(m_systems[0].get());  // This line will always fail
+    slot.store(system, std::memory_order_release);
+    return system;
 }
 
 template <typename T>
@@ -162,6 +408,7 @@ void EntityComponentSystem::RemoveSystems()
         }
         it++;
     }
+    ClearSystemLookup();
 }
 
 template <typename T>
@@ -182,6 +429,7 @@ inline void EntityComponentSystem::RemoveAllSystemAfter()
     {
         m_systems.erase(it, m_systems.end());
     }
+    ClearSystemLookup();
 }
 
 }  // namespace bee
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "core/fwd.hpp"
+
+namespace bee
+{
+class EntityComponentSystem;
+
+/// <summary>
+/// Records structural changes to the ECS (creating and destroying entities, adding, replacing and removing components)
+/// so they can be made later, on the main thread. A buffer is written by one thread only; get the one for the current
+/// thread with EntityComponentSystem::Commands. The engine plays all buffers back at its sync points, see
+/// EntityComponentSystem::PlaybackCommands.
+///
+/// Components are moved into a chunked arena owned by the buffer, next to a small header per command, so recording does
+/// not allocate once the arena has grown to the size of a typical frame.
+/// </summary>
+class EntityCommandBuffer
+{
+public:
+    EntityCommandBuffer() = default;
+    ~EntityCommandBuffer();
+    EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+    EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+    /// <summary>
+    /// Records the creation of an entity. The returned handle is temporary: it can be passed to the other commands of
+    /// this buffer, and is replaced by the real entity on playback. It is not valid in the registry.
+    /// </summary>
+    Entity Create();
+
+    /// <summary>
+    /// Records the deletion of an entity (and its children), like EntityComponentSystem::DeleteEntity. Commands
+    /// recorded for the entity after it are dropped.
+    /// </summary>
+    void Destroy(Entity entity);
+
+    /// <summary>
+    /// Records adding a component. Dropped on playback if the entity already has one, use Replace for that.
+    /// </summary>
+    template <typename T, typename... Args>
+    void Emplace(Entity entity, Args&&... args);
+
+    /// <summary>
+    /// Records adding a component, or overwriting the one the entity has.
+    /// </summary>
+    template <typename T, typename... Args>
+    void Replace(Entity entity, Args&&... args);
+
+    /// <summary>
+    /// Records removing a component, if the entity has it.
+    /// </summary>
+    template <typename T>
+    void Remove(Entity entity);
+
+    /// <summary>
+    /// Records a call of function(entity), for changes that are more than adding or removing a component: damage to
+    /// another unit, spawning a projectile, playing a sound. The function is moved into the buffer and runs on playback,
+    /// on the main thread. Dropped, like the other commands, if the entity no longer exists by then. The function may change the registry
+    /// but not record commands.
+    /// </summary>
+    template <typename F>
+    void Call(Entity entity, F&& function);
+
+    /// <summary>
+    /// Orders the commands recorded after this call, across all buffers: playback runs them by increasing key, and in
+    /// recording order within a buffer. Parallel work should use a key that does not depend on the thread, such as the
+    /// index of the entity being processed, to get the same result no matter how the work was split. Defaults to 0.
+    /// </summary>
+    void SetSortKey(uint64_t key) { m_sortKey = key; }
+
+    /// <summary>
+    /// True if the handle was returned by Create (of any buffer) and has not been played back yet.
+    /// </summary>
+    static bool IsTemporary(Entity entity);
+
+    bool IsEmpty() const { return m_commands.empty(); }
+    size_t GetCommandCount() const { return m_commands.size(); }
+
+    /// <summary>
+    /// Drops all commands without playing them back. Keeps the arena memory for the next frame.
+    /// </summary>
+    void Clear();
+
+private:
+    friend class EntityComponentSystem;
+
+    enum class CommandType : uint8_t
+    {
+        Create,
+        Destroy,
+        Emplace,
+        Replace,
+        Remove,
+        Call
+    };
+
+    // Applies a component command to a real entity, or only destroys the payload when ecs is null.
+    using ComponentFunction = void (*)(EntityComponentSystem* ecs, Entity entity, void* payload);
+
+    struct Command
+    {
+        CommandType type;
+        Entity entity;
+        uint64_t sortKey;
+        ComponentFunction function;
+        void* payload;
+    };
+
+    static constexpr size_t ChunkSize = 64 * 1024;
+
+    void* Allocate(size_t size, size_t alignment);
+    void Record(CommandType type, Entity entity, ComponentFunction function = nullptr, void* payload = nullptr);
+
+    // Makes the change of one command, called by EntityComponentSystem::PlaybackCommands in sort key order.
+    void Playback(Command& command, EntityComponentSystem& ecs);
+
+    // Resolves a temporary handle of this buffer to the entity it was played back as, real handles are returned as is.
+    Entity Resolve(Entity entity) const;
+
+    // Defined in ecs.hpp, it needs the registry.
+    template <typename T, CommandType Type>
+    static void Apply(EntityComponentSystem* ecs, Entity entity, void* payload);
+
+    template <typename T, CommandType Type, typename... Args>
+    void RecordComponent(Entity entity, Args&&... args);
+
+    template <typename F>
+    static void Invoke(EntityComponentSystem* ecs, Entity entity, void* payload);
+
+    std::vector<Command> m_commands;
+    std::vector<std::unique_ptr<std::byte[]>> m_chunks;
+    size_t m_chunk = 0;   // chunk being filled
+    size_t m_offset = 0;  // first free byte in that chunk
+    std::vector<std::unique_ptr<std::byte[]>> m_largeAllocations;  // payloads that do not fit a chunk
+    std::vector<Entity> m_created;  // real entity per temporary handle, filled during playback
+    uint64_t m_sortKey = 0;
+};
+
+template <typename T, EntityCommandBuffer::CommandType Type, typename... Args>
+void EntityCommandBuffer::RecordComponent(Entity entity, Args&&... args)
+{
+    using Component = std::decay_t<T>;
+    void* payload = nullptr;
+    if constexpr (Type != CommandType::Remove)
+    {
+        void* memory = Allocate(sizeof(Component), alignof(Component));
+        // aggregates are brace initialized, like entt does
+        if constexpr (std::is_aggregate_v<Component>)
+            payload = new (memory) Component{std::forward<Args>(args)...};
+        else
+            payload = new (memory) Component(std::forward<Args>(args)...);
+    }
+    Record(Type, entity, &Apply<Component, Type>, payload);
+}
+
+template <typename T, typename... Args>
+void EntityCommandBuffer::Emplace(Entity entity, Args&&... args)
+{
+    RecordComponent<T, CommandType::Emplace>(entity, std::forward<Args>(args)...);
+}
+
+template <typename T, typename... Args>
+void EntityCommandBuffer::Replace(Entity entity, Args&&... args)
+{
+    RecordComponent<T, CommandType::Replace>(entity, std::forward<Args>(args)...);
+}
+
+template <typename T>
+void EntityCommandBuffer::Remove(Entity entity)
+{
+    RecordComponent<T, CommandType::Remove>(entity);
+}
+
+template <typename F>
+void EntityCommandBuffer::Call(Entity entity, F&& function)
+{
+    using Function = std::decay_t<F>;
+    void* memory = Allocate(sizeof(Function), alignof(Function));
+    Record(CommandType::Call, entity, &Invoke<Function>, new (memory) Function(std::forward<F>(function)));
+}
+
+template <typename F>
+void EntityCommandBuffer::Invoke(EntityComponentSystem* ecs, Entity entity, void* payload)
+{
+    F* function = static_cast<F*>(payload);
+    if (ecs != nullptr) (*function)(entity);
+    function->~F();
+}
+
+}  // namespace bee
@@ -6,6 +6,35 @@
 namespace bee
 {
 
+/// <summary>
+/// Read-only view of the contents of a whole file. On PC the file is memory mapped, so nothing is copied up front and
+/// the pages are loaded when they are first touched. Other platforms read the file into memory.
+/// </summary>
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool IsOpen() const { return m_data != nullptr; }
+    const char* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    friend class FileIO;
+    void Close();
+
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+    void* m_file = nullptr;     // platform file handle
+    void* m_mapping = nullptr;  // platform file mapping handle
+    std::vector<char> m_buffer;  // the contents, on platforms without memory mapping
+};
+
 /// <summary>
 /// The FileIO class provides a cross-platform way to read and write files.
 /// </summary>
@@ -47,6 +76,11 @@ public:
     /// </summary>
     bool WriteBinaryFile(Directory type, const std::string& path, const std::vector<char>& content);
 
+    /// <summary>
+    /// Map a file into memory for reading. The returned file is not open if the file was not found or is empty.
+    /// </summary>
+    MappedFile MapFile(Directory type, const std::string& path);
+
     /// <summary>
     /// Get the full path of a file.
     /// </summary>
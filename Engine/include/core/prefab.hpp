@@ -0,0 +1,138 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "core/ecs.hpp"
+#include "core/fwd.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// Maps the entities of a prefab to the entities of a copy of it, for components that refer to other entities.
+/// </summary>
+class PrefabEntityMap
+{
+public:
+    /// <summary>
+    /// The entity of the copy that corresponds to the given entity. Entities that are not part of the prefab (and null)
+    /// are returned as they are, so references to shared entities such as the terrain stay valid.
+    /// </summary>
+    Entity operator()(Entity entity) const;
+
+private:
+    friend class Prefab;
+
+    std::vector<std::pair<Entity, Entity>> m_pairs;  // sorted on the first entity
+};
+
+/// <summary>
+/// A snapshot of a fully configured entity hierarchy, that can be stamped out again without redoing the work that made
+/// the original. The prefab keeps its own registry with a copy of every entity and component, so the snapshot is not
+/// picked up by the views of the game.
+///
+/// Transforms are always copied and the copies are linked up in the same order as the original. Other components are
+/// only copied if their type was registered with RegisterComponent; recording warns (in debug builds) about the ones
+/// that were not. Components with entity references or per-instance state register a clone function, which gets a
+/// PrefabEntityMap to remap the references with.
+/// </summary>
+class Prefab
+{
+public:
+    /// <summary>
+    /// Makes a copy of the component in the given registry, for the given entity. Used both ways: from the game
+    /// registry into the prefab when recording, and from the prefab into the game registry when instantiating. The
+    /// prefab keeps the references to the entities it was recorded from, so the map only changes them when
+    /// instantiating.
+    /// </summary>
+    template <typename T>
+    using CloneFunction = void (*)(entt::registry& registry, Entity entity, const T& original, const PrefabEntityMap& map);
+
+    /// <summary>
+    /// The default clone function: copy constructs the component.
+    /// </summary>
+    template <typename T>
+    static void CopyComponent(entt::registry& registry, Entity entity, const T& original, const PrefabEntityMap&)
+    {
+        registry.emplace<T>(entity, original);
+    }
+
+    /// <summary>
+    /// Records root and all its descendants, and the entities (with descendants) in extraRoots. Use extraRoots for
+    /// entities that belong with root but are not its children, such as props that follow a bone.
+    /// </summary>
+    Prefab(Entity root, const std::vector<Entity>& extraRoots = {});
+
+    /// <summary>
+    /// Creates a copy of the recorded entities in the ECS of the engine and returns the copy of the root.
+    /// </summary>
+    /// <param name="entities">Optional output argument. All entities of the copy, the root first and every parent
+    /// before its children.</param>
+    Entity Instantiate(std::vector<Entity>* entities = nullptr) const;
+
+    size_t GetEntityCount() const { return m_entities.size(); }
+
+    /// <summary>
+    /// Copies T into prefabs with Clone. The default copy constructs it, which suits components without entity
+    /// references or shared state. Registering a type again replaces its clone function.
+    /// </summary>
+    template <typename T, CloneFunction<T> Clone = &CopyComponent<T>>
+    static void RegisterComponent();
+
+    /// <summary>
+    /// Leaves T out of prefabs without a warning, for components that are derived from others, like WorldTransform.
+    /// </summary>
+    template <typename T>
+    static void IgnoreComponent();
+
+private:
+    // Copies the components of one type from every entity in from that has it to the entity at the same index in to.
+    using CopyFunction = void (*)(const entt::registry& fromRegistry, const std::vector<Entity>& from,
+                                  entt::registry& toRegistry, const std::vector<Entity>& to, const PrefabEntityMap& map);
+
+    template <typename T, CloneFunction<T> Clone>
+    static void CopyComponents(const entt::registry& fromRegistry, const std::vector<Entity>& from, entt::registry& toRegistry,
+                               const std::vector<Entity>& to, const PrefabEntityMap& map);
+
+    static void AddComponentType(entt::id_type type, CopyFunction copy);
+
+    entt::registry m_registry;
+    std::vector<Entity> m_entities;   // in m_registry, parents before children
+    std::vector<int> m_parents;       // index of the parent in m_entities, -1 for roots
+    std::vector<Entity> m_originals;  // the entities the prefab was recorded from, same order
+    std::vector<int> m_originalOrder;  // indices into m_originals, sorted on the entity
+};
+
+template <typename T, Prefab::CloneFunction<T> Clone>
+void Prefab::RegisterComponent()
+{
+    AddComponentType(entt::type_hash<T>::value(), &CopyComponents<T, Clone>);
+}
+
+template <typename T>
+void Prefab::IgnoreComponent()
+{
+    AddComponentType(entt::type_hash<T>::value(), nullptr);
+}
+
+template <typename T, Prefab::CloneFunction<T> Clone>
+void Prefab::CopyComponents(const entt::registry& fromRegistry, const std::vector<Entity>& from, entt::registry& toRegistry,
+                            const std::vector<Entity>& to, const PrefabEntityMap& map)
+{
+    for (size_t i = 0; i < from.size(); i++)
+    {
+        // entt does not store empty types, so tags have nothing to copy
+        if constexpr (std::is_empty_v<T>)
+        {
+            if (fromRegistry.all_of<T>(from[i])) toRegistry.emplace<T>(to[i]);
+        }
+        else
+        {
+            if (const T* component = fromRegistry.try_get<T>(from[i])) Clone(toRegistry, to[i], *component, map);
+        }
+    }
+}
+
+}  // namespace bee
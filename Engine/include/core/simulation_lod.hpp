@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include "core/ecs.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// How much of the simulation of an entity is worth doing, from how well the player can see it.
+/// </summary>
+enum class SimulationTier
+{
+    Full,     // on screen and close to the camera: everything, every frame
+    Reduced,  // on screen but far away: cosmetic work every few frames, decisions less often
+    Dormant   // off screen: no cosmetic work until it comes into view again, decisions least often
+};
+
+/// <summary>
+/// The simulation level of detail of an entity, classified every frame by SimulationLODSystem.
+/// Cosmetic work (animation, props, the height of units on the terrain) skips frames because of it. Decisions (AI state
+/// updates, path finding and steering) are made every decisionInterval periods of their time slicer, and are handed all
+/// the time since the previous one; orders still take effect on the next frame. What follows from the decisions
+/// (movement, physics, combat) runs every frame in every tier, so a battle out of view plays out the same way, only
+/// with units that react a little later.
+/// </summary>
+struct SimulationLOD
+{
+    SimulationTier tier = SimulationTier::Full;
+    bool cosmeticUpdate = true;      // whether the cosmetic work of the entity runs this frame
+    float cosmeticDeltaTime = 0.0f;  // the time that work covers, the frames it skipped included
+    float skippedTime = 0.0f;        // how far the cosmetic work is behind, caught up on its next update
+    int decisionInterval = 1;        // the entity decides once every so many periods, see TimeSlicer::Tick
+};
+
+/// <summary>
+/// The level of detail of the entity, or of its closest ancestor that has one. Nullptr if none of them has, in which
+/// case the entity is simulated fully. Lets model nodes and props follow the unit they belong to.
+/// </summary>
+const SimulationLOD* FindSimulationLOD(const entt::registry& registry, Entity entity);
+
+/// <summary>
+/// Puts the entities with a SimulationLOD in a tier every frame, by whether the first camera sees them and how far away
+/// they look. The distance is corrected for the field of view, so zooming in counts as coming closer.
+/// Without a camera, as when running headless, every entity is simulated fully.
+/// Create it after the camera system and before the systems that look at the tiers.
+/// </summary>
+class SimulationLODSystem : public System
+{
+public:
+    /// <summary>
+    /// Entities on screen are simulated fully up to fullDistance (as seen through a 90 degree lens) and reduced beyond
+    /// it, where their cosmetic work runs once every reducedInterval frames. Reduced and dormant entities decide once
+    /// every reducedDecisionInterval and dormantDecisionInterval periods.
+    /// </summary>
+    SimulationLODSystem(float fullDistance = 40.0f, int reducedInterval = 4, int reducedDecisionInterval = 2,
+                        int dormantDecisionInterval = 4);
+    void Update(float dt) override;
+#ifdef BEE_INSPECTOR
+    void Inspect() override;
+#endif
+
+    /// <summary>
+    /// How many entities were put in the tier last frame.
+    /// </summary>
+    int GetCount(SimulationTier tier) const { return m_counts[static_cast<size_t>(tier)]; }
+
+    // Cosmetic work skipped in the dormant tier is caught up on, but never by more than this, in seconds.
+    static constexpr float MaxCatchUpTime = 0.5f;
+
+private:
+    float m_fullDistance;
+    int m_reducedInterval;
+    int m_reducedDecisionInterval;
+    int m_dormantDecisionInterval;
+    uint32_t m_frame = 0;
+    std::array<int, 3> m_counts = {};
+};
+
+}  // namespace bee
@@ -8,12 +8,26 @@
 #include <string>
 
 #include "core/fwd.hpp"
+#include "tools/interned_string.hpp"
 
 namespace bee
 {
+/// <summary>
+/// The world space matrix of an entity, worked out from its Transform and those of its parents by
+/// EntityComponentSystem::UpdateWorldTransforms. Added and removed together with the Transform, but kept out of it so
+/// systems that only read or move positions do not drag a matrix per entity through the cache.
+/// </summary>
+struct WorldTransform
+{
+    glm::mat4 WorldMatrix = glm::mat4(1.0f);
+    glm::vec3 TranslationWorld = glm::vec3(0.0f, 0.0f, 0.0f);
+};
+
 /// <summary>
 /// Transform component. Contains the position, rotation and scale of the entity.
 /// Implemented on top of the entity-component-system (entt).
+/// Only holds what is needed to move entities around; the derived world matrix lives in WorldTransform and the links to
+/// the parent and children in Hierarchy.
 /// </summary>
 struct Transform
 {
@@ -21,9 +35,6 @@ struct Transform
     /// Translation in local space.
     /// </summary>
     glm::vec3 Translation = glm::vec3(0.0f, 0.0f, 0.0f);
-    glm::vec3 TranslationWorld = glm::vec3(0.0f, 0.0f, 0.0f);
-
-    glm::mat4 WorldMatrix = glm::mat4(1.0f);
 
     /// <summary>
     /// Scale in local space.
@@ -37,24 +48,24 @@ struct Transform
 
     /// <summary>
     /// The name of the entity. Used for debugging and editor purposes.
-    /// If small, it can benefit from the small string optimization.
+    /// Interned, so entities with the same name share it.
     /// </summary>
-    std::string Name = {};
+    InternedString Name = {};
 
     template <class Archive>
     void save(Archive& archive) const
     {
-        archive(CEREAL_NVP(Translation), CEREAL_NVP(Scale), CEREAL_NVP(Rotation), CEREAL_NVP(Name));
+        archive(CEREAL_NVP(Translation), CEREAL_NVP(Scale), CEREAL_NVP(Rotation), cereal::make_nvp("Name", Name.String()));
     }
 
     template <class Archive>
     void load(Archive& archive)
     {
-        archive(CEREAL_NVP(Translation), CEREAL_NVP(Scale), CEREAL_NVP(Rotation), CEREAL_NVP(Name));
+        std::string name;
+        archive(CEREAL_NVP(Translation), CEREAL_NVP(Scale), CEREAL_NVP(Rotation), cereal::make_nvp("Name", name));
+        Name = name;
     }
 
-    entt::entity GetParent() const { return m_parent; }
-
     /// <summary>
     /// Creates a Transform with default translation (0,0,0), scale (1,1,1), and rotation (identity quaternion).
     /// </summary>
@@ -68,25 +79,38 @@ struct Transform
     {
     }
 
-    entt::entity GetNextChild() const { return m_next; }
-
     /// <summary>
-    /// Sets the parent of the entity. Will automatically add the entity to
-    /// the parent's children.
+    /// The matrix that transforms from local space to the space of the parent: scale, then rotation, then translation.
     /// </summary>
-    /// <param name="parent">The parent entity.</param>
-    void SetParent(Entity parent);
+    [[nodiscard]] glm::mat4 Local() const;
 
-    /// <summary>
-    /// The matrix that transforms from local space to world space.
-    /// </summary>
-    [[nodiscard]] glm::mat4 World() const;
+    /// <summary>Subscribe to the events from the ECS. Call this from the engine init.</summary>
+    static void SubscribeToEvents();
+
+    /// <summary>Un-subscribe to the events from the ECS. Call this from the engine shutdown.</summary>
+    static void UnsubscribeToEvents();
+
+private:
+    static void OnTransformCreate(entt::registry& registry, entt::entity entity);
+    static void OnTransformDestroy(entt::registry& registry, entt::entity entity);
+};
 
+/// <summary>
+/// The place of an entity in the scene hierarchy: its parent and its children. Added and removed together with the
+/// Transform, but kept out of it so systems that move entities do not drag five links per entity through the cache.
+/// </summary>
+struct Hierarchy
+{
+    entt::entity GetParent() const { return m_parent; }
+    entt::entity GetNextChild() const { return m_next; }
+    entt::entity GetPreviousChild() const { return m_previous; }
 
     /// <summary>
-    /// Position in world space.
+    /// Sets the parent of the entity. Will automatically add the entity to
+    /// the parent's children, as the last child, and remove it from the children of its previous parent.
     /// </summary>
-    [[nodiscard]] glm::vec3 WorldTranslation() const;
+    /// <param name="parent">The parent entity.</param>
+    void SetParent(Entity parent);
 
     /// <summary>True if the entity has a children.</summary>
     [[nodiscard]] bool HasChildern() const { return m_first != entt::null; }
@@ -97,31 +121,42 @@ struct Transform
     // <summary> The first child of the entity. </summary>
     [[nodiscard]] Entity FirstChild() const { return m_first; }
 
+    // <summary> The last child of the entity. </summary>
+    [[nodiscard]] Entity LastChild() const { return m_last; }
+
     /// <summary>
     /// Tells the entity it has no children. This can potentially cause you to lose access to the children.
     /// The intended use case is when the children of an entity are deleted, but it still thinks it has them.
     /// </summary>
-    void NoChildren() { m_first = entt::null; }
-
-    /// <summary>Subscribe to the events from the ECS. Call this from the engine init.</summary>
-    static void SubscribeToEvents();
-
-    /// <summary>Un-subscribe to the events from the ECS. Call this from the engine shutdown.</summary>
-    static void UnsubscribeToEvents();
+    void NoChildren()
+    {
+        m_first = entt::null;
+        m_last = entt::null;
+    }
 
+    /// <summary>
+    /// Removes a child from the children of the entity, in constant time. The child no longer has a parent afterwards.
+    /// </summary>
     void RemoveChild(Entity child);
 
 private:
-    // The hierarchy is implemented as a linked list.
+    friend struct Transform;  // subscribes OnHierarchyDestroy
+
+    // The hierarchy is implemented as a doubly linked list of siblings, so children can be appended and unlinked
+    // without walking the list.
     entt::entity m_parent{entt::null};
     entt::entity m_first{entt::null};
+    entt::entity m_last{entt::null};
+    entt::entity m_previous{entt::null};
     entt::entity m_next{entt::null};
 
     // Add a child to the entity. Called by SetParent.
     void AddChild(Entity child);
 
-    static void OnTransformCreate(entt::registry& registry, entt::entity entity);
-    static void OnTransformDestroy(entt::registry& registry, entt::entity entity);
+    // Takes a child out of the sibling list of its parent.
+    static void Unlink(entt::registry& registry, Entity child, Hierarchy& childHierarchy);
+
+    static void OnHierarchyDestroy(entt::registry& registry, entt::entity entity);
 
 public:
     /// <summary>
@@ -143,12 +178,12 @@ public:
     /// <summary>
     /// The begin iterator for the children of the entity.
     /// </summary>
-    Iterator begin() { return Iterator(m_first); }
+    Iterator begin() const { return Iterator(m_first); }
 
     /// <summary>
     /// The end iterator for the children of the entity.
     /// </summary>
-    Iterator end() { return Iterator(); }
+    Iterator end() const { return Iterator(); }
 };
 
 /// Decomposes a transform matrix into its translation, scale and rotation components
@@ -7,6 +7,7 @@
 
 #include "graph/euclidean_graph.hpp"
 #include "graph/graph.hpp"
+#include "tools/frame_arena.hpp"
 
 /// <summary>
 /// A namespace containing functions related to graph search.
@@ -58,15 +59,19 @@ std::vector<int> AStar(const Graph<V>& graph, const int start, const int goal, s
         bool operator<(const OpenListItem& other) const { return g + h > other.g + other.h; }
     };
 
+    // The search lists live in the frame arena of this thread and are released when the search returns, so searches
+    // on the worker threads of the navigation system do not go to the heap.
+    ArenaScope arenaScope(FrameArena());
+
     // Open list: items that may be checked in the future, ordered by g+h values.
-    std::priority_queue<OpenListItem> openList;
+    std::priority_queue<OpenListItem, FrameVector<OpenListItem>> openList;
 
     // Add the first item to the open list
     openList.push(OpenListItem(start, 0, heuristic(startVertex, goalVertex)));
 
     // Closed list: vertices that do not need to be checked anymore.
     // An alternative implementation could be a "visited" flag per vertex, but this has disadvantages.
-    std::unordered_set<int> closedList;
+    std::unordered_set<int, std::hash<int>, std::equal_to<int>, ArenaAllocator<int>> closedList;
 
     /// <summary>
     /// Represents a reference to the best known data about a vertex during the A* search.
@@ -79,7 +84,8 @@ std::vector<int> AStar(const Graph<V>& graph, const int start, const int goal, s
         BestVertexData() : previousVertex(-1), pathCost(0) {}
         BestVertexData(int _previousVertex, float _pathCost) : previousVertex(_previousVertex), pathCost(_pathCost) {}
     };
-    std::unordered_map<int, BestVertexData> bestVertexData;
+    std::unordered_map<int, BestVertexData, std::hash<int>, std::equal_to<int>, ArenaAllocator<std::pair<const int, BestVertexData>>>
+        bestVertexData;
     bestVertexData[start] = {-1, 0};
 
     while (!openList.empty())
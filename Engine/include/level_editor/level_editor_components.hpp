@@ -43,7 +43,17 @@ struct TerrainDataComponent
     float m_step = 0;               // dimensions of a tile
 
     std::vector<DWORD> m_indices;  // triangles are described counter-clockwise (CCW)
-    std::vector<TVertex> m_vertices;
+
+    // Vertex attributes, one stream per attribute. Vertices are laid out row by row, (m_width + 1) * (m_height + 1)
+    // of them, so the vertex at grid coordinates (x, y) is at index x + y * (m_width + 1) in every stream.
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::vec3> m_normals;
+    std::vector<glm::vec2> m_uvs;
+    std::vector<glm::vec3> m_tangents;
+    std::vector<glm::vec3> m_bitangents;
+    std::vector<int> m_cliffLevels;
+    std::vector<MaterialWeights> m_materialWeights;
+
     std::vector<glm::vec2> m_smallGridPoints;  // a smaller grid using for brush snapping for structures and props.
     std::vector<tile> m_tiles;
     std::vector<AreaPreset> m_areaPresets;
@@ -51,9 +61,65 @@ struct TerrainDataComponent
                                                 "materials/TerrainRock.pepimat", "materials/Empty.pepimat"};
     std::vector<std::shared_ptr<bee::Material>> m_materials = {nullptr, nullptr, nullptr, nullptr};
 
+    int GetVertexCount() const { return static_cast<int>(m_positions.size()); }
+
+    /// <summary>
+    /// Resizes every vertex stream. New vertices get the defaults of TVertex.
+    /// </summary>
+    void ResizeVertices(const int count)
+    {
+        const TVertex defaults;
+        m_positions.resize(count, defaults.position);
+        m_normals.resize(count, defaults.normal);
+        m_uvs.resize(count, defaults.uv);
+        m_tangents.resize(count, defaults.tangent);
+        m_bitangents.resize(count, defaults.bitangent);
+        m_cliffLevels.resize(count, defaults.cliffLevel);
+        m_materialWeights.resize(count, defaults.materialWeights);
+    }
+
+    TVertex GetVertex(const int index) const
+    {
+        TVertex vertex;
+        vertex.position = m_positions[index];
+        vertex.normal = m_normals[index];
+        vertex.uv = m_uvs[index];
+        vertex.tangent = m_tangents[index];
+        vertex.bitangent = m_bitangents[index];
+        vertex.cliffLevel = m_cliffLevels[index];
+        vertex.materialWeights = m_materialWeights[index];
+        return vertex;
+    }
+
+    void SetVertex(const int index, const TVertex& vertex)
+    {
+        m_positions[index] = vertex.position;
+        m_normals[index] = vertex.normal;
+        m_uvs[index] = vertex.uv;
+        m_tangents[index] = vertex.tangent;
+        m_bitangents[index] = vertex.bitangent;
+        m_cliffLevels[index] = vertex.cliffLevel;
+        m_materialWeights[index] = vertex.materialWeights;
+    }
+
+    /// <summary>
+    /// The vertices at the corners of a tile: A, B, C, D as drawn in TerrainSystem::CreatePlane
+    /// (bottom left, bottom right, top right, top left).
+    /// </summary>
+    std::array<int, 4> GetTileVertexIndices(const int tileIndex) const
+    {
+        const int vWidth = m_width + 1;
+        const int a = tileIndex % m_width + (tileIndex / m_width) * vWidth;
+        return {a, a + 1, a + vWidth + 1, a + vWidth};
+    }
+
     template <class Archive>
     void save(Archive& archive) const
     {
+        // level files store whole vertices
+        std::vector<TVertex> m_vertices(m_positions.size());
+        for (int i = 0; i < GetVertexCount(); i++) m_vertices[i] = GetVertex(i);
+
         archive(CEREAL_NVP(m_width), CEREAL_NVP(m_height), CEREAL_NVP(m_step), CEREAL_NVP(m_indices), CEREAL_NVP(m_vertices),
                 CEREAL_NVP(m_tiles), CEREAL_NVP(m_areaPresets), CEREAL_NVP(m_materialPaths));
     }
@@ -61,9 +127,13 @@ struct TerrainDataComponent
     template <class Archive>
     void load(Archive& archive)
     {
+        std::vector<TVertex> m_vertices;
         archive(CEREAL_NVP(m_width), CEREAL_NVP(m_height), CEREAL_NVP(m_step), CEREAL_NVP(m_indices), CEREAL_NVP(m_vertices),
                 CEREAL_NVP(m_tiles), CEREAL_NVP(m_areaPresets), CEREAL_NVP(m_materialPaths));
+
+        ResizeVertices(static_cast<int>(m_vertices.size()));
+        for (int i = 0; i < GetVertexCount(); i++) SetVertex(i, m_vertices[i]);
     }
 };
 
-}  // namespace lvle
\ No newline at end of file
+}  // namespace lvle
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lvle
+{
+
+struct TerrainDataComponent;
+
+/// <summary>
+/// Binary level files are stored next to the json ones in the terrain directory, with this extension.
+/// </summary>
+constexpr const char* TerrainBinaryExtension = ".lvl";
+
+/// <summary>
+/// Version of the binary level layout. Files with a different version are rejected, convert them again from json.
+/// </summary>
+constexpr uint32_t TerrainBinaryVersion = 1;
+
+/// <summary>
+/// Serializes the terrain to the binary level format: a fixed header with a section table, followed by one section per
+/// stream (indices, vertex attributes, tiles, tile flags, small grid points, ...). Every section starts at a 16 byte
+/// aligned offset and is a plain array, so it can be copied straight out of a memory mapped file.
+/// Holds the same data as the json level files.
+/// </summary>
+std::vector<char> WriteTerrainBinary(const TerrainDataComponent& data);
+
+/// <summary>
+/// Reads a terrain from a buffer in the binary level format.
+/// </summary>
+/// <returns>False (and leaves data untouched) if the buffer is not a valid level of the current version.</returns>
+bool ReadTerrainBinary(const char* bytes, size_t size, TerrainDataComponent& data);
+
+/// <summary>
+/// Writes the terrain to [fileName].lvl in the terrain directory.
+/// </summary>
+bool SaveTerrainBinary(const TerrainDataComponent& data, const std::string& fileName);
+
+/// <summary>
+/// Loads [fileName].lvl from the terrain directory.
+/// </summary>
+/// <param name="memoryMapped">Map the file instead of reading it into a buffer first.</param>
+bool LoadTerrainBinary(const std::string& fileName, TerrainDataComponent& data, bool memoryMapped = true);
+
+/// <summary>
+/// Loads [fileName].json from the terrain directory.
+/// </summary>
+bool LoadTerrainJson(const std::string& fileName, TerrainDataComponent& data);
+
+/// <summary>
+/// Writes the terrain to [fileName].json in the terrain directory.
+/// </summary>
+bool SaveTerrainJson(const TerrainDataComponent& data, const std::string& fileName);
+
+/// <summary>
+/// Loads a level, from the binary file if there is one that is at least as new as the json file, from json otherwise.
+/// </summary>
+bool LoadTerrainLevel(const std::string& fileName, TerrainDataComponent& data);
+
+/// <summary>
+/// Converts [fileName].json in the terrain directory to [fileName].lvl.
+/// </summary>
+bool ConvertLevelToBinary(const std::string& fileName);
+
+/// <summary>
+/// Converts [fileName].lvl in the terrain directory to [fileName].json.
+/// </summary>
+bool ConvertLevelToJson(const std::string& fileName);
+
+}  // namespace lvle
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace bee
+{
+class ThreadPool;
+}
+
+namespace lvle
+{
+
+struct TerrainDataComponent;
+
+/// <summary>
+/// Groups the blocked tiles of a width x height tile grid into 4-connected components, with a union-find pass over
+/// horizontal bands of rows that runs in parallel, followed by a merge of the band borders. No recursion, so the stack
+/// use does not depend on the map size.
+/// </summary>
+/// <param name="blocked">One entry per tile, non-zero for tiles that need a collider.</param>
+/// <param name="labels">Output argument. For every blocked tile, the index of the lowest tile of its component. -1 for
+/// free tiles.</param>
+/// <param name="pool">Runs the bands in parallel. May be null.</param>
+/// <returns>The first tile of every component, in increasing order.</returns>
+std::vector<int> LabelBlockedTiles(const std::vector<uint8_t>& blocked, int width, int height, std::vector<int>& labels,
+                                   bee::ThreadPool* pool = nullptr);
+
+/// <summary>
+/// Walks the outer boundary of a component counter-clockwise (marching squares over the tile corners) and returns the
+/// terrain vertex indices where it changes direction. Tiles that only touch the component diagonally are not part of
+/// it, so holes that are diagonally open to the outside are left out of the polygon.
+/// </summary>
+/// <param name="labels">The labels made by LabelBlockedTiles.</param>
+/// <param name="firstTile">The lowest tile of the component (its label).</param>
+std::vector<int> TraceTileGroupContour(const std::vector<int>& labels, int width, int height, int firstTile);
+
+/// <summary>
+/// Removes corners from a closed contour (Douglas-Peucker) as long as no removed corner is further than tolerance tiles
+/// from the simplified outline. If that would make the polygon intersect itself the contour is returned unchanged.
+/// </summary>
+/// <param name="contour">Terrain vertex indices, as returned by TraceTileGroupContour.</param>
+/// <param name="width">Terrain width in tiles.</param>
+std::vector<int> SimplifyColliderPolygon(const std::vector<int>& contour, int width, float tolerance);
+
+/// <summary>
+/// The signed area, in tiles, of a polygon given as terrain vertex indices. Positive for counter-clockwise polygons.
+/// </summary>
+double ColliderPolygonArea(const std::vector<int>& polygon, int width);
+
+/// <summary>
+/// Finds the polygons that cover the tiles flagged NoGroundTraverse: one polygon (terrain vertex indices, counter-clockwise)
+/// per group of connected tiles, ordered by the lowest tile in the group. Contours are traced and simplified in parallel.
+/// </summary>
+/// <param name="tolerance">How far, in tiles, a simplified outline may deviate from the tiles. 0 keeps every corner.</param>
+/// <param name="pool">Spreads the work over its threads. May be null.</param>
+std::vector<std::vector<int>> ExtractTerrainColliders(const TerrainDataComponent& data, float tolerance,
+                                                      bee::ThreadPool* pool = nullptr);
+
+}  // namespace lvle
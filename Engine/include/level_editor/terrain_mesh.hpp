@@ -0,0 +1,119 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "platform/dx12/ResourceManager.hpp"
+
+namespace lvle
+{
+
+struct TerrainDataComponent;
+
+/// <summary>
+/// A rectangle of terrain vertices, in vertex coordinates. Both corners are inclusive.
+/// </summary>
+struct TerrainRect
+{
+    glm::ivec2 min = glm::ivec2(0);
+    glm::ivec2 max = glm::ivec2(-1);
+
+    bool IsEmpty() const { return max.x < min.x || max.y < min.y; }
+
+    /// <summary>
+    /// Grows the rectangle so it also covers the given vertex.
+    /// </summary>
+    void Include(const glm::ivec2& vertex);
+
+    /// <summary>
+    /// Grows the rectangle so it also covers the other one.
+    /// </summary>
+    void Merge(const TerrainRect& other);
+
+    /// <summary>
+    /// Returns the rectangle grown by border vertices on every side, clamped to the vertices of the terrain.
+    /// </summary>
+    TerrainRect Expanded(int border, const TerrainDataComponent& data) const;
+
+    /// <summary>
+    /// The rectangle covering every vertex of the terrain.
+    /// </summary>
+    static TerrainRect Whole(const TerrainDataComponent& data);
+};
+
+/// <summary>
+/// Recalculates the normals of the vertices inside the region.
+/// Like the full update, the normals of the vertices along the terrain edges are left untouched.
+/// </summary>
+void UpdateTerrainNormals(TerrainDataComponent& data, const TerrainRect& region);
+
+/// <summary>
+/// Recalculates the tangents and bitangents of the vertices inside the region. Only the quads touching the region are
+/// visited, in the same order as a full update, so the result is identical to recalculating the whole terrain.
+/// </summary>
+void UpdateTerrainTangents(TerrainDataComponent& data, const TerrainRect& region);
+
+/// <summary>
+/// Gathers a terrain vertex from the attribute streams into the vertex layout the renderer uses.
+/// The material weights go in the skinning weights.
+/// </summary>
+Vertex ToRenderVertex(const TerrainDataComponent& data, int index);
+
+/// <summary>
+/// The render side of the terrain. The vertex buffer is split in square chunks that are stored one after the other, so
+/// an edit only needs to regenerate (and upload) the few chunks it touches. Vertices on the border between two chunks
+/// are stored in both. The index buffer is built once and only changes when the terrain dimensions do.
+/// </summary>
+class TerrainChunkedMesh
+{
+public:
+    static constexpr int ChunkSize = 16;  // chunk dimensions in tiles
+
+    /// <summary>
+    /// The range of the vertex buffer that belongs to a chunk.
+    /// </summary>
+    struct VertexRange
+    {
+        size_t first = 0;
+        size_t count = 0;
+    };
+
+    /// <summary>
+    /// Lays out the chunks for the dimensions of the terrain and regenerates all vertices and indices.
+    /// </summary>
+    void Build(const TerrainDataComponent& data);
+
+    /// <summary>
+    /// Regenerates the vertices of every chunk that overlaps the region.
+    /// </summary>
+    /// <param name="data">The terrain the mesh was built for.</param>
+    /// <param name="region">The vertices that changed.</param>
+    /// <param name="updatedRanges">Output argument, the vertex buffer ranges that were rewritten.</param>
+    void UpdateRegion(const TerrainDataComponent& data, const TerrainRect& region, std::vector<VertexRange>& updatedRanges);
+
+    /// <summary>
+    /// True if the chunks were laid out for a terrain with these dimensions.
+    /// </summary>
+    bool Matches(const TerrainDataComponent& data) const;
+
+    std::vector<Vertex>& GetVertices() { return m_vertices; }
+    std::vector<DWORD>& GetIndices() { return m_indices; }
+    int GetChunkCount() const { return static_cast<int>(m_chunks.size()); }
+
+private:
+    struct Chunk
+    {
+        glm::ivec2 min = glm::ivec2(0);  // first vertex of the chunk, in terrain vertex coordinates
+        glm::ivec2 max = glm::ivec2(0);  // last vertex of the chunk (inclusive)
+        VertexRange range;
+    };
+
+    void WriteChunk(const TerrainDataComponent& data, const Chunk& chunk);
+
+    std::vector<Chunk> m_chunks;
+    std::vector<Vertex> m_vertices;
+    std::vector<DWORD> m_indices;
+    int m_width = 0, m_height = 0;  // terrain dimensions in tiles, at the time of building
+    int m_chunksX = 0, m_chunksY = 0;
+};
+
+}  // namespace lvle
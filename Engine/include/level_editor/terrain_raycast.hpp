@@ -0,0 +1,87 @@
+#pragma once
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace lvle
+{
+
+struct TerrainDataComponent;
+struct TerrainRect;
+
+/// <summary>
+/// The result of a ray query against the terrain mesh.
+/// </summary>
+struct TerrainRayHit
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    int triangle = -1;      // index of the hit triangle (its first index is m_indices[triangle * 3])
+    float distance = 0.0f;  // ray parameter of the hit, measured in lengths of the ray direction
+};
+
+/// <summary>
+/// Tests the ray against every triangle of the terrain and keeps the closest hit in front of the ray start.
+/// This is the reference implementation, use TerrainRaycaster for anything that runs per frame.
+/// </summary>
+/// <param name="data">The terrain to test against.</param>
+/// <param name="rayStart">The origin of the ray.</param>
+/// <param name="rayDir">The direction of the ray. Does not need to be normalized.</param>
+/// <param name="hit">Output argument, only written when the function returns true.</param>
+/// <returns>True if the ray hits the terrain.</returns>
+bool RaycastTerrainBruteForce(const TerrainDataComponent& data, const glm::vec3& rayStart, const glm::vec3& rayDir,
+                              TerrainRayHit& hit);
+
+/// <summary>
+/// Accelerated ray queries against the terrain. The ray is walked over the tile lattice in 2D (DDA) and only the two
+/// triangles of the quads it crosses are tested. A per-chunk min/max height range lets whole chunks the ray passes
+/// over (or under) be skipped without looking at their quads.
+/// The terrain is assumed to be a regular grid in x and y (as made by TerrainSystem::CreatePlane), only heights may vary.
+/// </summary>
+class TerrainRaycaster
+{
+public:
+    static constexpr int ChunkSize = 16;  // chunk dimensions in tiles
+
+    /// <summary>
+    /// Recalculates the height ranges of all chunks. Called lazily by Raycast after Invalidate.
+    /// </summary>
+    void Build(const TerrainDataComponent& data);
+
+    /// <summary>
+    /// Marks the height ranges as stale. Call this after the terrain heights or dimensions change.
+    /// </summary>
+    void Invalidate() { m_valid = false; }
+
+    /// <summary>
+    /// Recalculates the height ranges of the chunks overlapping the region. Cheaper than Invalidate after a local edit.
+    /// </summary>
+    void Refit(const TerrainDataComponent& data, const TerrainRect& region);
+
+    /// <summary>
+    /// Finds the closest intersection in front of the ray start. Returns the same hit as RaycastTerrainBruteForce.
+    /// </summary>
+    /// <param name="data">The terrain to test against. Must be the same terrain the height ranges were built for.</param>
+    /// <param name="rayStart">The origin of the ray.</param>
+    /// <param name="rayDir">The direction of the ray. Does not need to be normalized.</param>
+    /// <param name="hit">Output argument, only written when the function returns true.</param>
+    /// <returns>True if the ray hits the terrain.</returns>
+    bool Raycast(const TerrainDataComponent& data, const glm::vec3& rayStart, const glm::vec3& rayDir, TerrainRayHit& hit);
+
+private:
+    struct HeightRange
+    {
+        float min = 0.0f;
+        float max = 0.0f;
+    };
+
+    HeightRange CalculateChunkRange(const TerrainDataComponent& data, int cx, int cy) const;
+    void TestQuad(const TerrainDataComponent& data, int x, int y, const glm::vec3& rayStart, const glm::vec3& rayDir,
+                  TerrainRayHit& hit, bool& hasHit) const;
+
+    std::vector<HeightRange> m_chunks;
+    HeightRange m_bounds;
+    int m_width = 0, m_height = 0;    // terrain dimensions in tiles, at the time of building
+    int m_chunksX = 0, m_chunksY = 0;
+    bool m_valid = false;
+};
+
+}  // namespace lvle
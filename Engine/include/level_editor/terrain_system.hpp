@@ -5,6 +5,8 @@
 #include "core/engine.hpp"
 #include "core/transform.hpp"
 #include "level_editor/level_editor_components.hpp"
+#include "level_editor/terrain_mesh.hpp"
+#include "level_editor/terrain_raycast.hpp"
 #include "rendering/mesh.hpp"
 #include "tools/log.hpp"
 
@@ -24,13 +26,26 @@ public:
 
     void UpdateTerrainDataComponent();
 
+    /// <summary>
+    /// Finds the closest point where the ray hits the terrain. Only the quads the ray crosses are tested.
+    /// </summary>
     bool FindRayMeshIntersection(const glm::vec3& rayStart, const glm::vec3& rayDir, glm::vec3& result);
 
+    /// <summary>
+    /// Marks vertices whose position or material weights were edited. The mesh around them is refreshed by
+    /// UpdateDirtyRegion, which is far cheaper than UpdatePlane for an edit that only touches part of the terrain.
+    /// </summary>
+    void MarkDirty(const std::vector<int>& vertexIndices);
+
     void SaveLevel(std::string& fileName);
     void LoadLevel(const std::string& fileName);
 
     void CalculateAllTilesCentralPositions();
     void CalculateTileCentralPosition(int tileIndex);
+    /// <summary>
+    /// Creates a static polygon collider around every group of connected NoGroundTraverse tiles.
+    /// See ExtractTerrainColliders.
+    /// </summary>
     void CalculateTerrainColliders();
 
     bee::Entity CreateTerrainColliderEntity(const std::vector<int>& pointsIndices, const std::string& name);
@@ -68,19 +83,23 @@ protected:
     /// <param name="atlasHeight">Quad segments on the y axis of the atlas</param>
     /// <param name="atlasStep">Size of a single atlas tile. (both dimensions, they're squares)</param>
     void CreatePlane(int width, int height, float step);
+    /// <summary>
+    /// Fills the terrain data for a flat plane like CreatePlane, without building the mesh.
+    /// </summary>
+    void CreatePlaneData(int width, int height, float step);
     void CreatePlaneLite(const TerrainDataComponent& data);
     void UpdatePlane();
+    void UpdateDirtyRegion();
     void UpdateNormals();
     void UpdateTangents();
 
-    void FindColliderTileGroupRecursive(std::vector<int>& allTiles, std::vector<int>& tileGroup, const int tileIndexToInspect,
-                                        const std::vector<int>& directions);
-    void FindColliderEdgesPerTileInTileGroup(const std::vector<int>& group, std::vector<std::pair<int, int>>& result);
-    void FindColliderCornerPoints(const std::vector<std::pair<int, int>>& edgeGroup, std::vector<int>& result);
-
 protected:
     std::shared_ptr<lvle::TerrainDataComponent> m_data;
     std::shared_ptr<bee::Mesh> m_mesh;
+    TerrainChunkedMesh m_chunkedMesh;
+    TerrainRaycaster m_raycaster;
+    TerrainRect m_dirtyRegion;  // vertices edited since the last mesh update
+    std::vector<TerrainChunkedMesh::VertexRange> m_updatedRanges;
 
     bool m_loadLevel = false;
 
@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <optional>
 #include <glm/glm.hpp>
 #include <vector>
@@ -6,6 +8,7 @@
 #include "cereal/cereal.hpp"
 #include <cereal/types/string.hpp>
 #include <cereal/types/optional.hpp>
+#include <cereal/types/vector.hpp>
 #include <cereal/archives/json.hpp>
 
 namespace lvle
@@ -22,7 +25,12 @@ enum TileFlags
     NoNavalTraverse = 1 << 4,
 };
 
+// One weight per terrain material (grass, dirt, rock, empty), blended in the terrain shader.
+using MaterialWeights = std::array<float, 4>;
+
 // Represents a vertex on the terrain.
+// The terrain itself stores its vertices as separate attribute streams (see TerrainDataComponent), this struct is what
+// a single vertex looks like in the level files.
 struct TVertex
 {
     glm::vec3 position = glm::vec3(0.0f);
@@ -32,46 +40,40 @@ struct TVertex
     glm::vec3 bitangent = glm::vec3(0.0f);
 
     int cliffLevel = 0;
-    std::vector<float> materialWeights = {1, 0, 0, 0};
+    MaterialWeights materialWeights = {1, 0, 0, 0};
 
+    // The weights are written as the std::vector they used to be, a list of numbers, so the level files keep their
+    // layout.
     template <class Archive>
-    void serialize(Archive& archive)
+    void save(Archive& archive) const
     {
-        archive(CEREAL_NVP(position), CEREAL_NVP(normal), CEREAL_NVP(uv), CEREAL_NVP(cliffLevel), CEREAL_NVP(materialWeights));
+        const std::vector<float> weights(materialWeights.begin(), materialWeights.end());
+        archive(CEREAL_NVP(position), CEREAL_NVP(normal), CEREAL_NVP(uv), CEREAL_NVP(cliffLevel),
+                cereal::make_nvp("materialWeights", weights));
+    }
+
+    template <class Archive>
+    void load(Archive& archive)
+    {
+        std::vector<float> weights;
+        archive(CEREAL_NVP(position), CEREAL_NVP(normal), CEREAL_NVP(uv), CEREAL_NVP(cliffLevel),
+                cereal::make_nvp("materialWeights", weights));
+        materialWeights = {};
+        std::copy_n(weights.begin(), std::min(weights.size(), materialWeights.size()), materialWeights.begin());
     }
 };
 
 // Represents a tile on the terrain
 // Tiles are used for pathing.
+// The corners of a tile are not stored, use TerrainDataComponent::GetTileVertexIndices.
 struct tile
 {
     int index;
     int tileFlags = TileFlags::Traversible;
     int area= 0;
 
-    std::vector<std::reference_wrapper<TVertex>> vertices;
     glm::vec3 centralPos = glm::vec3(0.0f);
 
-    // TODO (sure buddy)
-    std::vector<int> GetVerticesIndices()
-    {
-        /*
-        auto& data = bee::Engine.ECS().GetSystem<lvle::TerrainSystem>().m_data;
-        int x = index % data->m_width;
-        int y = index / data->m_width;
-        int a = x + y * data->m_width + y;
-        int b = a + 1;
-        int c = a + (data->m_width + 1) + 1;
-        int d = a + (data->m_width + 1);
-        std::vector<std::reference_wrapper<lvle::vertex>> returnVector;
-        returnVector.push_back(data->m_vertices[a]);
-        returnVector.push_back(data->m_vertices[b]);
-        returnVector.push_back(data->m_vertices[c]);
-        returnVector.push_back(data->m_vertices[d]);
-        return returnVector;
-        */
-    }
-
     template <class Archive>
     void save(Archive& archive)const
     {
@@ -15,7 +15,7 @@ struct CollisionData;
 class World : public bee::System
 {
 public:
-    World(const float fixedDeltaTime) : m_fixedDeltaTime(fixedDeltaTime), m_timeSinceLastFrame(0), m_gravity(glm::vec2(0, 0)) {}
+    World(const float fixedDeltaTime);
 #ifdef BEE_INSPECTOR
     void Inspect(bee::Entity entity) override;
 #endif
@@ -218,9 +218,9 @@ public:
     ComPtr<ID3D12DescriptorHeap> m_mipMapHeap;
 
     void QueueImageLoading(bee::Image* image);
-    std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::Transform>> drawables;
-    std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::Transform>> particleDrawables;
-    std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::Transform>> foliageDrawables;
+    std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::WorldTransform>> drawables;
+    std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::WorldTransform>> particleDrawables;
+    std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::WorldTransform>> foliageDrawables;
 private:
     ResourceManager(DeviceManager* device_manager);
 
@@ -309,12 +309,12 @@ private:
     std::vector<Light1> m_lights;
     int m_light_count;
 
-    void InstanceCounterUpdate(std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::Transform>>& vector,
+    void InstanceCounterUpdate(std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::WorldTransform>>& vector,
                                DirectX::XMMATRIX& viewMat, DirectX::XMMATRIX& projMat);
     std::vector<unsigned int> m_instance_counter_local;
     std::vector<unsigned int> m_mesh_joints_local;
 
-    void LoadInMemory(std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::Transform>>& vector);
+    void LoadInMemory(std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::WorldTransform>>& vector);
 
     inline bool isPointInFrustum(DirectX::XMVECTOR& posVector, const DirectX::XMMATRIX& viewProj)
     {
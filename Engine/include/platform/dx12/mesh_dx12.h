@@ -34,6 +34,9 @@ public:
 
     void SetAttribute(std::vector<Vertex>& data);
 
+    // Uploads only the given (first vertex, vertex count) ranges of data. Falls back to SetAttribute when the size changed.
+    void UpdateVertices(std::vector<Vertex>& data, const std::vector<std::pair<size_t, size_t>>& ranges);
+
     void SetIndices(std::vector<DWORD>& data);
    
     void SetIndices(std::vector<uint16_t>& data);
@@ -16,6 +16,7 @@ struct TransformsUBO;
 struct DirectionalLightsUBO;
 struct MeshRenderer;
 struct Transform;
+struct WorldTransform;
 
 struct DebugData
 {
@@ -47,7 +48,7 @@ public:
 
 private:
     friend class UIRenderer;
-    void ProcessObjectForRendering(const bee::MeshRenderer& renderer, const bee::Transform& transform, int& instances);
+    void ProcessObjectForRendering(const bee::MeshRenderer& renderer, const bee::WorldTransform& transform, int& instances);
     void RenderCurrentInstances(int instances);
     void CreateFrameBuffers();
     void DeleteFrameBuffers();
@@ -198,6 +198,14 @@ struct MeshRenderer
 
 };
 
+/// <summary>
+/// Entities with this are not drawn and cast no shadow, like the enemies hidden by the fog of war.
+/// </summary>
+struct Hidden
+{
+    char dummy = 'd';  // just a variable to make sure that the struct doesn't get optimized
+};
+
 struct Sampler
 {
     Sampler(const Model& model, int index);
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// Items bucketed by their position on the ground into a uniform grid, for finding the ones near a point without
+/// looking at all of them. Add the items, Build, then look them up until the next Clear.
+///
+/// The grid only covers the items, and its cells grow when the items are so spread out that most cells would be empty,
+/// so a few items far apart do not make a huge grid.
+/// </summary>
+template <typename T>
+class BucketGrid
+{
+public:
+    void Clear()
+    {
+        m_added.clear();
+        m_positions.clear();
+    }
+
+    void Add(const glm::vec2& position, const T& item)
+    {
+        m_added.push_back(item);
+        m_positions.push_back(position);
+    }
+
+    /// <summary>
+    /// Sorts the items added into cells of cellSize, or bigger when they are spread out.
+    /// </summary>
+    void Build(float cellSize);
+
+    /// <summary>
+    /// Calls function with every item in the cells that overlap the square around center, so with all the items within
+    /// radius of it and some more.
+    /// </summary>
+    template <typename F>
+    void ForEachWithin(const glm::vec2& center, float radius, F&& function) const;
+
+    size_t GetCount() const { return m_items.size(); }
+    float GetCellSize() const { return m_cellSize; }
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+
+    // More cells than this per item and the grid is mostly empty, so the cells grow.
+    static constexpr size_t MaxCellsPerItem = 4;
+
+private:
+    size_t CellOf(const glm::vec2& position) const
+    {
+        const int x = std::min(static_cast<int>((position.x - m_origin.x) / m_cellSize), m_width - 1);
+        const int y = std::min(static_cast<int>((position.y - m_origin.y) / m_cellSize), m_height - 1);
+        return static_cast<size_t>(y) * static_cast<size_t>(m_width) + static_cast<size_t>(x);
+    }
+
+    std::vector<T> m_added;  // in the order they were added, until Build
+    std::vector<glm::vec2> m_positions;
+    std::vector<T> m_items;             // sorted by cell
+    std::vector<uint32_t> m_cellStarts;  // where the items of every cell start in m_items, and one past the end
+    std::vector<uint32_t> m_next;        // scratch space for Build
+    glm::vec2 m_origin = {};
+    float m_cellSize = 1.0f;
+    int m_width = 0;
+    int m_height = 0;
+};
+
+template <typename T>
+void BucketGrid<T>::Build(const float cellSize)
+{
+    m_items.clear();
+    m_cellStarts.assign(1, 0);
+    m_width = m_height = 0;
+    if (m_added.empty()) return;
+
+    glm::vec2 minimum(std::numeric_limits<float>::max());
+    glm::vec2 maximum(std::numeric_limits<float>::lowest());
+    for (const auto& position : m_positions)
+    {
+        minimum = glm::min(minimum, position);
+        maximum = glm::max(maximum, position);
+    }
+
+    m_origin = minimum;
+    m_cellSize = std::max(cellSize, 0.001f);
+    const glm::vec2 extent = maximum - minimum;
+    const size_t maxCells = std::max<size_t>(64, m_added.size() * MaxCellsPerItem);
+    while (true)
+    {
+        m_width = static_cast<int>(extent.x / m_cellSize) + 1;
+        m_height = static_cast<int>(extent.y / m_cellSize) + 1;
+        if (static_cast<size_t>(m_width) * static_cast<size_t>(m_height) <= maxCells) break;
+        m_cellSize *= 2.0f;
+    }
+
+    // a counting sort by cell, which keeps the order the items were added in within a cell
+    m_cellStarts.assign(static_cast<size_t>(m_width) * static_cast<size_t>(m_height) + 1, 0);
+    for (const auto& position : m_positions) m_cellStarts[CellOf(position) + 1]++;
+    for (size_t cell = 1; cell < m_cellStarts.size(); cell++) m_cellStarts[cell] += m_cellStarts[cell - 1];
+    m_items.resize(m_added.size());
+    m_next.assign(m_cellStarts.begin(), m_cellStarts.end() - 1);
+    for (size_t i = 0; i < m_added.size(); i++) m_items[m_next[CellOf(m_positions[i])]++] = m_added[i];
+}
+
+template <typename T>
+template <typename F>
+void BucketGrid<T>::ForEachWithin(const glm::vec2& center, const float radius, F&& function) const
+{
+    if (m_items.empty()) return;
+
+    const int minX = std::max(static_cast<int>(std::floor((center.x - radius - m_origin.x) / m_cellSize)), 0);
+    const int minY = std::max(static_cast<int>(std::floor((center.y - radius - m_origin.y) / m_cellSize)), 0);
+    const int maxX = std::min(static_cast<int>(std::floor((center.x + radius - m_origin.x) / m_cellSize)), m_width - 1);
+    const int maxY = std::min(static_cast<int>(std::floor((center.y + radius - m_origin.y) / m_cellSize)), m_height - 1);
+    if (minX > maxX || minY > maxY) return;
+
+    // the cells of a row are next to each other in m_items
+    for (int y = minY; y <= maxY; y++)
+    {
+        const size_t row = static_cast<size_t>(y) * static_cast<size_t>(m_width);
+        for (uint32_t i = m_cellStarts[row + minX]; i < m_cellStarts[row + maxX + 1]; i++) function(m_items[i]);
+    }
+}
+
+}  // namespace bee
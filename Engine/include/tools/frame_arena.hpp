@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace bee
+{
+
+/// <summary>
+/// A bump allocator for short lived data. Allocating moves a pointer through a list of chunks, freeing does nothing
+/// (except for the last allocation, so temporaries freed in reverse order give their space back), and Reset drops
+/// everything at once.
+/// When a frame needed more than one chunk, Reset replaces them by one chunk that fits the whole frame, so after a few
+/// frames a frame costs no heap allocations at all.
+///
+/// Debug builds fill new memory with 0xCD and released memory with 0xDD, so use after reset stands out.
+/// </summary>
+class LinearArena
+{
+public:
+    struct Statistics
+    {
+        size_t bytesUsed = 0;         // in use right now
+        size_t highWaterMark = 0;     // the most bytes in use at once, since the arena was made
+        size_t allocations = 0;       // since the last reset
+        size_t heapAllocations = 0;   // chunks allocated since the arena was made
+        size_t capacity = 0;          // bytes in chunks
+    };
+
+    /// <summary>
+    /// A position in the arena to rewind to, see ArenaScope.
+    /// </summary>
+    struct Marker
+    {
+        size_t chunk = 0;
+        size_t offset = 0;
+    };
+
+    explicit LinearArena(size_t chunkSize = 256 * 1024);
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment);
+
+    /// <summary>
+    /// Gives the memory back if it was the last allocation, does nothing otherwise.
+    /// </summary>
+    void Deallocate(void* pointer, size_t size);
+
+    /// <summary>
+    /// Releases everything allocated so far. Memory handed out before must not be used after this.
+    /// </summary>
+    void Reset();
+
+    Marker GetMarker() const { return {m_chunk, m_offset}; }
+
+    /// <summary>
+    /// Releases everything allocated since the marker was taken.
+    /// </summary>
+    void Rewind(const Marker& marker);
+
+    Statistics GetStatistics() const;
+
+private:
+    friend class ArenaScope;
+    friend LinearArena& FrameArena();
+
+    void Poison(std::byte* begin, size_t size, std::byte value) const;
+    void UpdateUsage();
+
+    size_t m_chunkSize;
+    std::vector<std::unique_ptr<std::byte[]>> m_chunks;
+    std::vector<size_t> m_chunkSizes;
+    size_t m_chunk = 0;         // chunk being filled
+    size_t m_offset = 0;        // first free byte in that chunk
+    size_t m_usedBefore = 0;    // bytes in the chunks before m_chunk, including their unused tails
+    size_t m_frameUsage = 0;    // the most bytes in use at once since the last reset
+    int m_scopes = 0;           // open ArenaScopes
+    uint64_t m_frame = 0;       // frame the arena was last reset for, see FrameArena
+
+    // written by the owning thread, read by anyone for the statistics
+    std::atomic<size_t> m_bytesUsed = 0;
+    std::atomic<size_t> m_highWaterMark = 0;
+    std::atomic<size_t> m_allocations = 0;
+    std::atomic<size_t> m_heapAllocations = 0;
+    std::atomic<size_t> m_capacity = 0;
+};
+
+/// <summary>
+/// Rewinds the arena to where it was when the scope was opened. Use it for temporaries of a function that may run many
+/// times per frame, or on a worker thread, so the arena does not grow with the number of calls.
+/// </summary>
+class ArenaScope
+{
+public:
+    explicit ArenaScope(LinearArena& arena) : m_arena(arena), m_marker(arena.GetMarker()) { m_arena.m_scopes++; }
+    ~ArenaScope()
+    {
+        m_arena.Rewind(m_marker);
+        m_arena.m_scopes--;
+    }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    LinearArena& m_arena;
+    LinearArena::Marker m_marker;
+};
+
+/// <summary>
+/// The frame arena of the calling thread. Every thread, including the workers of the thread pool and of parallel
+/// algorithms, has its own, so no locking is needed. Everything allocated from it is released at the end of the frame
+/// (see ResetFrameArenas), so it is only for data that does not outlive the frame.
+/// </summary>
+LinearArena& FrameArena();
+
+/// <summary>
+/// Ends the frame for the frame arenas. The arena of the calling thread is reset right away, the arenas of other
+/// threads reset on their next allocation, unless an ArenaScope is open on them. Engine::Run calls this at the end of
+/// every frame.
+/// </summary>
+void ResetFrameArenas();
+
+/// <summary>
+/// The statistics of the frame arenas of all threads, added up.
+/// </summary>
+LinearArena::Statistics GetFrameArenaStatistics();
+
+/// <summary>
+/// An STL allocator that allocates from a LinearArena, by default the frame arena of the thread that makes it.
+/// </summary>
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator() : m_arena(&FrameArena()) {}
+    explicit ArenaAllocator(LinearArena& arena) : m_arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : m_arena(other.m_arena)
+    {
+    }
+
+    T* allocate(size_t count) { return static_cast<T*>(m_arena->Allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T* pointer, size_t count) { m_arena->Deallocate(pointer, count * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const
+    {
+        return m_arena == other.m_arena;
+    }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const
+    {
+        return m_arena != other.m_arena;
+    }
+
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    LinearArena* m_arena;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+}  // namespace bee
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+
+namespace bee
+{
+/// <summary>
+/// A string that is stored once for the whole program: copies and comparisons only touch a pointer, and holding one
+/// costs 8 bytes no matter how long the string is. Meant for names that repeat a lot, such as entity names. Interned
+/// strings are never freed, so do not intern strings that are unique per entity or per frame.
+/// </summary>
+class InternedString
+{
+public:
+    InternedString() = default;
+    InternedString(const std::string& string) : m_string(Intern(string)) {}
+    InternedString(const char* string) : m_string(Intern(string)) {}
+
+    const std::string& String() const { return *m_string; }
+    operator const std::string&() const { return *m_string; }
+    const char* c_str() const { return m_string->c_str(); }
+    bool empty() const { return m_string->empty(); }
+
+    InternedString& operator+=(const std::string& string)
+    {
+        m_string = Intern(*m_string + string);
+        return *this;
+    }
+
+    bool operator==(const InternedString& other) const { return m_string == other.m_string; }
+    bool operator!=(const InternedString& other) const { return m_string != other.m_string; }
+    bool operator==(const std::string& other) const { return *m_string == other; }
+    bool operator!=(const std::string& other) const { return *m_string != other; }
+    bool operator==(const char* other) const { return *m_string == other; }
+    bool operator!=(const char* other) const { return *m_string != other; }
+
+    /// <summary>
+    /// The number of different strings interned so far, and the bytes they take up.
+    /// </summary>
+    static size_t GetInternedCount();
+    static size_t GetInternedBytes();
+
+private:
+    static const std::string* Intern(const std::string& string);
+
+    static const std::string* Empty();
+
+    const std::string* m_string = Empty();
+};
+
+}  // namespace bee
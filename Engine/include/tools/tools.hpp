@@ -123,10 +123,10 @@ template <typename T>
 inline T& GetComponentInChildren(entt::entity parentEntity)
 {
     auto& registry = bee::Engine.ECS().Registry;
-    Transform& parentTransform = registry.get<Transform>(parentEntity);
+    Hierarchy& parentHierarchy = registry.get<Hierarchy>(parentEntity);
 
     // Iterate through the children
-    entt::entity childEntity = parentTransform.FirstChild();
+    entt::entity childEntity = parentHierarchy.FirstChild();
     while (childEntity != entt::null)
     {
         // Check if the child has the component
@@ -135,7 +135,7 @@ inline T& GetComponentInChildren(entt::entity parentEntity)
             return registry.get<T>(childEntity);
         }
 
-        childEntity = registry.get<Transform>(childEntity).FirstChild();
+        childEntity = registry.get<Hierarchy>(childEntity).FirstChild();
     }
 
     throw std::runtime_error("Component not found in any children.");
@@ -145,10 +145,10 @@ template <typename T>
 inline T* TryGetComponentInChildren(entt::entity parentEntity)
 {
     auto& registry = bee::Engine.ECS().Registry;
-    Transform& parentTransform = registry.get<Transform>(parentEntity);
+    Hierarchy& parentHierarchy = registry.get<Hierarchy>(parentEntity);
 
     // Iterate through the children
-    entt::entity childEntity = parentTransform.FirstChild();
+    entt::entity childEntity = parentHierarchy.FirstChild();
     while (childEntity != entt::null)
     {
         // Check if the child has the component
@@ -157,7 +157,7 @@ inline T* TryGetComponentInChildren(entt::entity parentEntity)
             return registry.try_get<T>(childEntity);
         }
 
-        childEntity = registry.get<Transform>(childEntity).FirstChild();
+        childEntity = registry.get<Hierarchy>(childEntity).FirstChild();
     }
 
     return nullptr;
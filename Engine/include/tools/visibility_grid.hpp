@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+namespace bee
+{
+
+/// <summary>
+/// What one team can see of the terrain, in a uniform grid of cells: a bit per cell for what is visible now and a bit
+/// for what was ever visible. Every cell counts the observers that see it, observers are added with the stamp of
+/// their sight radius when they arrive in a cell and the same stamp is taken off when they leave, so keeping the grid
+/// up to date costs as much as the observers that moved.
+///
+/// With heights set, observers do not see cells higher than where they stand, nor what is behind them.
+/// </summary>
+class VisibilityGrid
+{
+public:
+    /// <summary>
+    /// Covers width by height cells of cellSize, starting at origin. Nothing is visible or explored afterwards, and
+    /// there are no heights.
+    /// </summary>
+    void Resize(const glm::vec2& origin, float cellSize, int width, int height);
+
+    /// <summary>
+    /// The ground height of every cell, for line of sight. Cells more than tolerance above an observer block its sight.
+    /// Empty turns line of sight off. Only change the heights while no observer is on the grid, their stamps would not
+    /// come off the same otherwise.
+    /// </summary>
+    void SetHeights(std::vector<float> heights, float tolerance = 0.25f);
+    bool HasLineOfSight() const { return !m_heights.empty(); }
+
+    /// <summary>
+    /// The cell the position is in, -1 when it is outside of the grid.
+    /// </summary>
+    int GetCell(const glm::vec2& position) const;
+    glm::vec2 GetCellCenter(int cell) const;
+
+    int GetWidth() const { return m_width; }
+    int GetHeight() const { return m_height; }
+    int GetCellCount() const { return m_width * m_height; }
+    float GetCellSize() const { return m_cellSize; }
+
+    /// <summary>
+    /// Adds (count 1) or takes away (count -1) an observer in cell that sees radius cells around it. Does nothing for
+    /// cell -1.
+    /// </summary>
+    void See(int cell, int radius, int count);
+
+    bool IsVisible(int cell) const { return (m_visible[cell >> 6] >> (cell & 63)) & 1; }
+    bool IsExplored(int cell) const { return (m_explored[cell >> 6] >> (cell & 63)) & 1; }
+    int GetObserverCount(int cell) const { return m_observers[cell]; }
+
+    /// <summary>
+    /// Whether the position is in a visible cell. Nothing outside of the grid is.
+    /// </summary>
+    bool IsVisible(const glm::vec2& position) const;
+    bool IsExplored(const glm::vec2& position) const;
+
+    /// <summary>
+    /// The bits of every cell, cell i in bit i % 64 of word i / 64.
+    /// </summary>
+    const std::vector<uint64_t>& GetVisibleBits() const { return m_visible; }
+    const std::vector<uint64_t>& GetExploredBits() const { return m_explored; }
+
+    int GetVisibleCellCount() const { return m_visibleCells; }
+
+    // The largest sight radius, larger ones are cut off.
+    static constexpr int MaxRadius = 32;
+
+private:
+    struct StampCell
+    {
+        int x = 0;
+        int y = 0;
+        int parent = -1;  // the cell before it on the way from the observer, -1 for the observer itself
+    };
+
+    // the cells within radius of the observer, every cell after its parent
+    const std::vector<StampCell>& GetStamp(int radius);
+    void Count(int cell, int count);
+
+    glm::vec2 m_origin = {};
+    float m_cellSize = 1.0f;
+    int m_width = 0;
+    int m_height = 0;
+    int m_visibleCells = 0;
+    float m_tolerance = 0.0f;
+    std::vector<int32_t> m_observers;  // by cell, how many observers see it
+    std::vector<uint64_t> m_visible;   // a bit by cell
+    std::vector<uint64_t> m_explored;  // a bit by cell
+    std::vector<float> m_heights;      // by cell, empty without line of sight
+    std::vector<std::vector<StampCell>> m_stamps;  // by radius, built when first used
+    std::vector<uint8_t> m_inSight;                // scratch space for See, by stamp cell
+};
+
+}  // namespace bee
@@ -12,6 +12,8 @@ void bee::actors::CreateActorSystems()
     Engine.ECS().CreateSystem<UnitManager>();
     Engine.ECS().CreateSystem<StructureManager>();
     Engine.ECS().CreateSystem<PropManager>();
+    // before the AI, which reads the targets it picks
+    Engine.ECS().CreateSystem<TargetingSystem>();
 }
 
 void bee::actors::LoadActorsData(const std::string& fileName)
@@ -9,7 +9,29 @@
 #include "rendering/debug_render.hpp"
 #include "tools/inspector.hpp"
 
-BuffSystem::BuffSystem() { Title = "Buff System"; }
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/gtx/norm.hpp>
+
+BuffSystem::BuffSystem(const float period, const float hysteresis)
+    : m_period(period), m_hysteresis(std::max(hysteresis, 0.0f))
+{
+    Title = "Buff System";
+    Reads<AllyUnit, bee::Transform, bee::Entity>();
+    Writes<BuffStructure, AttributesComponent, AuraBuffs>();
+    auto& registry = bee::Engine.ECS().Registry;
+    registry.on_destroy<BuffStructure>().connect<&BuffSystem::OnAuraDestroyed>(*this);
+    registry.on_destroy<AuraBuffs>().connect<&BuffSystem::OnUnitDestroyed>(*this);
+}
+
+BuffSystem::~BuffSystem()
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    registry.on_destroy<BuffStructure>().disconnect<&BuffSystem::OnAuraDestroyed>(*this);
+    registry.on_destroy<AuraBuffs>().disconnect<&BuffSystem::OnUnitDestroyed>(*this);
+}
 
 void BuffSystem::AddBuff(AttributesComponent& attributes, const BuffStructure& buffStructure)
 {
@@ -53,109 +75,163 @@ void BuffSystem::RemoveBuff(AttributesComponent& attributes, const BuffStructure
     }
 }
 
-
-void BuffSystem::HandleBuffAddition(entt::entity entity, BuffStructure& buffStructure)
+void BuffSystem::Update(const float dt)
 {
-    const auto view = bee::Engine.ECS().Registry.view<AllyUnit, bee::Transform, AttributesComponent>();
-    auto& attributes = view.get<AttributesComponent>(entity);
+    m_time += dt;
+    if (m_time < m_period) return;
+    m_time = std::fmod(m_time, std::max(m_period, std::numeric_limits<float>::min()));
+    Tick();
+}
 
-    const auto& modifiers = attributes.GetModifiers(buffStructure.buffType);
+void BuffSystem::Tick()
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    m_tick++;
+    m_enters = m_exits = 0;
 
-    if (std::count_if(modifiers.begin(), modifiers.end(),[](const StatModifier& modifier)
+    const auto auraView = registry.view<BuffStructure, bee::Transform, AttributesComponent>();
+    float largestRange = 0.0f;
+    for (const auto aura : auraView)
     {
-        return modifier.isBuff;
-    }) > 0)
+        const auto& attributes = auraView.get<AttributesComponent>(aura);
+        if (!attributes.HasAttribute(BaseAttributes::BuffRange)) continue;
+        largestRange = std::max(largestRange, static_cast<float>(attributes.GetValue(BaseAttributes::BuffRange)));
+    }
+
+    m_units.Clear();
+    const auto unitView = registry.view<AllyUnit, bee::Transform, AttributesComponent>();
+    for (const auto entity : unitView)
     {
-        for (auto& modifier : modifiers)
-        {
-            const double value = modifier.GetValue();
+        const glm::vec3& position = unitView.get<bee::Transform>(entity).Translation;
+        m_units.Add(glm::vec2(position), {entity, position});
+    }
+    m_units.Build(largestRange + m_hysteresis);
 
-            if (!modifier.isBuff) continue;
-            if (value <= buffStructure.buffModifier.GetValue() &&buffStructure.buffModifier.GetModifierType() == modifier.GetModifierType())continue;
+    for (const auto aura : auraView)
+    {
+        auto& buffStructure = auraView.get<BuffStructure>(aura);
+        const auto& attributes = auraView.get<AttributesComponent>(aura);
+        const glm::vec3& center = auraView.get<bee::Transform>(aura).Translation;
 
-            AddBuff(attributes,buffStructure);
-            RemoveBuff(attributes, buffStructure, modifier);
-            attributes.RemoveModifier(buffStructure.buffType, modifier);
+        // units enter within range, and only leave once they are further out than that
+        if (attributes.HasAttribute(BaseAttributes::BuffRange) && attributes.HasAttribute(BaseAttributes::BuffValue))
+        {
+            const float range = static_cast<float>(attributes.GetValue(BaseAttributes::BuffRange));
+            const float stayRange = range + m_hysteresis;
+            m_units.ForEachWithin(glm::vec2(center), stayRange,
+                                  [&](const Unit& unit)
+                                  {
+                                      const float distance2 = glm::distance2(unit.position, center);
+                                      const auto member = buffStructure.members.find(unit.entity);
+                                      if (member != buffStructure.members.end())
+                                      {
+                                          if (distance2 <= stayRange * stayRange) member->second = m_tick;
+                                          return;
+                                      }
+                                      if (distance2 > range * range) return;
+                                      buffStructure.members.emplace(unit.entity, m_tick);
+                                      Enter(unit.entity, aura);
+                                  });
+        }
 
-            buffStructure.buffedEntities.push_back(entity);
-            return;
+        // the members it did not see this tick left, or are no ally units any more
+        m_leaving.clear();
+        for (const auto& [unit, tick] : buffStructure.members)
+            if (tick != m_tick) m_leaving.push_back(unit);
+        for (const auto unit : m_leaving)
+        {
+            buffStructure.members.erase(unit);
+            Exit(unit, aura);
         }
     }
-    else
-    {
-        AddBuff(attributes, buffStructure);
-        buffStructure.buffedEntities.push_back(entity);
-    }
 }
 
-void BuffSystem::RemoveBuff(entt::entity entity, BuffStructure& buffStructure) const
+void BuffSystem::Enter(const bee::Entity unit, const bee::Entity aura)
 {
-    const auto view = bee::Engine.ECS().Registry.view<AllyUnit, bee::Transform, AttributesComponent>();
-    auto& attributes = view.get<AttributesComponent>(entity);
+    auto& registry = bee::Engine.ECS().Registry;
+    auto& buffs = registry.get_or_emplace<AuraBuffs>(unit);
+    auto& attributes = registry.get<AttributesComponent>(unit);
+    const auto& buffStructure = registry.get<BuffStructure>(aura);
+    buffs.auras.push_back(aura);
+    m_enters++;
 
-    for (auto& modifier : attributes.GetModifiers(buffStructure.buffType))
+    // only the strongest aura of an attribute buffs the unit
+    const auto applied = std::find_if(buffs.applied.begin(), buffs.applied.end(), [&](const bee::Entity other)
+                                      { return registry.get<BuffStructure>(other).buffType == buffStructure.buffType; });
+    if (applied == buffs.applied.end())
     {
-        const double value = modifier.GetValue();
-        if (value != buffStructure.buffModifier.GetValue()) continue;
-        if (modifier.GetModifierType() != buffStructure.buffModifier.GetModifierType()) continue;
-
-        RemoveBuff(attributes, buffStructure, modifier);
+        AddBuff(attributes, buffStructure);
+        buffs.applied.push_back(aura);
         return;
     }
+
+    const auto& current = registry.get<BuffStructure>(*applied);
+    if (buffStructure.buffModifier.GetValue() <= current.buffModifier.GetValue()) return;
+    RemoveBuff(attributes, current, current.buffModifier);
+    AddBuff(attributes, buffStructure);
+    *applied = aura;
 }
 
-void BuffSystem::HandleBuffs(BuffStructure& allyStructure, const AttributesComponent& attributes,
-                                  const bee::Transform& structureTransform)
+void BuffSystem::Exit(const bee::Entity unit, const bee::Entity aura)
 {
-    float range = attributes.GetValue(BaseAttributes::BuffRange);
-    const auto view = bee::Engine.ECS().Registry.view<AllyUnit, bee::Transform, AttributesComponent>();
+    auto& registry = bee::Engine.ECS().Registry;
+    auto* buffs = registry.try_get<AuraBuffs>(unit);
+    if (buffs == nullptr) return;
+    m_exits++;
 
-    for (const auto entity : view)
+    const auto member = std::find(buffs->auras.begin(), buffs->auras.end(), aura);
+    if (member != buffs->auras.end())
     {
-        auto& transform = view.get<bee::Transform>(entity);
-        if (glm::distance2(transform.Translation, structureTransform.Translation) <= glm::pow(range, 2))
-        {
-            HandleBuffAddition(entity, allyStructure);
-        }
+        *member = buffs->auras.back();
+        buffs->auras.pop_back();
     }
 
-    for (const auto entity : allyStructure.buffedEntities)
-    {
-        if (!bee::Engine.ECS().Registry.valid(entity))
-        {
-            allyStructure.buffedEntities.erase(
-                std::remove(allyStructure.buffedEntities.begin(), allyStructure.buffedEntities.end(), entity));
-            continue;
-        }
+    const auto applied = std::find(buffs->applied.begin(), buffs->applied.end(), aura);
+    if (applied == buffs->applied.end()) return;
+    *applied = buffs->applied.back();
+    buffs->applied.pop_back();
 
-        auto& transform = view.get<bee::Transform>(entity);
-        if (glm::distance2(transform.Translation, structureTransform.Translation) > glm::pow(range, 2))
-        {
-            RemoveBuff(entity, allyStructure);
-        }
-    }
+    auto* attributes = registry.try_get<AttributesComponent>(unit);
+    if (attributes == nullptr) return;
+
+    // the next strongest aura of the attribute takes over
+    const auto& buffStructure = registry.get<BuffStructure>(aura);
+    RemoveBuff(*attributes, buffStructure, buffStructure.buffModifier);
+    const bee::Entity next = FindStrongest(*buffs, buffStructure.buffType);
+    if (next == entt::null) return;
+    AddBuff(*attributes, registry.get<BuffStructure>(next));
+    buffs->applied.push_back(next);
 }
 
-void BuffSystem::Update(float dt)
+bee::Entity BuffSystem::FindStrongest(const AuraBuffs& buffs, const BaseAttributes type) const
 {
-    const auto alliedStructuresView = bee::Engine.ECS().Registry.view<BuffStructure, bee::Transform, AttributesComponent>();
-    for (auto [structureEntity, allyStructure, structureTransform, attributes] : alliedStructuresView.each())
+    const auto& registry = bee::Engine.ECS().Registry;
+    bee::Entity strongest = entt::null;
+    double strongestValue = 0.0;
+    for (const auto aura : buffs.auras)
     {
-        if (!attributes.HasAttribute(BaseAttributes::BuffRange) || !attributes.HasAttribute(BaseAttributes::BuffValue))
-            continue;
-        HandleBuffs(allyStructure, attributes, structureTransform);
+        const auto* buffStructure = registry.try_get<BuffStructure>(aura);
+        if (buffStructure == nullptr || buffStructure->buffType != type) continue;
+        if (strongest != entt::null && buffStructure->buffModifier.GetValue() <= strongestValue) continue;
+        strongest = aura;
+        strongestValue = buffStructure->buffModifier.GetValue();
     }
-    //Debug code for HP
-   /* if (bee::Engine.Input().GetKeyboardKeyOnce(bee::Input::KeyboardKey::Space))
-    {
-        auto view = bee::Engine.ECS().Registry.view<AllyUnit, AttributesComponent,Selected>();
-        for (auto [entity,ally,attribute,selected]:view.each())
-        {
-            attribute.AddModifier(BaseAttributes::HitPoints, ModifierType::Additive, -1, false);
-            break;
-        }
-    }*/
+    return strongest;
 }
+
+void BuffSystem::OnAuraDestroyed(entt::registry& registry, const bee::Entity aura)
+{
+    auto& buffStructure = registry.get<BuffStructure>(aura);
+    for (const auto& [unit, tick] : buffStructure.members) Exit(unit, aura);
+    buffStructure.members.clear();
+}
+
+void BuffSystem::OnUnitDestroyed(entt::registry& registry, const bee::Entity unit)
+{
+    for (const auto aura : registry.get<AuraBuffs>(unit).auras)
+        if (auto* buffStructure = registry.try_get<BuffStructure>(aura)) buffStructure->members.erase(unit);
+}
+
 #ifdef BEE_INSPECTOR
 void BuffSystem::Inspect()
 {
@@ -173,6 +249,7 @@ void BuffSystem::Inspect()
         }
     }
     ImGui::Begin("Buff System Debug Information");
+    ImGui::Text("Last tick: %d entered, %d left", m_enters, m_exits);
     auto view = bee::Engine.ECS().Registry.view<AttributesComponent, AllyUnit, Selected>();
     for (auto [entity, attributes, ally, selected] : view.each())
     {
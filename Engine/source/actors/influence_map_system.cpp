@@ -0,0 +1,210 @@
+#include "actors/influence_map_system.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "actors/attributes.hpp"
+#include "actors/props/resource_system.hpp"
+#include "actors/structures/structure_manager_system.hpp"
+#include "actors/units/unit_manager_system.hpp"
+#include "core/engine.hpp"
+#include "core/transform.hpp"
+#include "level_editor/level_editor_components.hpp"
+
+#ifdef BEE_INSPECTOR
+#include <imgui/imgui.h>
+#endif
+
+using bee::ai::InfluenceLayer;
+
+namespace
+{
+float ValueOrZero(const AttributesComponent* attributes, const BaseAttributes type)
+{
+    if (attributes == nullptr || !attributes->HasAttribute(type)) return 0.0f;
+    return static_cast<float>(attributes->GetValue(type));
+}
+
+InfluenceLayer ThreatLayer(const Team team) { return team == Team::Ally ? InfluenceLayer::AllyThreat : InfluenceLayer::EnemyThreat; }
+
+InfluenceLayer DensityLayer(const Team team) { return team == Team::Ally ? InfluenceLayer::AllyDensity : InfluenceLayer::EnemyDensity; }
+}  // namespace
+
+InfluenceMapSystem::InfluenceMapSystem(const float period, const float sightRange)
+    : m_period(period), m_sightRange(std::max(sightRange, 0.0f))
+{
+    Title = "Influence Map";
+    Reads<AllyUnit, EnemyUnit, AllyStructure, EnemyStructure, PropResourceComponent, bee::Transform, AttributesComponent,
+          lvle::TerrainDataComponent>();
+    Writes<InfluenceSource>();
+    bee::Engine.ECS().Registry.on_destroy<InfluenceSource>().connect<&InfluenceMapSystem::OnSourceDestroyed>(*this);
+}
+
+InfluenceMapSystem::~InfluenceMapSystem()
+{
+    bee::Engine.ECS().Registry.on_destroy<InfluenceSource>().disconnect<&InfluenceMapSystem::OnSourceDestroyed>(*this);
+}
+
+void InfluenceMapSystem::Update(const float dt)
+{
+    m_time += dt;
+    m_sinceSync += dt;
+    if (m_sinceSync < m_period) return;
+    m_sinceSync = std::fmod(m_sinceSync, std::max(m_period, std::numeric_limits<float>::min()));
+    Sync();
+}
+
+void InfluenceMapSystem::UpdateFromTerrain()
+{
+    const auto view = bee::Engine.ECS().Registry.view<lvle::TerrainDataComponent>();
+    for (const auto entity : view)
+    {
+        // the terrain is centered on the origin, the small grid has points every half tile
+        const auto& data = view.get<lvle::TerrainDataComponent>(entity);
+        const glm::vec2 size(static_cast<float>(data.m_width) * data.m_step, static_cast<float>(data.m_height) * data.m_step);
+        SetBounds(-size * 0.5f, data.m_step * 0.5f, data.m_width * 2, data.m_height * 2);
+    }
+}
+
+void InfluenceMapSystem::SetBounds(const glm::vec2& origin, const float cellSize, const int width, const int height)
+{
+    // the sources come off an empty map, which costs nothing
+    auto& registry = bee::Engine.ECS().Registry;
+    m_map.Resize(origin, cellSize, 0, 0);
+    m_gone.clear();
+    for (const auto entity : registry.view<InfluenceSource>()) m_gone.push_back(entity);
+    for (const auto entity : m_gone) registry.remove<InfluenceSource>(entity);
+    m_map.Resize(origin, cellSize, width, height);
+}
+
+void InfluenceMapSystem::Sync()
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    m_tick++;
+    m_restamps = 0;
+
+    SyncActors<AllyUnit>(Team::Ally, true);
+    SyncActors<EnemyUnit>(Team::Enemy, true);
+    SyncActors<AllyStructure>(Team::Ally, false);
+    SyncActors<EnemyStructure>(Team::Enemy, false);
+    SyncResources();
+
+    // what was not seen this sync is no actor or resource any more
+    m_gone.clear();
+    for (const auto& [entity, source] : registry.view<InfluenceSource>().each())
+        if (source.tick != m_tick) m_gone.push_back(entity);
+    for (const auto entity : m_gone) registry.remove<InfluenceSource>(entity);
+}
+
+template <typename Tag>
+void InfluenceMapSystem::SyncActors(const Team team, const bool unit)
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    const auto view = registry.view<Tag, bee::Transform>();
+    for (const auto entity : view)
+    {
+        const auto* attributes = registry.try_get<AttributesComponent>(entity);
+        const float damage = ValueOrZero(attributes, BaseAttributes::Damage);
+        const float cooldown = ValueOrZero(attributes, BaseAttributes::AttackCooldown);
+        const float interceptionRange = ValueOrZero(attributes, BaseAttributes::InterceptionRange);
+
+        InfluenceSource next;
+        next.cell = m_map.GetCell(glm::vec2(view.template get<bee::Transform>(entity).Translation));
+        next.threat = cooldown > 0.0f ? damage / cooldown : damage;
+        next.threatRadius = ToCells(interceptionRange > 0.0f ? interceptionRange : ValueOrZero(attributes, BaseAttributes::Range));
+        next.sightRadius = team == Team::Enemy ? ToCells(m_sightRange) : -1;
+        next.density = unit ? 1.0f : 0.0f;
+        next.team = team;
+        Apply(entity, next);
+    }
+}
+
+void InfluenceMapSystem::SyncResources()
+{
+    const auto view = bee::Engine.ECS().Registry.view<PropResourceComponent, bee::Transform>();
+    for (const auto entity : view)
+    {
+        InfluenceSource next;
+        next.cell = m_map.GetCell(glm::vec2(view.get<bee::Transform>(entity).Translation));
+        next.resources = static_cast<float>(view.get<PropResourceComponent>(entity).resourceGain);
+        Apply(entity, next);
+    }
+}
+
+void InfluenceMapSystem::Apply(const bee::Entity entity, InfluenceSource next)
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    next.tick = m_tick;
+    auto* source = registry.try_get<InfluenceSource>(entity);
+    if (source == nullptr)
+    {
+        Put(next, 1);
+        registry.emplace<InfluenceSource>(entity, next);
+        m_restamps++;
+        return;
+    }
+
+    const bool changed = source->cell != next.cell || source->threatRadius != next.threatRadius ||
+                         source->sightRadius != next.sightRadius || source->threat != next.threat ||
+                         source->density != next.density || source->resources != next.resources || source->team != next.team;
+    if (changed)
+    {
+        Put(*source, -1);
+        Put(next, 1);
+        m_restamps++;
+    }
+    *source = next;
+}
+
+void InfluenceMapSystem::Put(const InfluenceSource& source, const int sign)
+{
+    if (source.cell < 0) return;
+    const float scale = static_cast<float>(sign);
+    if (source.team != Team::Neutral)
+    {
+        if (source.threat != 0.0f) m_map.Stamp(ThreatLayer(source.team), source.cell, source.threatRadius, scale * source.threat);
+        if (source.density != 0.0f) m_map.Stamp(DensityLayer(source.team), source.cell, 0, scale * source.density);
+    }
+    if (source.resources != 0.0f) m_map.Stamp(InfluenceLayer::Resources, source.cell, 0, scale * source.resources);
+    if (source.sightRadius >= 0) m_map.See(source.cell, source.sightRadius, sign, m_time);
+}
+
+int InfluenceMapSystem::ToCells(const float range) const
+{
+    const float cells = std::ceil(range / m_map.GetCellSize());
+    return std::clamp(static_cast<int>(cells), 0, bee::ai::InfluenceMap::MaxRadius);
+}
+
+void InfluenceMapSystem::OnSourceDestroyed(entt::registry& registry, const bee::Entity entity)
+{
+    Put(registry.get<InfluenceSource>(entity), -1);
+}
+
+std::optional<glm::vec2> InfluenceMapSystem::FindWeakestCluster(const Team team) const
+{
+    if (team == Team::Neutral) return std::nullopt;
+    return m_map.FindWeakestCluster(DensityLayer(team), ThreatLayer(team));
+}
+
+std::optional<glm::vec2> InfluenceMapSystem::FindSafestResource(const Team threatOf, const glm::vec2& from) const
+{
+    if (threatOf == Team::Neutral) return std::nullopt;
+    return m_map.FindSafestResource(ThreatLayer(threatOf), from);
+}
+
+std::optional<glm::vec2> InfluenceMapSystem::FindLeastExplored(const glm::vec2& from) const
+{
+    return m_map.FindLeastExplored(from, m_time);
+}
+
+#ifdef BEE_INSPECTOR
+void InfluenceMapSystem::Inspect()
+{
+    ImGui::Begin("Influence Map");
+    ImGui::DragFloat("Period", &m_period, 0.05f, 0.0f, 5.0f);
+    ImGui::Text("Cells: %d x %d of %.2f", m_map.GetWidth(), m_map.GetHeight(), m_map.GetCellSize());
+    ImGui::Text("Restamped on the last sync: %d", m_restamps);
+    ImGui::End();
+}
+#endif
@@ -12,6 +12,7 @@
 #include "core/engine.hpp"
 #include "core/resources.hpp"
 #include "rendering/model.hpp"
+#include "rendering/render_components.hpp"
 #include "actors/units/unit_template.hpp"
 #include "particle_system/particle_system.hpp"
 
@@ -23,11 +24,15 @@ ProjectileSystem::ProjectileSystem()
                           auto& ecs = bee::Engine.ECS();
                           const auto entity = ecs.CreateEntity();
                           auto& transform = ecs.CreateComponent<bee::Transform>(entity);
-                          transform.Name = "Projectile"+std::to_string(static_cast<int>(entity));
+                          transform.Name = "Projectile";
                           auto& projectile = ecs.CreateComponent<Projectile>(entity);
                           return entity;
                     }))
 {
+    Title = "Projectiles";
+    // a hit hurts the target, tells its AI and sets off particles
+    Writes<Projectile, bee::Transform, AttributesComponent, bee::ai::StateMachineAgent, bee::ParticleEmitter,
+           bee::ParticleComponent, bee::Hierarchy, bee::WorldTransform, bee::MeshRenderer, bee::Entity>();
 }
 
 ProjectileSystem::~ProjectileSystem()
@@ -173,12 +173,12 @@ void PropManager::ReloadPropsFromTemplate(std::string propHandle)
             // update attributes
             propAttribute.SetAttributes(GetPropTemplate(propAttribute.GetEntityType()).GetAttributes());
             // update model
-            transform.NoChildren();
+            bee::Engine.ECS().Registry.get<bee::Hierarchy>(entity).NoChildren();
             transform.Scale = glm::vec3(m_Props.at(propAttribute.GetEntityType()).GetAttribute(BaseAttributes::Scale));
             auto modelEntity = bee::Engine.ECS().CreateEntity();
             auto& modelTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(modelEntity);
             modelTransform.Name = "Model";
-            modelTransform.SetParent(entity);
+            bee::Engine.ECS().Registry.get<bee::Hierarchy>(modelEntity).SetParent(entity);
             modelTransform.Translation += propTemplate.modelOffset.Translation;
             auto modelEuler = glm::eulerAngles(modelTransform.Rotation);
             auto modelOffsetEuler = glm::eulerAngles(propTemplate.modelOffset.Rotation);
@@ -239,7 +239,7 @@ std::optional<bee::Entity> PropManager::SpawnProp(std::string propTemplateHandle
     auto modelEntity = bee::Engine.ECS().CreateEntity();
     auto& modelTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(modelEntity);
     modelTransform.Name = "Model";
-    modelTransform.SetParent(propEntity);
+    bee::Engine.ECS().Registry.get<bee::Hierarchy>(modelEntity).SetParent(propEntity);
     modelTransform.Translation += propTemplate.modelOffset.Translation;
     auto modelEuler = glm::eulerAngles(modelTransform.Rotation);
     auto modelOffsetEuler = glm::eulerAngles(propTemplate.modelOffset.Rotation);
@@ -291,8 +291,7 @@ std::optional<bee::Entity> PropManager::SpawnProp(std::string propTemplateHandle
         std::string name = propTemplateHandle + "PropCollider";
         auto colliderEntity =
             terrainSystem.CreateTerrainColliderEntity({colliderPointA, colliderPointB, colliderPointC, colliderPointD}, name);
-        auto& colliderTransform = bee::Engine.ECS().Registry.get<bee::Transform>(colliderEntity);
-        colliderTransform.SetParent(propEntity);
+        bee::Engine.ECS().Registry.get<bee::Hierarchy>(colliderEntity).SetParent(propEntity);
     }
 
     return propEntity;
@@ -2,8 +2,10 @@
 
 #include "actors/units/unit_manager_system.hpp"
 #include "core/engine.hpp"
+#include "core/transform.hpp"
 #include "physics/world.hpp"
 #include "physics/physics_components.hpp"
+#include "rendering/render_components.hpp"
 #include "tools/3d_utility_functions.hpp"
 #include "tools/tools.hpp"
 #include "user_interface/user_interface.hpp"
@@ -12,6 +14,9 @@
 ResourceSystem::ResourceSystem()
 {
     Title = "ResourceSystem";
+    Reads<bee::Hierarchy>();
+    Writes<ResourceSystem, PropResourceComponent, bee::Transform, bee::MeshRenderer, bee::Entity,
+           bee::ui::UserInterface>();
     auto& UI = bee::Engine.ECS().GetSystem<bee::ui::UserInterface>();
     m_plusResource = UI.serialiser->LoadElement("CollectedResources");
     m_plusTransparency = UI.serialiser->LoadElement("CollectResourceTransparency");
@@ -6,6 +6,7 @@
 #include "level_editor/terrain_system.hpp"
 #include "physics/physics_components.hpp"
 #include "rendering/debug_render.hpp"
+#include "rendering/render_components.hpp"
 #include "tools/3d_utility_functions.hpp"
 #ifdef STEAM_API_WINDOWS
 #include "tools/steam_input_system.hpp"
@@ -230,7 +231,7 @@ void SelectionSystem::SelectUnits(const bool preSelection) const
                 auto seletionEntity= bee::Engine.ECS().CreateEntity();
                 bee::Engine.ECS().CreateComponent<SelectionCircle>(seletionEntity);
                 auto& selectionTransform =bee::Engine.ECS().CreateComponent<bee::Transform>(seletionEntity);
-                selectionTransform.SetParent(entity);
+                bee::Engine.ECS().Registry.get<bee::Hierarchy>(seletionEntity).SetParent(entity);
                 selectionTransform.Translation.z = 0.255f;
                 selectionTransform.Scale *=bee::Engine.ECS().Registry.get<AttributesComponent>(entity).GetValue(BaseAttributes::SelectionRange);
                 selectionModel->Instantiate(seletionEntity);
@@ -245,7 +246,7 @@ void SelectionSystem::SelectUnits(const bool preSelection) const
                 auto seletionEntity = bee::Engine.ECS().CreateEntity();
                 bee::Engine.ECS().CreateComponent<SelectionCircle>(seletionEntity);
                 auto& selectionTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(seletionEntity);
-                selectionTransform.SetParent(entity);
+                bee::Engine.ECS().Registry.get<bee::Hierarchy>(seletionEntity).SetParent(entity);
                 selectionTransform.Translation.z = 0.255f;
                 selectionTransform.Scale *=
                     bee::Engine.ECS().Registry.get<AttributesComponent>(entity).GetValue(BaseAttributes::SelectionRange);
@@ -283,7 +284,7 @@ void SelectionSystem::SelectUnits(const bool preSelection) const
                 auto seletionEntity = bee::Engine.ECS().CreateEntity();
                 bee::Engine.ECS().CreateComponent<SelectionCircle>(seletionEntity);
                 auto& selectionTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(seletionEntity);
-                selectionTransform.SetParent(entity);
+                bee::Engine.ECS().Registry.get<bee::Hierarchy>(seletionEntity).SetParent(entity);
                 selectionTransform.Translation.z = 0.255f;
                 selectionTransform.Scale *=
                     bee::Engine.ECS().Registry.get<AttributesComponent>(entity).GetValue(BaseAttributes::SelectionRange);
@@ -299,7 +300,7 @@ void SelectionSystem::SelectUnits(const bool preSelection) const
                 auto seletionEntity = bee::Engine.ECS().CreateEntity();
                 bee::Engine.ECS().CreateComponent<SelectionCircle>(seletionEntity);
                 auto& selectionTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(seletionEntity);
-                selectionTransform.SetParent(entity);
+                bee::Engine.ECS().Registry.get<bee::Hierarchy>(seletionEntity).SetParent(entity);
                 selectionTransform.Translation.z = 0.255f;
                 selectionTransform.Scale *=
                     bee::Engine.ECS().Registry.get<AttributesComponent>(entity).GetValue(BaseAttributes::SelectionRange);
@@ -373,15 +374,15 @@ void SelectionSystem::ControllerSelectionUnits(const bool preSelection) const
 
 void SelectionSystem::DeselectUnits(const bool preSelection) const
 {
-    auto view = bee::Engine.ECS().Registry.view<SelectionCircle, bee::Transform>();
+    auto view = bee::Engine.ECS().Registry.view<SelectionCircle, bee::Hierarchy>();
     if (!preSelection)
     {
         const auto alliedUnits = bee::Engine.ECS().Registry.view<Selected>();
         bee::Engine.ECS().Registry.remove<Selected>(alliedUnits.begin(), alliedUnits.end());
         for (const auto selectionCircle : view)
         {
-            auto& transform = view.get<bee::Transform>(selectionCircle);
-            bee::Engine.ECS().Registry.get<bee::Transform>(transform.GetParent()).RemoveChild(selectionCircle);
+            auto& hierarchy = view.get<bee::Hierarchy>(selectionCircle);
+            bee::Engine.ECS().Registry.get<bee::Hierarchy>(hierarchy.GetParent()).RemoveChild(selectionCircle);
             bee::Engine.ECS().DeleteEntity(selectionCircle);
         }
     }
@@ -391,8 +392,8 @@ void SelectionSystem::DeselectUnits(const bool preSelection) const
         bee::Engine.ECS().Registry.remove<MidSelection>(alliedUnits.begin(), alliedUnits.end());
         for (const auto selectionCircle : view)
         {
-            auto& transform = view.get<bee::Transform>(selectionCircle);
-            bee::Engine.ECS().Registry.get<bee::Transform>(transform.GetParent()).RemoveChild(selectionCircle);
+            auto& hierarchy = view.get<bee::Hierarchy>(selectionCircle);
+            bee::Engine.ECS().Registry.get<bee::Hierarchy>(hierarchy.GetParent()).RemoveChild(selectionCircle);
             bee::Engine.ECS().DeleteEntity(selectionCircle);
         }
     }
@@ -414,7 +415,7 @@ void SelectionSystem::AddHoveringForEnemy() const
         bee::Engine.ECS().CreateComponent<SelectionCircle>(seletionEntity);
         bee::Engine.ECS().CreateComponent<EnemyUnit>(seletionEntity);
         auto& selectionTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(seletionEntity);
-        selectionTransform.SetParent(enemyEntity);
+        bee::Engine.ECS().Registry.get<bee::Hierarchy>(seletionEntity).SetParent(enemyEntity);
         selectionTransform.Translation.z = 0.255f;
         selectionTransform.Scale *=
             bee::Engine.ECS().Registry.get<AttributesComponent>(enemyEntity).GetValue(BaseAttributes::SelectionRange);
@@ -426,9 +427,9 @@ void SelectionSystem::AddHoveringForEnemy() const
 
 void SelectionSystem::RemoveHoveringForEnemy()
 {
-    for (auto [entity,transform,selection,enemy] : bee::Engine.ECS().Registry.view<bee::Transform, SelectionCircle, EnemyUnit>().each())
+    for (auto [entity,hierarchy,selection,enemy] : bee::Engine.ECS().Registry.view<bee::Hierarchy, SelectionCircle, EnemyUnit>(entt::exclude<bee::Hidden>).each())
     {
-        bee::Engine.ECS().Registry.get<bee::Transform>(transform.GetParent()).RemoveChild(entity);
+        bee::Engine.ECS().Registry.get<bee::Hierarchy>(hierarchy.GetParent()).RemoveChild(entity);
         bee::Engine.ECS().DeleteEntity(entity);
     }
 }
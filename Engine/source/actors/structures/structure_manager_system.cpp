@@ -34,6 +34,15 @@ inline bool fileExists(const std::string& name)
     return (stat(name.c_str(), &buffer) == 0);
 }
 
+StructureManager::StructureManager()
+{
+    Title = "Structure Manager";
+    // marks the destroyed for their AI, and sets the badly damaged on fire
+    Reads<AttributesComponent, AllyStructure>();
+    Writes<bee::ai::StateMachineAgent, HurtBuildingVFX, bee::Transform, bee::Hierarchy, bee::WorldTransform,
+           bee::ParticleEmitter, bee::Entity>();
+}
+
 void StructureManager::AddNewStructureTemplate(StructureTemplate structureTemplate)
 {
     if (m_Structures.find(structureTemplate.name) != m_Structures.end())
@@ -41,6 +50,13 @@ void StructureManager::AddNewStructureTemplate(StructureTemplate structureTempla
         bee::Log::Warn("Strucuture Name " + structureTemplate.name + " is already used. Try another name.");
         return;
     }
+    // models can not be loaded without a device, a headless engine only simulates
+    if (bee::Engine.IsHeadless())
+    {
+        m_Structures.insert(std::pair<std::string, StructureTemplate>(structureTemplate.name, structureTemplate));
+        return;
+    }
+
     structureTemplate.model = bee::Engine.Resources().Load<bee::Model>(structureTemplate.modelPath);
     structureTemplate.corpseModel = bee::Engine.Resources().Load<bee::Model>(structureTemplate.corpsePath);
 
@@ -249,12 +265,12 @@ void StructureManager::ReloadStructuresFromTemplate(const std::string& structure
             auto& agent = bee::Engine.ECS().CreateComponent<bee::ai::StateMachineAgent>(entity, *fsm);
             agent.context.entity = entity;
             // update model
-            transform.NoChildren();
+            bee::Engine.ECS().Registry.get<bee::Hierarchy>(entity).NoChildren();
             transform.Scale = glm::vec3(m_Structures.at(structureAttribute.GetEntityType()).GetAttribute(BaseAttributes::Scale));
             auto modelEntity = bee::Engine.ECS().CreateEntity();
             auto& modelTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(modelEntity);
             modelTransform.Name = "Model";
-            modelTransform.SetParent(entity);
+            bee::Engine.ECS().Registry.get<bee::Hierarchy>(modelEntity).SetParent(entity);
             modelTransform.Translation += structureTemplate.modelOffset.Translation;
             auto modelEuler = glm::eulerAngles(modelTransform.Rotation);
             auto modelOffsetEuler = glm::eulerAngles(structureTemplate.modelOffset.Rotation);
@@ -342,7 +358,7 @@ std::optional<bee::Entity> StructureManager::SpawnStructure(const std::string& s
     // model transform
     auto& modelTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(modelEntity);
     modelTransform.Name = "Model";
-    modelTransform.SetParent(strucutureEntity);
+    bee::Engine.ECS().Registry.get<bee::Hierarchy>(modelEntity).SetParent(strucutureEntity);
     modelTransform.Translation += structureTemplate.modelOffset.Translation;
     auto modelEuler = glm::eulerAngles(modelTransform.Rotation);
     auto modelOffsetEuler = glm::eulerAngles(structureTemplate.modelOffset.Rotation);
@@ -353,11 +369,14 @@ std::optional<bee::Entity> StructureManager::SpawnStructure(const std::string& s
     auto& modelTag = bee::Engine.ECS().CreateComponent<StructureModelTag>(modelEntity);
     modelTag.structureTemplate = structureTemplateHandle;
 
-    // model
-    auto model = bee::Engine.Resources().Load<bee::Model>(structureTemplate.modelPath);
-    model->Instantiate(modelEntity);
-    int index = 0;
-    bee::UpdateMeshRenderer(modelEntity, structureTemplate.materials, index);
+    // model, not for a headless engine
+    if (!bee::Engine.IsHeadless())
+    {
+        auto model = bee::Engine.Resources().Load<bee::Model>(structureTemplate.modelPath);
+        model->Instantiate(modelEntity);
+        int index = 0;
+        bee::UpdateMeshRenderer(modelEntity, structureTemplate.materials, index);
+    }
 
     // training/production building
     for (const auto element : structureTemplate.availableOrders)
@@ -377,12 +396,14 @@ std::optional<bee::Entity> StructureManager::SpawnStructure(const std::string& s
             auto& flagTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(flagEntity);
             flagTransform.Translation = spawningStructure.rallyPoint;
             flagTransform.Name = "Flag";
-            const auto flagModel = bee::Engine.Resources().Load<bee::Model>("models/flag.glb");
             spawningStructure.flagEntity = flagEntity;
             spawningStructure.spawnLimit = static_cast<int>(baseAttributes.GetValue(BaseAttributes::MaxTrainedUnitsQueued));
-            flagModel->Instantiate(flagEntity);
-
-            bee::GetComponentInChildren<bee::MeshRenderer>(flagEntity).Material =bee::Engine.Resources().Load<bee::Material>("materials/flag.pepimat");
+            if (!bee::Engine.IsHeadless())
+            {
+                const auto flagModel = bee::Engine.Resources().Load<bee::Model>("models/flag.glb");
+                flagModel->Instantiate(flagEntity);
+                bee::GetComponentInChildren<bee::MeshRenderer>(flagEntity).Material =bee::Engine.Resources().Load<bee::Material>("materials/flag.pepimat");
+            }
 
             break;
         }
@@ -443,8 +464,7 @@ std::optional<bee::Entity> StructureManager::SpawnStructure(const std::string& s
     std::string name = structureTemplateHandle + "StructureCollider";
     auto colliderEntity =
         terrainSystem.CreateTerrainColliderEntity({colliderPointA, colliderPointB, colliderPointC, colliderPointD}, name);
-    auto& colliderTransform = bee::Engine.ECS().Registry.get<bee::Transform>(colliderEntity);
-    colliderTransform.SetParent(strucutureEntity);
+    bee::Engine.ECS().Registry.get<bee::Hierarchy>(colliderEntity).SetParent(strucutureEntity);
 
     if (structureTemplate.HasAttribute(BaseAttributes::BuffRange))
     {
@@ -0,0 +1,174 @@
+#include "actors/targeting_system.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/gtx/norm.hpp>
+
+#include "actors/attributes.hpp"
+#include "actors/structures/structure_manager_system.hpp"
+#include "actors/units/unit_manager_system.hpp"
+#include "core/engine.hpp"
+#include "core/transform.hpp"
+#include "rendering/render_components.hpp"
+
+#ifdef BEE_INSPECTOR
+#include <imgui/imgui.h>
+#endif
+
+namespace
+{
+uint32_t ToIndex(const bee::Entity entity) { return entt::to_integral(entity) & entt::entt_traits<bee::Entity>::entity_mask; }
+
+float ValueOrZero(const AttributesComponent* attributes, const BaseAttributes type)
+{
+    if (attributes == nullptr || !attributes->HasAttribute(type)) return 0.0f;
+    return static_cast<float>(attributes->GetValue(type));
+}
+}  // namespace
+
+TargetScoring TargetScorings::Closest()
+{
+    return [](const TargetCandidate& candidate) { return -candidate.distance2; };
+}
+
+TargetScoring TargetScorings::Threat()
+{
+    return [](const TargetCandidate& candidate)
+    { return candidate.damagePerSecond / (1.0f + std::sqrt(candidate.distance2)); };
+}
+
+TargetScoring TargetScorings::FocusFire()
+{
+    // the attackers make the whole part of the score, the hit points only decide between enemies with as many
+    return [](const TargetCandidate& candidate)
+    { return static_cast<float>(candidate.attackers) + 1.0f / (2.0f + std::max(candidate.hitPoints, 0.0f)); };
+}
+
+TargetingSystem::TargetingSystem(const float period, const float cellSize)
+    : m_period(period), m_cellSize(std::max(cellSize, 0.1f)), m_scoring(TargetScorings::Closest())
+{
+    Title = "Targeting";
+    Reads<AllyUnit, EnemyUnit, AllyStructure, bee::Transform, AttributesComponent, bee::Hidden>();
+    Writes<CombatTarget>();
+}
+
+void TargetingSystem::Update(const float dt)
+{
+    m_time += dt;
+    if (m_time < m_period) return;
+    m_time = std::fmod(m_time, std::max(m_period, std::numeric_limits<float>::min()));
+    Run();
+}
+
+template <typename... Tags>
+void TargetingSystem::AddCandidates(bee::BucketGrid<Candidate>& grid, const bool structure)
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    const auto view = registry.view<bee::Transform, Tags...>(entt::exclude<bee::Hidden>);
+    for (const auto entity : view)
+    {
+        const auto& transform = view.template get<bee::Transform>(entity);
+        const auto* attributes = registry.try_get<AttributesComponent>(entity);
+        const float cooldown = ValueOrZero(attributes, BaseAttributes::AttackCooldown);
+        const float damage = ValueOrZero(attributes, BaseAttributes::Damage);
+
+        Candidate candidate;
+        candidate.entity = entity;
+        candidate.position = transform.Translation;
+        candidate.hitPoints = ValueOrZero(attributes, BaseAttributes::HitPoints);
+        candidate.damagePerSecond = cooldown > 0.0f ? damage / cooldown : damage;
+        candidate.structure = structure;
+        grid.Add(glm::vec2(transform.Translation), candidate);
+    }
+}
+
+template <typename Tag>
+void TargetingSystem::PickTargets(const bee::BucketGrid<Candidate>& grid)
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    const auto view = registry.view<Tag, bee::Transform, AttributesComponent>();
+    for (const auto entity : view)
+    {
+        const auto& transform = view.template get<bee::Transform>(entity);
+        const auto& attributes = view.template get<AttributesComponent>(entity);
+        auto& target = registry.get_or_emplace<CombatTarget>(entity);
+        target = {};
+        if (!attributes.HasAttribute(BaseAttributes::InterceptionRange)) continue;
+
+        const float range = static_cast<float>(attributes.GetValue(BaseAttributes::InterceptionRange));
+        const float range2 = range * range;
+        const glm::vec3 position = transform.Translation;
+        float bestUnit = -std::numeric_limits<float>::infinity();
+        float bestAny = -std::numeric_limits<float>::infinity();
+
+        // the grid is flat, the distance is not, so the cells hold all the candidates and maybe a few more
+        grid.ForEachWithin(glm::vec2(position), range,
+                           [&](const Candidate& candidate)
+                           {
+                               TargetCandidate scored;
+                               scored.distance2 = glm::distance2(candidate.position, position);
+                               if (scored.distance2 > range2) return;
+                               scored.entity = candidate.entity;
+                               scored.hitPoints = candidate.hitPoints;
+                               scored.damagePerSecond = candidate.damagePerSecond;
+                               scored.structure = candidate.structure;
+                               const uint32_t index = ToIndex(candidate.entity);
+                               scored.attackers = index < m_attackers.size() ? m_attackers[index] : 0;
+
+                               const float score = m_scoring(scored);
+                               if (score > bestAny || target.unitOrStructure == entt::null)
+                               {
+                                   bestAny = score;
+                                   target.unitOrStructure = candidate.entity;
+                               }
+                               if (!candidate.structure && (score > bestUnit || target.unit == entt::null))
+                               {
+                                   bestUnit = score;
+                                   target.unit = candidate.entity;
+                               }
+                           });
+        if (target.unitOrStructure != entt::null) m_targetingCount++;
+    }
+}
+
+void TargetingSystem::Run()
+{
+    auto& registry = bee::Engine.ECS().Registry;
+
+    // count the attackers of the last run, for the scorings that care
+    std::fill(m_attackers.begin(), m_attackers.end(), 0);
+    for (const auto& [entity, target] : registry.view<CombatTarget>().each())
+    {
+        if (target.unitOrStructure == entt::null) continue;
+        const uint32_t index = ToIndex(target.unitOrStructure);
+        if (index >= m_attackers.size()) m_attackers.resize(index + 1, 0);
+        m_attackers[index]++;
+    }
+
+    m_enemies.Clear();
+    m_allies.Clear();
+    AddCandidates<EnemyUnit>(m_enemies, false);
+    AddCandidates<AllyUnit>(m_allies, false);
+    AddCandidates<AllyStructure>(m_allies, true);
+    m_enemies.Build(m_cellSize);
+    m_allies.Build(m_cellSize);
+
+    m_targetingCount = 0;
+    PickTargets<AllyUnit>(m_enemies);
+    PickTargets<EnemyUnit>(m_allies);
+}
+
+#ifdef BEE_INSPECTOR
+void TargetingSystem::Inspect()
+{
+    ImGui::Begin("Targeting");
+    ImGui::DragFloat("Period", &m_period, 0.01f, 0.0f, 2.0f);
+    ImGui::DragFloat("Cell size", &m_cellSize, 0.5f, 1.0f, 64.0f);
+    ImGui::Text("Units with a target: %d", m_targetingCount);
+    ImGui::Text("Cells: %d x %d (allies), %d x %d (enemies)", m_allies.GetWidth(), m_allies.GetHeight(),
+                m_enemies.GetWidth(), m_enemies.GetHeight());
+    ImGui::End();
+}
+#endif
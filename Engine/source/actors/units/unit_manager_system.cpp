@@ -21,6 +21,7 @@
 #include "core/engine.hpp"
 #include "core/input.hpp"
 #include "core/resources.hpp"
+#include "core/simulation_lod.hpp"
 #include "core/transform.hpp"
 
 #include "level_editor/terrain_system.hpp"
@@ -55,6 +56,91 @@ inline bool fileExists(const std::string& name)
     return (stat(name.c_str(), &buffer) == 0);
 }
 
+namespace
+{
+
+// Clone functions for the unit components that refer to entities or own state that can not be shared between units.
+
+void CloneStateMachineAgent(entt::registry& registry, bee::Entity entity, const bee::ai::StateMachineAgent& original,
+                            const bee::PrefabEntityMap& map)
+{
+    auto& agent = registry.emplace<bee::ai::StateMachineAgent>(entity, original.fsm);
+    agent.active = original.active;
+    agent.context.entity = map(original.context.entity);
+}
+
+void CloneAnimationAgent(entt::registry& registry, bee::Entity entity, const AnimationAgent& original,
+                         const bee::PrefabEntityMap&)
+{
+    // the skeleton is set once the mesh renderers are there, see UnitManager::LinkSkeleton
+    auto& animator = registry.emplace<AnimationAgent>(entity, original.fsm);
+    animator.context.blackboard->SetData("MoveSpeed", 0.0f);
+}
+
+void CloneMeshRenderer(entt::registry& registry, bee::Entity entity, const bee::MeshRenderer& original,
+                       const bee::PrefabEntityMap&)
+{
+    // every instance animates its own pose, like Model::Instantiate gives it
+    auto& renderer = registry.emplace<bee::MeshRenderer>(entity, original);
+    if (original.Skeleton) renderer.Skeleton = std::make_shared<bee::Skeleton>(*original.Skeleton);
+}
+
+void CloneParticleEmitter(entt::registry& registry, bee::Entity entity, const bee::ParticleEmitter& original,
+                          const bee::PrefabEntityMap&)
+{
+    auto& emitter = registry.emplace<bee::ParticleEmitter>(entity, original);
+    emitter.AssignEntity(entity);
+    if (original.particleProps) emitter.particleProps = std::make_shared<bee::ParticleProps>(*original.particleProps);
+}
+
+void ClonePropTagL(entt::registry& registry, bee::Entity entity, const UnitPropTagL& original, const bee::PrefabEntityMap& map)
+{
+    registry.emplace<UnitPropTagL>(entity, map(original.propLeft), original.jointLeftArm);
+}
+
+void ClonePropTagR(entt::registry& registry, bee::Entity entity, const UnitPropTagR& original, const bee::PrefabEntityMap& map)
+{
+    registry.emplace<UnitPropTagR>(entity, map(original.propRight), original.jointRightArm);
+}
+
+}  // namespace
+
+UnitManager::UnitManager()
+{
+    Title = "Unit Manager";
+    // marks the dead for their AI, and moves the props to the bones they are held by
+    Reads<AttributesComponent, bee::Hierarchy, bee::WorldTransform, bee::MeshRenderer, bee::SimulationLOD, UnitPropTagL,
+          UnitPropTagR>();
+    Writes<bee::ai::StateMachineAgent, bee::Transform>();
+    RegisterPrefabComponents();
+}
+
+void UnitManager::RegisterPrefabComponents()
+{
+    bee::Prefab::RegisterComponent<AttributesComponent>();
+    bee::Prefab::RegisterComponent<bee::ai::StateMachineAgent, &CloneStateMachineAgent>();
+    bee::Prefab::RegisterComponent<AnimationAgent, &CloneAnimationAgent>();
+    bee::Prefab::RegisterComponent<bee::ai::GridAgent>();
+    bee::Prefab::RegisterComponent<bee::SimulationLOD>();
+    bee::Prefab::RegisterComponent<bee::physics::Body>();
+    bee::Prefab::RegisterComponent<bee::physics::DiskCollider>();
+    bee::Prefab::RegisterComponent<bee::physics::Interactable>();
+    bee::Prefab::RegisterComponent<bee::MeshRenderer, &CloneMeshRenderer>();
+    bee::Prefab::RegisterComponent<bee::ParticleEmitter, &CloneParticleEmitter>();
+    bee::Prefab::RegisterComponent<UnitModelTag>();
+    bee::Prefab::RegisterComponent<UnitPropTagL, &ClonePropTagL>();
+    bee::Prefab::RegisterComponent<UnitPropTagR, &ClonePropTagR>();
+    bee::Prefab::RegisterComponent<AllyUnit>();
+    bee::Prefab::RegisterComponent<EnemyUnit>();
+    bee::Prefab::RegisterComponent<NeutralUnit>();
+}
+
+void UnitManager::ForgetPrefabs(const std::string& unitHandle)
+{
+    for (auto it = m_prefabs.begin(); it != m_prefabs.end();)
+        it = it->first.first == unitHandle ? m_prefabs.erase(it) : std::next(it);
+}
+
 void UnitManager::AddNewUnitTemplate(UnitTemplate unitTemplate)
 {
     if (m_Units.find(unitTemplate.name) != m_Units.end())
@@ -62,6 +148,13 @@ void UnitManager::AddNewUnitTemplate(UnitTemplate unitTemplate)
         bee::Log::Warn("Unit Name " + unitTemplate.name + " is already used. Try another name.");
         return;
     }
+    // models can not be loaded without a device, a headless engine only simulates
+    if (bee::Engine.IsHeadless())
+    {
+        m_Units.insert(std::pair<std::string, UnitTemplate>(unitTemplate.name, unitTemplate));
+        return;
+    }
+
     unitTemplate.model = bee::Engine.Resources().Load<bee::Model>(unitTemplate.modelPath);
     unitTemplate.corpseModel = bee::Engine.Resources().Load<bee::Model>(unitTemplate.corpsePath);
 
@@ -96,6 +189,7 @@ void UnitManager::RemoveUnitTemplate(const std::string& unitHandle)
         bee::Log::Warn("There is no unit type with the name " + unitHandle + ". Try another name.");
         return;
     }
+    ForgetPrefabs(unitHandle);
     m_Units.erase(unitHandle);
 }
 
@@ -161,6 +255,7 @@ void UnitManager::SaveUnitTemplates(const std::string& fileName)
 void UnitManager::LoadUnitTemplates(const std::string& fileName)
 {
     m_Units.clear();
+    m_prefabs.clear();
     if (fileExists(bee::Engine.FileIO().GetPath(bee::FileIO::Directory::Terrain, fileName + "_UnitTemplates.json")))
     {
         std::ifstream is(bee::Engine.FileIO().GetPath(bee::FileIO::Directory::Terrain, fileName + "_UnitTemplates.json"));
@@ -177,6 +272,8 @@ void UnitManager::LoadUnitTemplates(const std::string& fileName)
 
 void UnitManager::ReloadUnitsFromTemplate(const std::string& unitHandle)
 {
+    ForgetPrefabs(unitHandle);
+
     // delete all Model entities which are children to the unit entities of the type in the function's argument.
     auto model_view = bee::Engine.ECS().Registry.view<bee::Transform, UnitModelTag>();
     for (auto model_entity : model_view)
@@ -229,7 +326,7 @@ void UnitManager::ReloadUnitsFromTemplate(const std::string& unitHandle)
             if (!unitTemplate.animationControllerPath.empty())
             {
                 const auto& animator = bee::Engine.ECS().CreateComponent<AnimationAgent>(entity, animationController);
-                const auto ids = animator.fsm->GetStateIDsOfType<AnimationState>();
+                const auto& ids = animator.fsm->GetStateIDsOfType<AnimationState>();
 
                 for (const auto id : ids)
                 {
@@ -252,12 +349,12 @@ void UnitManager::ReloadUnitsFromTemplate(const std::string& unitHandle)
             // agent.SetStateOfType<IdleState>();
 
             // update model
-            transform.NoChildren();
+            bee::Engine.ECS().Registry.get<bee::Hierarchy>(entity).NoChildren();
             transform.Scale = glm::vec3(m_Units.at(unitAttribute.GetEntityType()).GetAttribute(BaseAttributes::Scale));
             auto modelEntity = bee::Engine.ECS().CreateEntity();
             auto& modelTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(modelEntity);
             modelTransform.Name = "Model";
-            modelTransform.SetParent(entity);
+            bee::Engine.ECS().Registry.get<bee::Hierarchy>(modelEntity).SetParent(entity);
             modelTransform.Translation += unitTemplate.modelOffset.Translation;
             auto modelEuler = glm::eulerAngles(modelTransform.Rotation);
             auto modelOffsetEuler = glm::eulerAngles(unitTemplate.modelOffset.Rotation);
@@ -294,31 +391,53 @@ std::optional<bee::Entity> UnitManager::SpawnUnit(const std::string& unitTemplat
         bee::Log::Warn("There is no unit type with the name " + unitTemplateHandle + ". Try another name.");
         return {};
     }
-    auto& unitTemplate = m_Units.find(unitTemplateHandle)->second;
-    auto unitEntity = bee::Engine.ECS().CreateEntity();
-
-    auto& transform = bee::Engine.ECS().CreateComponent<bee::Transform>(unitEntity);
-        transform.Translation = position;
-        transform.Name = unitTemplateHandle;
-
-    auto& terrain_system = bee::Engine.ECS().GetSystem<lvle::TerrainSystem>();
 
-    glm::vec3 cameraPosition;
-    const auto screen = bee::Engine.ECS().Registry.view<bee::Transform, bee::Camera>();
-    for (auto& entity : screen)
+    const auto prefab = m_prefabs.find({unitTemplateHandle, team});
+    if (prefab == m_prefabs.end())
     {
-        auto [transform, camera] = screen.get(entity);
-        cameraPosition = transform.Translation;
+        const auto unitEntity = BuildUnit(unitTemplateHandle, position, team);
+
+        // props follow a bone of the model, they are not part of its hierarchy
+        std::vector<bee::Entity> props;
+        for (const auto child : bee::Engine.ECS().Registry.get<bee::Hierarchy>(unitEntity))
+        {
+            if (const auto* prop = bee::Engine.ECS().Registry.try_get<UnitPropTagL>(child)) props.push_back(prop->propLeft);
+            if (const auto* prop = bee::Engine.ECS().Registry.try_get<UnitPropTagR>(child)) props.push_back(prop->propRight);
+        }
+        m_prefabs.try_emplace({unitTemplateHandle, team}, unitEntity, props);
+        return unitEntity;
     }
 
-    glm::vec3 point;
-    const bool result = terrain_system.FindRayMeshIntersection(cameraPosition, position - cameraPosition, point);
+    // only what differs between units of the same template is redone, the props catch up in UpdateProps
+    std::vector<bee::Entity> entities;
+    const auto unitEntity = prefab->second.Instantiate(&entities);
 
-    if (result)
+    auto& transform = bee::Engine.ECS().Registry.get<bee::Transform>(unitEntity);
+    transform.Translation = position;
+    PlaceOnTerrain(transform.Translation);
+    bee::Engine.ECS().Registry.get<bee::ai::GridAgent>(unitEntity).verticalPosition = transform.Translation.z;
+    bee::Engine.ECS().Registry.get<bee::physics::Body>(unitEntity).SetPosition(transform.Translation);
+
+    if (!m_Units.at(unitTemplateHandle).animationControllerPath.empty())
     {
-        transform.Translation.z = point.z;
+        for (const auto entity : entities)
+            if (const auto* renderer = bee::Engine.ECS().Registry.try_get<bee::MeshRenderer>(entity)) LinkSkeleton(entity, *renderer);
     }
 
+    CountSpawnedUnit(unitTemplateHandle, team);
+    return unitEntity;
+}
+
+bee::Entity UnitManager::BuildUnit(const std::string& unitTemplateHandle, const glm::vec3& position, Team team)
+{
+    auto& unitTemplate = m_Units.find(unitTemplateHandle)->second;
+    auto unitEntity = bee::Engine.ECS().CreateEntity();
+
+    auto& transform = bee::Engine.ECS().CreateComponent<bee::Transform>(unitEntity);
+        transform.Translation = position;
+        transform.Name = unitTemplateHandle;
+    PlaceOnTerrain(transform.Translation);
+
     transform.Scale = glm::vec3(GetUnitTemplate(unitTemplateHandle).GetAttribute(BaseAttributes::Scale));
 
     auto& baseAttributes = bee::Engine.ECS().CreateComponent<AttributesComponent>(unitEntity);
@@ -328,11 +447,13 @@ std::optional<bee::Entity> UnitManager::SpawnUnit(const std::string& unitTemplat
     const std::shared_ptr<bee::ai::FiniteStateMachine> fsm =
         bee::Engine.Resources().Load<bee::ai::FiniteStateMachine>(unitTemplate.fsmPath);
 
-    if (!unitTemplate.animationControllerPath.empty())
+    // headless units (see SpawnUnit) have no model to animate
+    const bool headless = bee::Engine.IsHeadless();
+    if (!headless && !unitTemplate.animationControllerPath.empty())
     {
         const std::shared_ptr<bee::ai::FiniteStateMachine> animationController =bee::Engine.Resources().Load<bee::ai::FiniteStateMachine>(unitTemplate.animationControllerPath);
         const auto& animator = bee::Engine.ECS().CreateComponent<AnimationAgent>(unitEntity, animationController);
-        const auto ids = animator.fsm->GetStateIDsOfType<AnimationState>();
+        const auto& ids = animator.fsm->GetStateIDsOfType<AnimationState>();
 
         for (const auto id : ids)
         {
@@ -350,6 +471,7 @@ std::optional<bee::Entity> UnitManager::SpawnUnit(const std::string& unitTemplat
         unitEntity, 0.5f, baseAttributes.GetValue(BaseAttributes::MovementSpeed),
         baseAttributes.GetValue(BaseAttributes::Height));
     gridAgent.verticalPosition = transform.Translation.z;
+    bee::Engine.ECS().CreateComponent<bee::SimulationLOD>(unitEntity);
     auto& body =
         bee::Engine.ECS().CreateComponent<bee::physics::Body>(unitEntity, bee::physics::Body::Type::Dynamic, 1.0f, 0.0f);
     auto& disk = bee::Engine.ECS().CreateComponent<bee::physics::DiskCollider>(
@@ -358,12 +480,27 @@ std::optional<bee::Entity> UnitManager::SpawnUnit(const std::string& unitTemplat
     body.SetPosition(transform.Translation);
     baseAttributes.SetTeam(static_cast<int>(team));
 
-    // interactable
+    if (team == Team::Ally)
+    {
+        bee::Engine.ECS().CreateComponent<AllyUnit>(unitEntity);
+        auto interactable = bee::Engine.ECS().CreateComponent<bee::physics::Interactable>(unitEntity);
+    }
+    else if (team == Team::Enemy)
+    {
+        bee::Engine.ECS().CreateComponent<EnemyUnit>(unitEntity);
+    }
+    else if (team == Team::Neutral)
+    {
+        bee::Engine.ECS().CreateComponent<NeutralUnit>(unitEntity);
+    }
+
+    CountSpawnedUnit(unitTemplateHandle, team);
+    if (headless) return unitEntity;
 
     auto modelEntity = bee::Engine.ECS().CreateEntity();
     auto& modelTransform = bee::Engine.ECS().CreateComponent<bee::Transform>(modelEntity);
         modelTransform.Name = unitTemplateHandle;
-        modelTransform.SetParent(unitEntity);
+        bee::Engine.ECS().Registry.get<bee::Hierarchy>(modelEntity).SetParent(unitEntity);
         modelTransform.Translation += unitTemplate.modelOffset.Translation;
     auto modelEuler = glm::eulerAngles(modelTransform.Rotation);
     auto modelOffsetEuler = glm::eulerAngles(unitTemplate.modelOffset.Rotation);
@@ -378,36 +515,6 @@ std::optional<bee::Entity> UnitManager::SpawnUnit(const std::string& unitTemplat
     int index = 0;
     bee::UpdateMeshRenderer(modelEntity, unitTemplate.materials, index);
 
-    if (team == Team::Ally)
-    {
-        bee::Engine.ECS().CreateComponent<AllyUnit>(unitEntity);
-        auto interactable = bee::Engine.ECS().CreateComponent<bee::physics::Interactable>(unitEntity);
-    }
-    else if (team == Team::Enemy)
-    {
-        bee::Engine.ECS().CreateComponent<EnemyUnit>(unitEntity);
-    }
-    else if (team == Team::Neutral)
-    {
-        bee::Engine.ECS().CreateComponent<NeutralUnit>(unitEntity);
-    }
-
-    if (team == Team::Ally)
-    {
-        for (auto [entity, debugMetric] : bee::Engine.ECS().Registry.view<bee::DebugMetricData>().each())
-            if (debugMetric.allyUnitsSpawned.find(unitTemplateHandle) == debugMetric.allyUnitsSpawned.end())
-                debugMetric.allyUnitsSpawned.insert(std::pair<std::string, int>(unitTemplateHandle, 1));
-        else
-                debugMetric.allyUnitsSpawned[unitTemplateHandle]++;
-    }
-    else if (team == Team::Enemy)
-    {
-        for (auto [entity, debugMetric] : bee::Engine.ECS().Registry.view<bee::DebugMetricData>().each())
-            if (debugMetric.enemyUnitsSpawned.find(unitTemplateHandle) == debugMetric.enemyUnitsSpawned.end())
-                debugMetric.enemyUnitsSpawned.insert(std::pair<std::string, int>(unitTemplateHandle, 1));
-        else
-                debugMetric.enemyUnitsSpawned[unitTemplateHandle]++;
-    }
     AttachProp(modelEntity, modelTransform);
 
     if (baseAttributes.GetValue(BaseAttributes::WoodBounty) > 0)
@@ -428,36 +535,69 @@ void UnitManager::InitAnimators(const std::string& unitTemplateHandle)
 
     if (!unitTemplate.animationControllerPath.empty())
     {
-        for (const auto entity : view)
-        {
-            auto t = bee::Engine.ECS().Registry.try_get<bee::Transform>(entity);
-            auto& renderer = view.get<bee::MeshRenderer>(entity);
+        for (const auto entity : view) LinkSkeleton(entity, view.get<bee::MeshRenderer>(entity));
+    }
+}
 
-            bee::Entity current = entity;
-            while (t->HasParent())
-            {
-                if (!bee::Engine.ECS().Registry.try_get<bee::Transform>(current)) break;
-                t = bee::Engine.ECS().Registry.try_get<bee::Transform>(current);
-                const AnimationAgent* agent = bee::Engine.ECS().Registry.try_get<AnimationAgent>(current);
+void UnitManager::LinkSkeleton(bee::Entity entity, const bee::MeshRenderer& renderer)
+{
+    auto t = bee::Engine.ECS().Registry.try_get<bee::Hierarchy>(entity);
 
-                // This happens in UpdateMeshRenderers (int tools.hpp) anyway.
-                /*if (bee::Engine.ECS().Registry.try_get<AttributesComponent>(current))
-                {
-                    if (!unitTemplate.materialPath.empty() &&
-                        bee::Engine.ECS().Registry.try_get<AttributesComponent>(current)->GetEntityType() == unitTemplateHandle)
-                    {
-                        renderer.Material = unitTemplate.material;
-                    }
-                }*/
-
-                if (agent)
-                {
-                    agent->context.blackboard->SetData<std::shared_ptr<bee::Skeleton>>("Skeleton", renderer.Skeleton);
-                    break;
-                }
-                current = t->GetParent();
-            }
+    bee::Entity current = entity;
+    while (t->HasParent())
+    {
+        if (!bee::Engine.ECS().Registry.try_get<bee::Hierarchy>(current)) break;
+        t = bee::Engine.ECS().Registry.try_get<bee::Hierarchy>(current);
+        const AnimationAgent* agent = bee::Engine.ECS().Registry.try_get<AnimationAgent>(current);
+
+        // The material of the renderer is set in UpdateMeshRenderers (in tools.hpp).
+        if (agent)
+        {
+            agent->context.blackboard->SetData<std::shared_ptr<bee::Skeleton>>("Skeleton", renderer.Skeleton);
+            break;
         }
+        current = t->GetParent();
+    }
+}
+
+void UnitManager::PlaceOnTerrain(glm::vec3& position) const
+{
+    auto& terrain_system = bee::Engine.ECS().GetSystem<lvle::TerrainSystem>();
+
+    glm::vec3 cameraPosition;
+    const auto screen = bee::Engine.ECS().Registry.view<bee::Transform, bee::Camera>();
+    for (auto& entity : screen)
+    {
+        auto [transform, camera] = screen.get(entity);
+        cameraPosition = transform.Translation;
+    }
+
+    glm::vec3 point;
+    const bool result = terrain_system.FindRayMeshIntersection(cameraPosition, position - cameraPosition, point);
+
+    if (result)
+    {
+        position.z = point.z;
+    }
+}
+
+void UnitManager::CountSpawnedUnit(const std::string& unitTemplateHandle, Team team)
+{
+    if (team == Team::Ally)
+    {
+        for (auto [entity, debugMetric] : bee::Engine.ECS().Registry.view<bee::DebugMetricData>().each())
+            if (debugMetric.allyUnitsSpawned.find(unitTemplateHandle) == debugMetric.allyUnitsSpawned.end())
+                debugMetric.allyUnitsSpawned.insert(std::pair<std::string, int>(unitTemplateHandle, 1));
+        else
+                debugMetric.allyUnitsSpawned[unitTemplateHandle]++;
+    }
+    else if (team == Team::Enemy)
+    {
+        for (auto [entity, debugMetric] : bee::Engine.ECS().Registry.view<bee::DebugMetricData>().each())
+            if (debugMetric.enemyUnitsSpawned.find(unitTemplateHandle) == debugMetric.enemyUnitsSpawned.end())
+                debugMetric.enemyUnitsSpawned.insert(std::pair<std::string, int>(unitTemplateHandle, 1));
+        else
+                debugMetric.enemyUnitsSpawned[unitTemplateHandle]++;
     }
 }
 
@@ -582,22 +722,22 @@ void UnitManager::AttachProp(bee::Entity parentEntity, const bee::Transform& par
 
     if (parentTransform.Name == nameMage)
     {
-        ConfigureMage(parentEntity, parentTransform);
+        ConfigureMage(parentEntity);
     }
     else if (parentTransform.Name == nameWarrior)
     {
-        ConfigureWarrior(parentEntity, parentTransform);
+        ConfigureWarrior(parentEntity);
     }
 }
 
-void UnitManager::ConfigureMage(bee::Entity parentEntity, const bee::Transform& parentTransform)
+void UnitManager::ConfigureMage(bee::Entity parentEntity)
 {
     // Need to get the skeleton from the mesh renderer component not the skeleton directly
     // Also the mesh renderer component is always a child to whatever entity you instantiated �\_(-_-#)_/�
-    auto& tempTransform = bee::Engine.ECS().Registry.get<bee::Transform>(parentEntity);
+    auto& hierarchy = bee::Engine.ECS().Registry.get<bee::Hierarchy>(parentEntity);
     bee::MeshRenderer* skeletonMeshRenderer = nullptr;
 
-    for (auto child = tempTransform.begin(); child != tempTransform.end(); ++child)
+    for (auto child = hierarchy.begin(); child != hierarchy.end(); ++child)
     {
         if (bee::Engine.ECS().Registry.all_of<bee::MeshRenderer>(*child))
         {
@@ -614,7 +754,7 @@ void UnitManager::ConfigureMage(bee::Entity parentEntity, const bee::Transform&
 
     const int index = skeletonMeshRenderer->Skeleton->GiveNameGetIndex("j_wingRoll_B_L");          // Getting the joint index for mages
     const glm::mat4 boneTransform = skeletonMeshRenderer->Skeleton->GiveIndexGetMatrixGLM(index);  // Getting bone glm matrix based on bone index
-    const glm::mat4 worldTransform = parentTransform.World();          // Getting mage transform
+    const glm::mat4 worldTransform = bee::Engine.ECS().Registry.get<bee::WorldTransform>(parentEntity).WorldMatrix;  // Getting mage transform
     const glm::mat4 finalTransform = worldTransform * boneTransform;   // multiplying the matrices
 
     // Preparing the model and material
@@ -635,14 +775,14 @@ void UnitManager::ConfigureMage(bee::Entity parentEntity, const bee::Transform&
         propTag.jointRightArm = index;
 }
 
-void UnitManager::ConfigureWarrior(bee::Entity parentEntity, const bee::Transform& parentTransform)
+void UnitManager::ConfigureWarrior(bee::Entity parentEntity)
 {
     // Need to get the skeleton from the mesh renderer component not the skeleton directly
     // Also the mesh renderer component is always a child to whatever entity you instantiated �\_(-_-#)_/�
-    auto& tempTransform = bee::Engine.ECS().Registry.get<bee::Transform>(parentEntity);
+    auto& hierarchy = bee::Engine.ECS().Registry.get<bee::Hierarchy>(parentEntity);
     bee::MeshRenderer* skeletonMeshRenderer = nullptr;
 
-    for (auto child = tempTransform.begin(); child != tempTransform.end(); ++child)
+    for (auto child = hierarchy.begin(); child != hierarchy.end(); ++child)
     {
         if (bee::Engine.ECS().Registry.all_of<bee::MeshRenderer>(*child))
         {
@@ -659,7 +799,7 @@ void UnitManager::ConfigureWarrior(bee::Entity parentEntity, const bee::Transfor
 
     const int indexL = skeletonMeshRenderer->Skeleton->GiveNameGetIndex("j_wingRoll_B_L");           // Getting the joint index for mages
     const glm::mat4 boneTransformL = skeletonMeshRenderer->Skeleton->GiveIndexGetMatrixGLM(indexL);  // Getting bone glm matrix based on bone index
-    const glm::mat4 worldTransform = parentTransform.World();           // Getting mage transform
+    const glm::mat4 worldTransform = bee::Engine.ECS().Registry.get<bee::WorldTransform>(parentEntity).WorldMatrix;  // Getting mage transform
     const glm::mat4 finalTransformL = worldTransform * boneTransformL;  // multiplying the matrices
 
     // Loading the new material
@@ -703,11 +843,15 @@ void UnitManager::ConfigureWarrior(bee::Entity parentEntity, const bee::Transfor
 void UnitManager::UpdateProps()
 { 
     // Only get the units that have props
-    const auto viewRight = bee::Engine.ECS().Registry.view<bee::Transform, UnitPropTagR>();
-    for (const auto [parentEntity, parentTransform, parentProp] : viewRight.each())
+    const auto viewRight = bee::Engine.ECS().Registry.view<bee::Hierarchy, bee::WorldTransform, UnitPropTagR>();
+    for (const auto [parentEntity, parentHierarchy, parentWorld, parentProp] : viewRight.each())
     {
+        // props only follow the animation, they can wait as long as it does
+        const auto* lod = bee::FindSimulationLOD(bee::Engine.ECS().Registry, parentEntity);
+        if (lod != nullptr && !lod->cosmeticUpdate) continue;
+
         bee::MeshRenderer* skeletonMeshRenderer = nullptr;
-        for (auto child = parentTransform.begin(); child != parentTransform.end(); ++child)
+        for (auto child = parentHierarchy.begin(); child != parentHierarchy.end(); ++child)
         {
             if (bee::Engine.ECS().Registry.all_of<bee::MeshRenderer>(*child))
             {
@@ -719,7 +863,7 @@ void UnitManager::UpdateProps()
 
         // Calculating the new transform of the proper
         const glm::mat4 boneTransform = skeletonMeshRenderer->Skeleton->GiveIndexGetMatrixGLM(parentProp.jointRightArm);
-        const glm::mat4 worldTransform = parentTransform.WorldMatrix;
+        const glm::mat4 worldTransform = parentWorld.WorldMatrix;
         const glm::mat4 finalTransform = worldTransform * boneTransform;
 
         glm::vec3 position = glm::vec3(0.0f), scale = glm::vec3(0.0f);
@@ -733,11 +877,15 @@ void UnitManager::UpdateProps()
     }
 
     // Only get the units that have props
-    const auto viewLeft = bee::Engine.ECS().Registry.view<bee::Transform, UnitPropTagL>();
-    for (const auto [parentEntity, parentTransform, parentProp] : viewLeft.each())
+    const auto viewLeft = bee::Engine.ECS().Registry.view<bee::Hierarchy, bee::WorldTransform, UnitPropTagL>();
+    for (const auto [parentEntity, parentHierarchy, parentWorld, parentProp] : viewLeft.each())
     {
+        // props only follow the animation, they can wait as long as it does
+        const auto* lod = bee::FindSimulationLOD(bee::Engine.ECS().Registry, parentEntity);
+        if (lod != nullptr && !lod->cosmeticUpdate) continue;
+
         bee::MeshRenderer* skeletonMeshRenderer = nullptr;
-        for (auto child = parentTransform.begin(); child != parentTransform.end(); ++child)
+        for (auto child = parentHierarchy.begin(); child != parentHierarchy.end(); ++child)
         {
             if (bee::Engine.ECS().Registry.all_of<bee::MeshRenderer>(*child))
             {
@@ -749,7 +897,7 @@ void UnitManager::UpdateProps()
 
         // Calculating the new transform of the proper
         const glm::mat4 boneTransform = skeletonMeshRenderer->Skeleton->GiveIndexGetMatrixGLM(parentProp.jointLeftArm);
-        const glm::mat4 worldTransform = parentTransform.WorldMatrix;
+        const glm::mat4 worldTransform = parentWorld.WorldMatrix;
         const glm::mat4 finalTransform = worldTransform * boneTransform;
 
         glm::vec3 position = glm::vec3(0.0f), scale = glm::vec3(0.0f);
@@ -771,7 +919,7 @@ void UnitManager::InstantiateProp(bee::Entity parentEntity, const bee::Model& mo
     // Getting the transform from the node
     auto& transform = bee::Engine.ECS().CreateComponent<bee::Transform>(entity);
     transform.Name = node.name;
-    transform.SetParent(parentEntity);
+    bee::Engine.ECS().Registry.get<bee::Hierarchy>(entity).SetParent(parentEntity);
 
     if (!node.matrix.empty())
     {
@@ -0,0 +1,213 @@
+#include "actors/visibility_system.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "actors/attributes.hpp"
+#include "actors/structures/structure_manager_system.hpp"
+#include "actors/units/unit_manager_system.hpp"
+#include "core/engine.hpp"
+#include "core/transform.hpp"
+#include "level_editor/level_editor_components.hpp"
+#include "rendering/render_components.hpp"
+
+#ifdef BEE_INSPECTOR
+#include <imgui/imgui.h>
+#endif
+
+namespace
+{
+float ValueOrZero(const AttributesComponent* attributes, const BaseAttributes type)
+{
+    if (attributes == nullptr || !attributes->HasAttribute(type)) return 0.0f;
+    return static_cast<float>(attributes->GetValue(type));
+}
+
+// the meshes of an actor are on its children, so they are hidden along with it, also when they were attached later
+void SetHidden(entt::registry& registry, const bee::Entity entity, const bool hidden)
+{
+    if (hidden != registry.all_of<bee::Hidden>(entity))
+    {
+        if (hidden)
+            registry.emplace<bee::Hidden>(entity);
+        else
+            registry.remove<bee::Hidden>(entity);
+    }
+
+    auto* hierarchy = registry.try_get<bee::Hierarchy>(entity);
+    if (hierarchy == nullptr) return;
+    for (const auto child : *hierarchy) SetHidden(registry, child, hidden);
+}
+}  // namespace
+
+VisibilitySystem::VisibilitySystem(const float period, const float sightRange, const bool lineOfSight)
+    : m_period(period), m_sightRange(std::max(sightRange, 0.0f)), m_lineOfSight(lineOfSight)
+{
+    Title = "Visibility";
+    Reads<AllyUnit, EnemyUnit, AllyStructure, EnemyStructure, bee::Transform, bee::Hierarchy, AttributesComponent,
+          lvle::TerrainDataComponent>();
+    Writes<VisibilitySource, bee::Hidden>();
+    bee::Engine.ECS().Registry.on_destroy<VisibilitySource>().connect<&VisibilitySystem::OnSourceDestroyed>(*this);
+}
+
+VisibilitySystem::~VisibilitySystem()
+{
+    bee::Engine.ECS().Registry.on_destroy<VisibilitySource>().disconnect<&VisibilitySystem::OnSourceDestroyed>(*this);
+}
+
+void VisibilitySystem::Update(const float dt)
+{
+    m_time += dt;
+    if (m_time < m_period) return;
+    m_time = std::fmod(m_time, std::max(m_period, std::numeric_limits<float>::min()));
+    Sync();
+}
+
+void VisibilitySystem::UpdateFromTerrain()
+{
+    const auto view = bee::Engine.ECS().Registry.view<lvle::TerrainDataComponent>();
+    for (const auto entity : view)
+    {
+        // the terrain is centered on the origin, a cell for every tile
+        const auto& data = view.get<lvle::TerrainDataComponent>(entity);
+        const glm::vec2 size(static_cast<float>(data.m_width) * data.m_step, static_cast<float>(data.m_height) * data.m_step);
+        std::vector<float> heights;
+        if (m_lineOfSight && data.m_tiles.size() == static_cast<size_t>(data.m_width * data.m_height))
+        {
+            heights.reserve(data.m_tiles.size());
+            for (const auto& tile : data.m_tiles) heights.push_back(tile.centralPos.z);
+        }
+        SetBounds(-size * 0.5f, data.m_step, data.m_width, data.m_height, std::move(heights));
+    }
+}
+
+void VisibilitySystem::SetBounds(const glm::vec2& origin, const float cellSize, const int width, const int height,
+                                 std::vector<float> heights)
+{
+    // the sources come off empty grids, which costs nothing
+    auto& registry = bee::Engine.ECS().Registry;
+    for (auto& grid : m_grids) grid.Resize(origin, cellSize, 0, 0);
+    m_gone.clear();
+    for (const auto entity : registry.view<VisibilitySource>()) m_gone.push_back(entity);
+    for (const auto entity : m_gone) registry.remove<VisibilitySource>(entity);
+
+    for (auto& grid : m_grids)
+    {
+        grid.Resize(origin, cellSize, width, height);
+        if (m_lineOfSight) grid.SetHeights(heights);
+    }
+}
+
+void VisibilitySystem::Sync()
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    m_tick++;
+    m_restamps = 0;
+
+    SyncObservers<AllyUnit>(Team::Ally);
+    SyncObservers<AllyStructure>(Team::Ally);
+    SyncObservers<EnemyUnit>(Team::Enemy);
+    SyncObservers<EnemyStructure>(Team::Enemy);
+
+    // what was not seen this sync is no actor any more
+    m_gone.clear();
+    for (const auto& [entity, source] : registry.view<VisibilitySource>().each())
+        if (source.tick != m_tick) m_gone.push_back(entity);
+    for (const auto entity : m_gone) registry.remove<VisibilitySource>(entity);
+
+    m_hidden = 0;
+    SyncHidden<EnemyUnit>(false);
+    SyncHidden<EnemyStructure>(true);
+}
+
+template <typename Tag>
+void VisibilitySystem::SyncObservers(const Team team)
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    const auto& grid = GetGrid(team);
+    const auto view = registry.view<Tag, bee::Transform>();
+    for (const auto entity : view)
+    {
+        const auto* attributes = registry.try_get<AttributesComponent>(entity);
+
+        VisibilitySource next;
+        next.cell = grid.GetCell(glm::vec2(view.template get<bee::Transform>(entity).Translation));
+        next.radius = ToCells(std::max(m_sightRange, ValueOrZero(attributes, BaseAttributes::InterceptionRange)));
+        next.team = team;
+        Apply(entity, next);
+    }
+}
+
+template <typename Tag>
+void VisibilitySystem::SyncHidden(const bool structure)
+{
+    // units are hidden while the player does not see them, structures stay in sight once they were explored
+    auto& registry = bee::Engine.ECS().Registry;
+    const auto& grid = GetGrid(Team::Ally);
+    const auto view = registry.view<Tag, bee::Transform>();
+    for (const auto entity : view)
+    {
+        const glm::vec2 position(view.template get<bee::Transform>(entity).Translation);
+        const bool hidden = m_hideEnemies && !(structure ? grid.IsExplored(position) : grid.IsVisible(position));
+        if (hidden) m_hidden++;
+        SetHidden(registry, entity, hidden);
+    }
+}
+
+void VisibilitySystem::Apply(const bee::Entity entity, VisibilitySource next)
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    next.tick = m_tick;
+    auto* source = registry.try_get<VisibilitySource>(entity);
+    if (source == nullptr)
+    {
+        Put(next, 1);
+        registry.emplace<VisibilitySource>(entity, next);
+        m_restamps++;
+        return;
+    }
+
+    if (source->cell != next.cell || source->radius != next.radius || source->team != next.team)
+    {
+        Put(*source, -1);
+        Put(next, 1);
+        m_restamps++;
+    }
+    *source = next;
+}
+
+void VisibilitySystem::Put(const VisibilitySource& source, const int count)
+{
+    if (source.team == Team::Neutral) return;
+    m_grids[GridIndex(source.team)].See(source.cell, source.radius, count);
+}
+
+int VisibilitySystem::ToCells(const float range) const
+{
+    const float cells = std::ceil(range / m_grids[0].GetCellSize());
+    return std::clamp(static_cast<int>(cells), 0, bee::VisibilityGrid::MaxRadius);
+}
+
+void VisibilitySystem::OnSourceDestroyed(entt::registry& registry, const bee::Entity entity)
+{
+    Put(registry.get<VisibilitySource>(entity), -1);
+}
+
+#ifdef BEE_INSPECTOR
+void VisibilitySystem::Inspect()
+{
+    ImGui::Begin("Visibility");
+    ImGui::DragFloat("Period", &m_period, 0.01f, 0.0f, 2.0f);
+    ImGui::Checkbox("Hide enemies", &m_hideEnemies);
+    const auto& grid = GetGrid(Team::Ally);
+    ImGui::Text("Cells: %d x %d of %.2f%s", grid.GetWidth(), grid.GetHeight(), grid.GetCellSize(),
+                grid.HasLineOfSight() ? ", with line of sight" : "");
+    ImGui::Text("Visible cells: %d (player), %d (enemy)", grid.GetVisibleCellCount(),
+                GetGrid(Team::Enemy).GetVisibleCellCount());
+    ImGui::Text("Restamped on the last sync: %d", m_restamps);
+    ImGui::Text("Hidden enemies: %d", m_hidden);
+    ImGui::End();
+}
+#endif
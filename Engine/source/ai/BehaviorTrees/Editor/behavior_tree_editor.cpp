@@ -64,7 +64,7 @@ void bee::ai::BehaviorWrapper::DrawNodeContent()
     ax::NodeEditor::EndNode();
 }
 
-void bee::ai::BehaviorWrapper::DrawNode(size_t transitionIndex, const BehaviorTreeContext& context)
+void bee::ai::BehaviorWrapper::DrawNode(size_t transitionIndex, const BehaviorTree& bt, const BehaviorTreeContext& context)
 {
     ax::NodeEditor::BeginNode(id);
 
@@ -79,7 +79,7 @@ void bee::ai::BehaviorWrapper::DrawNode(size_t transitionIndex, const BehaviorTr
     int childIndex = 0;
     for (auto& child : children)
     {
-        child.DrawNode(childIndex + transitionIndex + children.size(),context);
+        child.DrawNode(childIndex + transitionIndex + children.size(), bt, context);
         childIndex++;
     }
 
@@ -88,12 +88,10 @@ void bee::ai::BehaviorWrapper::DrawNode(size_t transitionIndex, const BehaviorTr
     {
         ax::NodeEditor::Link(transitionIndex + index * 100 + id + child.id, maxAmountNodes + id * 2,maxAmountNodes + child.id * 2 - 1);
 
-        if (context.statuses.find(child.id-2) != context.statuses.end())
+        // compiled trees keep their statuses by node, the tree looks them up by id
+        if (bt.GetStatus(context, child.id - 2) == Status::RUNNING)
         {
-            if ( context.statuses.at(child.id - 2) == Status::RUNNING)
-            {
-                ax::NodeEditor::Flow(transitionIndex + index * 100 + id + child.id);
-            }
+            ax::NodeEditor::Flow(transitionIndex + index * 100 + id + child.id);
         }
 
         index++;
@@ -414,7 +412,7 @@ void bee::ai::BehaviorTreeEditor::PreviewContext(const BehaviorTree& bt,const Be
     ax::NodeEditor::SetCurrentEditor(m_previewContext);
     ax::NodeEditor::Begin("BT context", ImVec2(0.0, 0.0f));
 
-    DrawNodesPreview(context);
+    DrawNodesPreview(bt, context);
 
     ax::NodeEditor::NavigateToContent(0);
     ax::NodeEditor::End();
@@ -441,9 +439,9 @@ void bee::ai::BehaviorTreeEditor::DrawNodes()
     editorRoot.DrawNode(0);
 }
 
-void bee::ai::BehaviorTreeEditor::DrawNodesPreview(const BehaviorTreeContext& context)
+void bee::ai::BehaviorTreeEditor::DrawNodesPreview(const BehaviorTree& bt, const BehaviorTreeContext& context)
 {
-    previewRoot.DrawNode(0,context);
+    previewRoot.DrawNode(0, bt, context);
 }
 
 void bee::ai::BehaviorTreeEditor::DrawUpperMenu()
@@ -1,9 +1,266 @@
 #include "ai/BehaviorTrees/behavior_tree.hpp"
+
+#include <algorithm>
+
 #include "ai/BehaviorTrees/behavior_tree_builder.hpp"
 
+namespace
+{
+template <typename T>
+const bee::ai::Comparison<T>* AsComparison(const bee::ai::Behavior& behavior)
+{
+    return dynamic_cast<const bee::ai::Comparison<T>*>(&behavior);
+}
+
+const bee::ai::IComparator* FindComparator(const bee::ai::Behavior& behavior, bool& isNegation)
+{
+    if (const auto* comparison = AsComparison<float>(behavior))
+    {
+        isNegation = comparison->IsNegation();
+        return &comparison->GetComparator();
+    }
+    if (const auto* comparison = AsComparison<double>(behavior))
+    {
+        isNegation = comparison->IsNegation();
+        return &comparison->GetComparator();
+    }
+    if (const auto* comparison = AsComparison<bool>(behavior))
+    {
+        isNegation = comparison->IsNegation();
+        return &comparison->GetComparator();
+    }
+    if (const auto* comparison = AsComparison<int>(behavior))
+    {
+        isNegation = comparison->IsNegation();
+        return &comparison->GetComparator();
+    }
+    if (const auto* comparison = AsComparison<std::string>(behavior))
+    {
+        isNegation = comparison->IsNegation();
+        return &comparison->GetComparator();
+    }
+    return nullptr;
+}
+}  // namespace
+
 void bee::ai::BehaviorTree::Execute(bee::ai::BehaviorTreeContext& context) const
 {
-    m_root->Execute(context);
+    if (!m_compiled)
+    {
+        m_root->Execute(context);
+        return;
+    }
+
+    if (context.compiledStatuses.size() != m_compiledBehaviors.size())
+        context.compiledStatuses.assign(m_compiledBehaviors.size(), Status::INVALID);
+    ExecuteCompiled(0, context);
+}
+
+bee::ai::Status bee::ai::BehaviorTree::GetStatus(const BehaviorTreeContext& context, const int id) const
+{
+    if (!m_compiled)
+    {
+        const auto status = context.statuses.find(id);
+        return status == context.statuses.end() ? Status::INVALID : status->second;
+    }
+
+    const auto behavior = std::find_if(m_compiledBehaviors.begin(), m_compiledBehaviors.end(),
+                                       [id](const CompiledBehavior& compiled) { return compiled.id == id; });
+    const auto index = static_cast<size_t>(behavior - m_compiledBehaviors.begin());
+    if (behavior == m_compiledBehaviors.end() || index >= context.compiledStatuses.size()) return Status::INVALID;
+    return context.compiledStatuses[index];
+}
+
+bool bee::ai::BehaviorTree::Compile()
+{
+    m_compiledBehaviors.clear();
+    m_compiledComparators.clear();
+    m_compiled = m_root != nullptr && CompileBehavior(*m_root);
+    if (!m_compiled)
+    {
+        m_compiledBehaviors.clear();
+        m_compiledComparators.clear();
+    }
+    return m_compiled;
+}
+
+bool bee::ai::BehaviorTree::CompileBehavior(Behavior& behavior)
+{
+    const auto index = static_cast<uint32_t>(m_compiledBehaviors.size());
+    CompiledBehavior compiled;
+    compiled.id = behavior.GetId();
+
+    const Behavior* child = nullptr;
+    const std::vector<std::unique_ptr<Behavior>>* children = nullptr;
+    bool isNegation = false;
+    if (const auto* sequence = dynamic_cast<const ai::Sequence*>(&behavior))
+    {
+        compiled.type = CompiledBehavior::Type::Sequence;
+        children = &sequence->GetChildren();
+    }
+    else if (const auto* selector = dynamic_cast<const ai::Selector*>(&behavior))
+    {
+        compiled.type = CompiledBehavior::Type::Selector;
+        children = &selector->GetChildren();
+    }
+    else if (const auto* repeater = dynamic_cast<const ai::Repeater*>(&behavior))
+    {
+        compiled.type = CompiledBehavior::Type::Repeater;
+        compiled.numRepeats = repeater->GetNumRepeats();
+        child = repeater->GetChild().get();
+    }
+    else if (const auto* inverter = dynamic_cast<const ai::Inverter*>(&behavior))
+    {
+        compiled.type = CompiledBehavior::Type::Inverter;
+        child = inverter->GetChild().get();
+    }
+    else if (const auto* alwaysSucceed = dynamic_cast<const ai::AlwaysSucceed*>(&behavior))
+    {
+        compiled.type = CompiledBehavior::Type::AlwaysSucceed;
+        child = alwaysSucceed->GetChild().get();
+    }
+    else if (const auto* untilFail = dynamic_cast<const ai::UntilFail*>(&behavior))
+    {
+        compiled.type = CompiledBehavior::Type::UntilFail;
+        child = untilFail->GetChild().get();
+    }
+    else if (auto* condition = dynamic_cast<ai::Condition*>(&behavior))
+    {
+        compiled.type = CompiledBehavior::Type::Condition;
+        compiled.isNegation = condition->IsNegation();
+        compiled.behavior = condition;
+        child = condition->GetChild().get();
+    }
+    else if (const IComparator* comparator = FindComparator(behavior, isNegation))
+    {
+        compiled.type = CompiledBehavior::Type::Comparison;
+        compiled.isNegation = isNegation;
+        compiled.comparator = static_cast<uint32_t>(m_compiledComparators.size());
+        m_compiledComparators.emplace_back(*comparator);
+        child = static_cast<const Decorator&>(behavior).GetChild().get();
+    }
+    else if (dynamic_cast<const Composite*>(&behavior) != nullptr || dynamic_cast<const Decorator*>(&behavior) != nullptr)
+    {
+        // a composite or decorator the interpreter does not know
+        return false;
+    }
+    else
+    {
+        compiled.type = CompiledBehavior::Type::Leaf;
+        compiled.behavior = &behavior;
+    }
+    m_compiledBehaviors.push_back(compiled);
+
+    if (children != nullptr)
+    {
+        for (const auto& element : *children)
+            if (!CompileBehavior(*element)) return false;
+    }
+    else if (compiled.type != CompiledBehavior::Type::Leaf)
+    {
+        if (child == nullptr || !CompileBehavior(const_cast<Behavior&>(*child))) return false;
+    }
+
+    m_compiledBehaviors[index].size = static_cast<uint32_t>(m_compiledBehaviors.size()) - index;
+    return true;
+}
+
+bee::ai::Status bee::ai::BehaviorTree::ExecuteCompiled(const uint32_t index, BehaviorTreeContext& context) const
+{
+    // same as Behavior::Execute, only the actions do anything on Initialize and End
+    const CompiledBehavior& node = m_compiledBehaviors[index];
+    Behavior* leaf = node.type == CompiledBehavior::Type::Leaf ? node.behavior : nullptr;
+    const Status previous = context.compiledStatuses[index];
+    if (previous != Status::RUNNING && leaf != nullptr) leaf->Initialize(context);
+
+    const Status status = TickCompiled(index, previous, context);
+
+    if (status != Status::RUNNING && leaf != nullptr) leaf->End(context, status);
+    context.compiledStatuses[index] = status;
+    return status;
+}
+
+bee::ai::Status bee::ai::BehaviorTree::TickCompiled(const uint32_t index, const Status previous,
+                                                    BehaviorTreeContext& context) const
+{
+    // the Tick of the behavior the node was compiled from, with the children found by offset
+    const CompiledBehavior& node = m_compiledBehaviors[index];
+    const uint32_t firstChild = index + 1;
+    const uint32_t last = index + node.size;
+    auto& statuses = context.compiledStatuses;
+
+    switch (node.type)
+    {
+        case CompiledBehavior::Type::Sequence:
+        {
+            bool allSuccess = true;
+            for (uint32_t child = firstChild; child != last; child += m_compiledBehaviors[child].size)
+            {
+                if (statuses[child] == Status::SUCCESS) continue;
+                allSuccess = false;
+                const Status childStatus = ExecuteCompiled(child, context);
+                if (childStatus != Status::SUCCESS) return childStatus;
+            }
+            if (allSuccess) ResetCompiled(firstChild, last, context);
+            return Status::SUCCESS;
+        }
+        case CompiledBehavior::Type::Selector:
+        {
+            for (uint32_t child = firstChild; child != last; child += m_compiledBehaviors[child].size)
+            {
+                const Status childStatus = ExecuteCompiled(child, context);
+                if (childStatus == Status::FAILURE) continue;
+                ResetCompiled(firstChild, child, context);
+                ResetCompiled(child + m_compiledBehaviors[child].size, last, context);
+                return childStatus;
+            }
+            return Status::FAILURE;
+        }
+        case CompiledBehavior::Type::Repeater:
+        {
+            // like Repeater::Tick, this looks at the status the repeater itself had before the tick
+            for (int i = 0; i < node.numRepeats; i++)
+            {
+                ExecuteCompiled(firstChild, context);
+                if (previous == Status::RUNNING) return Status::SUCCESS;
+                if (previous == Status::FAILURE) return Status::FAILURE;
+                ResetCompiled(firstChild, last, context);
+            }
+            return Status::SUCCESS;
+        }
+        case CompiledBehavior::Type::Inverter:
+        {
+            const Status status = ExecuteCompiled(firstChild, context);
+            if (status == Status::FAILURE) return Status::SUCCESS;
+            if (status == Status::SUCCESS) return Status::FAILURE;
+            return Status::INVALID;
+        }
+        case CompiledBehavior::Type::AlwaysSucceed:
+            ExecuteCompiled(firstChild, context);
+            return Status::SUCCESS;
+        case CompiledBehavior::Type::UntilFail:
+            return ExecuteCompiled(firstChild, context) != Status::FAILURE ? Status::SUCCESS : Status::FAILURE;
+        case CompiledBehavior::Type::Comparison:
+        {
+            const bool passes = m_compiledComparators[node.comparator].Evaluate(*context.blackboard);
+            if (passes != node.isNegation) return ExecuteCompiled(firstChild, context);
+            return Status::FAILURE;
+        }
+        case CompiledBehavior::Type::Condition:
+        {
+            const bool passes = static_cast<const ai::Condition*>(node.behavior)->Check();
+            if (passes != node.isNegation) ExecuteCompiled(firstChild, context);
+            return passes != node.isNegation ? Status::SUCCESS : Status::FAILURE;
+        }
+        case CompiledBehavior::Type::Leaf:
+            return node.behavior->Tick(context);
+    }
+    return Status::INVALID;
+}
+
+void bee::ai::BehaviorTree::ResetCompiled(const uint32_t first, const uint32_t last, BehaviorTreeContext& context)
+{
+    std::fill(context.compiledStatuses.begin() + first, context.compiledStatuses.begin() + last, Status::INVALID);
 }
 
 std::stringstream bee::ai::BehaviorTree::Serialize() const
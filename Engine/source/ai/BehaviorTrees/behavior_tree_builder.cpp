@@ -68,9 +68,10 @@ bee::ai::BehaviorTreeBuilder& bee::ai::BehaviorTreeBuilder::Back()
     return *this;
 }
 
-std::unique_ptr<bee::ai::BehaviorTree> bee::ai::BehaviorTreeBuilder::End()
+std::unique_ptr<bee::ai::BehaviorTree> bee::ai::BehaviorTreeBuilder::End(const bool compile)
 {
     auto behavior_tree = std::make_unique<ai::BehaviorTree>(m_treeRoot);
+    if (compile) behavior_tree->Compile();
     return std::move(behavior_tree);
 }
 
@@ -1,5 +1,36 @@
 #include "ai/Blackboards/blackboard.hpp"
 
+#include <deque>
+#include <mutex>
+
+bee::ai::BlackboardKey::BlackboardKey(const std::string& name)
+{
+    // keys are made when state machines are loaded, possibly on several threads
+    static std::mutex mutex;
+    static std::unordered_map<std::string, uint32_t> ids;
+    static std::deque<std::string> names;  // a deque does not move its elements, so m_name stays valid
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto [it, added] = ids.try_emplace(name, static_cast<uint32_t>(names.size()));
+    if (added) names.push_back(name);
+    m_id = it->second;
+    m_name = &names[m_id];
+}
+
+bee::ai::Blackboard::IHandle* bee::ai::Blackboard::FindHandle(const BlackboardKey& key) const
+{
+    if (key.GetId() >= m_slots.size()) m_slots.resize(key.GetId() + 1);
+
+    // values are only ever removed all at once by Clear, so a handle that was found stays valid
+    Slot& slot = m_slots[key.GetId()];
+    if (slot.handle != nullptr || slot.generation == m_generation) return slot.handle;
+
+    const auto it = m_Map.find(key.GetName());
+    slot.handle = it == m_Map.end() ? nullptr : it->second.get();
+    slot.generation = m_generation;
+    return slot.handle;
+}
+
 std::vector<std::pair<std::string, std::string>> bee::ai::Blackboard::PreviewToString()
 {
     std::vector<std::pair<std::string, std::string>> toReturn = {};
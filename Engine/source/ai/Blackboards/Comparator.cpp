@@ -1 +1,102 @@
 #include "ai/Blackboards/comparator.hpp"
+
+namespace
+{
+template <typename T>
+bool Compare(const bee::ai::ComparisonType comparison, const T& value, const T& reference)
+{
+    switch (comparison)
+    {
+        case bee::ai::ComparisonType::EQUAL:
+            return value == reference;
+        case bee::ai::ComparisonType::NOT_EQUAL:
+            return value != reference;
+        case bee::ai::ComparisonType::LESS:
+            return value < reference;
+        case bee::ai::ComparisonType::LESS_EQUAL:
+            return value <= reference;
+        case bee::ai::ComparisonType::GREATER:
+            return value > reference;
+        case bee::ai::ComparisonType::GREATER_EQUAL:
+            return value >= reference;
+    }
+    return false;
+}
+
+template <typename T>
+bool Compare(const bee::ai::Blackboard& blackboard, const bee::ai::BlackboardKey& key,
+             const bee::ai::ComparisonType comparison, const T& reference)
+{
+    const T* value = blackboard.TryGet<T>(key);
+    return value != nullptr && Compare(comparison, *value, reference);
+}
+
+template <typename T>
+const bee::ai::Comparator<T>* AsComparator(const bee::ai::IComparator& comparator)
+{
+    return dynamic_cast<const bee::ai::Comparator<T>*>(&comparator);
+}
+}  // namespace
+
+bee::ai::CompiledComparator::CompiledComparator(const IComparator& comparator)
+{
+    if (const auto* typed = AsComparator<float>(comparator))
+    {
+        type = ValueType::Float;
+        comparison = typed->GetComparisonType();
+        key.emplace(typed->GetComparisonKey());
+        floatValue = typed->GetValue();
+    }
+    else if (const auto* typed = AsComparator<double>(comparator))
+    {
+        type = ValueType::Double;
+        comparison = typed->GetComparisonType();
+        key.emplace(typed->GetComparisonKey());
+        doubleValue = typed->GetValue();
+    }
+    else if (const auto* typed = AsComparator<bool>(comparator))
+    {
+        type = ValueType::Bool;
+        comparison = typed->GetComparisonType();
+        key.emplace(typed->GetComparisonKey());
+        boolValue = typed->GetValue();
+    }
+    else if (const auto* typed = AsComparator<int>(comparator))
+    {
+        type = ValueType::Int;
+        comparison = typed->GetComparisonType();
+        key.emplace(typed->GetComparisonKey());
+        intValue = typed->GetValue();
+    }
+    else if (const auto* typed = AsComparator<std::string>(comparator))
+    {
+        type = ValueType::String;
+        comparison = typed->GetComparisonType();
+        key.emplace(typed->GetComparisonKey());
+        stringValue = typed->GetValue();
+    }
+    else
+    {
+        other = &comparator;
+    }
+}
+
+bool bee::ai::CompiledComparator::Evaluate(const Blackboard& blackboard) const
+{
+    switch (type)
+    {
+        case ValueType::Float:
+            return Compare(blackboard, *key, comparison, floatValue);
+        case ValueType::Double:
+            return Compare(blackboard, *key, comparison, doubleValue);
+        case ValueType::Bool:
+            return Compare(blackboard, *key, comparison, boolValue);
+        case ValueType::Int:
+            return Compare(blackboard, *key, comparison, intValue);
+        case ValueType::String:
+            return Compare(blackboard, *key, comparison, stringValue);
+        case ValueType::Other:
+            return other->Evaluate(blackboard);
+    }
+    return false;
+}
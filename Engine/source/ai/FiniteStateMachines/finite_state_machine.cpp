@@ -1,5 +1,6 @@
 #include "ai/FiniteStateMachines/finite_state_machine.hpp"
 
+#include <mutex>
 #include <sstream>
 #include <tinygltf/json.hpp>
 
@@ -32,27 +33,164 @@ void bee::ai::FiniteStateMachine::Execute(StateMachineContext& context)
 
     const auto currentStateIndex = context.currentState.value();
 
-    for (const auto& transitionData : m_transitions[currentStateIndex])
+    if (m_compiled && m_transitionEvaluation == TransitionEvaluation::EventDriven)
     {
-        if (!transitionData.CanTransition(context))
+        const Blackboard& blackboard = *context.blackboard;
+        bool checkAll = context.quietState != currentStateIndex || context.quietBlackboard != &blackboard;
+        if (context.wakeUpIn <= 0.0f)
         {
-            continue;
+            checkAll = true;
+            context.wakeUpIn = std::numeric_limits<float>::infinity();
+        }
+        // counted down like a timer the state counts down in Update, which the transitions see on the next Execute
+        context.wakeUpIn -= context.deltaTime;
+
+        // a transition that was false stays false until one of its values changes
+        const uint32_t since = context.quietSince;
+        const uint32_t stamp = blackboard.GetChangeStamp();
+        bool transitioned = false;
+        if (checkAll || stamp != since)
+        {
+            const auto* transition = m_compiledTransitions.data() + m_compiledStates[currentStateIndex];
+            const auto* lastTransition = m_compiledTransitions.data() + m_compiledStates[currentStateIndex + 1];
+            for (; transition != lastTransition; ++transition)
+            {
+                if (!checkAll && !InputsChanged(*transition, blackboard, since)) continue;
+                if (!CanTransition(*transition, blackboard)) continue;
+                Transition(currentStateIndex, transition->stateToGoTo, context);
+                transitioned = true;
+            }
         }
 
-        auto typeIndex = transitionData.StateToGoTo();
-        const std::unique_ptr<State>& endedState = m_states.at(currentStateIndex);
-        endedState->End(context);
+        // after a transition, even one back to the same state, the next Execute checks them all again
+        context.quietState = transitioned ? std::nullopt : std::optional<size_t>(currentStateIndex);
+        context.quietBlackboard = &blackboard;
+        context.quietSince = stamp;
+    }
+    else if (m_compiled)
+    {
+        const auto* transition = m_compiledTransitions.data() + m_compiledStates[currentStateIndex];
+        const auto* lastTransition = m_compiledTransitions.data() + m_compiledStates[currentStateIndex + 1];
+        for (; transition != lastTransition; ++transition)
+        {
+            if (!CanTransition(*transition, *context.blackboard)) continue;
+            Transition(currentStateIndex, transition->stateToGoTo, context);
+        }
+    }
+    else
+    {
+        for (const auto& transitionData : m_transitions[currentStateIndex])
+        {
+            if (!transitionData.CanTransition(context)) continue;
+            Transition(currentStateIndex, transitionData.StateToGoTo(), context);
+        }
+    }
 
-        context.currentState = typeIndex;
+    m_states[currentStateIndex]->Update(context);
+}
+
+void bee::ai::FiniteStateMachine::Compile()
+{
+    m_compiledStates.assign(m_states.size() + 1, 0);
+    m_compiledTransitions.clear();
+    m_compiledComparators.clear();
 
-        if (!context.currentState.has_value()) continue;
-        if (context.currentState.value() >= m_states.size()) continue;
+    for (size_t state = 0; state < m_states.size(); state++)
+    {
+        m_compiledStates[state] = static_cast<uint32_t>(m_compiledTransitions.size());
+
+        const auto it = m_transitions.find(state);
+        if (it == m_transitions.end()) continue;
+
+        for (const auto& transitionData : it->second)
+        {
+            CompiledTransition& transition = m_compiledTransitions.emplace_back();
+            transition.firstComparator = static_cast<uint32_t>(m_compiledComparators.size());
+            transition.comparatorCount = static_cast<uint32_t>(transitionData.comparators.size());
+            transition.stateToGoTo = transitionData.StateToGoTo();
 
-        const std::unique_ptr<State>& stateToInit = m_states.at(context.currentState.value());
-        stateToInit->Initialize(context);
+            for (const auto& comparator : transitionData.comparators) m_compiledComparators.emplace_back(*comparator);
+        }
     }
+    m_compiledStates[m_states.size()] = static_cast<uint32_t>(m_compiledTransitions.size());
+    m_compiled = true;
+}
 
-    m_states[currentStateIndex]->Update(context);
+bool bee::ai::FiniteStateMachine::CanRunInParallel(const StateMachineContext& context) const
+{
+    if (!m_compiled || m_states.empty()) return false;
+
+    const size_t currentStateIndex = context.currentState.value_or(m_defaultState.value());
+    if (!m_states[currentStateIndex]->parallelSafe) return false;
+
+    const auto* transition = m_compiledTransitions.data() + m_compiledStates[currentStateIndex];
+    const auto* lastTransition = m_compiledTransitions.data() + m_compiledStates[currentStateIndex + 1];
+    for (; transition != lastTransition; ++transition)
+    {
+        if (transition->stateToGoTo >= m_states.size() || !m_states[transition->stateToGoTo]->parallelSafe)
+        {
+            if (CanTransition(*transition, *context.blackboard)) return false;
+        }
+    }
+    return true;
+}
+
+uint32_t bee::ai::FiniteStateMachine::GetStateTypeId(const std::type_index& type)
+{
+    // state machines are loaded on several threads
+    static std::mutex mutex;
+    static std::unordered_map<std::type_index, uint32_t> ids;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return ids.try_emplace(type, static_cast<uint32_t>(ids.size())).first->second;
+}
+
+void bee::ai::FiniteStateMachine::IndexState(const size_t index)
+{
+    const uint32_t type = GetStateTypeId(typeid(*m_states[index]));
+    if (type >= m_statesOfType.size()) m_statesOfType.resize(type + 1);
+    m_statesOfType[type].push_back(index);
+}
+
+void bee::ai::FiniteStateMachine::IndexStates()
+{
+    for (auto& ids : m_statesOfType) ids.clear();
+    for (size_t index = 0; index < m_states.size(); index++) IndexState(index);
+}
+
+bool bee::ai::FiniteStateMachine::CanTransition(const CompiledTransition& transition, const Blackboard& blackboard) const
+{
+    const auto* comparator = m_compiledComparators.data() + transition.firstComparator;
+    const auto* lastComparator = comparator + transition.comparatorCount;
+    for (; comparator != lastComparator; ++comparator)
+    {
+        if (!comparator->Evaluate(blackboard)) return false;
+    }
+    return true;
+}
+
+bool bee::ai::FiniteStateMachine::InputsChanged(const CompiledTransition& transition, const Blackboard& blackboard,
+                                                const uint32_t since) const
+{
+    const auto* comparator = m_compiledComparators.data() + transition.firstComparator;
+    const auto* lastComparator = comparator + transition.comparatorCount;
+    for (; comparator != lastComparator; ++comparator)
+    {
+        // comparators that were not compiled may look at anything
+        if (!comparator->key.has_value()) return true;
+        if (blackboard.GetChangeStamp(*comparator->key) > since) return true;
+    }
+    return false;
+}
+
+void bee::ai::FiniteStateMachine::Transition(const size_t from, const size_t to, StateMachineContext& context) const
+{
+    m_states.at(from)->End(context);
+
+    context.currentState = to;
+    if (to >= m_states.size()) return;
+
+    m_states.at(to)->Initialize(context);
 }
 
 void bee::ai::FiniteStateMachine::SetCurrentState(size_t stateToSet, StateMachineContext& context) const
@@ -173,6 +311,7 @@ bool bee::ai::FiniteStateMachine::DeserializeStates(nlohmann::json& json, Finite
 
         stateMachine.m_states.push_back(std::move(state));
     }
+    stateMachine.IndexStates();
 
     if (stateMachine.m_states.empty()) return false;
     if (!stateMachine.m_defaultState.has_value())
@@ -254,7 +393,8 @@ void bee::ai::FiniteStateMachine::DeserializeTransitionData(nlohmann::json json,
     }
 }
 
-std::unique_ptr<bee::ai::FiniteStateMachine> bee::ai::FiniteStateMachine::DeserializeFromStringStream(std::stringstream& stream)
+std::unique_ptr<bee::ai::FiniteStateMachine> bee::ai::FiniteStateMachine::DeserializeFromStringStream(std::stringstream& stream,
+                                                                                                 const bool compile)
 {
     int transitionDataAmount = 0;
     stream >> transitionDataAmount;
@@ -265,6 +405,7 @@ std::unique_ptr<bee::ai::FiniteStateMachine> bee::ai::FiniteStateMachine::Deseri
 
     if (!DeserializeStates(json["states"], *temp)) return std::move(temp);
     DeserializeTransitionData(json["transition-data"], *temp);
+    if (compile) temp->Compile();
     return std::move(temp);
 }
 
@@ -1,44 +1,176 @@
 #include "ai/ai_behavior_selection_system.hpp"
 #include "core/engine.hpp"
+#include "core/simulation_lod.hpp"
+#include <algorithm>
 #include <execution>
 
-bee::ai::AIBehaviorSelectionSystem::AIBehaviorSelectionSystem(float fixedDeltaTime)
+namespace
+{
+// agents out of view decide less often, see SimulationLOD
+int DecisionInterval(const entt::registry& registry, const bee::Entity entity)
+{
+    const auto* lod = registry.try_get<bee::SimulationLOD>(entity);
+    return lod != nullptr ? lod->decisionInterval : 1;
+}
+}  // namespace
+
+bee::ai::AIBehaviorSelectionSystem::AIBehaviorSelectionSystem(float fixedDeltaTime, int bucketCount)
+    : m_slicer(fixedDeltaTime, bucketCount)
 {
     Title = "AI Behavior Selection";
-    m_fixedDeltaTime = fixedDeltaTime;
+    bee::Engine.ECS().Registry.on_destroy<StateMachineAgent>().connect<&AIBehaviorSelectionSystem::OnAgentDestroyed>(*this);
+}
+
+bee::ai::AIBehaviorSelectionSystem::~AIBehaviorSelectionSystem()
+{
+    bee::Engine.ECS().Registry.on_destroy<StateMachineAgent>().disconnect<&AIBehaviorSelectionSystem::OnAgentDestroyed>(*this);
 }
 
 void bee::ai::AIBehaviorSelectionSystem::Update(float dt)
 {
-    m_hasExecutedFrame = false;
-    m_timeSinceLastFrame += dt;
+    m_slicer.Advance(dt);
 
-    while (m_timeSinceLastFrame >= m_fixedDeltaTime)
+    // agents whose timers ran out tick on this frame, whatever their bucket
+    auto& registry = bee::Engine.ECS().Registry;
+    m_expiredTimers.clear();
+    m_timers.Advance(dt, m_expiredTimers);
+    for (const auto entity : m_expiredTimers)
     {
-        auto btEntities = bee::Engine.ECS().Registry.view<bee::ai::BTAgent>();
-
-        std::for_each(std::execution::par, btEntities.begin(), btEntities.end(),
-      [btEntities,this](auto&& entity) {
-              auto& agent = btEntities.get<BTAgent>(entity);
-              agent.context.deltaTime = m_fixedDeltaTime;
-              agent.bt.Execute(agent.context);  
-        });
-
-        auto fsmEntities = bee::Engine.ECS().Registry.view<bee::ai::StateMachineAgent>();
-
-        std::for_each(std::execution::seq, fsmEntities.begin(), fsmEntities.end(),
-          [fsmEntities, this](auto&& entity)
-          {
-              if (!bee::Engine.ECS().Registry.valid(entity)) return;
-              auto& agent = fsmEntities.get<StateMachineAgent>(entity);
-              if (agent.active == false) return;
-              agent.context.deltaTime = m_fixedDeltaTime;
-              agent.fsm.Execute(agent.context);
-          });
-
-        m_timeSinceLastFrame -= m_fixedDeltaTime;
-        m_hasExecutedFrame = true;
+        auto* agent = registry.valid(entity) ? registry.try_get<StateMachineAgent>(entity) : nullptr;
+        if (agent == nullptr || !agent->suspension.suspended) continue;
+        Resume(entity, *agent);
+        agent->slice.Prioritize();
     }
+
+    auto btEntities = bee::Engine.ECS().Registry.view<bee::ai::BTAgent>();
+
+    std::for_each(std::execution::par, btEntities.begin(), btEntities.end(),
+  [btEntities,&registry,this](auto&& entity) {
+          auto& agent = btEntities.get<BTAgent>(entity);
+          float agentDt = 0.0f;
+          if (!m_slicer.Tick(entity, agent.slice, agentDt, agent.slice.priority, DecisionInterval(registry, entity))) return;
+          agent.context.deltaTime = agentDt;
+          agent.bt.Execute(agent.context);
+    });
+
+    auto fsmEntities = registry.view<bee::ai::StateMachineAgent>();
+
+    // tick the agents that can not run in parallel right away, and keep the others for after
+    m_parallelAgents.clear();
+    for (const auto entity : fsmEntities)
+    {
+        if (!registry.valid(entity)) continue;
+        auto& agent = fsmEntities.get<StateMachineAgent>(entity);
+        if (agent.active == false) continue;
+        if (agent.suspension.suspended)
+        {
+            // woken by a change to its blackboard or state, which would not be seen while it sleeps, or an order
+            if (!agent.slice.priority && agent.suspension.state == agent.context.GetCurrentState() &&
+                agent.suspension.blackboardStamp == agent.context.blackboard->GetChangeStamp())
+                continue;
+            Resume(entity, agent);
+        }
+        float agentDt = 0.0f;
+        if (!m_slicer.Tick(entity, agent.slice, agentDt, agent.slice.priority, DecisionInterval(registry, entity))) continue;
+        agent.context.deltaTime = agentDt;
+        if (agent.fsm.CanRunInParallel(agent.context))
+        {
+            m_parallelAgents.push_back(entity);
+            continue;
+        }
+        agent.context.snapshot = nullptr;
+        agent.fsm.Execute(agent.context);
+        Suspend(entity, agent);
+    }
+
+    // the serial agents may have changed the state of the others
+    size_t parallelAgentCount = 0;
+    for (const auto entity : m_parallelAgents)
+    {
+        auto* agent = registry.valid(entity) ? registry.try_get<StateMachineAgent>(entity) : nullptr;
+        if (agent == nullptr) continue;
+        if (agent->fsm.CanRunInParallel(agent->context))
+        {
+            m_parallelAgents[parallelAgentCount++] = entity;
+            continue;
+        }
+        agent->context.snapshot = nullptr;
+        agent->fsm.Execute(agent->context);
+        Suspend(entity, *agent);
+    }
+    m_parallelAgents.resize(parallelAgentCount);
+
+    ExecuteParallelAgents();
+    for (const auto entity : m_parallelAgents) Suspend(entity, fsmEntities.get<StateMachineAgent>(entity));
+}
+
+void bee::ai::AIBehaviorSelectionSystem::DeclareAgentAccess()
+{
+    Reads<SimulationLOD>();
+    Writes<StateMachineAgent, BTAgent>();
+}
+
+void bee::ai::AIBehaviorSelectionSystem::Wake(const Entity entity)
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    auto* agent = registry.valid(entity) ? registry.try_get<StateMachineAgent>(entity) : nullptr;
+    if (agent != nullptr && agent->suspension.suspended) Resume(entity, *agent);
+}
+
+void bee::ai::AIBehaviorSelectionSystem::Suspend(const Entity entity, StateMachineAgent& agent)
+{
+    auto& context = agent.context;
+    if (!context.suspendFor.has_value()) return;
+
+    // the state may have asked before its agent was deleted in the same tick
+    const float seconds = context.suspendFor.value();
+    context.suspendFor.reset();
+    if (bee::Engine.ECS().Registry.all_of<Delete>(entity)) return;
+
+    agent.suspension.suspended = true;
+    agent.suspension.state = context.GetCurrentState();
+    agent.suspension.blackboardStamp = context.blackboard->GetChangeStamp();
+    m_timers.Schedule(entity, seconds);
+    m_suspendedAgents++;
+}
+
+void bee::ai::AIBehaviorSelectionSystem::Resume(const Entity entity, StateMachineAgent& agent)
+{
+    agent.suspension.suspended = false;
+    m_timers.Cancel(entity);
+    m_suspendedAgents--;
+}
+
+void bee::ai::AIBehaviorSelectionSystem::OnAgentDestroyed(entt::registry& registry, const Entity entity)
+{
+    if (registry.get<StateMachineAgent>(entity).suspension.suspended) m_suspendedAgents--;
+    m_timers.Cancel(entity);
+}
+
+void bee::ai::AIBehaviorSelectionSystem::ExecuteParallelAgents()
+{
+    if (m_parallelAgents.empty()) return;
+
+    auto& registry = bee::Engine.ECS().Registry;
+    m_snapshot.Take(registry, m_parallelAgents);
+
+    auto fsmEntities = registry.view<bee::ai::StateMachineAgent>();
+    const auto execute = [fsmEntities, this](const Entity entity)
+    {
+        auto& agent = fsmEntities.get<StateMachineAgent>(entity);
+        auto& commands = bee::Engine.ECS().Commands();
+        // deferred changes are played back by agent, whichever thread recorded them
+        commands.SetSortKey(entt::to_integral(entity));
+        agent.context.snapshot = &m_snapshot;
+        agent.fsm.Execute(agent.context);
+        agent.context.snapshot = nullptr;
+        commands.SetSortKey(0);
+    };
+
+    if (m_execution == StateMachineExecution::Parallel)
+        std::for_each(std::execution::par, m_parallelAgents.begin(), m_parallelAgents.end(), execute);
+    else
+        std::for_each(std::execution::seq, m_parallelAgents.begin(), m_parallelAgents.end(), execute);
 }
 
 void bee::ai::AIBehaviorSelectionSystem::Render()
@@ -4,6 +4,7 @@
 
 #include "ai/FiniteStateMachines/finite_state_machine.hpp"
 #include "ai/navmesh_agent.hpp"
+#include "core/simulation_lod.hpp"
 #include "core/transform.hpp"
 #include "level_editor/level_editor_components.hpp"
 #include "physics/physics_components.hpp"
@@ -11,6 +12,7 @@
 #include <cmath>
 
 #include "animation/animation_state.hpp"
+#include "rendering/debug_render.hpp"
 #include "tools/log.hpp"
 
 void bee::ai::GridAgent::SetGoal(const glm::vec2& goalToSet, bool shouldRecomputePath)
@@ -63,53 +65,63 @@ void bee::ai::GridAgent::ComputePreferredVelocity(const glm::vec3& currentPos, f
     preferredVelocity = glm::normalize(glm::vec2(attractionPoint) - glm::vec2(currentPos)) * speed;
 }
 
-bee::ai::GridNavigationSystem::GridNavigationSystem(float fixedDeltaTime, const bee::ai::NavigationGrid& grid)
-    : m_fixedDeltaTime(fixedDeltaTime), m_grid(grid)
+bee::ai::GridNavigationSystem::GridNavigationSystem(float fixedDeltaTime, const bee::ai::NavigationGrid& grid, int bucketCount)
+    : m_grid(grid), m_slicer(fixedDeltaTime, bucketCount)
 {
+    Title = "Grid Navigation";
+    Reads<SimulationLOD>();
+    Writes<GridAgent, bee::physics::Body, bee::Transform, AnimationAgent, DebugRenderer>();
 }
 
 void bee::ai::GridNavigationSystem::Update(float dt)
 {
     System::Update(dt);
-    m_timeSinceLastFrame += dt;
+    m_slicer.Advance(dt);
+    m_steeredAgents = 0;
+    m_verticalUpdates = 0;
 
+    const auto& registry = bee::Engine.ECS().Registry;
     const auto& view = bee::Engine.ECS().Registry.view<GridAgent, bee::physics::Body, bee::Transform>();
 
-    if (m_timeSinceLastFrame >= m_fixedDeltaTime)
-    {
-        std::for_each(std::execution::par,view.begin(), view.end(),[view,this](const auto entity) 
-            {
-                  auto& body = view.get<bee::physics::Body>(entity);
-                  auto& agent = view.get<GridAgent>(entity);
-                  auto& transform = view.get<bee::Transform>(entity);
-                  const glm::vec2& pos = glm::vec2(body.GetPosition());
-                      if (agent.recomputePath) agent.ComputePath(m_grid, pos);
-
-                      transform.Translation.z = agent.verticalPosition;
-                      agent.ComputePreferredVelocity(glm::vec3(pos, 0), m_fixedDeltaTime);
-                      transform.Translation.z = glm::mix(transform.Translation.z, agent.verticalPosition + 0.9f, 0.9f);
-            });
-
-        for(const auto&[entity1, agent1, body1, transform1] : view.each())
+    // paths and steering are time sliced, and slowed down further for agents out of view (see SimulationLOD); an
+    // agent with a new goal that was prioritized steers right away
+    std::for_each(std::execution::par,view.begin(), view.end(),[view,&registry,this](const auto entity) 
+        {
+              auto& body = view.get<bee::physics::Body>(entity);
+              auto& agent = view.get<GridAgent>(entity);
+              const auto* lod = registry.try_get<SimulationLOD>(entity);
+              const int interval = lod != nullptr ? lod->decisionInterval : 1;
+              float agentDt = 0.0f;
+              if (!m_slicer.Tick(entity, agent.slice, agentDt, agent.slice.priority && agent.recomputePath, interval)) return;
+
+              const glm::vec2& pos = glm::vec2(body.GetPosition());
+                  if (agent.recomputePath) agent.ComputePath(m_grid, pos);
+
+                  agent.ComputePreferredVelocity(glm::vec3(pos, 0), agentDt);
+        });
+
+    for(const auto&[entity1, agent1, body1, transform1] : view.each())
 {
-            for (const auto& [entity2, agent2, body2, transform2] : view.each())
-            {
-                if (entity1 == entity2) continue;
+        if (agent1.slice.lastTick != m_slicer.GetTime()) continue;  // not ticked this frame
+        m_steeredAgents++;
+        for (const auto& [entity2, agent2, body2, transform2] : view.each())
+        {
+            if (entity1 == entity2) continue;
 
-                Separation(agent1.m_detectionRadius, transform1.Translation, transform2.Translation, agent1.preferredVelocity);
-            }
+            Separation(agent1.m_detectionRadius, transform1.Translation, transform2.Translation, agent1.preferredVelocity);
+        }
 }
-        m_timeSinceLastFrame -= m_fixedDeltaTime;
-    }
 
-    std::for_each(std::execution::par, view.begin(), view.end(),[view, this,dt](const auto entity) 
+    // the height on the terrain is only seen, so it follows the cosmetic updates of the tier
+    std::for_each(std::execution::par, view.begin(), view.end(),[view, &registry, this,dt](const auto entity) 
     {
-          auto& body = view.get<bee::physics::Body>(entity);
+          const auto* lod = registry.try_get<SimulationLOD>(entity);
+          if (lod != nullptr && !lod->cosmeticUpdate) return;
           auto& agent = view.get<GridAgent>(entity);
           auto& transform = view.get<bee::Transform>(entity);
-          const glm::vec2& pos = glm::vec2(body.GetPosition());
           agent.CalculateVerticalPosition(transform.Translation, dt);
           transform.Translation.z = agent.verticalPosition;
+          m_verticalUpdates++;
     });
 
     // link agents to physics
@@ -0,0 +1,194 @@
+#include "ai/influence_map.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace bee::ai;
+
+namespace
+{
+int32_t ToFixed(const float value) { return static_cast<int32_t>(std::lround(value / InfluenceMap::Resolution)); }
+}  // namespace
+
+void InfluenceMap::Resize(const glm::vec2& origin, const float cellSize, const int width, const int height)
+{
+    m_origin = origin;
+    m_cellSize = std::max(cellSize, 0.001f);
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+
+    const size_t cells = static_cast<size_t>(m_width) * static_cast<size_t>(m_height);
+    m_layers.assign(static_cast<size_t>(InfluenceLayer::Count), std::vector<int32_t>(cells, 0));
+    m_observers.assign(cells, 0);
+    m_lastSeen.assign(cells, -std::numeric_limits<float>::infinity());
+}
+
+int InfluenceMap::GetCell(const glm::vec2& position) const
+{
+    const glm::vec2 local = (position - m_origin) / m_cellSize;
+    if (!(local.x >= 0.0f && local.y >= 0.0f)) return -1;
+    const int x = static_cast<int>(local.x);
+    const int y = static_cast<int>(local.y);
+    if (x >= m_width || y >= m_height) return -1;
+    return y * m_width + x;
+}
+
+glm::vec2 InfluenceMap::GetCellCenter(const int cell) const
+{
+    const int x = cell % m_width;
+    const int y = cell / m_width;
+    return m_origin + (glm::vec2(static_cast<float>(x), static_cast<float>(y)) + 0.5f) * m_cellSize;
+}
+
+const std::vector<InfluenceMap::KernelCell>& InfluenceMap::GetKernel(int radius)
+{
+    radius = std::clamp(radius, 0, MaxRadius);
+    if (static_cast<size_t>(radius) >= m_kernels.size()) m_kernels.resize(radius + 1);
+    auto& kernel = m_kernels[radius];
+    if (!kernel.empty()) return kernel;
+
+    for (int y = -radius; y <= radius; y++)
+    {
+        for (int x = -radius; x <= radius; x++)
+        {
+            const float distance = std::sqrt(static_cast<float>(x * x + y * y));
+            if (distance > static_cast<float>(radius) + 0.5f) continue;
+            kernel.push_back({x, y, std::max(1.0f - distance / static_cast<float>(radius + 1), 0.0f)});
+        }
+    }
+    return kernel;
+}
+
+template <typename F>
+void InfluenceMap::ForEachInKernel(const int cell, const int radius, F&& function)
+{
+    if (cell < 0 || cell >= GetCellCount()) return;
+    const int x = cell % m_width;
+    const int y = cell / m_width;
+    for (const auto& offset : GetKernel(radius))
+    {
+        const int kx = x + offset.x;
+        const int ky = y + offset.y;
+        if (kx < 0 || ky < 0 || kx >= m_width || ky >= m_height) continue;
+        function(ky * m_width + kx, offset.weight);
+    }
+}
+
+void InfluenceMap::Stamp(const InfluenceLayer layer, const int cell, const int radius, const float value)
+{
+    auto& values = m_layers[static_cast<size_t>(layer)];
+    ForEachInKernel(cell, radius, [&](const int stamped, const float weight) { values[stamped] += ToFixed(value * weight); });
+}
+
+float InfluenceMap::Get(const InfluenceLayer layer, const int cell) const
+{
+    return static_cast<float>(m_layers[static_cast<size_t>(layer)][cell]) * Resolution;
+}
+
+void InfluenceMap::See(const int cell, const int radius, const int count, const float time)
+{
+    ForEachInKernel(cell, radius,
+                    [&](const int seen, float)
+                    {
+                        m_observers[seen] += count;
+                        if (m_observers[seen] <= 0) m_lastSeen[seen] = time;
+                    });
+}
+
+float InfluenceMap::GetExploredAge(const int cell, const float time) const
+{
+    if (IsInSight(cell)) return 0.0f;
+    return time - m_lastSeen[cell];
+}
+
+std::optional<glm::vec2> InfluenceMap::FindWeakestCluster(const InfluenceLayer density, const InfluenceLayer threat,
+                                                          int radius) const
+{
+    radius = std::max(radius, 0);
+    const auto& densities = m_layers[static_cast<size_t>(density)];
+    const auto& threats = m_layers[static_cast<size_t>(threat)];
+
+    // summed-area tables of both layers, so the sum of every neighbourhood takes four lookups
+    const int stride = m_width + 1;
+    const size_t tableSize = static_cast<size_t>(stride) * static_cast<size_t>(m_height + 1);
+    m_sums.assign(tableSize * 2, 0);
+    int64_t* densitySums = m_sums.data();
+    int64_t* threatSums = m_sums.data() + tableSize;
+    for (int y = 0; y < m_height; y++)
+    {
+        for (int x = 0; x < m_width; x++)
+        {
+            const int cell = y * m_width + x;
+            const int at = (y + 1) * stride + x + 1;
+            densitySums[at] = densities[cell] + densitySums[at - 1] + densitySums[at - stride] - densitySums[at - stride - 1];
+            threatSums[at] = threats[cell] + threatSums[at - 1] + threatSums[at - stride] - threatSums[at - stride - 1];
+        }
+    }
+    const auto sum = [&](const int64_t* table, const int x0, const int y0, const int x1, const int y1)
+    { return table[y1 * stride + x1] - table[y0 * stride + x1] - table[y1 * stride + x0] + table[y0 * stride + x0]; };
+
+    int best = -1;
+    int64_t bestThreat = 0;
+    int64_t bestDensity = 0;
+    for (int cell = 0; cell < GetCellCount(); cell++)
+    {
+        if (densities[cell] <= 0) continue;
+        const int x = cell % m_width;
+        const int y = cell / m_width;
+        const int x0 = std::max(x - radius, 0);
+        const int y0 = std::max(y - radius, 0);
+        const int x1 = std::min(x + radius + 1, m_width);
+        const int y1 = std::min(y + radius + 1, m_height);
+        const int64_t clusterThreat = sum(threatSums, x0, y0, x1, y1);
+        const int64_t clusterDensity = sum(densitySums, x0, y0, x1, y1);
+        if (best != -1 && (clusterThreat > bestThreat || (clusterThreat == bestThreat && clusterDensity <= bestDensity)))
+            continue;
+        best = cell;
+        bestThreat = clusterThreat;
+        bestDensity = clusterDensity;
+    }
+    if (best == -1) return std::nullopt;
+    return GetCellCenter(best);
+}
+
+std::optional<glm::vec2> InfluenceMap::FindSafestResource(const InfluenceLayer threat, const glm::vec2& from) const
+{
+    const auto& resources = m_layers[static_cast<size_t>(InfluenceLayer::Resources)];
+    const auto& threats = m_layers[static_cast<size_t>(threat)];
+
+    int best = -1;
+    float bestDistance2 = 0.0f;
+    for (int cell = 0; cell < GetCellCount(); cell++)
+    {
+        if (resources[cell] <= 0) continue;
+        const glm::vec2 offset = GetCellCenter(cell) - from;
+        const float distance2 = glm::dot(offset, offset);
+        if (best != -1 && (threats[cell] > threats[best] || (threats[cell] == threats[best] && distance2 >= bestDistance2)))
+            continue;
+        best = cell;
+        bestDistance2 = distance2;
+    }
+    if (best == -1) return std::nullopt;
+    return GetCellCenter(best);
+}
+
+std::optional<glm::vec2> InfluenceMap::FindLeastExplored(const glm::vec2& from, const float time) const
+{
+    int best = -1;
+    float bestAge = 0.0f;
+    float bestDistance2 = 0.0f;
+    for (int cell = 0; cell < GetCellCount(); cell++)
+    {
+        if (IsInSight(cell)) continue;
+        const float age = GetExploredAge(cell, time);
+        const glm::vec2 offset = GetCellCenter(cell) - from;
+        const float distance2 = glm::dot(offset, offset);
+        if (best != -1 && (age < bestAge || (age == bestAge && distance2 >= bestDistance2))) continue;
+        best = cell;
+        bestAge = age;
+        bestDistance2 = distance2;
+    }
+    if (best == -1) return std::nullopt;
+    return GetCellCenter(best);
+}
@@ -5,9 +5,7 @@
 #include "core/engine.hpp"
 #include "core/transform.hpp"
 #include "physics/physics_components.hpp"
-#ifdef _DEBUG
 #include "rendering/debug_render.hpp"
-#endif
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
@@ -18,6 +16,9 @@ using namespace glm;
 NavigationSystem::NavigationSystem(float fixedDeltaTime, float agentRadius)
     : m_fixedDeltaTime(fixedDeltaTime), m_timeSinceLastFrame(0)
 {
+    Title = "Navigation";
+    Writes<NavmeshAgent, physics::Body, DebugRenderer>();
+
     // get all navmesh input
     geometry2d::PolygonList navmeshObstacles;
     geometry2d::PolygonList navmeshWalkableAreas;
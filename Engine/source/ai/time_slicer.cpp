@@ -0,0 +1,52 @@
+#include "ai/time_slicer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace bee::ai;
+
+TimeSlicer::TimeSlicer(const float period, const int bucketCount)
+    : m_period(period),
+      m_bucketCount(bucketCount > 0 ? bucketCount : std::max(1, static_cast<int>(std::lround(period * 60.0f))))
+{
+}
+
+void TimeSlicer::Advance(const float dt)
+{
+    m_time += dt;
+    m_sinceLastBucket += dt;
+
+    const float slice = m_period / static_cast<float>(m_bucketCount);
+    m_firstDueBucket = m_nextBucket;
+    m_dueBuckets = 0;
+    while (m_sinceLastBucket >= slice)
+    {
+        m_sinceLastBucket -= slice;
+        m_dueBuckets++;
+    }
+    m_nextBucket = (m_nextBucket + m_dueBuckets) % m_bucketCount;
+}
+
+bool TimeSlicer::Tick(const Entity entity, TimeSlice& slice, float& dt, const bool jumpQueue, const int interval) const
+{
+    if (!jumpQueue)
+    {
+        const int bucket = static_cast<int>(entt::to_integral(entity) % static_cast<entt::id_type>(m_bucketCount));
+        if (!IsBucketDue(bucket)) return false;
+        // the bucket comes around about once per period, half a period of slack covers the frames it is late or early
+        const double wait = (static_cast<double>(interval) - 0.5) * m_period;
+        if (interval > 1 && slice.lastTick >= 0.0 && m_time - slice.lastTick < wait) return false;
+    }
+
+    dt = slice.lastTick < 0.0 ? m_period : static_cast<float>(m_time - slice.lastTick);
+    slice.lastTick = m_time;
+    slice.priority = false;
+    return true;
+}
+
+bool TimeSlicer::IsBucketDue(const int bucket) const
+{
+    if (m_dueBuckets >= m_bucketCount) return true;
+    const int offset = (bucket - m_firstDueBucket + m_bucketCount) % m_bucketCount;
+    return offset < m_dueBuckets;
+}
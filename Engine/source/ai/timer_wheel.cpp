@@ -0,0 +1,151 @@
+#include "ai/timer_wheel.hpp"
+
+#include <cmath>
+
+using namespace bee::ai;
+
+namespace
+{
+uint32_t ToIndex(const bee::Entity entity) { return entt::to_integral(entity) & entt::entt_traits<bee::Entity>::entity_mask; }
+}  // namespace
+
+TimerWheel::TimerWheel(const float resolution) : m_resolution(resolution), m_lists(FarList + 1, None) {}
+
+void TimerWheel::Schedule(const Entity entity, const float delay)
+{
+    Cancel(entity);
+    if (!std::isfinite(delay)) return;
+
+    uint32_t timer = None;
+    if (!m_freeTimers.empty())
+    {
+        timer = m_freeTimers.back();
+        m_freeTimers.pop_back();
+    }
+    else
+    {
+        timer = static_cast<uint32_t>(m_timers.size());
+        m_timers.emplace_back();
+    }
+
+    Timer& data = m_timers[timer];
+    data.entity = entity;
+    data.deadline = m_time + static_cast<double>(delay);
+    data.tick = data.deadline > 0.0 ? static_cast<uint64_t>(std::floor(data.deadline / m_resolution)) : 0;
+    Insert(timer);
+
+    const uint32_t index = ToIndex(entity);
+    if (index >= m_timerOfEntity.size()) m_timerOfEntity.resize(index + 1, None);
+    m_timerOfEntity[index] = timer;
+    m_count++;
+}
+
+bool TimerWheel::Cancel(const Entity entity)
+{
+    const uint32_t timer = FindTimer(entity);
+    if (timer == None) return false;
+
+    Unlink(timer);
+    Free(timer);
+    return true;
+}
+
+void TimerWheel::Advance(const float dt, std::vector<Entity>& expired)
+{
+    m_time += dt;
+    const uint64_t target = m_time > 0.0 ? static_cast<uint64_t>(std::floor(m_time / m_resolution)) : 0;
+    while (m_tick < target)
+    {
+        m_tick++;
+
+        // the higher levels first, so their timers can drop all the way down
+        const uint64_t farSpan = uint64_t{1} << (SlotBits * LevelCount);
+        if ((m_tick & (farSpan - 1)) == 0) Cascade(FarList);
+        for (uint32_t level = LevelCount - 1; level > 0; level--)
+        {
+            const uint64_t span = uint64_t{1} << (SlotBits * level);
+            if ((m_tick & (span - 1)) != 0) continue;
+            Cascade(level * SlotCount + static_cast<uint32_t>((m_tick >> (SlotBits * level)) & (SlotCount - 1)));
+        }
+        Cascade(static_cast<uint32_t>(m_tick & (SlotCount - 1)));
+    }
+
+    // timers in the current tick may still be a fraction of it away
+    for (uint32_t timer = m_lists[DueList]; timer != None;)
+    {
+        const uint32_t next = m_timers[timer].next;
+        if (m_timers[timer].deadline <= m_time)
+        {
+            expired.push_back(m_timers[timer].entity);
+            Unlink(timer);
+            Free(timer);
+        }
+        timer = next;
+    }
+}
+
+uint32_t TimerWheel::FindTimer(const Entity entity) const
+{
+    const uint32_t index = ToIndex(entity);
+    if (index >= m_timerOfEntity.size()) return None;
+
+    // an older version of the entity has the same index
+    const uint32_t timer = m_timerOfEntity[index];
+    return timer != None && m_timers[timer].entity == entity ? timer : None;
+}
+
+void TimerWheel::Insert(const uint32_t timer)
+{
+    const uint64_t tick = m_timers[timer].tick;
+    if (tick <= m_tick)
+    {
+        Link(timer, DueList);
+        return;
+    }
+
+    // the level is the highest group of bits where the tick differs from the current one
+    const uint64_t difference = tick ^ m_tick;
+    uint32_t level = 0;
+    while (level < LevelCount && (difference >> (SlotBits * (level + 1))) != 0) level++;
+    if (level == LevelCount)
+        Link(timer, FarList);
+    else
+        Link(timer, level * SlotCount + static_cast<uint32_t>((tick >> (SlotBits * level)) & (SlotCount - 1)));
+}
+
+void TimerWheel::Link(const uint32_t timer, const uint32_t list)
+{
+    Timer& data = m_timers[timer];
+    data.list = list;
+    data.previous = None;
+    data.next = m_lists[list];
+    if (data.next != None) m_timers[data.next].previous = timer;
+    m_lists[list] = timer;
+}
+
+void TimerWheel::Unlink(const uint32_t timer)
+{
+    Timer& data = m_timers[timer];
+    if (data.previous != None)
+        m_timers[data.previous].next = data.next;
+    else
+        m_lists[data.list] = data.next;
+    if (data.next != None) m_timers[data.next].previous = data.previous;
+    data.list = data.previous = data.next = None;
+}
+
+void TimerWheel::Free(const uint32_t timer)
+{
+    m_timerOfEntity[ToIndex(m_timers[timer].entity)] = None;
+    m_timers[timer].entity = entt::null;
+    m_freeTimers.push_back(timer);
+    m_count--;
+}
+
+void TimerWheel::Cascade(const uint32_t list)
+{
+    m_cascade.clear();
+    for (uint32_t timer = m_lists[list]; timer != None; timer = m_timers[timer].next) m_cascade.push_back(timer);
+    m_lists[list] = None;
+    for (const uint32_t timer : m_cascade) Insert(timer);
+}
@@ -0,0 +1,44 @@
+#include "ai/world_snapshot.hpp"
+
+#include <atomic>
+
+using namespace bee;
+using namespace bee::ai;
+
+namespace
+{
+uint32_t ToIndex(const Entity entity) { return entt::to_integral(entity) & entt::entt_traits<Entity>::entity_mask; }
+}  // namespace
+
+size_t bee::ai::internal::NextSnapshotTypeId()
+{
+    static std::atomic<size_t> next{0};
+    return next++;
+}
+
+void WorldSnapshot::Take(const entt::registry& registry, const std::vector<Entity>& entities)
+{
+    // only forget the entities of the last snapshot, the index covers every entity ever put in one
+    for (const auto entity : m_entities) m_positions[ToIndex(entity)] = NotFound;
+
+    m_entities = entities;
+    for (uint32_t position = 0; position < m_entities.size(); position++)
+    {
+        const uint32_t index = ToIndex(m_entities[position]);
+        if (index >= m_positions.size()) m_positions.resize(index + 1, NotFound);
+        m_positions[index] = position;
+    }
+
+    for (const auto& storage : m_storages)
+        if (storage != nullptr) storage->Take(registry, m_entities);
+}
+
+uint32_t WorldSnapshot::FindEntity(const Entity entity) const
+{
+    const uint32_t index = ToIndex(entity);
+    if (index >= m_positions.size()) return NotFound;
+
+    // an older version of the entity has the same index
+    const uint32_t position = m_positions[index];
+    return position != NotFound && m_entities[position] == entity ? position : NotFound;
+}
@@ -1,6 +1,14 @@
 #include "core/ecs.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
 #include "core/transform.hpp"
+#include "tools/log.hpp"
+#include "tools/thread_pool.hpp"
 
 using namespace bee;
 using namespace std;
@@ -8,43 +16,266 @@ using namespace entt;
 
 constexpr float kMaxDeltaTime = 1.0f / 30.0f;
 
+namespace
+{
+
+// The system whose Update runs on this thread, for the access checks.
+thread_local const System* t_runningSystem = nullptr;
+
+// The command buffer of this thread, and the ECS it belongs to.
+struct ThreadCommands
+{
+    uint64_t ecs = 0;
+    EntityCommandBuffer* buffer = nullptr;
+};
+thread_local ThreadCommands t_commands;
+std::atomic<uint64_t> g_nextEcsId = 1;
+std::atomic<size_t> g_nextSystemTypeId = 0;
+
+void AddSorted(std::vector<std::type_index>& types, const std::type_index& type)
+{
+    const auto it = std::lower_bound(types.begin(), types.end(), type);
+    if (it == types.end() || *it != type) types.insert(it, type);
+}
+
+bool ContainsSorted(const std::vector<std::type_index>& types, const std::type_index& type)
+{
+    return std::binary_search(types.begin(), types.end(), type);
+}
+
+bool Intersects(const std::vector<std::type_index>& a, const std::vector<std::type_index>& b)
+{
+    auto first = a.begin(), second = b.begin();
+    while (first != a.end() && second != b.end())
+    {
+        if (*first < *second)
+            ++first;
+        else if (*second < *first)
+            ++second;
+        else
+            return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+void bee::internal::RunSystem(System& system, const float dt)
+{
+    const auto start = chrono::steady_clock::now();
+    t_runningSystem = &system;
+    system.Update(dt);
+    t_runningSystem = nullptr;
+    system.m_updateTime = chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+}
+
+size_t bee::internal::NextSystemTypeId() { return g_nextSystemTypeId++; }
+
+void SystemAccess::AddRead(const std::type_index& type)
+{
+    Declared = true;
+    AddSorted(ReadTypes, type);
+}
+
+void SystemAccess::AddWrite(const std::type_index& type)
+{
+    Declared = true;
+    AddSorted(WriteTypes, type);
+}
+
+bool SystemAccess::CanRead(const std::type_index& type) const { return ContainsSorted(ReadTypes, type) || CanWrite(type); }
+
+bool SystemAccess::CanWrite(const std::type_index& type) const { return ContainsSorted(WriteTypes, type); }
+
+bool SystemAccess::ConflictsWith(const SystemAccess& other) const
+{
+    if (!Declared || !other.Declared) return true;
+    return Intersects(WriteTypes, other.WriteTypes) || Intersects(WriteTypes, other.ReadTypes) ||
+           Intersects(ReadTypes, other.WriteTypes);
+}
+
 void bee::EntityComponentSystem::RemoveSystems(const std::vector<std::unique_ptr<System>>::iterator start,
                                                const std::vector<std::unique_ptr<System>>::iterator end)
 {
     m_systems.erase(start, end);
+    ClearSystemLookup();
 }
 
-EntityComponentSystem::EntityComponentSystem() = default;
+void EntityComponentSystem::ClearSystemLookup()
+{
+    const size_t count = min(g_nextSystemTypeId.load(), MaxSystemTypes);
+    for (size_t i = 0; i < count; i++) m_systemLookup[i].store(nullptr, std::memory_order_relaxed);
+}
+
+EntityComponentSystem::EntityComponentSystem()
+    : m_systemLookup(std::make_unique<std::atomic<void*>[]>(MaxSystemTypes)), m_id(g_nextEcsId++)
+{
+}
 
 bee::EntityComponentSystem::~EntityComponentSystem() = default;
 
 void EntityComponentSystem::DeleteEntity(Entity e)
 {
-    // mark entity for deletion
+    CheckAccess<Entity>(true);
     assert(Registry.valid(e));
-    Registry.emplace_or_replace<Delete>(e);
 
-    // mark all of its children for deletion
-    auto* transform = Registry.try_get<Transform>(e);
-    if (transform != nullptr)
+    // collect the entity and all of its descendants in one pass, without recursion
+    m_deleteSubtree.clear();
+    m_deleteSubtree.push_back(e);
+    for (size_t i = 0; i < m_deleteSubtree.size(); i++)
     {
-        for (auto child : *transform)
-        {
-            DeleteEntity(child);
-        }
+        const auto* hierarchy = Registry.try_get<Hierarchy>(m_deleteSubtree[i]);
+        if (hierarchy == nullptr) continue;
+        for (auto child = hierarchy->FirstChild(); child != entt::null; child = Registry.get<Hierarchy>(child).GetNextChild())
+            m_deleteSubtree.push_back(child);
+    }
+
+    // mark them for deletion
+    const auto marked = std::remove_if(m_deleteSubtree.begin(), m_deleteSubtree.end(),
+                                       [this](const Entity entity) { return Registry.all_of<Delete>(entity); });
+    Registry.insert<Delete>(m_deleteSubtree.begin(), marked);
+}
+
+void EntityComponentSystem::UpdateWorldTransforms()
+{
+    // Start from the roots, an entity whose parent is gone counts as one. Walk the trees with a stack instead of
+    // recursion, the parent is always done before its children.
+    m_transformStack.clear();
+    for (const auto [entity, hierarchy] : Registry.view<const Hierarchy>().each())
+        if (!hierarchy.HasParent() || !Registry.valid(hierarchy.GetParent())) m_transformStack.push_back(entity);
+
+    while (!m_transformStack.empty())
+    {
+        const Entity entity = m_transformStack.back();
+        m_transformStack.pop_back();
+
+        const auto& [transform, hierarchy, world] = Registry.get<const Transform, const Hierarchy, WorldTransform>(entity);
+        const Entity parent = hierarchy.GetParent();
+        if (parent != entt::null && Registry.valid(parent))
+            world.WorldMatrix = Registry.get<const WorldTransform>(parent).WorldMatrix * transform.Local();
+        else
+            world.WorldMatrix = transform.Local();
+        world.TranslationWorld = glm::vec3(world.WorldMatrix[3]);
+
+        for (const auto child : hierarchy) m_transformStack.push_back(child);
     }
 }
 
 void EntityComponentSystem::UpdateSystems(float dt)
 {
     dt = min(dt, kMaxDeltaTime);
-    for (int i = 0; i < m_systems.size(); i++)
+    UpdateWorldTransforms();
+    if (m_scheduling == Scheduling::Serial)
+    {
+        for (int i = 0; i < m_systems.size(); i++)
+        {
+            if (!m_systems.at(i).get()->IsPause())
+            internal::RunSystem(*m_systems.at(i), dt);
+        }
+        return;
+    }
+
+    // Dependency graph of this frame: a system has to wait for every system before it (in priority order) it conflicts
+    // with. Put each system in the first wave after all of those, every wave can then run at the same time.
+    std::vector<System*> systems;
+    for (auto& system : m_systems)
+        if (!system->IsPause()) systems.push_back(system.get());
+
+    std::vector<int> waves(systems.size(), 0);
+    int waveCount = 0;
+    for (size_t i = 0; i < systems.size(); i++)
+    {
+        for (size_t j = 0; j < i; j++)
+        {
+            if (waves[j] >= waves[i] && systems[i]->GetAccess().ConflictsWith(systems[j]->GetAccess()))
+                waves[i] = waves[j] + 1;
+        }
+        waveCount = max(waveCount, waves[i] + 1);
+    }
+
+    std::vector<System*> wave;
+    std::vector<std::future<void>> tasks;
+    for (int w = 0; w < waveCount; w++)
+    {
+        wave.clear();
+        for (size_t i = 0; i < systems.size(); i++)
+            if (waves[i] == w) wave.push_back(systems[i]);
+
+        // the first system of the wave runs here, the others on the workers
+        tasks.clear();
+        for (size_t i = 1; i < wave.size(); i++) tasks.push_back(m_workers->Enqueue(internal::RunSystem, std::ref(*wave[i]), dt));
+        internal::RunSystem(*wave[0], dt);
+        for (auto& task : tasks) task.get();
+    }
+}
+
+void EntityComponentSystem::SetScheduling(const Scheduling scheduling)
+{
+    m_scheduling = scheduling;
+    if (m_scheduling == Scheduling::Parallel && !m_workers)
     {
-        if (!m_systems.at(i).get()->IsPause())
-        m_systems.at(i).get()->Update(dt);
+        const unsigned int threads = max(std::thread::hardware_concurrency(), 2u) - 1;
+        m_workers = std::make_unique<ThreadPool>(threads);
     }
 }
 
+void EntityComponentSystem::CheckAccess(const std::type_index& type, const bool write)
+{
+    const System* system = t_runningSystem;
+    if (system == nullptr || !system->GetAccess().Declared) return;
+    if (write ? system->GetAccess().CanWrite(type) : system->GetAccess().CanRead(type)) return;
+
+    const std::string violation =
+        fmt::format("{} {} {} without declaring it", system->Title.empty() ? typeid(*system).name() : system->Title,
+                    write ? "writes" : "reads", type.name());
+    Log::Error("Access violation: {}", violation);
+    std::lock_guard<std::mutex> lock(m_accessViolationsMutex);
+    m_accessViolations.push_back(violation);
+}
+
+std::vector<std::string> EntityComponentSystem::GetAccessViolations()
+{
+    std::lock_guard<std::mutex> lock(m_accessViolationsMutex);
+    return m_accessViolations;
+}
+
+void EntityComponentSystem::ClearAccessViolations()
+{
+    std::lock_guard<std::mutex> lock(m_accessViolationsMutex);
+    m_accessViolations.clear();
+}
+
+EntityCommandBuffer& EntityComponentSystem::Commands()
+{
+    assert(!m_playingBack);
+    if (t_commands.ecs != m_id)
+    {
+        std::lock_guard<std::mutex> lock(m_commandBuffersMutex);
+        m_commandBuffers.push_back(std::make_unique<EntityCommandBuffer>());
+        t_commands = {m_id, m_commandBuffers.back().get()};
+    }
+    return *t_commands.buffer;
+}
+
+void EntityComponentSystem::PlaybackCommands()
+{
+    m_playbackOrder.clear();
+    for (auto& buffer : m_commandBuffers)
+        for (size_t i = 0; i < buffer->m_commands.size(); i++) m_playbackOrder.emplace_back(buffer.get(), i);
+    if (m_playbackOrder.empty()) return;
+
+    // stable, so equal keys keep the order of the buffers and the order of recording
+    std::stable_sort(m_playbackOrder.begin(), m_playbackOrder.end(),
+                     [](const auto& a, const auto& b)
+                     { return a.first->m_commands[a.second].sortKey < b.first->m_commands[b.second].sortKey; });
+
+    m_playingBack = true;
+    for (const auto& [buffer, index] : m_playbackOrder) buffer->Playback(buffer->m_commands[index], *this);
+    m_playingBack = false;
+
+    for (auto& buffer : m_commandBuffers) buffer->Clear();
+}
+
 void EntityComponentSystem::RenderSystems()
 {
     for (auto& s : m_systems) s->Render();
@@ -52,13 +283,13 @@ void EntityComponentSystem::RenderSystems()
 
 void EntityComponentSystem::RemovedDeleted()
 {
-    bool isDeleteQueueEmpty;
-    do
+    // DeleteEntity marks whole subtrees, so this normally takes a single batch. Destroying entities can still cause
+    // other entities to be deleted, so we need to do this in a loop.
+    while (true)
     {
-        // Deleting entities can cause other entities to be deleted,
-        // so we need to do this in a loop
-        const auto del = Registry.view<Delete>();
-        Registry.destroy(del.begin(), del.end());
-        isDeleteQueueEmpty = del.empty();
-    } while (!isDeleteQueueEmpty);
+        const auto marked = Registry.view<Delete>();
+        if (marked.empty()) break;
+        m_deleteBatch.assign(marked.begin(), marked.end());
+        Registry.destroy(m_deleteBatch.begin(), m_deleteBatch.end());
+    }
 }
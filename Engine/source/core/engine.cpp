@@ -12,6 +12,7 @@
 #include "core/resources.hpp"
 #include "core/transform.hpp"
 #include "rendering/debug_render.hpp"
+#include "tools/frame_arena.hpp"
 #include "tools/inspector.hpp"
 #include "tools/log.hpp"
 #include "tools/profiler.hpp"
@@ -44,12 +45,13 @@ void EngineClass::Initialize()
     if (!m_headless)
     {
         m_input = new bee::Input();
-        m_debugRenderer = new bee::DebugRenderer();
         m_inspector = new bee::Inspector();
         m_serializer = new bee::Serializer();
         m_profiler = new bee::Profiler();
     }
 
+    // headless it draws nothing, but systems can keep calling it
+    m_debugRenderer = new bee::DebugRenderer();
     m_ECS = new EntityComponentSystem();
     #ifdef STEAM_API_WINDOWS
         m_steamInputSystem = new bee::SteamInputSystem();
@@ -82,11 +84,11 @@ void EngineClass::Shutdown()
         delete m_profiler;
         delete m_serializer;
         delete m_inspector;
-        delete m_debugRenderer;
         delete m_input;
         delete m_inputWrapper;
     }
 
+    delete m_debugRenderer;
     delete m_audio;
 
     if (!m_headless)
@@ -126,6 +128,7 @@ void EngineClass::Run()
             m_game->Update(dt);
             m_game->Render();
         }
+        m_ECS->PlaybackCommands();
 
         #ifdef STEAM_API_WINDOWS
         m_steamInputSystem->Update();
@@ -135,6 +138,8 @@ void EngineClass::Run()
         m_inputWrapper->Update();
         m_audio->Update();
         m_ECS->UpdateSystems(dt);
+        m_ECS->PlaybackCommands();
+        m_ECS->UpdateWorldTransforms();
         m_device->BeginFrame();
         m_ECS->RenderSystems();
         m_debugRenderer->Render();
@@ -143,6 +148,9 @@ void EngineClass::Run()
         m_device->EndFrame();
         m_device->Update();
 
+        // nothing allocated from the frame arenas may live past this point
+        ResetFrameArenas();
+
         time = ctime;
     }
 }
@@ -0,0 +1,112 @@
+#include "core/entity_command_buffer.hpp"
+
+#include "core/ecs.hpp"
+
+using namespace bee;
+
+namespace
+{
+
+// Temporary handles use a version the registry does not hand out in practice (entt's 20 bit index, 12 bit version),
+// and count their index down from the top of the range, far away from real entities.
+constexpr uint32_t kIndexBits = 20;
+constexpr uint32_t kIndexMask = (1u << kIndexBits) - 1;
+constexpr uint32_t kTemporaryVersion = 0xFFE;
+constexpr uint32_t kMaxTemporaryEntities = 1u << (kIndexBits - 1);
+
+uint32_t ToTemporaryIndex(const Entity entity) { return kIndexMask - (static_cast<uint32_t>(entity) & kIndexMask); }
+
+}  // namespace
+
+EntityCommandBuffer::~EntityCommandBuffer() { Clear(); }
+
+Entity EntityCommandBuffer::Create()
+{
+    const auto index = static_cast<uint32_t>(m_created.size());
+    assert(index < kMaxTemporaryEntities);
+    const auto entity = static_cast<Entity>((kTemporaryVersion << kIndexBits) | (kIndexMask - index));
+    m_created.push_back(entt::null);
+    Record(CommandType::Create, entity);
+    return entity;
+}
+
+void EntityCommandBuffer::Destroy(const Entity entity) { Record(CommandType::Destroy, entity); }
+
+bool EntityCommandBuffer::IsTemporary(const Entity entity)
+{
+    const auto value = static_cast<uint32_t>(entity);
+    return value >> kIndexBits == kTemporaryVersion && ToTemporaryIndex(entity) < kMaxTemporaryEntities;
+}
+
+void EntityCommandBuffer::Clear()
+{
+    // payloads that were not played back still need their destructor
+    for (auto& command : m_commands)
+        if (command.payload != nullptr) command.function(nullptr, entt::null, command.payload);
+
+    m_commands.clear();
+    m_created.clear();
+    m_largeAllocations.clear();
+    m_chunk = 0;
+    m_offset = 0;
+    m_sortKey = 0;
+}
+
+void* EntityCommandBuffer::Allocate(const size_t size, const size_t alignment)
+{
+    if (size + alignment > ChunkSize)
+    {
+        m_largeAllocations.push_back(std::make_unique<std::byte[]>(size + alignment));
+        void* memory = m_largeAllocations.back().get();
+        size_t space = size + alignment;
+        return std::align(alignment, size, memory, space);
+    }
+
+    while (true)
+    {
+        if (m_chunk == m_chunks.size()) m_chunks.push_back(std::make_unique<std::byte[]>(ChunkSize));
+
+        void* memory = m_chunks[m_chunk].get() + m_offset;
+        size_t space = ChunkSize - m_offset;
+        if (std::align(alignment, size, memory, space) != nullptr)
+        {
+            m_offset = ChunkSize - space + size;
+            return memory;
+        }
+        m_chunk++;
+        m_offset = 0;
+    }
+}
+
+void EntityCommandBuffer::Record(const CommandType type, const Entity entity, const ComponentFunction function, void* payload)
+{
+    m_commands.push_back({type, entity, m_sortKey, function, payload});
+}
+
+Entity EntityCommandBuffer::Resolve(const Entity entity) const
+{
+    if (!IsTemporary(entity)) return entity;
+    const uint32_t index = ToTemporaryIndex(entity);
+    return index < m_created.size() ? m_created[index] : entt::null;
+}
+
+void EntityCommandBuffer::Playback(Command& command, EntityComponentSystem& ecs)
+{
+    if (command.type == CommandType::Create)
+    {
+        m_created[ToTemporaryIndex(command.entity)] = ecs.Registry.create();
+        return;
+    }
+
+    const Entity entity = Resolve(command.entity);
+    const bool alive = ecs.Registry.valid(entity) && !ecs.Registry.all_of<Delete>(entity);
+    if (command.type == CommandType::Destroy)
+    {
+        if (alive) ecs.DeleteEntity(entity);
+        return;
+    }
+
+    // a dropped command still destroys its payload
+    command.function(alive ? &ecs : nullptr, entity, command.payload);
+    command.payload = nullptr;
+}
@@ -4,6 +4,7 @@
 
 #if defined(BEE_PLATFORM_PC)
 #include <filesystem>
+#include <Windows.h>
 #endif
 
 #include "core/fileio.hpp"
@@ -74,6 +75,82 @@ bool FileIO::WriteBinaryFile(Directory type, const std::string& path, const std:
     return true;
 }
 
+MappedFile FileIO::MapFile(Directory type, const std::string& path)
+{
+    MappedFile result;
+    const auto fullPath = GetPath(type, path);
+#if defined(BEE_PLATFORM_PC)
+    HANDLE file = CreateFileA(fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        Log::Error("File {} with full path {} was not found!", path, fullPath);
+        return result;
+    }
+    result.m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        result.Close();
+        return result;
+    }
+
+    result.m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (result.m_mapping == nullptr)
+    {
+        Log::Error("File {} could not be mapped into memory!", fullPath);
+        result.Close();
+        return result;
+    }
+    result.m_data = static_cast<const char*>(MapViewOfFile(result.m_mapping, FILE_MAP_READ, 0, 0, 0));
+    result.m_size = result.m_data != nullptr ? static_cast<size_t>(size.QuadPart) : 0;
+    if (result.m_data == nullptr) result.Close();
+#else
+    result.m_buffer = ReadBinaryFile(type, path);
+    if (!result.m_buffer.empty())
+    {
+        result.m_data = result.m_buffer.data();
+        result.m_size = result.m_buffer.size();
+    }
+#endif
+    return result;
+}
+
+MappedFile::~MappedFile() { Close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this == &other) return *this;
+    Close();
+    m_data = other.m_data;
+    m_size = other.m_size;
+    m_file = other.m_file;
+    m_mapping = other.m_mapping;
+    m_buffer = std::move(other.m_buffer);
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_file = nullptr;
+    other.m_mapping = nullptr;
+    return *this;
+}
+
+void MappedFile::Close()
+{
+#if defined(BEE_PLATFORM_PC)
+    if (m_mapping != nullptr && m_data != nullptr) UnmapViewOfFile(m_data);
+    if (m_mapping != nullptr) CloseHandle(m_mapping);
+    if (m_file != nullptr) CloseHandle(m_file);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_file = nullptr;
+    m_mapping = nullptr;
+    m_buffer.clear();
+}
+
 std::string FileIO::GetPath(Directory type, const std::string& path)
 {
     // Get path taking the type into account.
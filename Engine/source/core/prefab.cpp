@@ -0,0 +1,129 @@
+#include "core/prefab.hpp"
+
+#include <algorithm>
+
+#include "core/engine.hpp"
+#include "core/transform.hpp"
+#include "tools/log.hpp"
+
+using namespace bee;
+
+namespace
+{
+
+struct ComponentType
+{
+    entt::id_type type;
+    void (*copy)(const entt::registry& fromRegistry, const std::vector<Entity>& from, entt::registry& toRegistry,
+                 const std::vector<Entity>& to, const PrefabEntityMap& map);  // null to leave it out
+};
+
+std::vector<ComponentType>& ComponentTypes()
+{
+    // transforms are copied by the prefab itself, hierarchies and world transforms come with them and the delete tag
+    // must not be copied
+    static std::vector<ComponentType> types = {{entt::type_hash<Transform>::value(), nullptr},
+                                               {entt::type_hash<Hierarchy>::value(), nullptr},
+                                               {entt::type_hash<WorldTransform>::value(), nullptr},
+                                               {entt::type_hash<Delete>::value(), nullptr},
+                                               {entt::type_hash<Entity>::value(), nullptr}};
+    return types;
+}
+
+}  // namespace
+
+Entity PrefabEntityMap::operator()(const Entity entity) const
+{
+    const auto it = std::lower_bound(m_pairs.begin(), m_pairs.end(), entity,
+                                     [](const std::pair<Entity, Entity>& pair, const Entity e) { return pair.first < e; });
+    return it != m_pairs.end() && it->first == entity ? it->second : entity;
+}
+
+void Prefab::AddComponentType(const entt::id_type type, const CopyFunction copy)
+{
+    auto& types = ComponentTypes();
+    const auto it = std::find_if(types.begin(), types.end(), [type](const ComponentType& t) { return t.type == type; });
+    if (it != types.end())
+        it->copy = copy;
+    else
+        types.push_back({type, copy});
+}
+
+Prefab::Prefab(const Entity root, const std::vector<Entity>& extraRoots)
+{
+    auto& registry = Engine.ECS().Registry;
+
+    // depth first, so parents come before their children and children keep their order
+    std::vector<std::pair<Entity, int>> stack;
+    for (auto it = extraRoots.rbegin(); it != extraRoots.rend(); ++it) stack.emplace_back(*it, -1);
+    stack.emplace_back(root, -1);
+    while (!stack.empty())
+    {
+        const auto [entity, parent] = stack.back();
+        stack.pop_back();
+        assert(registry.all_of<Transform>(entity));
+
+        const int index = static_cast<int>(m_originals.size());
+        m_originals.push_back(entity);
+        m_parents.push_back(parent);
+        const auto& hierarchy = registry.get<Hierarchy>(entity);
+        for (auto child = hierarchy.LastChild(); child != entt::null; child = registry.get<Hierarchy>(child).GetPreviousChild())
+            stack.emplace_back(child, index);
+    }
+
+    m_originalOrder.resize(m_originals.size());
+    for (size_t i = 0; i < m_originals.size(); i++) m_originalOrder[i] = static_cast<int>(i);
+    std::sort(m_originalOrder.begin(), m_originalOrder.end(),
+              [this](const int a, const int b) { return m_originals[a] < m_originals[b]; });
+
+    m_entities.resize(m_originals.size());
+    m_registry.create(m_entities.begin(), m_entities.end());
+
+    // the hierarchy is kept in m_parents, the copies only need the local transforms
+    for (size_t i = 0; i < m_originals.size(); i++)
+        m_registry.emplace<Transform>(m_entities[i], registry.get<Transform>(m_originals[i]));
+
+    // an empty map keeps every reference as it is
+    const PrefabEntityMap map;
+    for (const auto& type : ComponentTypes())
+        if (type.copy != nullptr) type.copy(registry, m_originals, m_registry, m_entities, map);
+
+#ifdef _DEBUG
+    for (const auto [id, storage] : registry.storage())
+    {
+        if (std::any_of(ComponentTypes().begin(), ComponentTypes().end(), [id](const ComponentType& t) { return t.type == id; }))
+            continue;
+        for (const auto entity : m_originals)
+        {
+            if (!storage.contains(entity)) continue;
+            Log::Warn("Prefab: {} of entity {} is not registered with the prefab system and is left out.",
+                      std::string(storage.type().name()), entt::to_integral(entity));
+            break;
+        }
+    }
+#endif
+}
+
+Entity Prefab::Instantiate(std::vector<Entity>* entities) const
+{
+    auto& registry = Engine.ECS().Registry;
+
+    std::vector<Entity> instance;
+    auto& copies = entities != nullptr ? *entities : instance;
+    copies.resize(m_entities.size());
+    registry.create(copies.begin(), copies.end());
+
+    PrefabEntityMap map;
+    map.m_pairs.reserve(m_originals.size());
+    for (const int index : m_originalOrder) map.m_pairs.emplace_back(m_originals[index], copies[index]);
+
+    for (size_t i = 0; i < m_entities.size(); i++)
+    {
+        registry.emplace<Transform>(copies[i], m_registry.get<Transform>(m_entities[i]));
+        if (m_parents[i] >= 0) registry.get<Hierarchy>(copies[i]).SetParent(copies[m_parents[i]]);
+    }
+    for (const auto& type : ComponentTypes())
+        if (type.copy != nullptr) type.copy(m_registry, m_entities, registry, copies, map);
+
+    return copies.front();
+}
@@ -0,0 +1,111 @@
+#include "core/simulation_lod.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/engine.hpp"
+#include "core/transform.hpp"
+#include "rendering/render_components.hpp"
+
+#ifdef BEE_INSPECTOR
+#include <imgui/imgui.h>
+#endif
+
+using namespace bee;
+
+namespace
+{
+// Entities just outside the view still count as on screen, so units walking in are not popping.
+constexpr float ScreenMargin = 1.1f;
+}  // namespace
+
+const SimulationLOD* bee::FindSimulationLOD(const entt::registry& registry, Entity entity)
+{
+    while (entity != entt::null && registry.valid(entity))
+    {
+        if (const auto* lod = registry.try_get<SimulationLOD>(entity)) return lod;
+        const auto* hierarchy = registry.try_get<Hierarchy>(entity);
+        if (hierarchy == nullptr) return nullptr;
+        entity = hierarchy->GetParent();
+    }
+    return nullptr;
+}
+
+SimulationLODSystem::SimulationLODSystem(const float fullDistance, const int reducedInterval,
+                                         const int reducedDecisionInterval, const int dormantDecisionInterval)
+    : m_fullDistance(fullDistance),
+      m_reducedInterval(std::max(1, reducedInterval)),
+      m_reducedDecisionInterval(std::max(1, reducedDecisionInterval)),
+      m_dormantDecisionInterval(std::max(1, dormantDecisionInterval))
+{
+    Title = "Simulation LOD";
+    Reads<Camera, Transform>();
+    Writes<SimulationLOD>();
+}
+
+void SimulationLODSystem::Update(const float dt)
+{
+    m_frame++;
+    m_counts = {};
+
+    auto& registry = Engine.ECS().Registry;
+    const Camera* camera = nullptr;
+    for (const auto& [entity, cameraComponent, transform] : registry.view<Camera, Transform>().each())
+    {
+        camera = &cameraComponent;
+        break;
+    }
+    // how much bigger the lens makes things look than a 90 degree one
+    const float zoom = camera != nullptr && camera->Projection[1][1] > 0.0f ? camera->Projection[1][1] : 1.0f;
+
+    for (const auto& [entity, lod, transform] : registry.view<SimulationLOD, Transform>().each())
+    {
+        lod.tier = SimulationTier::Full;
+        if (camera != nullptr)
+        {
+            const glm::vec4 clip = camera->VP * glm::vec4(transform.Translation, 1.0f);
+            const float edge = clip.w * ScreenMargin;
+            const bool onScreen = clip.w > 0.0f && std::abs(clip.x) <= edge && std::abs(clip.y) <= edge;
+            if (!onScreen)
+                lod.tier = SimulationTier::Dormant;
+            else if (clip.w / zoom > m_fullDistance)
+                lod.tier = SimulationTier::Reduced;
+        }
+        m_counts[static_cast<size_t>(lod.tier)]++;
+
+        // reduced entities take turns by id, so every frame does about the same amount of cosmetic work
+        switch (lod.tier)
+        {
+            case SimulationTier::Full:
+                lod.cosmeticUpdate = true;
+                lod.decisionInterval = 1;
+                break;
+            case SimulationTier::Reduced:
+                lod.cosmeticUpdate = (m_frame + entt::to_integral(entity)) % static_cast<uint32_t>(m_reducedInterval) == 0;
+                lod.decisionInterval = m_reducedDecisionInterval;
+                break;
+            case SimulationTier::Dormant:
+                lod.cosmeticUpdate = false;
+                lod.decisionInterval = m_dormantDecisionInterval;
+                break;
+        }
+
+        const float pendingTime = std::min(lod.skippedTime + dt, MaxCatchUpTime);
+        lod.cosmeticDeltaTime = lod.cosmeticUpdate ? pendingTime : 0.0f;
+        lod.skippedTime = lod.cosmeticUpdate ? 0.0f : pendingTime;
+    }
+}
+
+#ifdef BEE_INSPECTOR
+void SimulationLODSystem::Inspect()
+{
+    ImGui::Begin("Simulation LOD");
+    ImGui::DragFloat("Full distance", &m_fullDistance, 1.0f, 0.0f, 1000.0f);
+    ImGui::SliderInt("Reduced interval", &m_reducedInterval, 1, 16);
+    ImGui::SliderInt("Reduced decision interval", &m_reducedDecisionInterval, 1, 8);
+    ImGui::SliderInt("Dormant decision interval", &m_dormantDecisionInterval, 1, 8);
+    ImGui::Text("Full: %d, reduced: %d, dormant: %d", GetCount(SimulationTier::Full), GetCount(SimulationTier::Reduced),
+                GetCount(SimulationTier::Dormant));
+    ImGui::End();
+}
+#endif
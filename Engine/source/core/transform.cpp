@@ -8,47 +8,70 @@
 using namespace bee;
 using namespace glm;
 
-void Transform::SetParent(Entity parent)
+void Hierarchy::SetParent(Entity parent)
 {
-    assert(Engine.ECS().Registry.valid(parent));
-    auto& parentTransform = Engine.ECS().Registry.get<Transform>(parent);
-    // We can always get the entity from the transform.
-    const Entity entity = to_entity(Engine.ECS().Registry, *this);
-    parentTransform.AddChild(entity);
+    auto& registry = Engine.ECS().Registry;
+    assert(registry.valid(parent));
+    // We can always get the entity from the hierarchy.
+    const Entity entity = to_entity(registry, *this);
+    if (m_parent != entt::null) Unlink(registry, entity, *this);
+    registry.get<Hierarchy>(parent).AddChild(entity);
     m_parent = parent;
 }
 
-void Transform::AddChild(Entity child)
+void Hierarchy::AddChild(Entity child)
 {
-    assert(Engine.ECS().Registry.valid(child));
-    if (m_first == entt::null)
-    {
+    auto& registry = Engine.ECS().Registry;
+    assert(registry.valid(child));
+    auto& childHierarchy = registry.get<Hierarchy>(child);
+    childHierarchy.m_previous = m_last;
+    childHierarchy.m_next = entt::null;
+    if (m_last == entt::null)
         m_first = child;
-    }
     else
-    {
-        auto itr = m_first;
-        while (true)
-        {
-            auto& t = Engine.ECS().Registry.get<Transform>(itr);
-            if (t.m_next == entt::null)
-            {
-                t.m_next = child;
-                break;
-            }
-            itr = t.m_next;
-        }
-    }
+        registry.get<Hierarchy>(m_last).m_next = child;
+    m_last = child;
+}
+
+void Hierarchy::Unlink(entt::registry& registry, Entity child, Hierarchy& childHierarchy)
+{
+    // Siblings always point at each other, but the parent may have let go of its children with NoChildren.
+    auto* parent = registry.valid(childHierarchy.m_parent) ? registry.try_get<Hierarchy>(childHierarchy.m_parent) : nullptr;
+    if (childHierarchy.m_previous != entt::null)
+        registry.get<Hierarchy>(childHierarchy.m_previous).m_next = childHierarchy.m_next;
+    else if (parent != nullptr && parent->m_first == child)
+        parent->m_first = childHierarchy.m_next;
+
+    if (childHierarchy.m_next != entt::null)
+        registry.get<Hierarchy>(childHierarchy.m_next).m_previous = childHierarchy.m_previous;
+    else if (parent != nullptr && parent->m_last == child)
+        parent->m_last = childHierarchy.m_previous;
+
+    childHierarchy.m_parent = entt::null;
+    childHierarchy.m_previous = entt::null;
+    childHierarchy.m_next = entt::null;
+}
+
+void Hierarchy::OnHierarchyDestroy(entt::registry& registry, entt::entity entity)
+{
+    // Deleting the children of the entity is done by DeleteEntity() in ecs.hpp.
+    // Leave the sibling list of the parent intact. Not needed if the parent goes as well, like when a subtree is deleted.
+    auto& hierarchy = registry.get<Hierarchy>(entity);
+    if (hierarchy.m_parent != entt::null && registry.valid(hierarchy.m_parent) && !registry.all_of<Delete>(hierarchy.m_parent))
+        Unlink(registry, entity, hierarchy);
 }
 
 void Transform::OnTransformCreate(entt::registry& registry, entt::entity entity)
 {
+    // A copied transform is not part of the hierarchy of the one it was copied from, it starts without links.
+    registry.emplace_or_replace<Hierarchy>(entity);
+    registry.emplace_or_replace<WorldTransform>(entity);
 }
 
 void Transform::OnTransformDestroy(entt::registry& registry, entt::entity entity)
 {
-    // Delete all children of the entity.
-    // Note: Functionality of this function was moved in DeleteEntity() in ecs.hpp
+    registry.remove<Hierarchy>(entity);
+    registry.remove<WorldTransform>(entity);
 }
 
 void bee::Decompose(const mat4& transform, vec3& translation, vec3& scale, quat& rotation)
@@ -68,39 +91,30 @@ void bee::Decompose(const mat4& transform, vec3& translation, vec3& scale, quat&
 }
 
 // Iterator implementation
-Transform::Iterator::Iterator(entt::entity ent) : m_current(ent) {}
+Hierarchy::Iterator::Iterator(entt::entity ent) : m_current(ent) {}
 
 // Iterator implementation
-Transform::Iterator& Transform::Iterator::operator++()
+Hierarchy::Iterator& Hierarchy::Iterator::operator++()
 {
     assert(Engine.ECS().Registry.valid(m_current));
-    auto& t = Engine.ECS().Registry.get<Transform>(m_current);
-    m_current = t.m_next;
+    auto& h = Engine.ECS().Registry.get<Hierarchy>(m_current);
+    m_current = h.m_next;
     return *this;
 }
 
 // Iterator implementation
-bool Transform::Iterator::operator!=(const Iterator& iterator) { return m_current != iterator.m_current; }
+bool Hierarchy::Iterator::operator!=(const Iterator& iterator) { return m_current != iterator.m_current; }
 
 // Iterator implementation
-Entity Transform::Iterator::operator*() { return m_current; }
+Entity Hierarchy::Iterator::operator*() { return m_current; }
 
 // Transform implementation
-inline glm::mat4 Transform::World() const
+glm::mat4 Transform::Local() const
 {
     const auto translation = glm::translate(glm::mat4(1.0f), Translation);
     const auto rotation = glm::toMat4(Rotation);
     const auto scale = glm::scale(glm::mat4(1.0f), Scale);
-    if (m_parent == entt::null) return translation * rotation * scale;
-    assert(Engine.ECS().Registry.valid(m_parent));
-    const auto& parent = Engine.ECS().Registry.get<Transform>(m_parent);
-    return parent.World() * translation * rotation * scale;
-}
-
-glm::vec3 Transform::WorldTranslation() const
-{
-    const glm::mat4 worldMatrix = World();
-    return glm::vec3(worldMatrix[3][0], worldMatrix[3][1], worldMatrix[3][2]);
+    return translation * rotation * scale;
 }
 
 void bee::Transform::SubscribeToEvents()
@@ -108,6 +122,9 @@ void bee::Transform::SubscribeToEvents()
     // We subscribe to the creation and destruction of the Transform component.
     Engine.ECS().Registry.on_construct<Transform>().connect<&Transform::OnTransformCreate>();
     Engine.ECS().Registry.on_destroy<Transform>().connect<&Transform::OnTransformDestroy>();
+    // The links are taken out when the hierarchy goes, which may be before or after the transform when an entity is
+    // destroyed.
+    Engine.ECS().Registry.on_destroy<Hierarchy>().connect<&Hierarchy::OnHierarchyDestroy>();
 }
 
 void bee::Transform::UnsubscribeToEvents()
@@ -115,37 +132,18 @@ void bee::Transform::UnsubscribeToEvents()
     // Un-subscribe to the events of the ECS.
     Engine.ECS().Registry.on_construct<Transform>().disconnect<&Transform::OnTransformCreate>();
     Engine.ECS().Registry.on_destroy<Transform>().disconnect<&Transform::OnTransformDestroy>();
+    Engine.ECS().Registry.on_destroy<Hierarchy>().disconnect<&Hierarchy::OnHierarchyDestroy>();
 }
 
-void Transform::RemoveChild(Entity child)
+void Hierarchy::RemoveChild(Entity child)
 {
-    assert(Engine.ECS().Registry.valid(child));
-
-    if (m_first == entt::null)
+    auto& registry = Engine.ECS().Registry;
+    assert(registry.valid(child));
+    auto& childHierarchy = registry.get<Hierarchy>(child);
+    if (childHierarchy.m_parent == entt::null || &registry.get<Hierarchy>(childHierarchy.m_parent) != this)
     {
-        // No children to remove
+        // Not one of our children
         return;
     }
-
-    if (m_first == child)
-    {
-        // If the child to remove is the first child, update the m_first pointer
-        m_first = Engine.ECS().Registry.get<Transform>(m_first).m_next;
-    }
-    else
-    {
-        // Traverse the list to find the child to remove
-        auto itr = m_first;
-        while (itr != entt::null)
-        {
-            auto& t = Engine.ECS().Registry.get<Transform>(itr);
-            if (t.m_next == child)
-            {
-                // Bypass the child to remove it
-                t.m_next = Engine.ECS().Registry.get<Transform>(child).m_next;
-                break;
-            }
-            itr = t.m_next;
-        }
-    }
+    Unlink(registry, child, childHierarchy);
 }
@@ -106,15 +106,15 @@ void lvle::Brush::FindCoveredTileIndices()
 
 void lvle::Brush::RemovePreviewModel()
 {
-    auto view = Engine.ECS().Registry.view<bee::Transform, PreviewModelTag>();
+    auto view = Engine.ECS().Registry.view<bee::Hierarchy, PreviewModelTag>();
     for (auto entity : view)
     {
-        auto [transform, previewModelTag] = view.get(entity);
-        if(transform.GetParent() == m_previewEntity);
+        auto [hierarchy, previewModelTag] = view.get(entity);
+        if(hierarchy.GetParent() == m_previewEntity);
         {
             Engine.ECS().DeleteEntity(entity);
-            auto& previewTransform = Engine.ECS().Registry.get<Transform>(m_previewEntity);
-            previewTransform.NoChildren();
+            auto& previewHierarchy = Engine.ECS().Registry.get<Hierarchy>(m_previewEntity);
+            previewHierarchy.NoChildren();
         }
     }
 }
@@ -140,7 +140,7 @@ void lvle::Brush::SnapBrush(glm::vec3& intersectionPoint)
             int x = static_cast<int>((intersectionPoint.x + terrainSize.x / 2.0f) / terrain.m_data->m_step + 0.5f);
             int y = static_cast<int>((intersectionPoint.y + terrainSize.y / 2.0f) / terrain.m_data->m_step + 0.5f);
             m_hoveredVertexIndex = x + y * (terrain.m_data->m_width + 1);
-            intersectionPoint = terrain.m_data->m_vertices[m_hoveredVertexIndex].position;
+            intersectionPoint = terrain.m_data->m_positions[m_hoveredVertexIndex];
             FindBrushCoveredVertexIndices();
             FindCoveredTileIndices();
             break;
@@ -206,7 +206,7 @@ void lvle::Brush::Clear()
 
 void lvle::Brush::RotatePreviewModel(const float& degreesOffset)
 {
-    if (!Engine.ECS().Registry.get<Transform>(m_previewEntity).HasChildern()) return;
+    if (!Engine.ECS().Registry.get<Hierarchy>(m_previewEntity).HasChildern()) return;
     if (m_previewEntity != entt::null)
     {
         auto& transform = Engine.ECS().Registry.get<Transform>(m_previewEntity);
@@ -238,7 +238,7 @@ void lvle::Brush::Render(const glm::vec3& intersectionPoint)
     {
         case SnapMode::NoSnap:
         {
-            if (Engine.ECS().Registry.get<bee::Transform>(m_previewEntity).HasChildern())
+            if (Engine.ECS().Registry.get<bee::Hierarchy>(m_previewEntity).HasChildern())
             {
                 auto& diskCollider = Engine.ECS().Registry.get<bee::physics::DiskCollider>(m_previewEntity);
                 Engine.DebugRenderer().AddCircle(DebugCategory::Editor, intersectionPoint + vec3(0.0f, 0.0f, 0.05f),
@@ -257,8 +257,8 @@ void lvle::Brush::Render(const glm::vec3& intersectionPoint)
             for (int i = 0; i < m_vertexIndices.size(); i++)
             {
                 Engine.DebugRenderer().AddLine(
-                    DebugCategory::Editor, terrain.m_data->m_vertices[m_vertexIndices[i]].position,
-                    terrain.m_data->m_vertices[m_vertexIndices[i]].position + vec3(0.0f, 0.0f, 1.0f),
+                    DebugCategory::Editor, terrain.m_data->m_positions[m_vertexIndices[i]],
+                    terrain.m_data->m_positions[m_vertexIndices[i]] + vec3(0.0f, 0.0f, 1.0f),
                     m_brushColor);
             }
             Engine.DebugRenderer().AddCircle(
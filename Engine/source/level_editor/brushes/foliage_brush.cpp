@@ -250,10 +250,10 @@ void lvle::FoliageBrush::SaveFoliageInstances(const std::string& filename)
         newTransform = transform;
         newTransform.Name = foliageComponent.name;
         glm::vec3 color = glm::vec3(1.0f);
-        auto meshRendererView = bee::Engine.ECS().Registry.view<bee::MeshRenderer, bee::Transform>();
-        for (auto [childEntity, meshRenderer, childTransform] : meshRendererView.each())
+        auto meshRendererView = bee::Engine.ECS().Registry.view<bee::MeshRenderer, bee::Hierarchy>();
+        for (auto [childEntity, meshRenderer, childHierarchy] : meshRendererView.each())
         {
-            if (childTransform.GetParent() == entity)
+            if (childHierarchy.GetParent() == entity)
                 color = glm::vec3(meshRenderer.constant_data.red, meshRenderer.constant_data.green,
                                   meshRenderer.constant_data.blue);
         }
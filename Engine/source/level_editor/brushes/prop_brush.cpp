@@ -26,7 +26,7 @@ void lvle::PropBrush::SetPreviewModel(const std::string& objectHandle)
         auto modelEntity = Engine.ECS().CreateEntity();
         auto& modelTransform = Engine.ECS().CreateComponent<Transform>(modelEntity);
         modelTransform.Name = "Model";
-        modelTransform.SetParent(m_previewEntity);
+        Engine.ECS().Registry.get<Hierarchy>(modelEntity).SetParent(m_previewEntity);
         modelTransform.Translation += propTemplate.modelOffset.Translation;
         auto modelEuler = glm::eulerAngles(modelTransform.Rotation);
         auto modelOffsetEuler = glm::eulerAngles(propTemplate.modelOffset.Rotation);
@@ -71,7 +71,7 @@ void lvle::PropBrush::Update(glm::vec3& intersectionPoint, const std::string obj
 
 void lvle::PropBrush::RotatePreviewModel(const float& degreesOffset)
 {
-    if (!Engine.ECS().Registry.get<Transform>(m_previewEntity).HasChildern()) return;
+    if (!Engine.ECS().Registry.get<Hierarchy>(m_previewEntity).HasChildern()) return;
     if (m_previewEntity != entt::null)
     {
         auto& transform = Engine.ECS().Registry.get<Transform>(m_previewEntity);
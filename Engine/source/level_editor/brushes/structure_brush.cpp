@@ -35,7 +35,7 @@ void lvle::StructureBrush::SetPreviewModel(const std::string& objectHandle)
         auto modelEntity = Engine.ECS().CreateEntity();
         auto& modelTransform = Engine.ECS().CreateComponent<Transform>(modelEntity);
             modelTransform.Name = "Model";
-            modelTransform.SetParent(m_previewEntity);
+            Engine.ECS().Registry.get<Hierarchy>(modelEntity).SetParent(m_previewEntity);
             modelTransform.Translation += structureTemplate.modelOffset.Translation;
         auto modelEuler = glm::eulerAngles(modelTransform.Rotation);
         auto modelOffsetEuler = glm::eulerAngles(structureTemplate.modelOffset.Rotation);
@@ -87,7 +87,7 @@ int lvle::StructureBrush::CalculateSmallGridIndex(const glm::vec3& intersectionP
 
 void lvle::StructureBrush::RotatePreviewModel(const float& degreesOffset)
 {
-    if (!Engine.ECS().Registry.get<Transform>(m_previewEntity).HasChildern()) return;
+    if (!Engine.ECS().Registry.get<Hierarchy>(m_previewEntity).HasChildern()) return;
     if (m_previewEntity != entt::null)
     {
         auto& transform = Engine.ECS().Registry.get<Transform>(m_previewEntity);
@@ -39,6 +39,7 @@ void lvle::TerraformBrush::Terraform(const float deltaTime)
         default:
             break;
     }
+    Engine.ECS().GetSystem<TerrainSystem>().MarkDirty(m_vertexIndices);
 
     // Update actors' vertical positions
     static float dtSum;
@@ -61,9 +62,9 @@ void lvle::TerraformBrush::Raise(const float deltaTime)
         float avgHeight = CalculateAverageHeightInBrush();
         for (auto& index : m_vertexIndices)
         {
-            if (data->m_vertices[index].position.z <= avgHeight)
+            if (data->m_positions[index].z <= avgHeight)
             {
-                data->m_vertices[index].position.z += m_intensity * deltaTime;
+                data->m_positions[index].z += m_intensity * deltaTime;
             }
         }
     }
@@ -80,7 +81,7 @@ void lvle::TerraformBrush::Raise(const float deltaTime)
                                      (indexCoord.y - centerIndexCoord.y) * (indexCoord.y - centerIndexCoord.y);
             double heightChange = std::exp(-0.5 * distanceSquared / (spread * spread));
 
-            data->m_vertices[index].position.z += heightChange * m_intensity * deltaTime;
+            data->m_positions[index].z += heightChange * m_intensity * deltaTime;
         }
     }
 }
@@ -95,9 +96,9 @@ void lvle::TerraformBrush::Lower(const float deltaTime)
         float avgHeight = CalculateAverageHeightInBrush();
         for (auto& index : m_vertexIndices)
         {
-            if (data->m_vertices[index].position.z >= avgHeight)
+            if (data->m_positions[index].z >= avgHeight)
             {
-                data->m_vertices[index].position.z -= m_intensity * deltaTime;
+                data->m_positions[index].z -= m_intensity * deltaTime;
             }
         }
     }
@@ -114,7 +115,7 @@ void lvle::TerraformBrush::Lower(const float deltaTime)
                                      (indexCoord.y - centerIndexCoord.y) * (indexCoord.y - centerIndexCoord.y);
             double heightChange = std::exp(-0.5 * distanceSquared / (spread * spread));
 
-            data->m_vertices[index].position.z -= heightChange * m_intensity * deltaTime;
+            data->m_positions[index].z -= heightChange * m_intensity * deltaTime;
         }
     }
 }
@@ -124,10 +125,10 @@ void lvle::TerraformBrush::Plateau(const float deltaTime)
     auto& terrain = Engine.ECS().GetSystem<TerrainSystem>();
 
     auto& data = terrain.m_data;
-    float center_height = data->m_vertices[m_hoveredVertexIndex].position.z;
+    float center_height = data->m_positions[m_hoveredVertexIndex].z;
     for (auto& index : m_vertexIndices)
     {
-        data->m_vertices[index].position.z = center_height;
+        data->m_positions[index].z = center_height;
     }
 }
 
@@ -141,7 +142,7 @@ void lvle::TerraformBrush::Smooth(const float deltaTime)
     // int vHeight = data->m_height + 1;
     for (const auto index : m_vertexIndices)
     {
-        auto vertexPos = data->m_vertices[index].position;
+        auto vertexPos = data->m_positions[index];
         float smoothedHeight = vertexPos.z;
         int neighborIndices[4] = {index + vWidth, index - vWidth, index - 1, index + 1};  // up, down, left, right
         // sum heights
@@ -152,7 +153,7 @@ void lvle::TerraformBrush::Smooth(const float deltaTime)
             if (neighborVertexCoords.x >= 0 && neighborVertexCoords.x < data->m_width + 1 && neighborVertexCoords.y >= 0 &&
                 neighborVertexCoords.y < data->m_height + 1)
             {
-                smoothedHeight += data->m_vertices[neighborIndex].position.z;
+                smoothedHeight += data->m_positions[neighborIndex].z;
             }
             else
                 smoothedHeight += 0.0f;
@@ -161,7 +162,7 @@ void lvle::TerraformBrush::Smooth(const float deltaTime)
         // average heights
         smoothedHeight /= 5.0f;
 
-        data->m_vertices[index].position.z =
+        data->m_positions[index].z =
             mix(vertexPos.z, smoothedHeight, Remap(0.0f, m_maxIntensity * deltaTime, 0.0f, 1.0f, m_intensity * deltaTime));
     }
 }
@@ -173,11 +174,11 @@ float lvle::TerraformBrush::CalculateHighestPointInBrush()
     auto& terrain = Engine.ECS().GetSystem<TerrainSystem>();
 
     auto& data = terrain.m_data;
-    float maxHeight = data->m_vertices[m_hoveredVertexIndex].position.z;
+    float maxHeight = data->m_positions[m_hoveredVertexIndex].z;
     int vertexAtMaxHeightCnt = 0;  // number of vertices which are at max brush height
     for (auto& index : m_vertexIndices)
     {
-        float currentHeight = data->m_vertices[index].position.z;
+        float currentHeight = data->m_positions[index].z;
         if (currentHeight == maxHeight)
             vertexAtMaxHeightCnt++;
         else if (currentHeight > maxHeight)
@@ -192,14 +193,14 @@ float lvle::TerraformBrush::CalculateLowestPointInBrush()
     auto& terrain = Engine.ECS().GetSystem<TerrainSystem>();
 
     auto& data = terrain.m_data;
-    float minHeight = data->m_vertices[m_hoveredVertexIndex].position.z;
+    float minHeight = data->m_positions[m_hoveredVertexIndex].z;
     int vertexAtMinHeightCnt = 0;  // number of vertices which are at min brush height
     for (auto& index : m_vertexIndices)
     {
-        if (data->m_vertices[index].position.z == minHeight)
+        if (data->m_positions[index].z == minHeight)
             vertexAtMinHeightCnt++;
-        else if (data->m_vertices[index].position.z < minHeight)
-            minHeight = data->m_vertices[index].position.z;
+        else if (data->m_positions[index].z < minHeight)
+            minHeight = data->m_positions[index].z;
     }
     if (vertexAtMinHeightCnt == m_vertexIndices.size()) return -100000.0f;
     return minHeight;
@@ -213,7 +214,7 @@ float lvle::TerraformBrush::CalculateAverageHeightInBrush()
     float avgHeight = 0.0f;
     for (auto& index : m_vertexIndices)
     {
-        float currentHeight = data->m_vertices[index].position.z;
+        float currentHeight = data->m_positions[index].z;
         avgHeight += currentHeight;
     }
     return (avgHeight / static_cast<float>(m_vertexIndices.size()));
@@ -35,6 +35,7 @@ void lvle::TextureBrush::Terraform(const float deltaTime)
         default:
             break;
     }
+    Engine.ECS().GetSystem<TerrainSystem>().MarkDirty(m_vertexIndices);
 }
 
 void lvle::TextureBrush::Grass(const float deltaTime)
@@ -43,10 +44,10 @@ void lvle::TextureBrush::Grass(const float deltaTime)
     auto& data = terrain.m_data;
     for (auto vIndex : m_vertexIndices)
     {
-        data->m_vertices[vIndex].materialWeights[0] = std::clamp(data->m_vertices[vIndex].materialWeights[0] + weight, 0.0f, 1.0f);
-        data->m_vertices[vIndex].materialWeights[1] = std::clamp(data->m_vertices[vIndex].materialWeights[1] - weight, 0.0f, 1.0f);
-        data->m_vertices[vIndex].materialWeights[2] = std::clamp(data->m_vertices[vIndex].materialWeights[2] - weight, 0.0f, 1.0f);
-        data->m_vertices[vIndex].materialWeights[3] = std::clamp(data->m_vertices[vIndex].materialWeights[3] - weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][0] = std::clamp(data->m_materialWeights[vIndex][0] + weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][1] = std::clamp(data->m_materialWeights[vIndex][1] - weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][2] = std::clamp(data->m_materialWeights[vIndex][2] - weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][3] = std::clamp(data->m_materialWeights[vIndex][3] - weight, 0.0f, 1.0f);
     }
 }
 
@@ -56,14 +57,14 @@ void lvle::TextureBrush::Dirt(const float deltaTime)
     auto& data = terrain.m_data;
     for (auto vIndex : m_vertexIndices)
     {
-        data->m_vertices[vIndex].materialWeights[0] =
-            std::clamp(data->m_vertices[vIndex].materialWeights[0] - weight, 0.0f, 1.0f);
-        data->m_vertices[vIndex].materialWeights[1] =
-            std::clamp(data->m_vertices[vIndex].materialWeights[1] + weight, 0.0f, 1.0f);
-        data->m_vertices[vIndex].materialWeights[2] =
-            std::clamp(data->m_vertices[vIndex].materialWeights[2] - weight, 0.0f, 1.0f);
-        data->m_vertices[vIndex].materialWeights[3] =
-            std::clamp(data->m_vertices[vIndex].materialWeights[3] - weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][0] =
+            std::clamp(data->m_materialWeights[vIndex][0] - weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][1] =
+            std::clamp(data->m_materialWeights[vIndex][1] + weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][2] =
+            std::clamp(data->m_materialWeights[vIndex][2] - weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][3] =
+            std::clamp(data->m_materialWeights[vIndex][3] - weight, 0.0f, 1.0f);
     }
 }
 
@@ -73,14 +74,14 @@ void lvle::TextureBrush::Rock(const float deltaTime)
     auto& data = terrain.m_data;
     for (auto vIndex : m_vertexIndices)
     {
-        data->m_vertices[vIndex].materialWeights[0] =
-            std::clamp(data->m_vertices[vIndex].materialWeights[0] - weight, 0.0f, 1.0f);
-        data->m_vertices[vIndex].materialWeights[1] =
-            std::clamp(data->m_vertices[vIndex].materialWeights[1] - weight, 0.0f, 1.0f);
-        data->m_vertices[vIndex].materialWeights[2] =
-            std::clamp(data->m_vertices[vIndex].materialWeights[2] + weight, 0.0f, 1.0f);
-        data->m_vertices[vIndex].materialWeights[3] =
-            std::clamp(data->m_vertices[vIndex].materialWeights[3] - weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][0] =
+            std::clamp(data->m_materialWeights[vIndex][0] - weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][1] =
+            std::clamp(data->m_materialWeights[vIndex][1] - weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][2] =
+            std::clamp(data->m_materialWeights[vIndex][2] + weight, 0.0f, 1.0f);
+        data->m_materialWeights[vIndex][3] =
+            std::clamp(data->m_materialWeights[vIndex][3] - weight, 0.0f, 1.0f);
     }
 }
 
@@ -26,7 +26,7 @@ void lvle::UnitBrush::SetPreviewModel(const std::string& objectHandle)
         auto modelEntity = Engine.ECS().CreateEntity();
         auto& modelTransform = Engine.ECS().CreateComponent<Transform>(modelEntity);
         modelTransform.Name = "Model";
-        modelTransform.SetParent(m_previewEntity);
+        Engine.ECS().Registry.get<Hierarchy>(modelEntity).SetParent(m_previewEntity);
         modelTransform.Translation += unitTemplate.modelOffset.Translation;
         auto modelEuler = glm::eulerAngles(modelTransform.Rotation);
         auto modelOffsetEuler = glm::eulerAngles(unitTemplate.modelOffset.Rotation);
@@ -364,8 +364,8 @@ void LevelEditor::Edit(const float dt)
 
     // update the central positions of the tiles (this was moved so it's done only on save)
     // terrain.UpdateTilesCentralPositions();
-    // update the mesh after you're doing terraforming.
-    terrain.UpdatePlane();
+    // update the part of the mesh the brush changed.
+    terrain.UpdateDirtyRegion();
     //// update the TerrainDataComponent (this is a bit backwards, but it is done for easy terrain access in the level editor).
     terrain.UpdateTerrainDataComponent();
 }
@@ -2142,10 +2142,10 @@ void lvle::LevelEditor::Guizmo()
         ImGui::Text(ImGuizmo::IsOver(ImGuizmo::SCALE) ? "Over scale gizmo" : "");
     }
     ImGui::Separator();
-    auto selectedView = Engine.ECS().Registry.view<Selected, Transform>();
-    for (auto [entity, selectedObject, transform] : selectedView.each())
+    auto selectedView = Engine.ECS().Registry.view<Selected, Transform, WorldTransform>();
+    for (auto [entity, selectedObject, transform, worldTransform] : selectedView.each())
     {
-        const glm::mat4 transformM = transform.WorldMatrix;
+        const glm::mat4 transformM = worldTransform.WorldMatrix;
             float* floatProjection;
             float* floatViewM;
             float* floattransformM = (float*)glm::value_ptr(transformM);
@@ -0,0 +1,340 @@
+#include "level_editor/terrain_binary.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <cereal/archives/json.hpp>
+
+#include "core/engine.hpp"
+#include "core/fileio.hpp"
+#include "level_editor/level_editor_components.hpp"
+#include "tools/log.hpp"
+
+using namespace bee;
+using namespace lvle;
+
+namespace
+{
+
+// All multi-byte values are stored little endian, in the layout of the platform (all our targets are little endian).
+
+constexpr char kMagic[4] = {'O', 'W', 'L', 'T'};
+constexpr size_t kSectionAlignment = 16;
+constexpr uint32_t kMaxSections = 64;
+
+enum class SectionType : uint32_t
+{
+    Indices,
+    Positions,
+    Normals,
+    Uvs,
+    Tangents,
+    Bitangents,
+    CliffLevels,
+    MaterialWeights,
+    Tiles,
+    TileFlags,
+    SmallGridPoints,
+    AreaPresets,
+    MaterialPaths,  // per path: uint32_t length followed by the characters
+    Count
+};
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t sectionCount;
+    int32_t width;
+    int32_t height;
+    float step;
+    uint32_t reserved[2];
+};
+
+struct SectionHeader
+{
+    uint32_t type;
+    uint32_t elementSize;
+    uint64_t offset;  // from the start of the file
+    uint64_t count;   // number of elements
+};
+
+struct TileRecord
+{
+    int32_t index;
+    int32_t area;
+    glm::vec3 centralPos;
+};
+
+static_assert(sizeof(FileHeader) == 32, "The file header is part of the file format.");
+static_assert(sizeof(SectionHeader) == 24, "The section header is part of the file format.");
+static_assert(sizeof(DWORD) == sizeof(uint32_t), "Indices are stored as 32 bit.");
+static_assert(sizeof(glm::vec3) == 12 && sizeof(glm::vec2) == 8, "Vertex attributes are stored tightly packed.");
+static_assert(sizeof(MaterialWeights) == 16, "Material weights are stored as four floats.");
+
+size_t AlignUp(const size_t value) { return (value + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment; }
+
+// A section that still has to be written.
+struct PendingSection
+{
+    SectionType type;
+    uint32_t elementSize;
+    const void* data;
+    size_t count;
+};
+
+template <typename T>
+PendingSection MakeSection(const SectionType type, const std::vector<T>& elements)
+{
+    return PendingSection{type, static_cast<uint32_t>(sizeof(T)), elements.data(), elements.size()};
+}
+
+// Finds the section and copies it into elements. Fails if it is missing, out of bounds or has unexpected elements.
+template <typename T>
+bool ReadSection(const char* bytes, const size_t size, const std::vector<const SectionHeader*>& sections,
+                 const SectionType type, std::vector<T>& elements)
+{
+    const SectionHeader* section = sections[static_cast<size_t>(type)];
+    if (section == nullptr || section->elementSize != sizeof(T)) return false;
+    if (section->count > (size - section->offset) / sizeof(T)) return false;
+
+    elements.resize(static_cast<size_t>(section->count));
+    if (!elements.empty()) std::memcpy(elements.data(), bytes + section->offset, elements.size() * sizeof(T));
+    return true;
+}
+
+}  // namespace
+
+std::vector<char> lvle::WriteTerrainBinary(const TerrainDataComponent& data)
+{
+    std::vector<TileRecord> tiles(data.m_tiles.size());
+    std::vector<int32_t> tileFlags(data.m_tiles.size());
+    for (size_t i = 0; i < data.m_tiles.size(); i++)
+    {
+        tiles[i] = TileRecord{data.m_tiles[i].index, data.m_tiles[i].area, data.m_tiles[i].centralPos};
+        tileFlags[i] = data.m_tiles[i].tileFlags;
+    }
+
+    std::vector<char> materialPaths;
+    for (const auto& path : data.m_materialPaths)
+    {
+        const uint32_t length = static_cast<uint32_t>(path.size());
+        materialPaths.insert(materialPaths.end(), reinterpret_cast<const char*>(&length),
+                             reinterpret_cast<const char*>(&length) + sizeof(length));
+        materialPaths.insert(materialPaths.end(), path.begin(), path.end());
+    }
+
+    const std::vector<PendingSection> pending = {
+        MakeSection(SectionType::Indices, data.m_indices),
+        MakeSection(SectionType::Positions, data.m_positions),
+        MakeSection(SectionType::Normals, data.m_normals),
+        MakeSection(SectionType::Uvs, data.m_uvs),
+        MakeSection(SectionType::Tangents, data.m_tangents),
+        MakeSection(SectionType::Bitangents, data.m_bitangents),
+        MakeSection(SectionType::CliffLevels, data.m_cliffLevels),
+        MakeSection(SectionType::MaterialWeights, data.m_materialWeights),
+        MakeSection(SectionType::Tiles, tiles),
+        MakeSection(SectionType::TileFlags, tileFlags),
+        MakeSection(SectionType::SmallGridPoints, data.m_smallGridPoints),
+        MakeSection(SectionType::AreaPresets, data.m_areaPresets),
+        MakeSection(SectionType::MaterialPaths, materialPaths),
+    };
+
+    // lay out the sections after the header and the section table
+    std::vector<SectionHeader> sections;
+    size_t offset = AlignUp(sizeof(FileHeader) + pending.size() * sizeof(SectionHeader));
+    for (const auto& section : pending)
+    {
+        sections.push_back(SectionHeader{static_cast<uint32_t>(section.type), section.elementSize, offset, section.count});
+        offset = AlignUp(offset + section.count * section.elementSize);
+    }
+
+    std::vector<char> bytes(offset, 0);
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = TerrainBinaryVersion;
+    header.sectionCount = static_cast<uint32_t>(sections.size());
+    header.width = data.m_width;
+    header.height = data.m_height;
+    header.step = data.m_step;
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + sizeof(header), sections.data(), sections.size() * sizeof(SectionHeader));
+
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        if (pending[i].count == 0) continue;
+        std::memcpy(bytes.data() + sections[i].offset, pending[i].data, pending[i].count * pending[i].elementSize);
+    }
+    return bytes;
+}
+
+bool lvle::ReadTerrainBinary(const char* bytes, const size_t size, TerrainDataComponent& data)
+{
+    if (bytes == nullptr || size < sizeof(FileHeader)) return false;
+
+    FileHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) return false;
+    if (header.version != TerrainBinaryVersion)
+    {
+        Log::Warn("Binary level has version {}, expected {}. Convert it again from json.", header.version, TerrainBinaryVersion);
+        return false;
+    }
+    if (header.sectionCount > kMaxSections || size < sizeof(FileHeader) + header.sectionCount * sizeof(SectionHeader))
+        return false;
+    if (header.width <= 0 || header.height <= 0) return false;
+
+    std::vector<SectionHeader> table(header.sectionCount);
+    std::memcpy(table.data(), bytes + sizeof(FileHeader), table.size() * sizeof(SectionHeader));
+    std::vector<const SectionHeader*> sections(static_cast<size_t>(SectionType::Count), nullptr);
+    for (const auto& section : table)
+    {
+        // unknown sections are skipped, so newer writers can add optional data
+        if (section.type >= static_cast<uint32_t>(SectionType::Count)) continue;
+        if (section.offset % kSectionAlignment != 0 || section.offset > size) return false;
+        sections[section.type] = &section;
+    }
+
+    TerrainDataComponent result;
+    result.m_width = header.width;
+    result.m_height = header.height;
+    result.m_step = header.step;
+
+    std::vector<TileRecord> tiles;
+    std::vector<int32_t> tileFlags;
+    std::vector<char> materialPaths;
+    if (!ReadSection(bytes, size, sections, SectionType::Indices, result.m_indices) ||
+        !ReadSection(bytes, size, sections, SectionType::Positions, result.m_positions) ||
+        !ReadSection(bytes, size, sections, SectionType::Normals, result.m_normals) ||
+        !ReadSection(bytes, size, sections, SectionType::Uvs, result.m_uvs) ||
+        !ReadSection(bytes, size, sections, SectionType::Tangents, result.m_tangents) ||
+        !ReadSection(bytes, size, sections, SectionType::Bitangents, result.m_bitangents) ||
+        !ReadSection(bytes, size, sections, SectionType::CliffLevels, result.m_cliffLevels) ||
+        !ReadSection(bytes, size, sections, SectionType::MaterialWeights, result.m_materialWeights) ||
+        !ReadSection(bytes, size, sections, SectionType::Tiles, tiles) ||
+        !ReadSection(bytes, size, sections, SectionType::TileFlags, tileFlags) ||
+        !ReadSection(bytes, size, sections, SectionType::SmallGridPoints, result.m_smallGridPoints) ||
+        !ReadSection(bytes, size, sections, SectionType::AreaPresets, result.m_areaPresets) ||
+        !ReadSection(bytes, size, sections, SectionType::MaterialPaths, materialPaths))
+        return false;
+
+    // the sections have to describe the same grid
+    const size_t vertexCount = static_cast<size_t>(header.width + 1) * (header.height + 1);
+    const size_t tileCount = static_cast<size_t>(header.width) * header.height;
+    if (result.m_positions.size() != vertexCount || result.m_normals.size() != vertexCount ||
+        result.m_uvs.size() != vertexCount || result.m_tangents.size() != vertexCount ||
+        result.m_bitangents.size() != vertexCount || result.m_cliffLevels.size() != vertexCount ||
+        result.m_materialWeights.size() != vertexCount || result.m_indices.size() != tileCount * 6 ||
+        tiles.size() != tileCount || tileFlags.size() != tileCount)
+        return false;
+    for (const DWORD index : result.m_indices)
+        if (index >= vertexCount) return false;
+
+    result.m_tiles.resize(tileCount);
+    for (size_t i = 0; i < tileCount; i++)
+    {
+        result.m_tiles[i].index = tiles[i].index;
+        result.m_tiles[i].area = tiles[i].area;
+        result.m_tiles[i].centralPos = tiles[i].centralPos;
+        result.m_tiles[i].tileFlags = tileFlags[i];
+    }
+
+    result.m_materialPaths.clear();
+    size_t cursor = 0;
+    while (cursor < materialPaths.size())
+    {
+        uint32_t length = 0;
+        if (materialPaths.size() - cursor < sizeof(length)) return false;
+        std::memcpy(&length, materialPaths.data() + cursor, sizeof(length));
+        cursor += sizeof(length);
+        if (materialPaths.size() - cursor < length) return false;
+        result.m_materialPaths.emplace_back(materialPaths.data() + cursor, length);
+        cursor += length;
+    }
+
+    data = std::move(result);
+    return true;
+}
+
+bool lvle::SaveTerrainBinary(const TerrainDataComponent& data, const std::string& fileName)
+{
+    return Engine.FileIO().WriteBinaryFile(FileIO::Directory::Terrain, fileName + TerrainBinaryExtension, WriteTerrainBinary(data));
+}
+
+bool lvle::LoadTerrainBinary(const std::string& fileName, TerrainDataComponent& data, const bool memoryMapped)
+{
+    const std::string path = fileName + TerrainBinaryExtension;
+    bool loaded = false;
+    if (memoryMapped)
+    {
+        const MappedFile file = Engine.FileIO().MapFile(FileIO::Directory::Terrain, path);
+        loaded = ReadTerrainBinary(file.GetData(), file.GetSize(), data);
+    }
+    else
+    {
+        const std::vector<char> bytes = Engine.FileIO().ReadBinaryFile(FileIO::Directory::Terrain, path);
+        loaded = ReadTerrainBinary(bytes.data(), bytes.size(), data);
+    }
+
+    if (!loaded) Log::Warn("Could not load binary level {}", path);
+    return loaded;
+}
+
+bool lvle::LoadTerrainJson(const std::string& fileName, TerrainDataComponent& data)
+{
+    const std::string path = Engine.FileIO().GetPath(FileIO::Directory::Terrain, fileName + ".json");
+    std::ifstream is(path);
+    if (!is.is_open()) return false;
+
+    try
+    {
+        TerrainDataComponent loaded{};
+        cereal::JSONInputArchive archive(is);
+        archive(cereal::make_nvp("data", loaded));
+        data = std::move(loaded);
+        return true;
+    }
+    catch (const cereal::Exception& exception)
+    {
+        Log::Warn("Could not load level {}: {}", path, exception.what());
+        return false;
+    }
+}
+
+bool lvle::SaveTerrainJson(const TerrainDataComponent& data, const std::string& fileName)
+{
+    std::ofstream os(Engine.FileIO().GetPath(FileIO::Directory::Terrain, fileName + ".json"));
+    if (!os.is_open()) return false;
+
+    cereal::JSONOutputArchive archive(os);
+    archive(CEREAL_NVP(data));
+    return true;
+}
+
+bool lvle::LoadTerrainLevel(const std::string& fileName, TerrainDataComponent& data)
+{
+    const auto jsonPath = Engine.FileIO().GetPath(FileIO::Directory::Terrain, fileName + ".json");
+    const auto binaryPath = Engine.FileIO().GetPath(FileIO::Directory::Terrain, fileName + TerrainBinaryExtension);
+
+    // a json file that is newer than the binary one was edited by hand, or saved by an older editor
+    std::error_code error;
+    const bool hasJson = std::filesystem::exists(jsonPath, error);
+    const bool hasBinary = std::filesystem::exists(binaryPath, error);
+    const bool binaryIsCurrent =
+        hasBinary && (!hasJson || std::filesystem::last_write_time(binaryPath, error) >= std::filesystem::last_write_time(jsonPath, error));
+
+    if (binaryIsCurrent && LoadTerrainBinary(fileName, data)) return true;
+    return hasJson && LoadTerrainJson(fileName, data);
+}
+
+bool lvle::ConvertLevelToBinary(const std::string& fileName)
+{
+    TerrainDataComponent data{};
+    return LoadTerrainJson(fileName, data) && SaveTerrainBinary(data, fileName);
+}
+
+bool lvle::ConvertLevelToJson(const std::string& fileName)
+{
+    TerrainDataComponent data{};
+    return LoadTerrainBinary(fileName, data) && SaveTerrainJson(data, fileName);
+}
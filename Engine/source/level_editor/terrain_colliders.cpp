@@ -0,0 +1,304 @@
+#include "level_editor/terrain_colliders.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+
+#include "level_editor/level_editor_components.hpp"
+#include "tools/thread_pool.hpp"
+
+using namespace lvle;
+
+namespace
+{
+
+constexpr int kBandRows = 32;  // rows of tiles labelled by one task
+
+// Walking directions around a contour, counter-clockwise order: right, up, left, down.
+constexpr int kStepX[4] = {1, 0, -1, 0};
+constexpr int kStepY[4] = {0, 1, 0, -1};
+// The tiles ahead on the left and ahead on the right after arriving at a vertex, relative to that vertex.
+constexpr int kFrontLeftX[4] = {0, -1, -1, 0};
+constexpr int kFrontLeftY[4] = {0, 0, -1, -1};
+constexpr int kFrontRightX[4] = {0, 0, -1, -1};
+constexpr int kFrontRightY[4] = {-1, 0, 0, -1};
+
+// Calls function(task) for every task, on the pool if there is one, and waits for all of them.
+template <typename F>
+void RunParallel(bee::ThreadPool* pool, const int taskCount, const F& function)
+{
+    if (pool == nullptr || taskCount <= 1)
+    {
+        for (int task = 0; task < taskCount; task++) function(task);
+        return;
+    }
+
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(taskCount);
+    for (int task = 0; task < taskCount; task++) tasks.push_back(pool->Enqueue(function, task));
+    for (auto& task : tasks) task.get();
+}
+
+// Roots are always the lowest index of their set, so parents only ever point to lower indices.
+int FindRoot(std::vector<int>& parents, int index)
+{
+    while (parents[index] != index)
+    {
+        parents[index] = parents[parents[index]];  // path halving
+        index = parents[index];
+    }
+    return index;
+}
+
+void Unite(std::vector<int>& parents, const int a, const int b)
+{
+    const int rootA = FindRoot(parents, a);
+    const int rootB = FindRoot(parents, b);
+    if (rootA < rootB)
+        parents[rootB] = rootA;
+    else if (rootB < rootA)
+        parents[rootA] = rootB;
+}
+
+struct GridPoint
+{
+    int64_t x, y;
+};
+
+GridPoint ToGridPoint(const int vertex, const int width) { return {vertex % (width + 1), vertex / (width + 1)}; }
+
+double DistanceToSegment(const GridPoint& p, const GridPoint& a, const GridPoint& b)
+{
+    const double abX = static_cast<double>(b.x - a.x), abY = static_cast<double>(b.y - a.y);
+    const double apX = static_cast<double>(p.x - a.x), apY = static_cast<double>(p.y - a.y);
+    const double lengthSquared = abX * abX + abY * abY;
+    const double t = lengthSquared > 0.0 ? std::clamp((apX * abX + apY * abY) / lengthSquared, 0.0, 1.0) : 0.0;
+    const double dx = apX - t * abX, dy = apY - t * abY;
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+int Orientation(const GridPoint& a, const GridPoint& b, const GridPoint& c)
+{
+    const int64_t cross = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    return (cross > 0) - (cross < 0);
+}
+
+bool OnSegment(const GridPoint& a, const GridPoint& b, const GridPoint& p)
+{
+    return std::min(a.x, b.x) <= p.x && p.x <= std::max(a.x, b.x) && std::min(a.y, b.y) <= p.y && p.y <= std::max(a.y, b.y);
+}
+
+// True if the segments cross or touch.
+bool SegmentsIntersect(const GridPoint& a, const GridPoint& b, const GridPoint& c, const GridPoint& d)
+{
+    const int o1 = Orientation(a, b, c), o2 = Orientation(a, b, d);
+    const int o3 = Orientation(c, d, a), o4 = Orientation(c, d, b);
+    if (o1 != o2 && o3 != o4) return true;
+    return (o1 == 0 && OnSegment(a, b, c)) || (o2 == 0 && OnSegment(a, b, d)) || (o3 == 0 && OnSegment(c, d, a)) ||
+           (o4 == 0 && OnSegment(c, d, b));
+}
+
+bool IsSimplePolygon(const std::vector<GridPoint>& points)
+{
+    const size_t count = points.size();
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t j = i + 1; j < count; j++)
+        {
+            // neighbouring edges share a corner
+            if (j == i + 1 || (i == 0 && j == count - 1)) continue;
+            if (SegmentsIntersect(points[i], points[(i + 1) % count], points[j], points[(j + 1) % count])) return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+std::vector<int> lvle::LabelBlockedTiles(const std::vector<uint8_t>& blocked, const int width, const int height,
+                                         std::vector<int>& labels, bee::ThreadPool* pool)
+{
+    const int tileCount = width * height;
+    std::vector<int> parents(tileCount, -1);
+
+    // every band only links tiles inside it, so the bands can be labelled at the same time
+    const int bandCount = (height + kBandRows - 1) / kBandRows;
+    RunParallel(pool, bandCount,
+                [&](const int band)
+                {
+                    const int firstRow = band * kBandRows;
+                    const int lastRow = std::min(firstRow + kBandRows, height);
+                    for (int y = firstRow; y < lastRow; y++)
+                    {
+                        for (int x = 0; x < width; x++)
+                        {
+                            const int index = x + y * width;
+                            if (!blocked[index]) continue;
+                            parents[index] = index;
+                            if (x > 0 && blocked[index - 1]) Unite(parents, index, index - 1);
+                            if (y > firstRow && blocked[index - width]) Unite(parents, index, index - width);
+                        }
+                    }
+                });
+
+    // stitch the bands together
+    for (int band = 1; band < bandCount; band++)
+    {
+        const int y = band * kBandRows;
+        for (int x = 0; x < width; x++)
+        {
+            const int index = x + y * width;
+            if (blocked[index] && blocked[index - width]) Unite(parents, index, index - width);
+        }
+    }
+
+    // parents point to lower indices, so one pass in increasing order resolves every tile to its root
+    std::vector<int> roots;
+    labels.assign(tileCount, -1);
+    for (int index = 0; index < tileCount; index++)
+    {
+        if (parents[index] < 0) continue;
+        if (parents[index] == index)
+        {
+            labels[index] = index;
+            roots.push_back(index);
+        }
+        else
+        {
+            labels[index] = labels[parents[index]];
+        }
+    }
+    return roots;
+}
+
+std::vector<int> lvle::TraceTileGroupContour(const std::vector<int>& labels, const int width, const int height,
+                                             const int firstTile)
+{
+    const auto inside = [&](const int x, const int y)
+    { return x >= 0 && x < width && y >= 0 && y < height && labels[x + y * width] == firstTile; };
+
+    // The lowest tile has no group tiles below or to the left of it, so its bottom edge (A -> B) is on the outline.
+    // Walk with the group on the left until we are back at its corner A.
+    const int startX = firstTile % width;
+    const int startY = firstTile / width;
+    const int vWidth = width + 1;
+    std::vector<int> contour = {startX + startY * vWidth};
+
+    int x = startX, y = startY, direction = 0;
+    const int maxSteps = 4 * (width + 1) * (height + 1);
+    for (int step = 0; step < maxSteps; step++)
+    {
+        x += kStepX[direction];
+        y += kStepY[direction];
+        if (x == startX && y == startY) break;
+
+        int next = direction;
+        if (!inside(x + kFrontLeftX[direction], y + kFrontLeftY[direction]))
+            next = (direction + 1) % 4;  // turn left
+        else if (inside(x + kFrontRightX[direction], y + kFrontRightY[direction]))
+            next = (direction + 3) % 4;  // turn right
+
+        if (next != direction) contour.push_back(x + y * vWidth);
+        direction = next;
+    }
+    return contour;
+}
+
+std::vector<int> lvle::SimplifyColliderPolygon(const std::vector<int>& contour, const int width, const float tolerance)
+{
+    const size_t count = contour.size();
+    if (tolerance <= 0.0f || count <= 4) return contour;
+
+    std::vector<GridPoint> points(count);
+    for (size_t i = 0; i < count; i++) points[i] = ToGridPoint(contour[i], width);
+
+    // split the closed outline at the first corner and the corner furthest from it
+    size_t furthest = 0;
+    double furthestDistance = -1.0;
+    for (size_t i = 1; i < count; i++)
+    {
+        const double dx = static_cast<double>(points[i].x - points[0].x), dy = static_cast<double>(points[i].y - points[0].y);
+        if (dx * dx + dy * dy > furthestDistance)
+        {
+            furthestDistance = dx * dx + dy * dy;
+            furthest = i;
+        }
+    }
+
+    std::vector<bool> keep(count, false);
+    keep[0] = keep[furthest] = true;
+    std::vector<std::pair<size_t, size_t>> spans = {{0, furthest}, {furthest, count}};  // end index count wraps to 0
+    while (!spans.empty())
+    {
+        const auto [first, last] = spans.back();
+        spans.pop_back();
+        if (last <= first + 1) continue;
+
+        size_t worst = first;
+        double worstDistance = 0.0;
+        for (size_t i = first + 1; i < last; i++)
+        {
+            const double distance = DistanceToSegment(points[i], points[first], points[last % count]);
+            if (distance > worstDistance)
+            {
+                worstDistance = distance;
+                worst = i;
+            }
+        }
+        if (worstDistance <= tolerance) continue;
+
+        keep[worst] = true;
+        spans.emplace_back(first, worst);
+        spans.emplace_back(worst, last);
+    }
+
+    std::vector<int> result;
+    std::vector<GridPoint> resultPoints;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!keep[i]) continue;
+        result.push_back(contour[i]);
+        resultPoints.push_back(points[i]);
+    }
+
+    // a collider that folds over itself is worse than one with a few more corners
+    if (result.size() < 3 || ColliderPolygonArea(result, width) <= 0.0 || !IsSimplePolygon(resultPoints)) return contour;
+    return result;
+}
+
+double lvle::ColliderPolygonArea(const std::vector<int>& polygon, const int width)
+{
+    int64_t doubleArea = 0;
+    for (size_t i = 0; i < polygon.size(); i++)
+    {
+        const GridPoint a = ToGridPoint(polygon[i], width);
+        const GridPoint b = ToGridPoint(polygon[(i + 1) % polygon.size()], width);
+        doubleArea += a.x * b.y - b.x * a.y;
+    }
+    return static_cast<double>(doubleArea) * 0.5;
+}
+
+std::vector<std::vector<int>> lvle::ExtractTerrainColliders(const TerrainDataComponent& data, const float tolerance,
+                                                            bee::ThreadPool* pool)
+{
+    std::vector<uint8_t> blocked(data.m_tiles.size());
+    for (size_t i = 0; i < data.m_tiles.size(); i++) blocked[i] = (data.m_tiles[i].tileFlags & TileFlags::NoGroundTraverse) != 0;
+
+    std::vector<int> labels;
+    const std::vector<int> groups = LabelBlockedTiles(blocked, data.m_width, data.m_height, labels, pool);
+
+    // groups are independent, hand them out round robin so big and small ones are spread over the tasks
+    std::vector<std::vector<int>> polygons(groups.size());
+    const int taskCount =
+        pool != nullptr ? static_cast<int>(std::min(groups.size(), pool->NumberOfThreads() * 4)) : static_cast<int>(!groups.empty());
+    RunParallel(pool, taskCount,
+                [&](const int task)
+                {
+                    for (size_t i = task; i < groups.size(); i += taskCount)
+                    {
+                        const auto contour = TraceTileGroupContour(labels, data.m_width, data.m_height, groups[i]);
+                        polygons[i] = SimplifyColliderPolygon(contour, data.m_width, tolerance);
+                    }
+                });
+    return polygons;
+}
@@ -0,0 +1,271 @@
+#include "level_editor/terrain_mesh.hpp"
+
+#include <algorithm>
+
+#include "level_editor/level_editor_components.hpp"
+
+using namespace lvle;
+using namespace glm;
+
+namespace
+{
+
+// The tangent space of a single triangle, see TerrainSystem::UpdateTangents.
+void CalculateTriangleTangents(const TerrainDataComponent& data, const size_t firstIndex, vec3& tangent, vec3& bitangent)
+{
+    const DWORD i0 = data.m_indices[firstIndex];
+    const DWORD i1 = data.m_indices[firstIndex + 1];
+    const DWORD i2 = data.m_indices[firstIndex + 2];
+
+    vec3 edge1 = data.m_positions[i1] - data.m_positions[i0];
+    vec3 edge2 = data.m_positions[i2] - data.m_positions[i0];
+
+    vec2 deltaUV1 = data.m_uvs[i1] - data.m_uvs[i0];
+    vec2 deltaUV2 = data.m_uvs[i2] - data.m_uvs[i0];
+
+    float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV1.y * deltaUV2.x);
+
+    auto vector1 = vec3(deltaUV2.y) * edge1;
+    auto vector2 = vec3(deltaUV1.y * edge2);
+    tangent = vec3(vector1 - vector2) * f;
+
+    vector1 = vec3(deltaUV1.x) * edge2;
+    vector2 = vec3(deltaUV2.x) * edge1;
+    bitangent = vec3(vector1 - vector2) * f;
+}
+
+bool Contains(const TerrainRect& rect, const int x, const int y)
+{
+    return x >= rect.min.x && x <= rect.max.x && y >= rect.min.y && y <= rect.max.y;
+}
+
+}  // namespace
+
+void TerrainRect::Include(const glm::ivec2& vertex)
+{
+    if (IsEmpty())
+    {
+        min = vertex;
+        max = vertex;
+        return;
+    }
+    min = glm::min(min, vertex);
+    max = glm::max(max, vertex);
+}
+
+void TerrainRect::Merge(const TerrainRect& other)
+{
+    if (other.IsEmpty()) return;
+    Include(other.min);
+    Include(other.max);
+}
+
+TerrainRect TerrainRect::Expanded(const int border, const TerrainDataComponent& data) const
+{
+    if (IsEmpty()) return *this;
+
+    TerrainRect result;
+    result.min = glm::max(min - border, ivec2(0));
+    result.max = glm::min(max + border, ivec2(data.m_width, data.m_height));
+    return result;
+}
+
+TerrainRect TerrainRect::Whole(const TerrainDataComponent& data)
+{
+    TerrainRect result;
+    result.min = ivec2(0);
+    result.max = ivec2(data.m_width, data.m_height);
+    return result;
+}
+
+void lvle::UpdateTerrainNormals(TerrainDataComponent& data, const TerrainRect& region)
+{
+    const int vWidth = data.m_width + 1;
+    const int vHeight = data.m_height + 1;
+    const int xMin = std::max(region.min.x, 1), xMax = std::min(region.max.x, vWidth - 2);
+    const int yMin = std::max(region.min.y, 1), yMax = std::min(region.max.y, vHeight - 2);
+    for (int y = yMin; y <= yMax; y++)
+    {
+        for (int x = xMin; x <= xMax; x++)
+        {
+            // index of the current point
+            const int index = x + y * vWidth;
+            const float c_u = data.m_positions[index + vWidth].z;
+            const float c_d = data.m_positions[index - vWidth].z;
+            const float c_l = data.m_positions[index - 1].z;
+            const float c_r = data.m_positions[index + 1].z;
+
+            const vec3 normal =
+                normalize(vec3(-2.0f * data.m_step * (c_r - c_l), 2.0f * data.m_step * (c_d - c_u), 4.0f * data.m_step * data.m_step));
+            data.m_normals[index] = normal;
+        }
+    }
+}
+
+void lvle::UpdateTerrainTangents(TerrainDataComponent& data, const TerrainRect& region)
+{
+    if (region.IsEmpty()) return;
+
+    // Every triangle overwrites the tangents of its three vertices, so a vertex ends up with the tangent of the last
+    // triangle touching it. All of those belong to the (up to) four quads around the vertex, so walking the quads
+    // around the region in index order reproduces the full update.
+    const int vWidth = data.m_width + 1;
+    const int xMin = std::max(region.min.x - 1, 0), xMax = std::min(region.max.x, data.m_width - 1);
+    const int yMin = std::max(region.min.y - 1, 0), yMax = std::min(region.max.y, data.m_height - 1);
+    for (int y = yMin; y <= yMax; y++)
+    {
+        for (int x = xMin; x <= xMax; x++)
+        {
+            // two triangles (six indices) per quad, see TerrainSystem::CreatePlane
+            const size_t first = static_cast<size_t>(x + y * data.m_width) * 6;
+            for (size_t i = first; i < first + 6; i += 3)
+            {
+                vec3 tangent, bitangent;
+                CalculateTriangleTangents(data, i, tangent, bitangent);
+
+                for (size_t corner = i; corner < i + 3; corner++)
+                {
+                    const int index = static_cast<int>(data.m_indices[corner]);
+                    if (!Contains(region, index % vWidth, index / vWidth)) continue;
+                    data.m_tangents[index] = tangent;
+                    data.m_bitangents[index] = bitangent;
+                }
+            }
+        }
+    }
+
+    for (int y = region.min.y; y <= region.max.y; y++)
+    {
+        for (int x = region.min.x; x <= region.max.x; x++)
+        {
+            const int index = x + y * vWidth;
+            data.m_tangents[index] = glm::normalize(data.m_tangents[index]);
+            data.m_bitangents[index] = glm::normalize(data.m_bitangents[index]);
+        }
+    }
+}
+
+Vertex lvle::ToRenderVertex(const TerrainDataComponent& data, const int index)
+{
+    const vec3& position = data.m_positions[index];
+    const vec3& normal = data.m_normals[index];
+    const vec2& uv = data.m_uvs[index];
+    const vec3& tangent = data.m_tangents[index];
+    const vec3& bitangent = data.m_bitangents[index];
+    const MaterialWeights& weights = data.m_materialWeights[index];
+
+    Vertex vert;
+
+    vert.pos.x = position.x;
+    vert.pos.y = position.y;
+    vert.pos.z = position.z;
+    vert.normal.x = normal.x;
+    vert.normal.y = normal.y;
+    vert.normal.z = normal.z;
+    vert.texCoord.x = uv.x;
+    vert.texCoord.y = uv.y;
+    vert.tangent.x = tangent.x;
+    vert.tangent.y = tangent.y;
+    vert.tangent.z = tangent.z;
+    vert.bitangent.x = bitangent.x;
+    vert.bitangent.y = bitangent.y;
+    vert.bitangent.z = bitangent.z;
+    vert.jointids = DirectX::XMUINT4(0, 1, 2, 3);
+    vert.weights.x = weights[0];
+    vert.weights.y = weights[1];
+    vert.weights.z = weights[2];
+    vert.weights.w = weights[3];
+
+    return vert;
+}
+
+void TerrainChunkedMesh::Build(const TerrainDataComponent& data)
+{
+    m_width = data.m_width;
+    m_height = data.m_height;
+    m_chunksX = (m_width + ChunkSize - 1) / ChunkSize;
+    m_chunksY = (m_height + ChunkSize - 1) / ChunkSize;
+    m_chunks.clear();
+    m_indices.clear();
+
+    size_t vertexCount = 0;
+    for (int cy = 0; cy < m_chunksY; cy++)
+    {
+        for (int cx = 0; cx < m_chunksX; cx++)
+        {
+            Chunk chunk;
+            chunk.min = ivec2(cx, cy) * ChunkSize;
+            chunk.max = glm::min(chunk.min + ChunkSize, ivec2(m_width, m_height));
+            const ivec2 size = chunk.max - chunk.min + 1;
+            chunk.range.first = vertexCount;
+            chunk.range.count = static_cast<size_t>(size.x * size.y);
+            vertexCount += chunk.range.count;
+
+            // same triangles as TerrainSystem::CreatePlane, indexing into the vertices of the chunk
+            for (int y = 0; y < size.y - 1; y++)
+            {
+                for (int x = 0; x < size.x - 1; x++)
+                {
+                    const DWORD index = static_cast<DWORD>(chunk.range.first + x + y * size.x);
+                    const DWORD vWidth = static_cast<DWORD>(size.x);
+
+                    // CAB
+                    m_indices.push_back(index + vWidth + 1);
+                    m_indices.push_back(index);
+                    m_indices.push_back(index + 1);
+                    // ACD
+                    m_indices.push_back(index);
+                    m_indices.push_back(index + vWidth + 1);
+                    m_indices.push_back(index + vWidth);
+                }
+            }
+            m_chunks.push_back(chunk);
+        }
+    }
+
+    m_vertices.resize(vertexCount);
+    for (const auto& chunk : m_chunks) WriteChunk(data, chunk);
+}
+
+void TerrainChunkedMesh::UpdateRegion(const TerrainDataComponent& data, const TerrainRect& region,
+                                      std::vector<VertexRange>& updatedRanges)
+{
+    updatedRanges.clear();
+    if (region.IsEmpty() || m_chunks.empty()) return;
+
+    // vertices on a chunk border belong to the chunks on both sides
+    const int cxMin = std::max((region.min.x - 1) / ChunkSize, 0), cxMax = std::min(region.max.x / ChunkSize, m_chunksX - 1);
+    const int cyMin = std::max((region.min.y - 1) / ChunkSize, 0), cyMax = std::min(region.max.y / ChunkSize, m_chunksY - 1);
+    for (int cy = cyMin; cy <= cyMax; cy++)
+    {
+        for (int cx = cxMin; cx <= cxMax; cx++)
+        {
+            const Chunk& chunk = m_chunks[cx + cy * m_chunksX];
+            WriteChunk(data, chunk);
+
+            // neighbouring chunks are next to each other in the buffer, so they can be uploaded in one go
+            if (!updatedRanges.empty() && updatedRanges.back().first + updatedRanges.back().count == chunk.range.first)
+                updatedRanges.back().count += chunk.range.count;
+            else
+                updatedRanges.push_back(chunk.range);
+        }
+    }
+}
+
+bool TerrainChunkedMesh::Matches(const TerrainDataComponent& data) const
+{
+    return !m_chunks.empty() && m_width == data.m_width && m_height == data.m_height;
+}
+
+void TerrainChunkedMesh::WriteChunk(const TerrainDataComponent& data, const Chunk& chunk)
+{
+    const int vWidth = data.m_width + 1;
+    size_t target = chunk.range.first;
+    for (int y = chunk.min.y; y <= chunk.max.y; y++)
+    {
+        for (int x = chunk.min.x; x <= chunk.max.x; x++)
+        {
+            m_vertices[target++] = ToRenderVertex(data, x + y * vWidth);
+        }
+    }
+}
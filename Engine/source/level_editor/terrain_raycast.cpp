@@ -0,0 +1,269 @@
+#include "level_editor/terrain_raycast.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <glm/gtx/intersect.hpp>
+
+#include "level_editor/level_editor_components.hpp"
+#include "level_editor/terrain_mesh.hpp"
+
+using namespace lvle;
+using namespace glm;
+
+namespace
+{
+
+constexpr float kInfinity = std::numeric_limits<float>::infinity();
+constexpr float kHeightEpsilon = 1e-3f;
+
+// Tests a single terrain triangle. Returns the ray parameter of the hit in distance.
+bool IntersectTriangle(const TerrainDataComponent& data, const int triangle, const vec3& rayStart, const vec3& rayDir,
+                       vec3& position, float& distance)
+{
+    const int a = data.m_indices[triangle * 3];
+    const int b = data.m_indices[triangle * 3 + 1];
+    const int c = data.m_indices[triangle * 3 + 2];
+    const vec3& pa = data.m_positions[a];
+    const vec3& pb = data.m_positions[b];
+    const vec3& pc = data.m_positions[c];
+
+    vec3 bary = vec3(0.0f);
+    if (!intersectLineTriangle(rayStart, rayDir, pa, pb, pc, bary)) return false;
+    if (bary.x < 0.0f) return false;  // behind the ray start
+
+    double u, v, w;
+    v = bary.y;
+    w = bary.z;
+    u = 1.0f - (v + w);
+    position.x = u * pa.x + v * pb.x + w * pc.x;
+    position.y = u * pa.y + v * pb.y + w * pc.y;
+    position.z = u * pa.z + v * pb.z + w * pc.z;
+    distance = bary.x;
+    return true;
+}
+
+// Clips the ray against an axis aligned box. Shrinks [tMin, tMax] and returns false if nothing is left.
+bool ClipRayToBox(const vec3& rayStart, const vec3& rayDir, const vec3& boxMin, const vec3& boxMax, float& tMin, float& tMax)
+{
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (abs(rayDir[axis]) < std::numeric_limits<float>::epsilon())
+        {
+            if (rayStart[axis] < boxMin[axis] || rayStart[axis] > boxMax[axis]) return false;
+            continue;
+        }
+        float t0 = (boxMin[axis] - rayStart[axis]) / rayDir[axis];
+        float t1 = (boxMax[axis] - rayStart[axis]) / rayDir[axis];
+        if (t0 > t1) std::swap(t0, t1);
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax) return false;
+    }
+    return true;
+}
+
+// Walks the cells of a 2D lattice that the ray crosses between tStart and tEnd, in order.
+// The visitor gets the cell coordinates and the part of the ray inside the cell, and returns true to stop.
+// Cells are clamped to [cellMin, cellMax).
+template <typename Visitor>
+void TraverseLattice(const vec2& rayStart, const vec2& rayDir, const float tStart, const float tEnd, const vec2& latticeMin,
+                     const float cellSize, const ivec2& cellMin, const ivec2& cellMax, Visitor&& visitor)
+{
+    const vec2 start = rayStart + rayDir * tStart;
+    ivec2 cell = ivec2(floor((start - latticeMin) / cellSize));
+    cell = clamp(cell, cellMin, cellMax - 1);
+
+    ivec2 step = ivec2(0);
+    vec2 tNextBoundary = vec2(kInfinity);
+    vec2 tDelta = vec2(kInfinity);
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (abs(rayDir[axis]) < std::numeric_limits<float>::epsilon()) continue;
+        step[axis] = rayDir[axis] > 0.0f ? 1 : -1;
+        const float boundary = latticeMin[axis] + static_cast<float>(cell[axis] + (step[axis] > 0 ? 1 : 0)) * cellSize;
+        tNextBoundary[axis] = (boundary - rayStart[axis]) / rayDir[axis];
+        tDelta[axis] = cellSize / abs(rayDir[axis]);
+    }
+
+    float t = tStart;
+    while (true)
+    {
+        const float tExit = std::min(std::min(tNextBoundary.x, tNextBoundary.y), tEnd);
+        if (visitor(cell, t, std::max(t, tExit))) return;
+        if (tExit >= tEnd) return;
+
+        const int axis = tNextBoundary.x < tNextBoundary.y ? 0 : 1;
+        cell[axis] += step[axis];
+        t = tNextBoundary[axis];
+        tNextBoundary[axis] += tDelta[axis];
+        if (cell[axis] < cellMin[axis] || cell[axis] >= cellMax[axis]) return;
+    }
+}
+
+}  // namespace
+
+bool lvle::RaycastTerrainBruteForce(const TerrainDataComponent& data, const glm::vec3& rayStart, const glm::vec3& rayDir,
+                                    TerrainRayHit& hit)
+{
+    bool foundIntersection = false;
+    const int triangleCount = static_cast<int>(data.m_indices.size() / 3);
+    for (int i = 0; i < triangleCount; i++)
+    {
+        vec3 position;
+        float distance;
+        if (IntersectTriangle(data, i, rayStart, rayDir, position, distance) && (!foundIntersection || distance < hit.distance))
+        {
+            foundIntersection = true;
+            hit.position = position;
+            hit.triangle = i;
+            hit.distance = distance;
+        }
+    }
+    return foundIntersection;
+}
+
+void lvle::TerrainRaycaster::Build(const TerrainDataComponent& data)
+{
+    m_width = data.m_width;
+    m_height = data.m_height;
+    m_chunksX = (m_width + ChunkSize - 1) / ChunkSize;
+    m_chunksY = (m_height + ChunkSize - 1) / ChunkSize;
+    m_chunks.assign(m_chunksX * m_chunksY, HeightRange{kInfinity, -kInfinity});
+    m_bounds = HeightRange{kInfinity, -kInfinity};
+
+    const int vWidth = m_width + 1;
+    for (int y = 0; y <= m_height; y++)
+    {
+        for (int x = 0; x <= m_width; x++)
+        {
+            const float z = data.m_positions[x + y * vWidth].z;
+            m_bounds.min = std::min(m_bounds.min, z);
+            m_bounds.max = std::max(m_bounds.max, z);
+
+            // vertices on a chunk border belong to the chunks on both sides
+            const int cxMin = std::max((x - 1) / ChunkSize, 0), cxMax = std::min(x / ChunkSize, m_chunksX - 1);
+            const int cyMin = std::max((y - 1) / ChunkSize, 0), cyMax = std::min(y / ChunkSize, m_chunksY - 1);
+            for (int cy = cyMin; cy <= cyMax; cy++)
+            {
+                for (int cx = cxMin; cx <= cxMax; cx++)
+                {
+                    auto& chunk = m_chunks[cx + cy * m_chunksX];
+                    chunk.min = std::min(chunk.min, z);
+                    chunk.max = std::max(chunk.max, z);
+                }
+            }
+        }
+    }
+    m_valid = true;
+}
+
+void lvle::TerrainRaycaster::Refit(const TerrainDataComponent& data, const TerrainRect& region)
+{
+    // nothing to refit, the next query builds everything
+    if (!m_valid || m_width != data.m_width || m_height != data.m_height) return;
+    if (region.IsEmpty() || m_chunks.empty()) return;
+
+    // vertices on a chunk border belong to the chunks on both sides
+    const int cxMin = std::max((region.min.x - 1) / ChunkSize, 0), cxMax = std::min(region.max.x / ChunkSize, m_chunksX - 1);
+    const int cyMin = std::max((region.min.y - 1) / ChunkSize, 0), cyMax = std::min(region.max.y / ChunkSize, m_chunksY - 1);
+    for (int cy = cyMin; cy <= cyMax; cy++)
+        for (int cx = cxMin; cx <= cxMax; cx++) m_chunks[cx + cy * m_chunksX] = CalculateChunkRange(data, cx, cy);
+
+    m_bounds = HeightRange{kInfinity, -kInfinity};
+    for (const auto& chunk : m_chunks)
+    {
+        m_bounds.min = std::min(m_bounds.min, chunk.min);
+        m_bounds.max = std::max(m_bounds.max, chunk.max);
+    }
+}
+
+lvle::TerrainRaycaster::HeightRange lvle::TerrainRaycaster::CalculateChunkRange(const TerrainDataComponent& data, const int cx,
+                                                                               const int cy) const
+{
+    HeightRange range{kInfinity, -kInfinity};
+    const int vWidth = m_width + 1;
+    const int xMax = std::min((cx + 1) * ChunkSize, m_width);
+    const int yMax = std::min((cy + 1) * ChunkSize, m_height);
+    for (int y = cy * ChunkSize; y <= yMax; y++)
+    {
+        for (int x = cx * ChunkSize; x <= xMax; x++)
+        {
+            const float z = data.m_positions[x + y * vWidth].z;
+            range.min = std::min(range.min, z);
+            range.max = std::max(range.max, z);
+        }
+    }
+    return range;
+}
+
+void lvle::TerrainRaycaster::TestQuad(const TerrainDataComponent& data, const int x, const int y, const glm::vec3& rayStart,
+                                      const glm::vec3& rayDir, TerrainRayHit& hit, bool& hasHit) const
+{
+    // every quad is made of two consecutive triangles, see TerrainSystem::CreatePlane
+    const int quad = x + y * m_width;
+    for (int triangle = quad * 2; triangle < quad * 2 + 2; triangle++)
+    {
+        vec3 position;
+        float distance;
+        if (IntersectTriangle(data, triangle, rayStart, rayDir, position, distance) && (!hasHit || distance < hit.distance))
+        {
+            hasHit = true;
+            hit.position = position;
+            hit.triangle = triangle;
+            hit.distance = distance;
+        }
+    }
+}
+
+bool lvle::TerrainRaycaster::Raycast(const TerrainDataComponent& data, const glm::vec3& rayStart, const glm::vec3& rayDir,
+                                     TerrainRayHit& hit)
+{
+    if (!m_valid || m_width != data.m_width || m_height != data.m_height) Build(data);
+    if (m_width <= 0 || m_height <= 0) return false;
+
+    const float step = data.m_step;
+    const vec2 latticeMin = vec2(data.m_positions.front());
+    const vec2 latticeMax = latticeMin + vec2(m_width, m_height) * step;
+
+    // only the part of the ray inside the terrain bounds needs to be walked
+    float tMin = 0.0f;
+    float tMax = kInfinity;
+    if (!ClipRayToBox(rayStart, rayDir, vec3(latticeMin, m_bounds.min - kHeightEpsilon),
+                      vec3(latticeMax, m_bounds.max + kHeightEpsilon), tMin, tMax))
+        return false;
+
+    bool hasHit = false;
+    TerrainRayHit closest;
+    const vec2 start2D = vec2(rayStart);
+    const vec2 dir2D = vec2(rayDir);
+
+    TraverseLattice(
+        start2D, dir2D, tMin, tMax, latticeMin, step * ChunkSize, ivec2(0), ivec2(m_chunksX, m_chunksY),
+        [&](const ivec2& chunkCoords, const float chunkEnter, const float chunkExit)
+        {
+            // hits further down the ray can't be closer than the one we have
+            if (hasHit && chunkEnter > closest.distance) return true;
+
+            // skip the chunk if the ray passes completely above or below it
+            const auto& range = m_chunks[chunkCoords.x + chunkCoords.y * m_chunksX];
+            // (padded, the chunk borders found by the traversal are only as precise as the ray parameter)
+            const float zEnter = rayStart.z + rayDir.z * chunkEnter;
+            const float zExit = rayStart.z + rayDir.z * chunkExit;
+            const float padding = kHeightEpsilon * (1.0f + abs(rayDir.z) * chunkExit);
+            if (std::max(zEnter, zExit) < range.min - padding || std::min(zEnter, zExit) > range.max + padding) return false;
+
+            const ivec2 cellMin = chunkCoords * ChunkSize;
+            const ivec2 cellMax = min(cellMin + ChunkSize, ivec2(m_width, m_height));
+            TraverseLattice(start2D, dir2D, chunkEnter, chunkExit, latticeMin, step, cellMin, cellMax,
+                            [&](const ivec2& cell, const float cellEnter, const float)
+                            {
+                                if (hasHit && cellEnter > closest.distance) return true;
+                                TestQuad(data, cell.x, cell.y, rayStart, rayDir, closest, hasHit);
+                                return false;
+                            });
+            return false;
+        });
+
+    if (hasHit) hit = closest;
+    return hasHit;
+}
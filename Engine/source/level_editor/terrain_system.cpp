@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cereal/archives/json.hpp>
+#include <filesystem>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/intersect.hpp>
@@ -27,6 +28,8 @@
 #include "physics/physics_components.hpp"
 #include "actors/attributes.hpp"
 #include "actors/actor_wrapper.hpp"
+#include "level_editor/terrain_binary.hpp"
+#include "level_editor/terrain_colliders.hpp"
 
 using namespace bee;
 using namespace lvle;
@@ -55,6 +58,8 @@ inline bool fileExists(const std::string& name)
 
 TerrainSystem::TerrainSystem()
 {
+    Title = "Terrain";
+    ReadsNothing();  // changed through its functions only, by the level editor and at loading
     const auto entity = Engine.ECS().CreateEntity();
     // Creating TerrainDataComponent component
     auto& data = Engine.ECS().CreateComponent<TerrainDataComponent>(entity);
@@ -63,6 +68,16 @@ TerrainSystem::TerrainSystem()
     auto& transform = Engine.ECS().CreateComponent<Transform>(entity);
     transform.Name = "Terrain Ground";
     transform.Scale = vec3(1.0f);
+    // Mark this mesh as a terrain mesh.
+    auto& tag = Engine.ECS().CreateComponent<TerrainGroundTagComponent>(entity);
+
+    // without a device there is nothing to draw with, a headless terrain only has its data
+    if (Engine.IsHeadless())
+    {
+        CreatePlane(16, 16, 1.0f);
+        return;
+    }
+
     // Creating the MeshRender component
     for (int i = 0; i < m_data->m_materialPaths.size(); i++)
     {
@@ -89,8 +104,6 @@ TerrainSystem::TerrainSystem()
     material->UseOcclusionTexture = true;
     material->ReceiveShadows = false;
     Engine.ECS().CreateComponent<MeshRenderer>(entity, m_mesh, material/*m_data->m_materials[3]*/);
-    // Mark this mesh as a terrain mesh.
-    auto& tag = Engine.ECS().CreateComponent<TerrainGroundTagComponent>(entity);
     // TODO: not sure if this would work
     CreatePlane(16, 16, 1.0f);
 }
@@ -107,9 +120,16 @@ void lvle::TerrainSystem::UpdateTerrainDataComponent()
 }
 
 void TerrainSystem::CreatePlane(int width, int height, float step)
+{
+    CreatePlaneData(width, height, step);
+    UpdatePlane();
+    if (m_mesh != nullptr) m_mesh->SetIndices(m_chunkedMesh.GetIndices());
+}
+
+void TerrainSystem::CreatePlaneData(int width, int height, float step)
 {
     m_data->m_indices.clear();
-    m_data->m_vertices.clear();
+    m_data->ResizeVertices(0);
     m_data->m_smallGridPoints.clear();
     m_data->m_tiles.clear();
 
@@ -143,15 +163,16 @@ void TerrainSystem::CreatePlane(int width, int height, float step)
     }
 
     // vertices
+    m_data->ResizeVertices((m_data->m_width + 1) * (m_data->m_height + 1));
+    int vertexIndex = 0;
     for (int y = -m_data->m_height / 2; y <= m_data->m_height / 2; y++)
     {
         for (int x = -m_data->m_width / 2; x <= m_data->m_width / 2; x++)
         {
-            TVertex v;
-            v.position = vec3(x * m_data->m_step, y * m_data->m_step, 0.0f);
-            v.normal = vec3(0.0f, 0.0f, 1.0f);
-            v.uv = vec2(0.5f, 0.5f);
-            m_data->m_vertices.push_back(v);
+            m_data->m_positions[vertexIndex] = vec3(x * m_data->m_step, y * m_data->m_step, 0.0f);
+            m_data->m_normals[vertexIndex] = vec3(0.0f, 0.0f, 1.0f);
+            m_data->m_uvs[vertexIndex] = vec2(0.5f, 0.5f);
+            vertexIndex++;
         }
     }
 
@@ -162,21 +183,21 @@ void TerrainSystem::CreatePlane(int width, int height, float step)
         for (int x = 0; x < m_data->m_width + 1; x++)
         {
             int index = CoordsToIndex(vec2(x, y), m_data->m_width + 1);
-            m_data->m_vertices[index].uv.x = x*0.125f;
-            m_data->m_vertices[index].uv.y = y * 0.125f;
+            m_data->m_uvs[index].x = x*0.125f;
+            m_data->m_uvs[index].y = y * 0.125f;
            /* if (x % 2 == 0)
-                m_data->m_vertices[index].uv.x = 0;
+                m_data->m_uvs[index].x = 0;
             else
-                m_data->m_vertices[index].uv.x = 1;
+                m_data->m_uvs[index].x = 1;
 
              if (y % 2 == 0)
-                m_data->m_vertices[index].uv.y = 0;
+                m_data->m_uvs[index].y = 0;
             else
-                m_data->m_vertices[index].uv.y = 1;*/
+                m_data->m_uvs[index].y = 1;*/
 
             /*int index = CoordsToIndex(vec2(x, y), m_data->m_width + 1);
             auto uv = vec2(x * atlasStep.x, y * atlasStep.y);
-            m_data->m_vertices[index].uv = uv;*/
+            m_data->m_uvs[index] = uv;*/
         }
     }
 
@@ -220,122 +241,64 @@ void TerrainSystem::CreatePlane(int width, int height, float step)
     }
 
     // SetAllUVs();
-    //m_data->m_vertices[18].materialWeights = {0, 1, 0, 0};
-
-    UpdatePlane();
-    m_mesh->SetIndices(m_data->m_indices);
+    //m_data->m_materialWeights[18] = {0, 1, 0, 0};
 }
 
 void TerrainSystem::UpdatePlane()
 {
+    // heights might have changed, the raycaster rebuilds its height ranges on the next query
+    m_raycaster.Invalidate();
+    m_dirtyRegion = TerrainRect{};
     UpdateNormals();
     UpdateTangents();
-    std::vector<Vertex> vertexList;
-    for (auto& v : m_data->m_vertices)
-    {
-        Vertex vert;
-
-        vert.pos.x = v.position.x;
-        vert.pos.y = v.position.y;
-        vert.pos.z = v.position.z;
-        vert.normal.x = v.normal.x;
-        vert.normal.y = v.normal.y;
-        vert.normal.z = v.normal.z;
-        vert.texCoord.x = v.uv.x;
-        vert.texCoord.y = v.uv.y;
-        vert.tangent.x = v.tangent.x;
-        vert.tangent.y = v.tangent.y;
-        vert.tangent.z = v.tangent.z;
-        vert.bitangent.x = v.bitangent.x;
-        vert.bitangent.y = v.bitangent.y;
-        vert.bitangent.z = v.bitangent.z;
-        vert.jointids = DirectX::XMUINT4(0, 1, 2, 3);
-        vert.weights.x = v.materialWeights[0];
-        vert.weights.y = v.materialWeights[1];
-        vert.weights.z = v.materialWeights[2];
-        vert.weights.w = v.materialWeights[3];
-
-        vertexList.push_back(vert);
-    }
-    m_mesh->SetAttribute(vertexList);
+    if (m_mesh == nullptr) return;  // headless
+    m_chunkedMesh.Build(*m_data);
+    m_mesh->SetAttribute(m_chunkedMesh.GetVertices());
 }
 
-// The normals of the vertices along the terrain edges are not updated!
-void TerrainSystem::UpdateNormals()
+void TerrainSystem::MarkDirty(const std::vector<int>& vertexIndices)
 {
-    int vWidth = m_data->m_width + 1;
-    int vHeight = m_data->m_height + 1;
-    for (int y = 1; y < vHeight - 1; y++)
-    {
-        for (int x = 1; x < vWidth - 1; x++)
-        {
-            // index of the current point
-            int index = x + y * vWidth;
-            vec3 u = m_data->m_vertices[index + vWidth].position;
-            vec3 d = m_data->m_vertices[index - vWidth].position;
-            vec3 l = m_data->m_vertices[index - 1].position;
-            vec3 r = m_data->m_vertices[index + 1].position;
-            float c_u = u.z;
-            float c_d = d.z;
-            float c_l = l.z;
-            float c_r = r.z;
-
-            const vec3 normal = normalize(vec3(-2.0f * m_data->m_step * (c_r - c_l), 2.0f * m_data->m_step * (c_d - c_u),
-                                               4.0f * m_data->m_step * m_data->m_step));
-            m_data->m_vertices[index].normal = normal;
-        }
-    }
+    const int vWidth = m_data->m_width + 1;
+    for (const int index : vertexIndices) m_dirtyRegion.Include(ivec2(index % vWidth, index / vWidth));
 }
 
-void lvle::TerrainSystem::UpdateTangents()
+void TerrainSystem::UpdateDirtyRegion()
 {
-    for (size_t i = 0; i < m_data->m_indices.size(); i += 3)
-    {
-        TVertex& v0 = m_data->m_vertices[m_data->m_indices[i]];
-        TVertex& v1 = m_data->m_vertices[m_data->m_indices[i + 1]];
-        TVertex& v2 = m_data->m_vertices[m_data->m_indices[i + 2]];
+    if (m_dirtyRegion.IsEmpty()) return;
 
-        vec3 edge1 = v1.position - v0.position;
-        vec3 edge2 = v2.position - v0.position;
-
-        vec2 deltaUV1 = v1.uv - v0.uv;
-        vec2 deltaUV2 = v2.uv - v0.uv;
-
-        float f = 1.0f / (deltaUV1.x * deltaUV2.y - deltaUV1.y * deltaUV2.x);
-
-        auto vector1 = vec3(deltaUV2.y) * edge1;
-        auto vector2 = vec3(deltaUV1.y * edge2);
-        vec3 tangent = vec3(vector1 - vector2) * f;
+    // the chunk layout only holds for the dimensions it was built for
+    if (m_mesh == nullptr || !m_chunkedMesh.Matches(*m_data))
+    {
+        UpdatePlane();
+        if (m_mesh != nullptr) m_mesh->SetIndices(m_chunkedMesh.GetIndices());
+        return;
+    }
 
-        vector1 = vec3(deltaUV1.x) * edge2;
-        vector2 = vec3(deltaUV2.x) * edge1;
-        vec3 bitangent = vec3(vector1 - vector2) * f;
+    // normals and tangents of a vertex depend on its direct neighbours, so those change as well
+    const TerrainRect region = m_dirtyRegion.Expanded(1, *m_data);
+    m_dirtyRegion = TerrainRect{};
+    UpdateTerrainNormals(*m_data, region);
+    UpdateTerrainTangents(*m_data, region);
+    m_raycaster.Refit(*m_data, region);
 
-        v0.tangent = tangent;
-        v1.tangent = tangent;
-        v2.tangent = tangent;
+    m_chunkedMesh.UpdateRegion(*m_data, region, m_updatedRanges);
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (const auto& range : m_updatedRanges) ranges.emplace_back(range.first, range.count);
+    m_mesh->UpdateVertices(m_chunkedMesh.GetVertices(), ranges);
+}
 
-        v0.bitangent = bitangent;
-        v1.bitangent = bitangent;
-        v2.bitangent = bitangent;
-    }
+// The normals of the vertices along the terrain edges are not updated!
+void TerrainSystem::UpdateNormals() { UpdateTerrainNormals(*m_data, TerrainRect::Whole(*m_data)); }
 
-    for (TVertex& v : m_data->m_vertices)
-    {
-        v.tangent = glm::normalize(v.tangent);
-        v.bitangent = glm::normalize(v.bitangent);
-    }
-}
+void lvle::TerrainSystem::UpdateTangents() { UpdateTerrainTangents(*m_data, TerrainRect::Whole(*m_data)); }
 
 void lvle::TerrainSystem::CalculateTileCentralPosition(int tileIndex)
 {
     float halfStep = m_data->m_step / 2.0f;
 
-    int x = tileIndex % m_data->m_width;
-    int y = tileIndex / m_data->m_width;
-    int vIndex = x + y * m_data->m_width + y;
+    int vIndex = m_data->GetTileVertexIndices(tileIndex)[0];
     // calculate x and y of the central pos
-    vec3 centralPos = m_data->m_vertices[vIndex].position + vec3(halfStep, halfStep, 0.0f);
+    vec3 centralPos = m_data->m_positions[vIndex] + vec3(halfStep, halfStep, 0.0f);
     float result = 0.0f;
     if (GetTerrainHeightAtPoint(centralPos.x, centralPos.y, result))
     {
@@ -349,11 +312,9 @@ void lvle::TerrainSystem::CalculateAllTilesCentralPositions()
     float halfStep = m_data->m_step / 2.0f;
     for (int i = 0; i < m_data->m_tiles.size(); i++)
     {
-        int x = i % m_data->m_width;
-        int y = i / m_data->m_width;
-        int vIndex = x + y * m_data->m_width + y;
+        int vIndex = m_data->GetTileVertexIndices(i)[0];
         // calculate x and y of the central pos
-        vec3 centralPos = m_data->m_vertices[vIndex].position + vec3(halfStep, halfStep, 0.0f);
+        vec3 centralPos = m_data->m_positions[vIndex] + vec3(halfStep, halfStep, 0.0f);
         float result = 0.0f;
         if (GetTerrainHeightAtPoint(centralPos.x, centralPos.y, result))
         {
@@ -365,61 +326,14 @@ void lvle::TerrainSystem::CalculateAllTilesCentralPositions()
 
 void lvle::TerrainSystem::CalculateTerrainColliders()
 {
-    // represent the terrain tiles as ints. 0 for walkable, 1 for unwalkable.
-    std::vector<int> allTiles;
-    for (const auto& tile : m_data->m_tiles)
-    {
-        if (tile.tileFlags & TileFlags::NoGroundTraverse)
-            allTiles.push_back(1);
-        else
-            allTiles.push_back(0);
-    }
-
-    // -----------------------------------------------------
-    // Step 1: Find the separate groups of unwalkable tiles.
-    // -----------------------------------------------------
-    // the groups of unwalkable tiles
-    std::vector<std::vector<int>> tileGroups;
-
-    std::vector<int> directions({1, -1, -1, 1});  // Up, down, left, right
-    for (int i = 0; i < allTiles.size(); i++)
-    {
-        std::vector<int> group;
-        FindColliderTileGroupRecursive(allTiles, group, i, directions);
-        if (!group.empty())
-        {
-            tileGroups.push_back(group);
-        }
-    }
-
-    // ----------------------------------------------------------
-    // Step 2: Find outer edges for each outer tile in the group.
-    // ----------------------------------------------------------
-    std::vector<std::vector<std::pair<int, int>>> groupsEdges;
-
-    for (const auto& group : tileGroups)
-    {
-        std::vector<std::pair<int, int>> tileEdges;
-        FindColliderEdgesPerTileInTileGroup(group, tileEdges);
-        if (!tileEdges.empty()) groupsEdges.push_back(tileEdges);
-    }
-
-    // -------------------------------------------------
-    // Step 3: Reduce points by taking only the corners.
-    // -------------------------------------------------
-    std::vector<std::vector<int>> groupsColliderPoints;
+    // Outlines may cut up to this many tiles into (or out of) the unwalkable area. Enough to straighten the staircases
+    // along diagonal cliffs, which is where most of the corners come from.
+    constexpr float simplifyTolerance = 0.75f;
 
-    for (const auto& edgeGroup : groupsEdges)
-    {
-        std::vector<int> colliderCornerPoints;
-        FindColliderCornerPoints(edgeGroup, colliderCornerPoints);
-        if (!colliderCornerPoints.empty()) groupsColliderPoints.push_back(colliderCornerPoints);
-    }
+    const auto polygons = ExtractTerrainColliders(*m_data, simplifyTolerance, &Engine.ThreadPool());
 
-    // -----------------------------------
-    // Step 4: Create polygonal colliders.
-    // -----------------------------------
-    for (const auto& colliderPointsIndices : groupsColliderPoints)
+    // entities are created on this thread, the extraction only reads the terrain
+    for (const auto& colliderPointsIndices : polygons)
     {
         CreateTerrainColliderEntity(colliderPointsIndices, "TerrainCollider");
     }
@@ -429,7 +343,7 @@ bee::Entity lvle::TerrainSystem::CreateTerrainColliderEntity(const std::vector<i
 {
     // make a vector with the actual coordinates
     std::vector<glm::vec2> colliderPoints;
-    for (const auto index : pointsIndices) colliderPoints.push_back(m_data->m_vertices[index].position);
+    for (const auto index : pointsIndices) colliderPoints.push_back(m_data->m_positions[index]);
 
     auto colliderEntity = Engine.ECS().CreateEntity();
     auto& transform = Engine.ECS().CreateComponent<bee::Transform>(colliderEntity);
@@ -441,139 +355,6 @@ bee::Entity lvle::TerrainSystem::CreateTerrainColliderEntity(const std::vector<i
     return colliderEntity;
 }
 
-void lvle::TerrainSystem::FindColliderTileGroupRecursive(std::vector<int>& allTiles, std::vector<int>& tileGroup,
-                                                         const int tileIndexToInspect, const std::vector<int>& directions)
-{
-    if (allTiles[tileIndexToInspect] == 1)
-    {
-        tileGroup.push_back(tileIndexToInspect);
-        allTiles[tileIndexToInspect] = 0;
-        for (int i = 0; i < directions.size(); i++)
-        {
-            auto tileCoords = IndexToCoords(tileIndexToInspect, m_data->m_width);
-            if (i < 2)
-                tileCoords.y += directions[i];
-            else
-                tileCoords.x += directions[i];
-
-            if (IsTileInTerrain(tileCoords))
-            {
-                int newIndexToInspect = CoordsToIndex(tileCoords, m_data->m_width);
-                FindColliderTileGroupRecursive(allTiles, tileGroup, newIndexToInspect, directions);
-            }
-        }
-    }
-}
-
-void lvle::TerrainSystem::FindColliderEdgesPerTileInTileGroup(const std::vector<int>& group,
-                                                              std::vector<std::pair<int, int>>& result)
-{
-    for (const auto tileIndex : group)
-    {
-        std::vector<int> directions = {1, -1, -1, 1}; // Up, down, left, right
-        for (int i = 0; i < directions.size(); i++)
-        {
-            auto tileCoords = IndexToCoords(tileIndex, m_data->m_width);
-            if (i < 2)
-                tileCoords.y += directions[i];
-            else
-                tileCoords.x += directions[i];
-
-            int tileIndexToCheck = CoordsToIndex(tileCoords, m_data->m_width);
-            // add vertices if the neighbor tile isn't part of the group.
-            if (std::find(group.begin(), group.end(), tileIndexToCheck) == group.end() || !IsTileInTerrain(tileCoords))
-            {
-                enum Directions
-                {
-                    Up,
-                    Down,
-                    Left,
-                    Right
-                };
-                // vertex indices (A, B, C, D)
-                int x = tileIndex % m_data->m_width;
-                int y = tileIndex / m_data->m_width;
-                int a = x + y * m_data->m_width + y;
-                switch (i)
-                {
-                    case static_cast<int>(Up):  // C, D
-                    {
-                        int c = a + (m_data->m_width + 1) + 1;
-                        int d = a + (m_data->m_width + 1);
-                        result.push_back(std::pair<int, int>(c, d));
-                        break;
-                    }
-                    case static_cast<int>(Down):  // A, B
-                    {
-                        int b = a + 1;
-                        result.push_back(std::pair<int, int>(a, b));
-                        break;
-                    }
-                    case static_cast<int>(Left):  // D, A
-                    {
-                        int d = a + (m_data->m_width + 1);
-                        result.push_back(std::pair<int, int>(d, a));
-                        break;
-                    }
-                    case static_cast<int>(Right):  // B, C
-                    {
-                        int b = a + 1;
-                        int c = a + (m_data->m_width + 1) + 1;
-                        result.push_back(std::pair<int, int>(b, c));
-                        break;
-                    }
-                    default:
-                        break;
-                }
-                //
-            }
-        }
-    }
-}
-
-void lvle::TerrainSystem::FindColliderCornerPoints(const std::vector<std::pair<int, int>>& edgeGroup,
-                                                   std::vector<int>& result)
-{
-    int firstCornerIndex = edgeGroup[0].first;
-    result.push_back(firstCornerIndex);
-    int currentSecondPoint = edgeGroup[0].second;
-    enum Direction
-    {
-        Up, Down, Left, Right
-    };
-    Direction currentDirection = Direction::Right;
-    std::vector<int> directions = {m_data->m_width, -m_data->m_width, -1, 1};
-
-    while (firstCornerIndex != currentSecondPoint)
-    {
-        // D  <-  C
-        //   *--*
-        // | |  | ^
-        // v |  | |
-        //   *--*
-        // A  ->  B
-        // find next tile edge ( A->B, B->C, C->D, D->A)
-        auto it = std::find_if(edgeGroup.begin(), edgeGroup.end(),
-                               [currentSecondPoint](const std::pair<int, int>& element)
-                               { return element.first == currentSecondPoint; });
-        currentSecondPoint = it->second;
-        if (it != edgeGroup.end())
-        {
-            int indexDifference = it->second - it->first;
-            Direction edgeDirection = Direction::Up;
-            for (int i = 0; i < directions.size(); i++)
-            {
-                if (indexDifference == directions[i]) edgeDirection = static_cast<Direction>(i);
-            }
-            if (currentDirection != edgeDirection)
-            {
-                currentDirection = edgeDirection;
-                result.push_back(it->first);
-            }
-        }
-    }
-}
-
 glm::ivec2 lvle::TerrainSystem::IndexToCoords(int index, int width)
 {
     return glm::ivec2(index % width, index / width); }
@@ -631,8 +412,8 @@ void lvle::TerrainSystem::DrawWireframe(glm::vec4 color)
         {
             int indexA = x + y * vHeight;
             int indexB = indexA + 1;
-            vec3 aPos = m_data->m_vertices[indexA].position + vec3(0.0f, 0.0f, 0.05f);
-            vec3 bPos = m_data->m_vertices[indexB].position + vec3(0.0f, 0.0f, 0.05f);
+            vec3 aPos = m_data->m_positions[indexA] + vec3(0.0f, 0.0f, 0.05f);
+            vec3 bPos = m_data->m_positions[indexB] + vec3(0.0f, 0.0f, 0.05f);
             Engine.DebugRenderer().AddLine(DebugCategory::Editor, aPos, bPos, color);
         }
     }
@@ -643,8 +424,8 @@ void lvle::TerrainSystem::DrawWireframe(glm::vec4 color)
         {
             int indexA = x + y * vHeight;
             int indexB = indexA + vHeight;
-            vec3 aPos = m_data->m_vertices[indexA].position + vec3(0.0f, 0.0f, 0.05f);
-            vec3 bPos = m_data->m_vertices[indexB].position + vec3(0.0f, 0.0f, 0.05f);
+            vec3 aPos = m_data->m_positions[indexA] + vec3(0.0f, 0.0f, 0.05f);
+            vec3 bPos = m_data->m_positions[indexB] + vec3(0.0f, 0.0f, 0.05f);
             Engine.DebugRenderer().AddLine(DebugCategory::Editor, aPos, bPos, color);
         }
     }
@@ -652,10 +433,10 @@ void lvle::TerrainSystem::DrawWireframe(glm::vec4 color)
 
 void TerrainSystem::DrawNormals(glm::vec4 color)
 {
-    for (int i = 0; i < m_data->m_vertices.size(); i++)
+    for (int i = 0; i < m_data->GetVertexCount(); i++)
     {
-        Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_vertices[i].position,
-                                       m_data->m_vertices[i].position + m_data->m_vertices[i].normal,
+        Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_positions[i],
+                                       m_data->m_positions[i] + m_data->m_normals[i],
                                        color);
     }
 }
@@ -664,33 +445,28 @@ void lvle::TerrainSystem::DrawPathing()
 {
     for (int i = 0; i < m_data->m_tiles.size(); i++)
     {
-        int x = i % m_data->m_width;
-        int y = i / m_data->m_width;
-        int a = x + y * m_data->m_width + y;
-        int b = a + 1;
-        int c = a + (m_data->m_width + 1) + 1;
-        int d = a + (m_data->m_width + 1);
+        const auto [a, b, c, d] = m_data->GetTileVertexIndices(i);
 
         if (m_data->m_tiles[i].tileFlags & TileFlags::NoGroundTraverse)
         {
-            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_vertices[a].position,
-                                           m_data->m_vertices[c].position, vec4(1.0, 0.0, 0.0, 1.0));
-            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_vertices[b].position,
-                                           m_data->m_vertices[d].position, vec4(1.0, 0.0, 0.0, 1.0));
+            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_positions[a],
+                                           m_data->m_positions[c], vec4(1.0, 0.0, 0.0, 1.0));
+            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_positions[b],
+                                           m_data->m_positions[d], vec4(1.0, 0.0, 0.0, 1.0));
         }
         if (m_data->m_tiles[i].tileFlags & TileFlags::NoAirTraverse)
         {
-            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_vertices[a].position,
-                                           m_data->m_vertices[c].position + vec3(0.0, 0.0, 0.02), vec4(0.0, 0.0, 1.0, 1.0));
-            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_vertices[b].position,
-                                           m_data->m_vertices[d].position + vec3(0.0, 0.0, 0.02), vec4(0.0, 0.0, 1.0, 1.0));
+            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_positions[a],
+                                           m_data->m_positions[c] + vec3(0.0, 0.0, 0.02), vec4(0.0, 0.0, 1.0, 1.0));
+            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_positions[b],
+                                           m_data->m_positions[d] + vec3(0.0, 0.0, 0.02), vec4(0.0, 0.0, 1.0, 1.0));
         }
         if (m_data->m_tiles[i].tileFlags & TileFlags::NoBuild)
         {
-            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_vertices[a].position,
-                                           m_data->m_vertices[c].position + vec3(0.0, 0.0, 0.04), vec4(1.0, 1.0, 0.0, 1.0));
-            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_vertices[b].position,
-                                           m_data->m_vertices[d].position + vec3(0.0, 0.0, 0.04), vec4(1.0, 1.0, 0.0, 1.0));
+            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_positions[a],
+                                           m_data->m_positions[c] + vec3(0.0, 0.0, 0.04), vec4(1.0, 1.0, 0.0, 1.0));
+            Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_positions[b],
+                                           m_data->m_positions[d] + vec3(0.0, 0.0, 0.04), vec4(1.0, 1.0, 0.0, 1.0));
         }
     }
 }
@@ -701,12 +477,7 @@ void TerrainSystem::DrawAreas() const
     {
         if (m_data->m_tiles[i].area == 0) continue;
 
-        int x = i % m_data->m_width;
-        int y = i / m_data->m_width;
-        int a = x + y * m_data->m_width + y;
-        int b = a + 1;
-        int c = a + (m_data->m_width + 1) + 1;
-        int d = a + (m_data->m_width + 1);
+        const auto [a, b, c, d] = m_data->GetTileVertexIndices(i);
 
         if (m_data->m_areaPresets.size() <= m_data->m_tiles[i].area)
         {
@@ -716,9 +487,9 @@ void TerrainSystem::DrawAreas() const
 
 
         const auto color = m_data->m_areaPresets[m_data->m_tiles[i].area].color;
-        Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_vertices[a].position, m_data->m_vertices[c].position,
+        Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_positions[a], m_data->m_positions[c],
                                        vec4(color[0], color[1], color[2], 1.0));
-        Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_vertices[b].position, m_data->m_vertices[d].position,
+        Engine.DebugRenderer().AddLine(DebugCategory::Editor, m_data->m_positions[b], m_data->m_positions[d],
                                        vec4(color[0], color[1], color[2], 1.0));
     }
 }
@@ -766,18 +537,18 @@ void lvle::TerrainSystem::SaveLevel(std::string& fileName)
     std::ofstream os(Engine.FileIO().GetPath(bee::FileIO::Directory::Terrain, fileName));
     cereal::JSONOutputArchive archive(os);
     archive(CEREAL_NVP(data));
+
+    // the binary copy is what LoadLevel reads, the json file stays the editable/mergeable version
+    const std::string levelName = std::filesystem::path(fileName).replace_extension().string();
+    if (!SaveTerrainBinary(data, levelName)) bee::Log::Warn("Could not save binary level {}", levelName);
 }
 
 // TODO: Rework this whole logic when you're done converting Terrain to system
 void lvle::TerrainSystem::LoadLevel(const std::string& fileName)
 {
-    if (bee::fileExists(Engine.FileIO().GetPath(bee::FileIO::Directory::Terrain, fileName + ".json")))
+    TerrainDataComponent data{};
+    if (LoadTerrainLevel(fileName, data))
     {
-        TerrainDataComponent data{};
-        std::ifstream is(Engine.FileIO().GetPath(bee::FileIO::Directory::Terrain, fileName + ".json"));
-        cereal::JSONInputArchive archive(is);
-        archive(CEREAL_NVP(data));
-
         //auto view = Engine.ECS().Registry.view<Transform, MeshRenderer, TerrainGroundTagComponent, TerrainDataComponent>();
         //for (auto& entity : view)
         //{
@@ -790,12 +561,16 @@ void lvle::TerrainSystem::LoadLevel(const std::string& fileName)
 
         // CreatePlaneLite(data);
 
-        CreatePlane(data.m_width, data.m_height, data.m_step);
-        // vertices
-        for (int i = 0; i < m_data->m_vertices.size(); i++)
-        {
-            m_data->m_vertices[i] = data.m_vertices[i];
-        }
+        // the mesh is built once, after the loaded data is in place
+        CreatePlaneData(data.m_width, data.m_height, data.m_step);
+        // vertices, whole streams at once
+        m_data->m_positions = std::move(data.m_positions);
+        m_data->m_normals = std::move(data.m_normals);
+        m_data->m_uvs = std::move(data.m_uvs);
+        m_data->m_tangents = std::move(data.m_tangents);
+        m_data->m_bitangents = std::move(data.m_bitangents);
+        m_data->m_cliffLevels = std::move(data.m_cliffLevels);
+        m_data->m_materialWeights = std::move(data.m_materialWeights);
         // indices
         for (int i = 0; i < m_data->m_indices.size(); i++)
         {
@@ -809,7 +584,7 @@ void lvle::TerrainSystem::LoadLevel(const std::string& fileName)
         }
 
         UpdatePlane();
-        m_mesh->SetIndices(m_data->m_indices);
+        if (m_mesh != nullptr) m_mesh->SetIndices(m_chunkedMesh.GetIndices());
     }
 
     UpdateTerrainDataComponent();
@@ -817,34 +592,11 @@ void lvle::TerrainSystem::LoadLevel(const std::string& fileName)
 
 bool TerrainSystem::FindRayMeshIntersection(const glm::vec3& rayStart, const glm::vec3& rayDir, glm::vec3& result)
 {
-    bool foundIntersection = false;
-    for (int i = 0; i < m_data->m_indices.size(); i += 3)
-    {
-        if (!foundIntersection)
-        {
-            int a = m_data->m_indices[i];
-            int b = m_data->m_indices[i + 1];
-            int c = m_data->m_indices[i + 2];
-            glm::vec3 bary = vec3(0.0f, 0.0f, 0.0f);
-            if (foundIntersection = glm::intersectLineTriangle(rayStart, rayDir, m_data->m_vertices[a].position,
-                                                                m_data->m_vertices[b].position, m_data->m_vertices[c].position, bary))
-            {
-                double u, v, w;
-                v = bary.y;
-                w = bary.z;
-                u = 1.0f - (v + w);
-                result.x = u * m_data->m_vertices[a].position.x + v * m_data->m_vertices[b].position.x + w * m_data->m_vertices[c].position.x;
-                result.y = u * m_data->m_vertices[a].position.y + v * m_data->m_vertices[b].position.y + w * m_data->m_vertices[c].position.y;
-                result.z = u * m_data->m_vertices[a].position.z + v * m_data->m_vertices[b].position.z + w * m_data->m_vertices[c].position.z;
-            }
-        }
-        else
-        {
-            break;
-        }
-    }
-    
-    return foundIntersection;
+    TerrainRayHit hit;
+    if (!m_raycaster.Raycast(*m_data, rayStart, rayDir, hit)) return false;
+
+    result = hit.position;
+    return true;
 }
 
 const int lvle::TerrainSystem::GetSmallGridIndexFromPosition(const glm::vec3& position, int tileDimsX, int tileDimsY) const {
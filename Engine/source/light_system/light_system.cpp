@@ -25,6 +25,7 @@ inline bool fileExists(const std::string& name)
 LightSystem::LightSystem()
 {
     Title = "Light System";
+    ReadsNothing();  // the renderer looks the lights up itself
 }
 #ifdef BEE_INSPECTOR
 void LightSystem::Inspect()
@@ -21,6 +21,7 @@ using namespace bee;
 MaterialSystem::MaterialSystem()
 {
     Title = "Material System";
+    ReadsNothing();  // only the inspector and rendering
    // m_previewModel = Engine.Resources().Load<Model>("models/fleet/Sphere.gltf");
 }
 
@@ -39,6 +39,7 @@ void ParticleEmitter::Emit() const
 {
     
     if(particleProps->type == ParticleType::Mesh && m_particleModelPath == "") return;
+    if(m_particleModel == nullptr) return;  // headless, particles are only for show
     
     Entity entity = Engine.ECS().CreateEntity();
     ParticleComponent p;
@@ -81,8 +82,8 @@ void ParticleEmitter::Emit() const
     
     m_particleModel->Instantiate(entity);
     
-    auto& t = Engine.ECS().Registry.get<Transform>(entity);
-    auto& meshRenderer = Engine.ECS().Registry.get<MeshRenderer>(t.FirstChild());
+    auto& hierarchy = Engine.ECS().Registry.get<Hierarchy>(entity);
+    auto& meshRenderer = Engine.ECS().Registry.get<MeshRenderer>(hierarchy.FirstChild());
     meshRenderer.Material = m_particleMaterial;
 
     
@@ -105,6 +106,8 @@ void ParticleEmitter::AssignEntity(Entity newEntity)
 
 void ParticleEmitter::ReloadModels()
 {
+    if(Engine.IsHeadless()) return;
+
     if(m_materialPath != "")
     {
         m_particleMaterial = Engine.Resources().Load<Material>(m_materialPath);
@@ -6,6 +6,7 @@
 
 #include "core/engine.hpp"
 #include "core/transform.hpp"
+#include "rendering/render_components.hpp"
 #include "imgui/imgui_curve.hpp"
 
 
@@ -23,6 +24,8 @@ ParticleSystem::ParticleSystem()
 {
 
     Title = "Particle System";
+    // emitting instantiates the model of the particle
+    Writes<ParticleEmitter, ParticleComponent, Transform, Hierarchy, WorldTransform, MeshRenderer, Entity>();
     m_props = new ParticleProps();
     m_props->colorBegin = {254 / 255.0f, 212 / 255.0f, 123 / 255.0f, 1.0f};
     m_props->colorEnd = {254 / 255.0f, 109 / 255.0f, 41 / 255.0f, 1.0f};
@@ -115,14 +118,14 @@ void ParticleSystem::Update(float deltaTime)
 
 
     
-    const auto rendererView = Engine.ECS().Registry.view<MeshRenderer, Transform>();
+    const auto rendererView = Engine.ECS().Registry.view<MeshRenderer, Hierarchy>();
     for (const auto entity : rendererView)
     {
-        auto& transform = rendererView.get<Transform>(entity);
-        if (Engine.ECS().Registry.all_of<ParticleComponent>(transform.GetParent()))
+        auto& hierarchy = rendererView.get<Hierarchy>(entity);
+        if (Engine.ECS().Registry.all_of<ParticleComponent>(hierarchy.GetParent()))
         {
             auto& meshRenderer = rendererView.get<MeshRenderer>(entity);
-            const auto& particle = Engine.ECS().Registry.get<ParticleComponent>(transform.GetParent());
+            const auto& particle = Engine.ECS().Registry.get<ParticleComponent>(hierarchy.GetParent());
             const float life = particle.lifeRemaining / particle.lifeTime;
             const glm::vec4 color = glm::mix(particle.colorEnd, particle.colorBegin, life);
              
@@ -5,9 +5,7 @@
 #include "core/transform.hpp"
 #include "tools/tools.hpp"
 #include "physics/physics_components.hpp"
-#ifdef _DEBUG
 #include "rendering/debug_render.hpp"
-#endif
 #ifdef BEE_INSPECTOR
 #include "tools/inspector.hpp"
 #endif
@@ -74,6 +72,15 @@ bool CollisionCheckDiskPolygon(const vec2& diskCenter, float diskRadius, const v
     return true;
 }
 
+World::World(const float fixedDeltaTime)
+    : m_fixedDeltaTime(fixedDeltaTime), m_timeSinceLastFrame(0), m_gravity(glm::vec2(0, 0))
+{
+    Title = "Physics";
+    // the world itself stands for HasExecutedFrame, which others look at after the update
+    Writes<Body, Transform, World, DebugRenderer>();
+    Reads<DiskCollider, PolygonCollider>();
+}
+
 void World::ResolveCollision(const CollisionData& collision, Body& body1, Body& body2)
 {
     // if both bodies are not dynamic, there's nothing left to do
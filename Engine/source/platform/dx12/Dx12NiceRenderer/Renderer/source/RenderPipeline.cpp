@@ -59,7 +59,7 @@ void bee::RenderPipeline::Render()
     DirectX::XMFLOAT4X4 temp_mat;
     DirectX::XMStoreFloat4x4(&temp_mat, ConvertGLMToDXMatrix(transform));
 
-    auto cameras = Engine.ECS().Registry.view<Transform, Camera>();
+    auto cameras = Engine.ECS().Registry.view<WorldTransform, Camera>();
     DirectX::XMFLOAT4X4 view_matrix;
     DirectX::XMFLOAT4X4 projection_matrix;
 
@@ -69,7 +69,7 @@ void bee::RenderPipeline::Render()
     for (auto e : cameras)
     {
         const auto& camera = cameras.get<Camera>(e);
-        const auto& cameraTransform = cameras.get<Transform>(e);
+        const auto& cameraTransform = cameras.get<WorldTransform>(e);
 
         const glm::mat4 view = inverse(cameraTransform.WorldMatrix);
 
@@ -232,7 +232,7 @@ ResourceManager::ResourceManager(DeviceManager* device_manager)
 }
 
 
-void ResourceManager::InstanceCounterUpdate(std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::Transform>>& vector,DirectX::XMMATRIX& viewMat,DirectX::XMMATRIX& projMat)
+void ResourceManager::InstanceCounterUpdate(std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::WorldTransform>>& vector,DirectX::XMMATRIX& viewMat,DirectX::XMMATRIX& projMat)
 {
     DirectX::XMMATRIX viewProj = DirectX::XMMatrixMultiply(viewMat, projMat);
 
@@ -307,7 +307,7 @@ void ResourceManager::InstanceCounterUpdate(std::vector<std::tuple<bee::Entity,
     }
 }
 
-void ResourceManager::LoadInMemory(std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::Transform>>& vector)
+void ResourceManager::LoadInMemory(std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::WorldTransform>>& vector)
 {
     for (const auto& [e, renderer, transform] : vector)
     {
@@ -437,14 +437,7 @@ void ResourceManager::BeginFrame(DirectX::XMFLOAT4X4 view, DirectX::XMFLOAT4X4 p
     DirectX::XMMATRIX projMat = DirectX::XMLoadFloat4x4(&projection);
     DirectX::XMMATRIX invViewMatrix = DirectX::XMMatrixInverse(nullptr, viewMat);
 
-    //lets update here all the transform matrix;
-    const auto& transformView = bee::Engine.ECS().Registry.view<bee::Transform>();
-    for (const auto& [e, transform] : transformView.each())
-    {
-        const glm::mat4 world = transform.World();
-        transform.WorldMatrix = world;
-        transform.TranslationWorld = glm::vec3(world[3][0], world[3][1], world[3][2]);
-    }
+    // the world transforms are up to date, EntityComponentSystem::UpdateWorldTransforms ran before the frame started
 
     m_lights.clear();
     drawables.clear();
@@ -454,7 +447,7 @@ void ResourceManager::BeginFrame(DirectX::XMFLOAT4X4 view, DirectX::XMFLOAT4X4 p
     DirectX::XMFLOAT4 lightData = DirectX::XMFLOAT4(0,0,0,0);
 
     int light_count = 0;
-   for (const auto& [e, transform, light] : bee::Engine.ECS().Registry.view<bee::Transform, bee::Light>().each())
+   for (const auto& [e, transform, light] : bee::Engine.ECS().Registry.view<bee::WorldTransform, bee::Light>().each())
    {
       
        m_light_cb.intensity = light.Intensity;
@@ -544,39 +537,39 @@ void ResourceManager::BeginFrame(DirectX::XMFLOAT4X4 view, DirectX::XMFLOAT4X4 p
      m_light_count = light_count;
     
 
-    const auto drawablesView = bee::Engine.ECS().Registry.view<bee::MeshRenderer, bee::Transform>();
+    const auto drawablesView = bee::Engine.ECS().Registry.view<bee::MeshRenderer, bee::Transform, bee::Hierarchy, bee::WorldTransform>(entt::exclude<bee::Hidden>);
 
     // Assuming originalProjectionMatrix is your previously calculated matrix
     DirectX::XMMATRIX scaleMatrix = DirectX::XMMatrixScaling(0.55f, 0.55f, 1.0f);  // Scale x and y by 0.5
     DirectX::XMMATRIX modifiedProjectionMatrix = scaleMatrix * projMat;
 
     DirectX::XMMATRIX viewProj = DirectX::XMMatrixMultiply(viewMat, modifiedProjectionMatrix);
-    for(const auto& [e, renderer, transform]: drawablesView.each())
+    for(const auto& [e, renderer, transform, hierarchy, worldTransform]: drawablesView.each())
     {
         if(transform.Name == "Terrain Ground")
         {
             //never cull the terrain, what is wrong with you, why would you want this
-           // drawables.push_back({e, renderer, transform});
-            drawables.insert(drawables.begin(), {e, renderer, transform});
+           // drawables.push_back({e, renderer, worldTransform});
+            drawables.insert(drawables.begin(), {e, renderer, worldTransform});
             continue;
         }
 
-        const glm::mat4 WorldMatrix = transform.WorldMatrix;
+        const glm::mat4 WorldMatrix = worldTransform.WorldMatrix;
         const DirectX::XMFLOAT3 position = {WorldMatrix[3][0], WorldMatrix[3][1], WorldMatrix[3][2]};
         DirectX::XMVECTOR posVector = DirectX::XMLoadFloat3(&position);
 
         if (isPointInFrustum(posVector, viewProj)) 
         {
-            const bee::Entity& parent = transform.GetParent();
+            const bee::Entity& parent = hierarchy.GetParent();
             if (bee::Engine.ECS().Registry.all_of<bee::ParticleComponent>(parent)) 
             {
-                particleDrawables.push_back({parent, renderer, transform});
+                particleDrawables.push_back({parent, renderer, worldTransform});
             } else if(bee::Engine.ECS().Registry.all_of<lvle::FoliageComponent>(parent))
             {
-                foliageDrawables.push_back({parent, renderer, transform});
+                foliageDrawables.push_back({parent, renderer, worldTransform});
             }else
             {
-                drawables.push_back({e, renderer, transform});
+                drawables.push_back({e, renderer, worldTransform});
             }
         }
     }
@@ -1208,7 +1201,7 @@ void ResourceManager::CreateAccelerationStructures()
         };
     }*/
     
-    for (const auto& [e, renderer, transform] : bee::Engine.ECS().Registry.view<bee::MeshRenderer, bee::Transform>().each())
+    for (const auto& [e, renderer, transform] : bee::Engine.ECS().Registry.view<bee::MeshRenderer, bee::WorldTransform>(entt::exclude<bee::Hidden>).each())
         drawables.push_back({e, renderer, transform});
 
    // std::vector<std::pair<ComPtr<ID3D12Resource>, DirectX::XMMATRIX>> instances;
@@ -7,6 +7,7 @@
 #include "core/device.hpp"
 #include "core/ecs.hpp"
 #include "core/engine.hpp"
+#include "core/simulation_lod.hpp"
 #include "core/transform.hpp"
 #include "animation/animation_state.hpp"
 #include "rendering/render_components.hpp"
@@ -18,6 +19,9 @@
 
 bee::AnimationSystem::AnimationSystem() 
 { 
+    Title = "Animation";
+    Reads<SimulationLOD, Hierarchy, Transform>();
+    Writes<AnimationAgent, MeshRenderer>();  // the skeletons belong to the renderers
 }
 
 bee::AnimationSystem::~AnimationSystem() {}
@@ -62,18 +66,23 @@ void bee::AnimationSystem::Update(float dt)
         [fsmEntities, this,dt](const auto entity) {
           if (!bee::Engine.ECS().Registry.valid(entity)) return;
             AnimationAgent& agent = fsmEntities.get<AnimationAgent>(entity);
-          agent.context.deltaTime = dt;
+          // units far away or off screen sample their animation less often, see SimulationLODSystem
+          const auto* lod = bee::Engine.ECS().Registry.try_get<SimulationLOD>(entity);
+          if (lod != nullptr && !lod->cosmeticUpdate) return;
+          agent.context.deltaTime = lod != nullptr ? lod->cosmeticDeltaTime : dt;
             agent.fsm->Execute(agent.context);
     });
     
-    std::vector<std::tuple<bee::Entity, bee::MeshRenderer, bee::Transform>> drawables;
+    std::vector<std::tuple<bee::Entity, bee::MeshRenderer>> drawables;
     for (const auto& [e, renderer, transform] : bee::Engine.ECS().Registry.view<bee::MeshRenderer, bee::Transform>().each())
-        drawables.push_back({e, renderer, transform});
+        drawables.push_back({e, renderer});
 
-    for (const auto& [e, renderer, transform] : drawables)
+    for (const auto& [e, renderer] : drawables)
     {
         if (renderer.Skeleton)
         {
+            const auto* lod = FindSimulationLOD(bee::Engine.ECS().Registry, e);
+            if (lod != nullptr && !lod->cosmeticUpdate) continue;
             renderer.Skeleton->Update();
         }
     }
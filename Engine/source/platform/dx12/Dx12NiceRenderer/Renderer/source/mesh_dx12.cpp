@@ -529,6 +529,80 @@ void Mesh::SetAttribute(std::vector<Vertex>& data)
 
 
 }
+
+void Mesh::UpdateVertices(std::vector<Vertex>& data, const std::vector<std::pair<size_t, size_t>>& ranges)
+{
+    // a different size needs a new buffer, that path uploads everything anyway
+    if (m_num_verts != data.size() || m_vertexBuffer == nullptr)
+    {
+        SetAttribute(data);
+        return;
+    }
+    if (ranges.empty()) return;
+
+    UINT back_index = Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->GetCurrentBufferIndex();
+    bool close = false;
+
+    if (Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_command_list_closed)
+    {
+        Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->WaitForPreviousFrame();
+        Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_FenceValue[back_index]++;
+
+        auto commandAllocator = Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_CommandAllocators[back_index];
+
+        commandAllocator->Reset();
+        Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->GetCommandList()->Reset(
+            commandAllocator.Get(), Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_PipelineStateObject.Get());
+        Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_command_list_closed = false;
+        close = true;
+    }
+
+    // the upload heap is as big as the vertex buffer, every range is staged at its own offset
+    BYTE* uploadData = nullptr;
+    CD3DX12_RANGE readRange(0, 0);
+    ThrowIfFailed(vBufferUploadHeap->Map(0, &readRange, reinterpret_cast<void**>(&uploadData)));
+    for (const auto& [first, count] : ranges)
+        memcpy(uploadData + first * sizeof(Vertex), data.data() + first, count * sizeof(Vertex));
+    vBufferUploadHeap->Unmap(0, nullptr);
+
+    auto commandList = Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->GetCommandList();
+    {
+        CD3DX12_RESOURCE_BARRIER transitionBarrier =
+            CD3DX12_RESOURCE_BARRIER::Transition(m_vertexBuffer.Get(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE,
+                                                 D3D12_RESOURCE_STATE_COPY_DEST);
+        commandList->ResourceBarrier(1, &transitionBarrier);
+    }
+
+    for (const auto& [first, count] : ranges)
+        commandList->CopyBufferRegion(m_vertexBuffer.Get(), first * sizeof(Vertex), vBufferUploadHeap.Get(),
+                                      first * sizeof(Vertex), count * sizeof(Vertex));
+
+    {
+        CD3DX12_RESOURCE_BARRIER transitionBarrier =
+            CD3DX12_RESOURCE_BARRIER::Transition(m_vertexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST,
+                                                 D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+        commandList->ResourceBarrier(1, &transitionBarrier);
+    }
+
+    b_resetBLAS = true;
+
+    if (close)
+    {
+        commandList->Close();
+
+        ID3D12CommandList* ppCommandLists[] = {commandList.Get()};
+
+        Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_CommandQueue->ExecuteCommandLists(
+            _countof(ppCommandLists), ppCommandLists);
+        Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_command_list_closed = true;
+
+        Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_FenceValue[back_index]++;
+
+        Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_CommandQueue->Signal(
+            Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_Fence[back_index].Get(),
+            Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_FenceValue[back_index]);
+    }
+}
 void Mesh::SetIndices(std::vector<DWORD>& data)
 {
     bool ok = Engine.ECS().GetSystem<RenderPipeline>().GetDeviceManager()->m_command_list_closed;
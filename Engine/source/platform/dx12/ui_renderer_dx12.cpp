@@ -5,6 +5,7 @@
 #include "core/engine.hpp"
 #include "core/transform.hpp"
 #include "rendering/ui_render_data.hpp"
+#include "tools/frame_arena.hpp"
 #include "tools/inspector.hpp"
 #include "user_interface/font_handler.hpp"
 #include "user_interface/user_interface.hpp"
@@ -477,8 +478,10 @@ void UIRenderer::Render()
 
     auto& UI = Engine.ECS().GetSystem<UserInterface>();
 
-    std::vector<std::tuple<bee::Entity, UIElement, Transform>> drawables;
-    for (const auto& [e, renderer, transform] : Engine.ECS().Registry.view<UIElement, Transform>().each())
+    const auto view = Engine.ECS().Registry.view<UIElement, Transform>();
+    FrameVector<std::tuple<bee::Entity, UIElement, Transform>> drawables;
+    drawables.reserve(view.size_hint());
+    for (const auto& [e, renderer, transform] : view.each())
     {
         drawables.push_back({e, renderer, transform});
     }
@@ -501,11 +504,11 @@ void UIRenderer::Render()
             glm::mat4 transmat = glm::mat4(0.0f);
             if (ent == UI.m_selectedElementOverlay && UI.GetSelectedInteractable() != -1)
             {
-                transmat = Engine.ECS().Registry.get<Transform>(UI.GetSelectedElement()).WorldMatrix;
+                transmat = Engine.ECS().Registry.get<WorldTransform>(UI.GetSelectedElement()).WorldMatrix;
             }
             else
             {
-                transmat = trans.WorldMatrix;
+                transmat = Engine.ECS().Registry.get<WorldTransform>(ent).WorldMatrix;
             }
 
             DirectX::XMMATRIX worldMat = ConvertGLMToDXMatrix(transmat);
@@ -59,10 +59,11 @@ DebugRenderer::~DebugRenderer()
 
 void DebugRenderer::Render()
 {
-	for (const auto& [entity, transform, camera] : Engine.ECS().Registry.view<Transform, Camera>().each())
+    if (m_impl == nullptr) return;
+	for (const auto& [entity, transform, camera] : Engine.ECS().Registry.view<WorldTransform, Camera>().each())
     {
         // Get the view and projection matrices from the camera
-        mat4 view = inverse(transform.World());
+        mat4 view = inverse(transform.WorldMatrix);
         mat4 projection = camera.Projection;
         m_impl->Render(view, projection);
 	}
@@ -74,12 +75,12 @@ void DebugRenderer::AddLine(
 	const vec3& to,
 	const vec4& color)
 {
-    if (!(m_categoryFlags & category)) return;
+    if (!(m_categoryFlags & category) || m_impl == nullptr) return;
 	m_impl->AddLine(from, to, color);
 }
 void DebugRenderer::AddLine2D(DebugCategory::Enum category, const vec2& from, const vec2& to, const vec4& color)
 {
-        if (!(m_categoryFlags & category)) return;
+        if (!(m_categoryFlags & category) || m_impl == nullptr) return;
         m_impl->AddLine(from, to, color);
 }
 
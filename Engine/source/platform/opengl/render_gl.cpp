@@ -271,10 +271,10 @@ void Renderer::RenderShadowMaps()
 {
     BEE_PROFILE_FUNCTION();
     int i = 0;
-    auto lights = Engine.ECS().Registry.view<Transform, Light>();
+    auto lights = Engine.ECS().Registry.view<WorldTransform, Light>();
     for (auto e : lights)
     {
-        const Transform& transform = lights.get<Transform>(e);
+        const WorldTransform& transform = lights.get<WorldTransform>(e);
         const Light& light = lights.get<Light>(e);
 
         if (light.Type == Light::Type::Directional && i < m_max_dir_lights)
@@ -289,13 +289,13 @@ void Renderer::RenderShadowMaps()
             m_shadowPass->Activate();
             const float size = light.ShadowExtent;
             const mat4 projection = ortho(size * -0.5f, size * 0.5f, size * -0.5f, size * 0.5f, size * -0.5f, size * 0.5f);
-            const mat4 view = inverse(transform.World());
+            const mat4 view = inverse(transform.WorldMatrix);
             const mat4 vp = projection * view;
 
             m_currentMesh.reset();
             int instances = 0;
 
-            for (const auto& [e, renderer, transform] : Engine.ECS().Registry.view<MeshRenderer, Transform>().each())
+            for (const auto& [e, renderer, transform] : Engine.ECS().Registry.view<MeshRenderer, WorldTransform>(entt::exclude<Hidden>).each())
             {
                 // Check if end of batch is reached
                 if (m_currentMesh != renderer.Mesh || instances > MAX_TRANSFORM_INSTANCES - 1)
@@ -309,7 +309,7 @@ void Renderer::RenderShadowMaps()
                 }
 
                 // Always fill in the information for this object
-                auto world = transform.World();
+                const auto& world = transform.WorldMatrix;
                 m_transformsData->bee_transforms[instances].wvp = vp * world;
                 instances++;
             }
@@ -368,24 +368,25 @@ void Renderer::Render()
     if (m_iblSpecularMipCount != -1) m_forwardPass->GetParameter("u_ibl_specular_mip_count")->SetValue(m_iblSpecularMipCount);
     m_forwardPass->GetParameter("use_alpha_blending")->SetValue(m_useAlphaBlending);
 
-    auto lights = Engine.ECS().Registry.view<Transform, Light>();
+    auto lights = Engine.ECS().Registry.view<Transform, WorldTransform, Light>();
     int dirLightCount = 0;
     int pointLightCount = 0;
     for (const auto& e : lights)
     {
         const auto& l = lights.get<Light>(e);
         const auto& t = lights.get<Transform>(e);
+        const auto& world = lights.get<WorldTransform>(e);
         if (l.Type == Light::Type::Directional && dirLightCount < m_max_dir_lights)
         {
             const float size = l.ShadowExtent;
             const mat4 projection = ortho(size * -0.5f, size * 0.5f, size * -0.5f, size * 0.5f, size * -0.5f, size * 0.5f);
-            const mat4 view = inverse(t.World());
+            const mat4 view = inverse(world.WorldMatrix);
             const mat4 vp = projection * view;
 
             auto& sl = m_dirLightsData->bee_directional_lights[dirLightCount];
             sl.color = l.Color;
             sl.intensity = l.Intensity;
-            sl.direction = t.World() * vec4(0.0f, 0.0f, 1.0f, 0.0f);
+            sl.direction = world.WorldMatrix * vec4(0.0f, 0.0f, 1.0f, 0.0f);
             sl.shadow_matrix = vp;
 
             if (dirLightCount++ > m_max_dir_lights) break;
@@ -429,14 +430,14 @@ void Renderer::Render()
 #endif
 #pragma endregion
 
-    auto cameras = Engine.ECS().Registry.view<Transform, Camera>();
+    auto cameras = Engine.ECS().Registry.view<Transform, WorldTransform, Camera>();
     for (auto e : cameras)
     {
         const auto& camera = cameras.get<Camera>(e);
         const auto& cameraTransform = cameras.get<Transform>(e);
 
-        const mat4 cameraWorld = cameraTransform.World();
-        const mat4 view = inverse(cameraTransform.World());
+        const mat4 cameraWorld = cameras.get<WorldTransform>(e).WorldMatrix;
+        const mat4 view = inverse(cameraWorld);
         const vec4 eyePos = vec4(cameraTransform.Translation, 1.0f);  // cameraWorld* vec4(0.0f, 0.0f, 0.0f, 1.0f);
 
         m_cameraData->bee_view = view;
@@ -456,23 +457,23 @@ void Renderer::Render()
         if (m_useAlphaBlending)
         {
             // Sort the objects by z value
-            std::vector<std::tuple<bee::Entity, MeshRenderer, Transform>> drawables;
-            for (const auto& [e, renderer, transform] : Engine.ECS().Registry.view<MeshRenderer, Transform>().each())
+            std::vector<std::tuple<bee::Entity, MeshRenderer, WorldTransform>> drawables;
+            for (const auto& [e, renderer, transform] : Engine.ECS().Registry.view<MeshRenderer, WorldTransform>(entt::exclude<Hidden>).each())
                 drawables.push_back({e, renderer, transform});
 
             struct CompareDrawables
             {
-                bool operator()(const std::tuple<bee::Entity, MeshRenderer, Transform>& d1,
-                                const std::tuple<bee::Entity, MeshRenderer, Transform>& d2)
+                bool operator()(const std::tuple<bee::Entity, MeshRenderer, WorldTransform>& d1,
+                                const std::tuple<bee::Entity, MeshRenderer, WorldTransform>& d2)
                 {
-                    const auto& t1 = get<2>(d1);
-                    const auto& t2 = get<2>(d2);
-                    if (t1.Translation.z == t2.Translation.z)
+                    const auto& t1 = get<2>(d1).TranslationWorld;
+                    const auto& t2 = get<2>(d2).TranslationWorld;
+                    if (t1.z == t2.z)
                     {
-                        if (t1.Translation.y == t2.Translation.y) return t1.Translation.x < t2.Translation.x;
-                        return t1.Translation.y < t2.Translation.y;
+                        if (t1.y == t2.y) return t1.x < t2.x;
+                        return t1.y < t2.y;
                     }
-                    return t1.Translation.z < t2.Translation.z;
+                    return t1.z < t2.z;
                 }
             };
             std::sort(drawables.begin(), drawables.end(), CompareDrawables());
@@ -493,7 +494,7 @@ void Renderer::Render()
         {
             // Render all objects; try instancing as much as possible
             int instances = 0;
-            for (const auto& [e, renderer, transform] : Engine.ECS().Registry.view<MeshRenderer, Transform>().each())
+            for (const auto& [e, renderer, transform] : Engine.ECS().Registry.view<MeshRenderer, WorldTransform>(entt::exclude<Hidden>).each())
                 ProcessObjectForRendering(renderer, transform, instances);
 
             // Render last buffer
@@ -545,7 +546,7 @@ void Renderer::Render()
     }
 }
 
-void Renderer::ProcessObjectForRendering(const MeshRenderer& renderer, const Transform& transform, int& instances)
+void Renderer::ProcessObjectForRendering(const MeshRenderer& renderer, const WorldTransform& transform, int& instances)
 {
     // Check if end of batch is reached
     if (m_currentMesh != renderer.Mesh || m_currentMaterial != renderer.Material || instances > MAX_TRANSFORM_INSTANCES - 1)
@@ -564,7 +565,7 @@ void Renderer::ProcessObjectForRendering(const MeshRenderer& renderer, const Tra
     }
 
     // Always fill in the information for this object
-    auto world = transform.World();
+    const auto& world = transform.WorldMatrix;
     m_transformsData->bee_transforms[instances].world = world;
     m_transformsData->bee_transforms[instances].wvp = m_cameraData->bee_viewProjection * world;
     instances++;
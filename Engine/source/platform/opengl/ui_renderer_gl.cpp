@@ -224,7 +224,7 @@ unsigned int UIRenderer::LoadShader(std::string name, ShaderType shaderType, std
 
 void UIRenderer::Render()
 {
-    auto view = Engine.ECS().Registry.view<UIElement, Transform>();
+    auto view = Engine.ECS().Registry.view<UIElement, WorldTransform>();
 
     auto& renderer = Engine.ECS().GetSystem<Renderer>();
     auto& UI = Engine.ECS().GetSystem<UserInterface>();
@@ -253,7 +253,7 @@ void UIRenderer::Render()
     {
         if (element.drawing)
         {
-            auto transmat = trans.World();
+            auto transmat = trans.WorldMatrix;
             glUseProgram(m_imgShaderProgram);
             glUniformMatrix4fv(imgtrans, 1, GL_FALSE, glm::value_ptr(transmat));
             glUniform1f(imgop, element.opacity);
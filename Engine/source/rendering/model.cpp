@@ -131,7 +131,7 @@ void Model::InstantiateNode(uint32_t nodeIdx, Entity parent, const ConstantBuffe
     // Transform
     auto& transform = Engine.ECS().CreateComponent<Transform>(entity);
     transform.Name = node.name;
-    if (parent != entt::null) transform.SetParent(parent);
+    if (parent != entt::null) Engine.ECS().Registry.get<Hierarchy>(entity).SetParent(parent);
 
     if (!node.matrix.empty())
     {
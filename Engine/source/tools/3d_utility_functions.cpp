@@ -143,7 +143,7 @@ bool bee::HitResponse(bee::Entity& hitResponse, const glm::vec3& rayOrigin, floa
 
 bool bee::SelectionHitResponse(bee::Entity& hitResponse, const glm::vec3& rayOrigin, float length, const glm::vec3& rayDirection)
 {
-    const auto view = bee::Engine.ECS().Registry.view<Transform, AttributesComponent,EnemyUnit>();
+    const auto view = bee::Engine.ECS().Registry.view<Transform, AttributesComponent, EnemyUnit>(entt::exclude<Hidden>);
 
     bool hit = false;
     glm::vec3 direction1;
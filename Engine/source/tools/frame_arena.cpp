@@ -0,0 +1,209 @@
+#include "tools/frame_arena.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+
+using namespace bee;
+
+namespace
+{
+
+constexpr std::byte kAllocatedPattern{0xCD};
+constexpr std::byte kReleasedPattern{0xDD};
+
+struct FrameArenas
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<LinearArena>> arenas;  // of every thread that ever asked for one
+    std::vector<LinearArena*> unused;                  // of threads that have exited
+    std::atomic<uint64_t> frame = 1;
+};
+
+FrameArenas& GetFrameArenas()
+{
+    static FrameArenas frameArenas;
+    return frameArenas;
+}
+
+// Hands the arena to the next thread when this one exits. Thread pool workers live as long as the engine, but
+// std::execution may start and stop threads.
+struct ThreadArena
+{
+    LinearArena* arena = nullptr;
+
+    ~ThreadArena()
+    {
+        if (arena == nullptr) return;
+        auto& frameArenas = GetFrameArenas();
+        std::lock_guard lock(frameArenas.mutex);
+        frameArenas.unused.push_back(arena);
+    }
+};
+
+thread_local ThreadArena t_threadArena;
+
+}  // namespace
+
+LinearArena::LinearArena(const size_t chunkSize) : m_chunkSize(chunkSize) {}
+
+void* LinearArena::Allocate(const size_t size, const size_t alignment)
+{
+    while (true)
+    {
+        if (m_chunk == m_chunks.size())
+        {
+            const size_t chunkSize = std::max(m_chunkSize, size + alignment);
+            m_chunks.emplace_back(new std::byte[chunkSize]);
+            m_chunkSizes.push_back(chunkSize);
+            m_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+            m_capacity.fetch_add(chunkSize, std::memory_order_relaxed);
+        }
+
+        void* memory = m_chunks[m_chunk].get() + m_offset;
+        size_t space = m_chunkSizes[m_chunk] - m_offset;
+        if (std::align(alignment, size, memory, space) != nullptr)
+        {
+            m_offset = m_chunkSizes[m_chunk] - space + size;
+            m_allocations.fetch_add(1, std::memory_order_relaxed);
+            UpdateUsage();
+            Poison(static_cast<std::byte*>(memory), size, kAllocatedPattern);
+            return memory;
+        }
+
+        // chunks left over from an earlier frame may be too small, those are skipped
+        m_usedBefore += m_chunkSizes[m_chunk];
+        m_chunk++;
+        m_offset = 0;
+    }
+}
+
+void LinearArena::Deallocate(void* pointer, const size_t size)
+{
+    if (m_chunk == m_chunks.size()) return;
+
+    auto* begin = static_cast<std::byte*>(pointer);
+    if (begin + size != m_chunks[m_chunk].get() + m_offset) return;
+
+    Poison(begin, size, kReleasedPattern);
+    m_offset = begin - m_chunks[m_chunk].get();
+    UpdateUsage();
+}
+
+void LinearArena::Reset()
+{
+    assert(m_scopes == 0 && "resetting an arena with an open scope");
+
+    Rewind({});
+    if (m_chunks.size() > 1)
+    {
+        // one chunk that held the whole frame, so the next frame does not have to go to the heap
+        const size_t chunkSize = std::max(m_chunkSize, m_frameUsage);
+        m_chunks.clear();
+        m_chunkSizes.clear();
+        m_chunks.emplace_back(new std::byte[chunkSize]);
+        m_chunkSizes.push_back(chunkSize);
+        m_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        m_capacity.store(chunkSize, std::memory_order_relaxed);
+    }
+    m_frameUsage = 0;
+    m_allocations.store(0, std::memory_order_relaxed);
+}
+
+void LinearArena::Rewind(const Marker& marker)
+{
+    assert(marker.chunk < m_chunk || (marker.chunk == m_chunk && marker.offset <= m_offset));
+
+    for (size_t chunk = marker.chunk; chunk <= m_chunk && chunk < m_chunks.size(); chunk++)
+    {
+        const size_t begin = chunk == marker.chunk ? marker.offset : 0;
+        const size_t end = chunk == m_chunk ? m_offset : m_chunkSizes[chunk];
+        Poison(m_chunks[chunk].get() + begin, end - begin, kReleasedPattern);
+    }
+
+    m_usedBefore = 0;
+    for (size_t chunk = 0; chunk < marker.chunk; chunk++) m_usedBefore += m_chunkSizes[chunk];
+    m_chunk = marker.chunk;
+    m_offset = marker.offset;
+    UpdateUsage();
+}
+
+LinearArena::Statistics LinearArena::GetStatistics() const
+{
+    Statistics statistics;
+    statistics.bytesUsed = m_bytesUsed.load(std::memory_order_relaxed);
+    statistics.highWaterMark = m_highWaterMark.load(std::memory_order_relaxed);
+    statistics.allocations = m_allocations.load(std::memory_order_relaxed);
+    statistics.heapAllocations = m_heapAllocations.load(std::memory_order_relaxed);
+    statistics.capacity = m_capacity.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+void LinearArena::Poison([[maybe_unused]] std::byte* begin, [[maybe_unused]] const size_t size,
+                         [[maybe_unused]] const std::byte value) const
+{
+#ifdef _DEBUG
+    std::memset(begin, static_cast<int>(value), size);
+#endif
+}
+
+void LinearArena::UpdateUsage()
+{
+    const size_t used = m_usedBefore + m_offset;
+    m_frameUsage = std::max(m_frameUsage, used);
+    m_bytesUsed.store(used, std::memory_order_relaxed);
+    if (used > m_highWaterMark.load(std::memory_order_relaxed)) m_highWaterMark.store(used, std::memory_order_relaxed);
+}
+
+LinearArena& bee::FrameArena()
+{
+    auto& frameArenas = GetFrameArenas();
+    if (t_threadArena.arena == nullptr)
+    {
+        std::lock_guard lock(frameArenas.mutex);
+        if (!frameArenas.unused.empty())
+        {
+            t_threadArena.arena = frameArenas.unused.back();
+            frameArenas.unused.pop_back();
+        }
+        else
+        {
+            t_threadArena.arena = frameArenas.arenas.emplace_back(std::make_unique<LinearArena>()).get();
+        }
+    }
+
+    // arenas of other threads catch up with the frame here, an open scope means the thread is still using it
+    auto& arena = *t_threadArena.arena;
+    const uint64_t frame = frameArenas.frame.load(std::memory_order_acquire);
+    if (arena.m_frame != frame && arena.m_scopes == 0)
+    {
+        arena.Reset();
+        arena.m_frame = frame;
+    }
+    return arena;
+}
+
+void bee::ResetFrameArenas()
+{
+    GetFrameArenas().frame.fetch_add(1, std::memory_order_acq_rel);
+    FrameArena();
+}
+
+LinearArena::Statistics bee::GetFrameArenaStatistics()
+{
+    auto& frameArenas = GetFrameArenas();
+    std::lock_guard lock(frameArenas.mutex);
+
+    LinearArena::Statistics total;
+    for (const auto& arena : frameArenas.arenas)
+    {
+        const auto statistics = arena->GetStatistics();
+        total.bytesUsed += statistics.bytesUsed;
+        total.highWaterMark += statistics.highWaterMark;
+        total.allocations += statistics.allocations;
+        total.heapAllocations += statistics.heapAllocations;
+        total.capacity += statistics.capacity;
+    }
+    return total;
+}
@@ -356,7 +356,7 @@ void Inspector::Inspect(float dt)
         for (auto e : cameras)
         {
             const auto& camera = cameras.get<Camera>(e);
-            const auto& cameraTransform = cameras.get<Transform>(e);
+            const auto& cameraTransform = Engine.ECS().Registry.get<WorldTransform>(e);
 
             viewM = inverse(cameraTransform.WorldMatrix);
             proj = camera.Projection;
@@ -416,14 +416,14 @@ void Inspector::Inspect(float dt)
                                bee::Engine.Inspector().data.identityMatrix, 100.f);*/
             /*ImGuizmo::DrawCubes(bee::Engine.Inspector().data.cameraView, bee::Engine.Inspector().data. cameraProjection,
                                 &bee::Engine.Inspector().data.objectMatrix[0][0], bee::Engine.Inspector().data.gizmoCount);*/
-            auto view = Engine.ECS().Registry.view<Selected, Transform>();
+            auto view = Engine.ECS().Registry.view<Selected, Transform, WorldTransform>();
             static Entity lastEntity = entt::null;
-            for (auto [entity, selectedObject, transform] : view.each())
+            for (auto [entity, selectedObject, transform, worldTransform] : view.each())
             {
                 if (lastEntity != entity) data.freeMovement = true;
                 data.floatProjection = (float*)glm::value_ptr(proj);
                 data.floatViewM = (float*)glm::value_ptr(viewM);
-                data.floatTransformM = (float*)glm::value_ptr(transform.WorldMatrix);
+                data.floatTransformM = (float*)glm::value_ptr(worldTransform.WorldMatrix);
 
                 auto guizmoSnap = data.useSnap ? &data.snap[0] : NULL;
                 auto guizmoBounds = data.boundSizing ? data.bounds : NULL;
@@ -467,10 +467,10 @@ void Inspector::Inspect(float dt)
 
     std::set<Entity> inspected;
 
-    Engine.ECS().Registry.view<Transform>().each(
-        [this, &inspected](auto entity, Transform& transform)
+    Engine.ECS().Registry.view<Transform, Hierarchy>().each(
+        [this, &inspected](auto entity, Transform& transform, const Hierarchy& hierarchy)
         {
-            if (!transform.HasParent() && !Engine.ECS().Registry.all_of<ParticleComponent>(entity))
+            if (!hierarchy.HasParent() && !Engine.ECS().Registry.all_of<ParticleComponent>(entity))
                 Inspect(entity, transform, inspected);
         });
     ImGui::End();
@@ -745,9 +745,9 @@ namespace
 void AddToInspected(Entity entity, std::set<Entity>& inspected)
 {
     inspected.insert(entity);
-    if (auto transform = Engine.ECS().Registry.try_get<Transform>(entity))
+    if (auto hierarchy = Engine.ECS().Registry.try_get<Hierarchy>(entity))
     {
-        for (auto child : *transform)
+        for (auto child : *hierarchy)
         {
             AddToInspected(child, inspected);
         }
@@ -761,18 +761,19 @@ void Inspector::Inspect(Entity entity, Transform& transform, std::set<Entity>& i
     if (inspected.find(entity) != inspected.end()) return;
     inspected.insert(entity);
 
-    string name = transform.Name.empty() ? "Entity-" + std::to_string(static_cast<std::uint32_t>(entity)) : transform.Name;
+    string name = transform.Name.empty() ? "Entity-" + std::to_string(static_cast<std::uint32_t>(entity)) : transform.Name.String();
 
     static ImGuiTreeNodeFlags nodeFlags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
 
-    if (transform.HasChildern())
+    const auto& hierarchy = Engine.ECS().Registry.get<Hierarchy>(entity);
+    if (hierarchy.HasChildern())
     {
         const bool nodeOpen =
             ImGui::TreeNodeEx(reinterpret_cast<void*>(static_cast<long long>(entity)),  // NOLINT(performance-no-int-to-ptr)
                               nodeFlags, "%s", name.c_str());
         if (ImGui::IsItemClicked())
         {
-            if (m_insideEditor && !transform.HasParent())
+            if (m_insideEditor && !hierarchy.HasParent())
             {
                 auto view = bee::Engine.ECS().Registry.view<Selected>();
                 bee::Engine.ECS().Registry.remove<Selected>(view.begin(), view.end());
@@ -783,7 +784,7 @@ void Inspector::Inspect(Entity entity, Transform& transform, std::set<Entity>& i
 
         if (nodeOpen)
         {
-            for (auto child : transform)
+            for (auto child : hierarchy)
             {
                 if (Engine.ECS().Registry.valid(child))
                 {
@@ -795,7 +796,7 @@ void Inspector::Inspect(Entity entity, Transform& transform, std::set<Entity>& i
         }
         else
         {
-            for (auto child : transform)
+            for (auto child : hierarchy)
             {
                 AddToInspected(child, inspected);
             }
@@ -0,0 +1,57 @@
+#include "tools/interned_string.hpp"
+
+#include <mutex>
+#include <unordered_set>
+
+using namespace bee;
+
+namespace
+{
+
+// Set nodes never move, so the strings in it can be pointed to. Never destroyed, interned strings may be used by
+// other statics during shutdown.
+struct InternTable
+{
+    std::mutex mutex;
+    std::unordered_set<std::string> strings;
+    size_t bytes = 0;
+};
+
+InternTable& GetTable()
+{
+    static InternTable* table = new InternTable();
+    return *table;
+}
+
+}  // namespace
+
+const std::string* InternedString::Empty()
+{
+    static const std::string empty;
+    return &empty;
+}
+
+const std::string* InternedString::Intern(const std::string& string)
+{
+    if (string.empty()) return Empty();
+
+    auto& table = GetTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    const auto [it, inserted] = table.strings.insert(string);
+    if (inserted) table.bytes += sizeof(std::string) + string.capacity();
+    return &*it;
+}
+
+size_t InternedString::GetInternedCount()
+{
+    auto& table = GetTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    return table.strings.size();
+}
+
+size_t InternedString::GetInternedBytes()
+{
+    auto& table = GetTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    return table.bytes;
+}
@@ -154,9 +154,9 @@ void bee::UpdateMeshRenderer(entt::entity entity,  const std::vector<std::shared
             index ++;
         }
     }
-    if (registry.valid(entity) && registry.all_of<bee::Transform>(entity)) {
-        auto& transform = registry.get<bee::Transform>(entity);
-        for (auto child = transform.begin(); child != transform.end(); ++child) {
+    if (registry.valid(entity) && registry.all_of<bee::Hierarchy>(entity)) {
+        auto& hierarchy = registry.get<bee::Hierarchy>(entity);
+        for (auto child = hierarchy.begin(); child != hierarchy.end(); ++child) {
             UpdateMeshRenderer(*child, materials, index);
         }
     }
@@ -0,0 +1,145 @@
+#include "tools/visibility_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+using namespace bee;
+
+void VisibilityGrid::Resize(const glm::vec2& origin, const float cellSize, const int width, const int height)
+{
+    m_origin = origin;
+    m_cellSize = std::max(cellSize, 0.001f);
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_visibleCells = 0;
+
+    const size_t cells = static_cast<size_t>(m_width) * static_cast<size_t>(m_height);
+    m_observers.assign(cells, 0);
+    m_visible.assign((cells + 63) / 64, 0);
+    m_explored.assign((cells + 63) / 64, 0);
+    m_heights.clear();
+}
+
+void VisibilityGrid::SetHeights(std::vector<float> heights, const float tolerance)
+{
+    m_heights = std::move(heights);
+    if (m_heights.size() != m_observers.size()) m_heights.clear();
+    m_tolerance = tolerance;
+}
+
+int VisibilityGrid::GetCell(const glm::vec2& position) const
+{
+    const glm::vec2 local = (position - m_origin) / m_cellSize;
+    if (!(local.x >= 0.0f && local.y >= 0.0f)) return -1;
+    const int x = static_cast<int>(local.x);
+    const int y = static_cast<int>(local.y);
+    if (x >= m_width || y >= m_height) return -1;
+    return y * m_width + x;
+}
+
+glm::vec2 VisibilityGrid::GetCellCenter(const int cell) const
+{
+    const int x = cell % m_width;
+    const int y = cell / m_width;
+    return m_origin + (glm::vec2(static_cast<float>(x), static_cast<float>(y)) + 0.5f) * m_cellSize;
+}
+
+bool VisibilityGrid::IsVisible(const glm::vec2& position) const
+{
+    const int cell = GetCell(position);
+    return cell != -1 && IsVisible(cell);
+}
+
+bool VisibilityGrid::IsExplored(const glm::vec2& position) const
+{
+    const int cell = GetCell(position);
+    return cell != -1 && IsExplored(cell);
+}
+
+const std::vector<VisibilityGrid::StampCell>& VisibilityGrid::GetStamp(int radius)
+{
+    radius = std::clamp(radius, 0, MaxRadius);
+    if (static_cast<size_t>(radius) >= m_stamps.size()) m_stamps.resize(radius + 1);
+    auto& stamp = m_stamps[radius];
+    if (!stamp.empty()) return stamp;
+
+    // ring by ring outwards, so the parent of a cell, one ring further in, always comes before it
+    const int side = radius * 2 + 1;
+    std::vector<int> indices(static_cast<size_t>(side * side), -1);
+    const float reach = (static_cast<float>(radius) + 0.5f) * (static_cast<float>(radius) + 0.5f);
+    for (int ring = 0; ring <= radius; ring++)
+    {
+        for (int y = -ring; y <= ring; y++)
+        {
+            for (int x = -ring; x <= ring; x++)
+            {
+                if (std::max(std::abs(x), std::abs(y)) != ring) continue;
+                if (static_cast<float>(x * x + y * y) > reach) continue;
+
+                StampCell cell{x, y, -1};
+                if (ring > 0)
+                {
+                    // the cell on the line to the observer one ring further in
+                    const float scale = static_cast<float>(ring - 1) / static_cast<float>(ring);
+                    const int px = static_cast<int>(std::lround(static_cast<float>(x) * scale));
+                    const int py = static_cast<int>(std::lround(static_cast<float>(y) * scale));
+                    cell.parent = indices[(py + radius) * side + px + radius];
+                }
+                indices[(y + radius) * side + x + radius] = static_cast<int>(stamp.size());
+                stamp.push_back(cell);
+            }
+        }
+    }
+    return stamp;
+}
+
+void VisibilityGrid::See(const int cell, const int radius, const int count)
+{
+    if (cell < 0 || cell >= GetCellCount()) return;
+    const int x = cell % m_width;
+    const int y = cell / m_width;
+    const auto& stamp = GetStamp(radius);
+
+    const bool lineOfSight = HasLineOfSight();
+    const float eye = lineOfSight ? m_heights[cell] + m_tolerance : 0.0f;
+    if (lineOfSight) m_inSight.assign(stamp.size(), 0);
+
+    for (size_t i = 0; i < stamp.size(); i++)
+    {
+        const int sx = x + stamp[i].x;
+        const int sy = y + stamp[i].y;
+        if (sx < 0 || sy < 0 || sx >= m_width || sy >= m_height) continue;
+        const int seen = sy * m_width + sx;
+        if (lineOfSight)
+        {
+            // hidden when higher up, or when the cell before it is, the parent of a cell on the grid is on it as well
+            if (m_heights[seen] > eye) continue;
+            if (stamp[i].parent != -1 && !m_inSight[stamp[i].parent]) continue;
+            m_inSight[i] = 1;
+        }
+        Count(seen, count);
+    }
+}
+
+void VisibilityGrid::Count(const int cell, const int count)
+{
+    const bool was = m_observers[cell] > 0;
+    m_observers[cell] += count;
+    const bool is = m_observers[cell] > 0;
+    if (was == is) return;
+
+    const uint64_t bit = uint64_t(1) << (cell & 63);
+    if (is)
+    {
+        m_visible[cell >> 6] |= bit;
+        m_explored[cell >> 6] |= bit;
+        m_visibleCells++;
+    }
+    else
+    {
+        m_visible[cell >> 6] &= ~bit;
+        m_visibleCells--;
+    }
+}
@@ -453,8 +453,7 @@ void UserInterface::Update(float dt)
             {
                 if (element.input)
                 {
-                    auto& trans = Engine.ECS().Registry.get<Transform>(ent);
-                    const auto mat = trans.WorldMatrix;
+                    const auto mat = Engine.ECS().Registry.get<WorldTransform>(ent).WorldMatrix;
                     for (auto& interactable : element.buttons)
                     {
                         auto& inter = interactable.second;
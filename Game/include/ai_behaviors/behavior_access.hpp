@@ -0,0 +1,36 @@
+#pragma once
+#include "actors/attributes.hpp"
+#include "actors/projectile_system/projectile_system.hpp"
+#include "actors/props/resource_system.hpp"
+#include "actors/selection_system.hpp"
+#include "actors/structures/structure_manager_system.hpp"
+#include "actors/targeting_system.hpp"
+#include "actors/units/unit_manager_system.hpp"
+#include "ai/ai_behavior_selection_system.hpp"
+#include "ai/grid_navigation_system.hpp"
+#include "animation/animation_state.hpp"
+#include "core/audio.hpp"
+#include "core/simulation_lod.hpp"
+#include "core/transform.hpp"
+#include "particle_system/particle_system.hpp"
+#include "physics/physics_components.hpp"
+#include "rendering/render_components.hpp"
+#include "tools/debug_metric.hpp"
+#include "user_interface/user_interface.hpp"
+
+/// <summary>
+/// Tells the AI system what the states of the units, structures and the enemy AI touch, so the scheduler can run it
+/// next to the systems it does not conflict with. Spawning a unit or a projectile writes everything they are made of.
+/// </summary>
+inline void DeclareBehaviorAccess(bee::ai::AIBehaviorSelectionSystem& system)
+{
+    system.StatesRead<CombatTarget, bee::ai::GridNavigationSystem>();
+    system.StatesWrite<AttributesComponent, AllyUnit, EnemyUnit, NeutralUnit, AllyStructure, EnemyStructure,
+                       BuffStructure, SpawningStructure, UnitModelTag, UnitPropTagL, UnitPropTagR, Selected,
+                       PropResourceComponent, Projectile, bee::Transform, bee::Hierarchy, bee::WorldTransform,
+                       bee::MeshRenderer, bee::ParticleEmitter, bee::ParticleComponent, bee::SimulationLOD,
+                       bee::DebugMetricData, AnimationAgent, bee::ai::GridAgent, bee::physics::Body,
+                       bee::physics::DiskCollider, bee::physics::Interactable, bee::Entity>();
+    // the systems the states call into
+    system.StatesWrite<UnitManager, ResourceSystem, bee::ui::UserInterface, bee::Audio>();
+}
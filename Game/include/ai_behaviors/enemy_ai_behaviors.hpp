@@ -1,4 +1,5 @@
 #pragma once
+#include "actors/influence_map_system.hpp"
 #include "actors/props/resource_system.hpp"
 #include "actors/props/resource_type.hpp"
 #include "actors/units/unit_manager_system.hpp"
@@ -136,34 +137,39 @@ public:
         return toReturn;
     }
 
+    // whichever of the closest player unit and building is closer
+    glm::vec2 GetClosestPlayerTarget(const glm::vec3& position) const
+    {
+        const auto closestPlayerUnit = GetClosestPlayerUnit(position);
+        const auto closestPlayerBuilding = GetClosestPlayerBuilding(position);
+
+        const auto& playerUnitTransform = bee::Engine.ECS().Registry.get<bee::Transform>(closestPlayerUnit);
+        const auto& playerBuildingTransform = bee::Engine.ECS().Registry.get<bee::Transform>(closestPlayerBuilding);
+        const auto playerUnitPosition = playerUnitTransform.Translation;
+        const auto playerBuildingPosition = playerBuildingTransform.Translation;
+
+        if (glm::distance2(playerBuildingPosition, position) > glm::distance2(playerUnitPosition, position))
+            return glm::vec2(playerUnitPosition.x, playerUnitPosition.y);
+        return glm::vec2(playerBuildingPosition.x, playerBuildingPosition.y);
+    }
+
     void Initialize(bee::ai::StateMachineContext& context) override
     {
         const auto view = bee::Engine.ECS().Registry.view<EnemyUnit, AttributesComponent, bee::Transform>();
 
+        // with an influence map the army goes for the weakest group of the player, without every unit looking at every
+        // player unit and building
+        std::optional<glm::vec2> weakestCluster;
+        if (const auto* influenceMap = bee::Engine.ECS().TryGetSystem<InfluenceMapSystem>())
+            weakestCluster = influenceMap->FindWeakestCluster(Team::Ally);
+
         for (const auto element : view)
         {
             auto& stateMachineAgent = bee::Engine.ECS().Registry.get<bee::ai::StateMachineAgent>(element);
             const auto& unitTransform = bee::Engine.ECS().Registry.get<bee::Transform>(element);
 
-            const auto closestPlayerUnit = GetClosestPlayerUnit(unitTransform.Translation);
-            const auto closestPlayerBuilding = GetClosestPlayerBuilding(unitTransform.Translation);
-
-            const auto& playerUnitTransform = bee::Engine.ECS().Registry.get<bee::Transform>(closestPlayerUnit);
-            const auto& playerBuildingTransform = bee::Engine.ECS().Registry.get<bee::Transform>(closestPlayerBuilding);
-            const auto playerUnitPosition = playerUnitTransform.Translation;
-            const auto playerBuildingPosition = playerBuildingTransform.Translation;
-
-            glm::vec2 targetPosition{};
-
-            if (glm::distance2(playerBuildingPosition, unitTransform.Translation) >
-                glm::distance2(playerUnitPosition, unitTransform.Translation))
-            {
-                targetPosition = glm::vec2(playerUnitPosition.x, playerUnitPosition.y);
-            }
-            else
-            {
-                targetPosition = glm::vec2(playerBuildingPosition.x, playerBuildingPosition.y);
-            }
+            glm::vec2 targetPosition = weakestCluster.has_value() ? *weakestCluster
+                                                                  : GetClosestPlayerTarget(unitTransform.Translation);
 
             targetPosition =
                 bee::Engine.ECS().GetSystem<bee::ai::GridNavigationSystem>().GetGrid().SampleWalkablePoint(targetPosition);
@@ -302,6 +308,13 @@ public:
             numPlayerBuildings++;
         }
 
+        // with an influence map the scout goes where the enemy has not looked for the longest, near the player base
+        if (const auto* influenceMap = bee::Engine.ECS().TryGetSystem<InfluenceMapSystem>())
+        {
+            const glm::vec2 base = numPlayerBuildings > 0 ? position / static_cast<float>(numPlayerBuildings) : position;
+            if (const auto unexplored = influenceMap->FindLeastExplored(base)) position = *unexplored;
+        }
+
         const auto unitsView = bee::Engine.ECS().Registry.view<EnemyUnit, bee::Transform, bee::ai::StateMachineAgent>();
         if (unitsView.size_hint() == 0)
         {
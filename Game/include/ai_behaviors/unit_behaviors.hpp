@@ -3,6 +3,7 @@
 #include "actors/props/resource_system.hpp"
 #include "actors/selection_system.hpp"
 #include "actors/structures/structure_manager_system.hpp"
+#include "actors/targeting_system.hpp"
 #include "actors/units/unit_manager_system.hpp"
 #include "ai/FiniteStateMachines/finite_state_machine.hpp"
 #include "ai/Utils/editor_variables.hpp"
@@ -26,7 +27,11 @@ class RangedAttackState : public bee::ai::State
 {
 public:
     std::shared_ptr<bee::Material> m_fireballMaterial;
-    RangedAttackState() { m_fireballMaterial = bee::Engine.Resources().Load<bee::Material>("materials/Fireball.pepimat"); }
+    RangedAttackState()
+    {
+        m_fireballMaterial = bee::Engine.Resources().Load<bee::Material>("materials/Fireball.pepimat");
+        parallelSafe = true;
+    }
 
     void Initialize(bee::ai::StateMachineContext& context) override
     {
@@ -52,6 +57,9 @@ public:
         auto& bulletTransform = bee::Engine.ECS().Registry.get<bee::Transform>(spawnedBulletEntity);
         bulletTransform.Scale *= 4.0f;
 
+        // a headless engine (the benchmark runner) has no device to load the projectile models with
+        if (bee::Engine.IsHeadless()) return;
+
         if (bee::Engine.ECS().Registry.try_get<AllyUnit>(shooterEntity))
         {
             bee::Engine.Resources().Load<bee::Model>("models/VFX_Mesh_Ball.glb")->Instantiate(spawnedBulletEntity);
@@ -90,7 +98,12 @@ public:
         if (timer <= 0.0f)
         {
             timer = attackSpeed;
-            SpawnBullet(targetEntity, context.entity, transform);
+            // spawning creates entities, so it waits until the agents are done
+            context.Defer(context.entity, [this, targetEntity](const bee::Entity shooterEntity)
+            {
+                if (!bee::Engine.ECS().Registry.valid(targetEntity)) return;
+                SpawnBullet(targetEntity, shooterEntity, bee::Engine.ECS().Registry.get<bee::Transform>(shooterEntity));
+            });
             context.blackboard->SetData("AttackTimer", timer);
         }
     }
@@ -142,13 +155,21 @@ public:
             return;
         }
 
+        const auto* targetTransformPtr = context.Read<bee::Transform>(targetEntity);
+        const auto* targetAttributes = context.Read<AttributesComponent>(targetEntity);
+        if (targetTransformPtr == nullptr || targetAttributes == nullptr)
+        {
+            context.blackboard->SetData("HasTarget", false);
+            return;
+        }
+
         context.blackboard->SetData("HasTarget", true);
         const auto range = bee::Engine.ECS().Registry.get<AttributesComponent>(context.entity).GetValue(BaseAttributes::Range);
         auto& unitTransform = bee::Engine.ECS().Registry.get<bee::Transform>(context.entity);
-        const auto& targetTransform = bee::Engine.ECS().Registry.get<bee::Transform>(targetEntity);
+        const auto& targetTransform = *targetTransformPtr;
 
         float radius = 0.0f;
-        const auto diskCollider = bee::Engine.ECS().Registry.try_get<bee::physics::DiskCollider>(targetEntity);
+        const auto diskCollider = context.Read<bee::physics::DiskCollider>(targetEntity);
         if (diskCollider)
         {
             radius = diskCollider->radius;
@@ -179,7 +200,7 @@ public:
             }
 
 
-            if (bee::Engine.ECS().Registry.get<AttributesComponent>(targetEntity).GetValue(BaseAttributes::HitPoints) > 0)
+            if (targetAttributes->GetValue(BaseAttributes::HitPoints) > 0)
             {
                 if (!bee::Engine.ECS().Registry.valid(context.entity)) return;
                 if (!bee::Engine.ECS().Registry.try_get<bee::ai::GridAgent>(context.entity)) return;
@@ -211,6 +232,8 @@ REGISTER_STATE(RangedAttackState);
 class MeleeAttackState : public bee::ai::State
 {
 public:
+    MeleeAttackState() { parallelSafe = true; }
+
     void Initialize(bee::ai::StateMachineContext& context) override
     {
         const auto attackSpeed =
@@ -236,14 +259,19 @@ public:
 
             timer = attackSpeed;
             context.blackboard->SetData("AttackTimer", timer);
-            auto& attributes = bee::Engine.ECS().Registry.get<AttributesComponent>(targetEntity);
 
-            const auto targetArmor = attributes.GetValue(BaseAttributes::Armor);
+            // the target belongs to another agent, it takes the damage once the agents are done
             const auto damage =
                 bee::Engine.ECS().Registry.get<AttributesComponent>(context.entity).GetValue(BaseAttributes::Damage);
-            attributes.AddModifier(BaseAttributes::HitPoints, { ModifierType::Additive, (-1) * std::abs(damage - targetArmor) });
-            bee::Engine.Audio().PlaySoundW("audio/melee_hit3.wav", 2.0f, true);
+            context.Defer(targetEntity, [damage](const bee::Entity target)
+            {
+                auto* attributes = bee::Engine.ECS().Registry.try_get<AttributesComponent>(target);
+                if (attributes == nullptr) return;
 
+                const auto targetArmor = attributes->GetValue(BaseAttributes::Armor);
+                attributes->AddModifier(BaseAttributes::HitPoints, { ModifierType::Additive, (-1) * std::abs(damage - targetArmor) });
+                bee::Engine.Audio().PlaySoundW("audio/melee_hit3.wav", 2.0f, true);
+            });
         }
     }
 
@@ -295,12 +323,20 @@ public:
             return;
         }
 
+        const auto* targetTransformPtr = context.Read<bee::Transform>(targetEntity);
+        const auto* targetAttributes = context.Read<AttributesComponent>(targetEntity);
+        if (targetTransformPtr == nullptr || targetAttributes == nullptr)
+        {
+            context.blackboard->SetData("HasTarget", false);
+            return;
+        }
+
         const auto range = bee::Engine.ECS().Registry.get<AttributesComponent>(context.entity).GetValue(BaseAttributes::Range);
         auto& unitTransform = bee::Engine.ECS().Registry.get<bee::Transform>(context.entity);
-        const auto& targetTransform = bee::Engine.ECS().Registry.get<bee::Transform>(targetEntity);
+        const auto& targetTransform = *targetTransformPtr;
 
         float radius = 0.0f;
-        const auto diskCollider = bee::Engine.ECS().Registry.try_get<bee::physics::DiskCollider>(targetEntity);
+        const auto diskCollider = context.Read<bee::physics::DiskCollider>(targetEntity);
         if (diskCollider)
         {
             radius = diskCollider->radius;
@@ -309,7 +345,7 @@ public:
         const float distance = glm::distance(targetTransform.Translation, unitTransform.Translation) - radius;
         if (distance <= range)
         {
-            if (bee::Engine.ECS().Registry.get<AttributesComponent>(targetEntity).GetValue(BaseAttributes::HitPoints) > 0)
+            if (targetAttributes->GetValue(BaseAttributes::HitPoints) > 0)
             {
                 const glm::vec2 normalizedDir = glm::normalize(targetTransform.Translation - unitTransform.Translation);
 
@@ -348,6 +384,8 @@ REGISTER_STATE(MeleeAttackState);
 class PatrolState : public bee::ai::State
 {
 public:
+    PatrolState() { parallelSafe = true; }
+
     SERIALIZE_FIELD(float, stoppingDistance);
     void Initialize(bee::ai::StateMachineContext& context) override
     {
@@ -430,6 +468,8 @@ REGISTER_STATE(PatrolState);
 class OffensiveMove : public bee::ai::State
 {
 public:
+    OffensiveMove() { parallelSafe = true; }
+
     void Initialize(bee::ai::StateMachineContext& context) override
     {
         auto& agent = bee::Engine.ECS().Registry.get<bee::ai::GridAgent>(context.entity);
@@ -440,52 +480,11 @@ public:
     void Update(bee::ai::StateMachineContext& context) override
     {
         const auto& unitTransform = bee::Engine.ECS().Registry.get<bee::Transform>(context.entity);
-        auto interceptionRange =
-            bee::Engine.ECS().Registry.get<AttributesComponent>(context.entity).GetValue(BaseAttributes::InterceptionRange);
-        bee::Entity closestEntity;
-        float minDist = std::numeric_limits<float>::max();
-        bool inRange = false;
-
-        if (bee::Engine.ECS().Registry.try_get<AllyUnit>(context.entity))
-        {
-            const auto view = bee::Engine.ECS().Registry.view<EnemyUnit, bee::Transform>();
-            for (const auto entity : view)
-            {
-                auto& transform = view.get<bee::Transform>(entity);
-                const float distance2 = glm::distance2(transform.Translation, unitTransform.Translation);
-                if (distance2 >= glm::pow(interceptionRange, 2)) continue;
-                if (minDist <= distance2) continue;
-                inRange = true;
-                minDist = distance2;
-                closestEntity = entity;
-            }
-        }
-        else
-        {
-            const auto unitView = bee::Engine.ECS().Registry.view<AllyUnit, bee::Transform>();
-            for (const auto entity : unitView)
-            {
-                auto& transform = unitView.get<bee::Transform>(entity);
-                const float distance2 = glm::distance2(transform.Translation, unitTransform.Translation);
-                if (distance2 > glm::pow(interceptionRange, 2)) continue;
-                if (minDist <= distance2) continue;
-                inRange = true;
-                minDist = distance2;
-                closestEntity = entity;
-            }
 
-            const auto buildingView = bee::Engine.ECS().Registry.view<AllyStructure, bee::Transform>();
-            for (const auto entity : buildingView)
-            {
-                auto& transform = buildingView.get<bee::Transform>(entity);
-                const float distance2 = glm::distance2(transform.Translation, unitTransform.Translation);
-                if (distance2 > glm::pow(interceptionRange, 2)) continue;
-                if (minDist <= distance2) continue;
-                inRange = true;
-                minDist = distance2;
-                closestEntity = entity;
-            }
-        }
+        // picked by the TargetingSystem, structures count when moving in for the attack
+        const auto* combatTarget = bee::Engine.ECS().Registry.try_get<CombatTarget>(context.entity);
+        const bee::Entity closestEntity = combatTarget != nullptr ? combatTarget->unitOrStructure : bee::Entity(entt::null);
+        const bool inRange = bee::Engine.ECS().Registry.valid(closestEntity);
 
         if (inRange)
         {
@@ -537,9 +536,14 @@ REGISTER_STATE(OffensiveMove);
 class IdleState : public bee::ai::State
 {
 public:
+    IdleState() { parallelSafe = true; }
+
     void Initialize(bee::ai::StateMachineContext& context) override
     {
         const auto& unitTransform = bee::Engine.ECS().Registry.get<bee::Transform>(context.entity);
+
+        // idle units only leave on a blackboard change (an order, being hit or dying), which wakes them
+        context.Suspend();
     };
     void Update(bee::ai::StateMachineContext& context) override{
 
@@ -552,6 +556,8 @@ REGISTER_STATE(IdleState);
 class OffensiveIdleState : public bee::ai::State
 {
 public:
+    OffensiveIdleState() { parallelSafe = true; }
+
     void Initialize(bee::ai::StateMachineContext& context) override
     {
         const auto& unitTransform = bee::Engine.ECS().Registry.get<bee::Transform>(context.entity);
@@ -559,41 +565,11 @@ public:
     void Update(bee::ai::StateMachineContext& context) override
     {
         if (!bee::Engine.ECS().Registry.valid(context.entity)) return;
-        const auto offensiveVisionRange =
-            bee::Engine.ECS().Registry.get<AttributesComponent>(context.entity).GetValue(BaseAttributes::InterceptionRange);
-        const auto& unitTransform = bee::Engine.ECS().Registry.get<bee::Transform>(context.entity);
-        bee::Entity closestEntity;
-        float minDist = std::numeric_limits<float>::max();
-        bool inRange = false;
 
-        if (bee::Engine.ECS().Registry.try_get<AllyUnit>(context.entity))
-        {
-            const auto view = bee::Engine.ECS().Registry.view<EnemyUnit, bee::Transform>();
-            for (const auto entity : view)
-            {
-                auto& transform = view.get<bee::Transform>(entity);
-                const float distance2 = glm::distance2(transform.Translation, unitTransform.Translation);
-                if (distance2 >= glm::pow(offensiveVisionRange, 2)) continue;
-                if (minDist <= distance2) continue;
-                inRange = true;
-                minDist = distance2;
-                closestEntity = entity;
-            }
-        }
-        else
-        {
-            auto view = bee::Engine.ECS().Registry.view<AllyUnit, bee::Transform>();
-            for (const auto entity : view)
-            {
-                auto& transform = view.get<bee::Transform>(entity);
-                const float distance2 = glm::distance2(transform.Translation, unitTransform.Translation);
-                if (distance2 > glm::pow(offensiveVisionRange, 2)) continue;
-                if (minDist <= distance2) continue;
-                inRange = true;
-                minDist = distance2;
-                closestEntity = entity;
-            }
-        }
+        // picked by the TargetingSystem, only units draw an idle unit out
+        const auto* combatTarget = bee::Engine.ECS().Registry.try_get<CombatTarget>(context.entity);
+        const bee::Entity closestEntity = combatTarget != nullptr ? combatTarget->unit : bee::Entity(entt::null);
+        const bool inRange = bee::Engine.ECS().Registry.valid(closestEntity);
 
         if (inRange)
         {
@@ -617,6 +593,8 @@ REGISTER_STATE(OffensiveIdleState);
 class RevengeAttack : public bee::ai::State
 {
 public:
+    RevengeAttack() { parallelSafe = true; }
+
     void Initialize(bee::ai::StateMachineContext& context) override
     {
         const auto& targetEntity = context.blackboard->GetData<bee::Entity>("LastHitEnemy");
@@ -644,6 +622,8 @@ REGISTER_STATE(RevengeAttack);
 class MoveToPointState : public bee::ai::State
 {
 public:
+    MoveToPointState() { parallelSafe = true; }
+
     void Initialize(bee::ai::StateMachineContext& context) override
     {
         if (!context.blackboard->HasKey<glm::vec2>("PositionToMoveTo"))
@@ -686,12 +666,12 @@ public:
 
         if (hitEntity != entt::null && hitEntity != context.entity) //if we have hit a valid entity which is not the current agent, we check the distance to it.
         {
-            auto hitGridAgent = bee::Engine.ECS().Registry.try_get < bee::ai::GridAgent>(hitEntity);
-            auto& hitUnitTransform = bee::Engine.ECS().Registry.get<bee::Transform>(hitEntity);
+            // other agents may be changing their path right now, look at it as it was
+            const auto* hitGridAgent = context.Read<bee::ai::GridAgent>(hitEntity);
+            const auto* hitUnitTransform = context.Read<bee::Transform>(hitEntity);
+            if (hitGridAgent == nullptr || hitUnitTransform == nullptr) return;
 
-
-            auto distToUnit = glm::distance2(hitUnitTransform.Translation, transform.Translation);
-            if (hitGridAgent == nullptr) return;
+            auto distToUnit = glm::distance2(hitUnitTransform->Translation, transform.Translation);
 
             //if the other agent in our path has stopped and is close enough, this agent also stops
             if (distToUnit < stoppingDistanceSqr && hitGridAgent->path.IsEmpty())
@@ -735,7 +715,7 @@ public:
         auto& collider = bee::Engine.ECS().CreateComponent<bee::physics::DiskCollider>(corpseEntity, 1.0f);
         bee::Engine.ECS().Registry.remove<bee::physics::DiskCollider>(context.entity);
 
-        bee::Engine.Resources().Load<bee::Model>(actualResourcePath)->Instantiate(corpseEntity);
+        if (!bee::Engine.IsHeadless()) bee::Engine.Resources().Load<bee::Model>(actualResourcePath)->Instantiate(corpseEntity);
 
         const auto woodBounty =
             bee::Engine.ECS().Registry.get<AttributesComponent>(context.entity).GetValue(BaseAttributes::WoodBounty);
@@ -775,6 +755,9 @@ public:
 
     void EnemyAddResource(const bee::ai::StateMachineContext& context)
     {
+        // the resource system belongs to the game UI, simulations without it (the benchmark runner) have no resources
+        if (bee::Engine.ECS().TryGetSystem<ResourceSystem>() == nullptr) return;
+
         const auto woodBounty =bee::Engine.ECS().Registry.get<AttributesComponent>(context.entity).GetValue(BaseAttributes::WoodBounty);
         const auto stoneBounty =bee::Engine.ECS().Registry.get<AttributesComponent>(context.entity).GetValue(BaseAttributes::StoneBounty);
 
@@ -837,6 +820,9 @@ public:
             bee::Engine.ECS().Registry.get<AttributesComponent>(context.entity).GetValue(BaseAttributes::DeathCooldown);
         context.blackboard->SetData<float>("DestructionTimer", deathTimer);
         bee::Engine.ECS().Registry.remove<Selected>(context.entity);
+
+        // nothing to do until the timer runs out
+        context.Suspend(static_cast<float>(deathTimer));
     }
 
     void Update(bee::ai::StateMachineContext& context) override
@@ -849,10 +835,10 @@ public:
         if (timer <= 0.0f)
         {
             // Deleting the prop if it exists before deleting the unit
-            auto& tempTransform = bee::Engine.ECS().Registry.get<bee::Transform>(context.entity);
-            auto* propTagR = bee::Engine.ECS().Registry.try_get<UnitPropTagR>(tempTransform.FirstChild());
+            auto& hierarchy = bee::Engine.ECS().Registry.get<bee::Hierarchy>(context.entity);
+            auto* propTagR = bee::Engine.ECS().Registry.try_get<UnitPropTagR>(hierarchy.FirstChild());
             if (propTagR != nullptr) bee::Engine.ECS().DeleteEntity(propTagR->propRight);
-            auto* propTagL = bee::Engine.ECS().Registry.try_get<UnitPropTagL>(tempTransform.FirstChild());
+            auto* propTagL = bee::Engine.ECS().Registry.try_get<UnitPropTagL>(hierarchy.FirstChild());
             if (propTagL != nullptr) bee::Engine.ECS().DeleteEntity(propTagL->propLeft);
             if (woodBounty > 0.0f)
             {
@@ -871,6 +857,7 @@ public:
             return;
         }
         context.blackboard->SetData<float>("DestructionTimer", timer);
+        context.Suspend(timer);
     }
     void End(bee::ai::StateMachineContext& context) override {}
 
@@ -6,14 +6,17 @@
 
 #include "actors/actor_wrapper.hpp"
 #include "actors/buff_system.hpp"
+#include "actors/influence_map_system.hpp"
 #include "actors/projectile_system/projectile_system.hpp"
 #include "actors/props/resource_system.hpp"
 #include "actors/selection_system.hpp"
 #include "actors/units/unit_manager_system.hpp"
+#include "actors/visibility_system.hpp"
 #include "ai/ai_behavior_selection_system.hpp"
 #include "ai/behavior_editor_system.hpp"
 #include "ai/grid_navigation_system.hpp"
 #include "ai/navigation_grid.hpp"
+#include "ai_behaviors/behavior_access.hpp"
 #include "ai_behaviors/wave_system.hpp"
 #include "animation/animation_state.hpp"
 #include "camera/camera_rts_system.hpp"
@@ -134,7 +137,10 @@ void Starcraft::Init()
                                        resourceSystem.playerResourceData.resources[GameResourceType::Stone]);
     bee::actors::CreateActorSystems();
 
-    bee::Engine.ECS().CreateSystem<bee::ai::AIBehaviorSelectionSystem>(1.0f / 6.0f);
+    auto& aiSystem = bee::Engine.ECS().CreateSystem<bee::ai::AIBehaviorSelectionSystem>(1.0f / 6.0f);
+    // units in parallel-safe states change their own path and look at the paths of others
+    aiSystem.GetSnapshot().Capture<bee::ai::GridAgent>();
+    DeclareBehaviorAccess(aiSystem);
 
     bee::Engine.ECS().CreateSystem<bee::MaterialSystem>();
 
@@ -168,6 +174,10 @@ void Starcraft::Init()
         bee::Engine.DebugRenderer().SetCategoryFlags(flags);
         bee::Engine.ECS().CreateSystem<WaveSystem>().Pause(true);
         bee::Engine.ECS().CreateSystem<BuffSystem>();
+        // what the enemy AI decides where to attack and scout with
+        bee::Engine.ECS().CreateSystem<InfluenceMapSystem>().UpdateFromTerrain();
+        // the fog of war, hides the enemies the player cannot see
+        bee::Engine.ECS().CreateSystem<VisibilitySystem>().UpdateFromTerrain();
     }
 
     auto camera = bee::Engine.ECS().GetSystem<bee::CameraSystemRTS>();
@@ -460,7 +470,7 @@ void Starcraft::Update(float dt)
     bool endGame = true;
     for (auto [entity, allyStructure, transform] : bee::Engine.ECS().Registry.view<AllyStructure, bee::Transform>().each())
     {
-        if (transform.Name.find("TownHall") != std::string::npos) endGame = false;
+        if (transform.Name.String().find("TownHall") != std::string::npos) endGame = false;
     }
     if (endGame && !m_endScreen)
     {
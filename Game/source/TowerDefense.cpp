@@ -11,10 +11,12 @@
 #include "ai/behavior_editor_system.hpp"
 #include "ai/grid_navigation_system.hpp"
 #include "ai/navigation_grid.hpp"
+#include "ai_behaviors/behavior_access.hpp"
 #include "ai_behaviors/unit_behaviors.hpp"
 #include "camera/camera_rts_system.hpp"
 #include "core/ecs.hpp"
 #include "core/engine.hpp"
+#include "core/simulation_lod.hpp"
 #include "level_editor/terrain_system.hpp"
 #include "order/order_system.hpp"
 #include "physics/world.hpp"
@@ -29,6 +31,7 @@ void TowerDefense::Init()
     if (!bee::Engine.WasPreInitialized())
     {
         bee::Engine.ECS().CreateSystem<bee::CameraSystemRTS>();
+        bee::Engine.ECS().CreateSystem<bee::SimulationLODSystem>();
         bee::Engine.ECS().CreateSystem<bee::RenderPipeline>();
         bee::Engine.ECS().CreateSystem<bee::AnimationSystem>();
         auto& UI = bee::Engine.ECS().CreateSystem<bee::ui::UserInterface>();
@@ -46,7 +49,10 @@ void TowerDefense::Init()
 
     bee::actors::CreateActorSystems();
 
-    bee::Engine.ECS().CreateSystem<bee::ai::AIBehaviorSelectionSystem>(1.0f / 6.0f);
+    auto& aiSystem = bee::Engine.ECS().CreateSystem<bee::ai::AIBehaviorSelectionSystem>(1.0f / 6.0f);
+    // units in parallel-safe states change their own path and look at the paths of others
+    aiSystem.GetSnapshot().Capture<bee::ai::GridAgent>();
+    DeclareBehaviorAccess(aiSystem);
 
     {  // Terrain
         auto& terrain_system = bee::Engine.ECS().GetSystem<lvle::TerrainSystem>();
@@ -6,6 +6,7 @@
 #include "ai_behaviors/wave_system.hpp"
 #include "core/device.hpp"
 #include "order/order_system.hpp"
+#include "rendering/render_components.hpp"
 #include "tools/3d_utility_functions.hpp"
 #include "tools/tools.hpp"
 #include "user_interface/user_interface.hpp"
@@ -234,7 +235,7 @@ void InGameUI::CheckPopups()
         bool repairedRuin = true;
         for (auto [entity, allyStructure, transform] : bee::Engine.ECS().Registry.view<AllyStructure, bee::Transform>().each())
         {
-            if (transform.Name.find("TownHallLvl0") != std::string::npos)
+            if (transform.Name.String().find("TownHallLvl0") != std::string::npos)
             {
                 repairedRuin = false;
                 break;
@@ -272,8 +273,8 @@ void InGameUI::CheckPopups()
         bool fixedBar = true;
         for (auto [entity, allyStructure, transform] : bee::Engine.ECS().Registry.view<AllyStructure, bee::Transform>().each())
         {
-            fixedBar = transform.Name.find("SwordsmenTowerLvl0") != std::string::npos ? false : fixedBar;
-            fixedMage = transform.Name.find("MageTowerLvl0") != std::string::npos ? false : fixedMage;
+            fixedBar = transform.Name.String().find("SwordsmenTowerLvl0") != std::string::npos ? false : fixedBar;
+            fixedMage = transform.Name.String().find("MageTowerLvl0") != std::string::npos ? false : fixedMage;
         }
         if (fixedBar && fixedMage && m_currentPopup == Popups::FixBarAndMage)
         {
@@ -898,7 +899,7 @@ void InGameUI::Update(float dt)
     for (auto [entity, allyStructure, transform, attrib] :
          bee::Engine.ECS().Registry.view<AllyStructure, bee::Transform, AttributesComponent>().each())
     {
-        if (transform.Name.find("TownHall") != std::string::npos)
+        if (transform.Name.String().find("TownHall") != std::string::npos)
         {
             auto upgradeLvl = static_cast<int>(attrib.GetEntityType()[attrib.GetEntityType().size() - 1]) - 48;
             ui.ReplaceString(ui.GetComponentID(town, "townhallAmount"), std::to_string(upgradeLvl));
@@ -1225,7 +1226,7 @@ int InGameUI::UpdateEnemies(int index)
 
     auto& UI = Engine.ECS().GetSystem<UserInterface>();
 
-    auto viewEnemies = bee::Engine.ECS().Registry.view<AttributesComponent, bee::Transform, EnemyUnit>();
+    auto viewEnemies = bee::Engine.ECS().Registry.view<AttributesComponent, bee::Transform, EnemyUnit>(entt::exclude<bee::Hidden>);
     for (auto [entity, attributes, transform, unit] : viewEnemies.each())
     {
         // Checks to see if it could reuse already existing progress bars
@@ -7,6 +7,7 @@
 
 #include "actors/actor_wrapper.hpp"
 #include "camera/camera_rts_system.hpp"
+#include "core/simulation_lod.hpp"
 #include "leaderboard/leaderboard.hpp"
 #include "level_editor/terrain_system.hpp"
 #include "material_system/material_system.hpp"
@@ -20,6 +21,7 @@ void InitializeSystems()
     bee::Engine.ECS().CreateSystem<bee::AssetExplorer>();
     bee::Engine.ECS().CreateSystem<bee::MaterialSystem>();
     bee::Engine.ECS().CreateSystem<bee::CameraSystemRTS>();
+    bee::Engine.ECS().CreateSystem<bee::SimulationLODSystem>();
     auto& renderer = bee::Engine.ECS().CreateSystem<bee::RenderPipeline>();
     renderer.SetIsPausable(false);
     bee::Engine.ECS().CreateSystem<bee::AnimationSystem>();
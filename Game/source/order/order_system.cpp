@@ -367,6 +367,16 @@ bool OrderSystem::GetTerrainRaycastPosition(const glm::vec3 mouseWorldDirection,
 
 // --- Initializing Unit orders
 
+namespace
+{
+// AI and navigation are time sliced, an ordered unit jumps the queue so it reacts on the next frame
+void PrioritizeOrderedUnit(const bee::Entity entity, bee::ai::StateMachineAgent& stateMachineAgent)
+{
+    stateMachineAgent.slice.Prioritize();
+    if (auto* gridAgent = bee::Engine.ECS().Registry.try_get<bee::ai::GridAgent>(entity)) gridAgent->slice.Prioritize();
+}
+}  // namespace
+
 void OrderSystem::InitializeAttackOrder()
 {
     Order attackOrder;
@@ -393,6 +403,7 @@ void OrderSystem::InitializeAttackOrder()
                 stateMachineAgent.SetStateOfType<RangedAttackState>();
             else if (stateMachineAgent.fsm.StateExists<MeleeAttackState>())
                 stateMachineAgent.SetStateOfType<MeleeAttackState>();
+            PrioritizeOrderedUnit(entity, stateMachineAgent);
 
         }
         auto& hit = bee::Engine.ECS().Registry.get<bee::Transform>(targetEntity);
@@ -428,6 +439,7 @@ void OrderSystem::InitializeMoveOrder()
                 if (stateMachineAgent.IsInState<DeadState>()) continue;
                 stateMachineAgent.context.blackboard->SetData("PositionToMoveTo", glm::vec2(hit.x, hit.y));
                 stateMachineAgent.SetStateOfType<MoveToPointState>();
+                PrioritizeOrderedUnit(entity, stateMachineAgent);
             }
             if (unitView.begin() != unitView.end())
             {
@@ -476,6 +488,7 @@ void OrderSystem::InitializeOffensiveMoveOrder()
                 if (stateMachineAgent.IsInState<DeadState>()) continue;
                 stateMachineAgent.context.blackboard->SetData("PositionToMoveTo", glm::vec2(hit.x, hit.y));
                 stateMachineAgent.SetStateOfType<OffensiveMove>();
+                PrioritizeOrderedUnit(entity, stateMachineAgent);
                 //auto& transform = bee::Engine.ECS().Registry.get<bee::Transform>(m_attackGoalEntity);
                 //transform.Translation = hit;
                 //auto& emitter = bee::Engine.ECS().Registry.get<bee::ParticleEmitter>(m_attackGoalEntity);
@@ -512,6 +525,7 @@ void OrderSystem::InitializePatrolOrder()
                 stateMachineAgent.context.blackboard->SetData<glm::vec3>("PatrolPoint1", transform.Translation);
                 stateMachineAgent.context.blackboard->SetData<glm::vec3>("PatrolPoint2", glm::vec3(hit.x, hit.y, 0));
                 stateMachineAgent.SetStateOfType<PatrolState>();
+                PrioritizeOrderedUnit(entity, stateMachineAgent);
             }
         }
     };
@@ -891,9 +905,10 @@ void OrderSystem::InitializeTrainOrder(const std::string& unitHandle, OrderType
 
             if (stateMachineAgent.context.blackboard->HasKey<int>("NumUnits"))
             {
-                auto& numUnits = stateMachineAgent.context.blackboard->GetData<int>("NumUnits");
+                const auto numUnits = stateMachineAgent.context.blackboard->GetData<int>("NumUnits");
                 if (numUnits >= spawningStructure.spawnLimit) return;
-                numUnits = std::clamp(numUnits + 1, 0, spawningStructure.spawnLimit);
+                stateMachineAgent.context.blackboard->SetData<int>("NumUnits",
+                                                                   std::clamp(numUnits + 1, 0, spawningStructure.spawnLimit));
             }
             else
             {
@@ -34,7 +34,6 @@ void TrainUnitState::Update(bee::ai::StateMachineContext& context)
 
     if (timer <= 0 && context.blackboard->GetData<bool>("isTraining"))
     {
-        auto& resourceSystem = bee::Engine.ECS().GetSystem<ResourceSystem>();
         if (myTeam == Team::Ally)
         {
             const auto& transform = bee::Engine.ECS().Registry.get<bee::Transform>(context.entity);
@@ -49,50 +48,38 @@ void TrainUnitState::Update(bee::ai::StateMachineContext& context)
 
         auto attributes = bee::Engine.ECS().GetSystem<UnitManager>().GetUnitTemplate(unitHandle).GetAttributes();
         context.blackboard->SetData("TrainTimer", attributes[BaseAttributes::CreationTime] - timeReduction);
-        auto& numUnits = context.blackboard->GetData<int>("NumUnits");
+        const auto numUnits = context.blackboard->GetData<int>("NumUnits");
 
         //play spawn sound
         bee::Engine.Audio().PlaySoundW("audio/friend_spawn.wav", 1.5f, true);
 
-        numUnits--;
+        // set rather than changed through the reference, so event-driven transitions see it
+        context.blackboard->SetData("NumUnits", numUnits - 1);
     }
 }
 
 void BuildingDestroyedState::Initialize(bee::ai::StateMachineContext& context)
 {
     auto structureManager = bee::Engine.ECS().GetSystem<StructureManager>();
-    auto view = bee::Engine.ECS().Registry.view<AllyUnit, bee::Transform, AttributesComponent>();
 
-    const auto buffStructure = bee::Engine.ECS().Registry.try_get<BuffStructure>(context.entity);
-    if (buffStructure)
-    {
-        for (const auto entity : buffStructure->buffedEntities)
-        {
-            if (!bee::Engine.ECS().Registry.valid(entity)) continue;
-            auto& attributes = view.get<AttributesComponent>(entity);
-            for (auto& modifier : attributes.GetModifiers(buffStructure->buffType))
-            {
-                const double value = modifier.GetValue();
-                if (value != buffStructure->buffModifier.GetValue()) continue;
-                if (modifier.GetModifierType() != buffStructure->buffModifier.GetModifierType()) continue;
-                bee::Engine.ECS().GetSystem<BuffSystem>().RemoveBuff(attributes, *buffStructure, modifier);
-            }
-        }
-    }
+    // the BuffSystem takes the buff of the aura off the units in it
+    bee::Engine.ECS().Registry.remove<BuffStructure>(context.entity);
     bee::Engine.ECS().Registry.remove<Selected>(context.entity);
 
     bee::Engine.Audio().PlaySoundW("audio/rock_death2.wav",3.0f,true);
     const auto& attributes = bee::Engine.ECS().Registry.get<AttributesComponent>(context.entity);
-    auto& orderSystem = bee::Engine.ECS().GetSystem<OrderSystem>();
-
-    if (attributes.HasAttribute(BaseAttributes::SwordsmenLimitIncrease))
+    // the headless benchmark has no player, so no order system to keep the unit limits of
+    if (auto* orderSystem = bee::Engine.ECS().TryGetSystem<OrderSystem>())
     {
-        orderSystem.swordsmenLimit -= attributes.GetValue(BaseAttributes::SwordsmenLimitIncrease);
-    }
+        if (attributes.HasAttribute(BaseAttributes::SwordsmenLimitIncrease))
+        {
+            orderSystem->swordsmenLimit -= attributes.GetValue(BaseAttributes::SwordsmenLimitIncrease);
+        }
 
-    if (attributes.HasAttribute(BaseAttributes::MageLimitIncrease))
-    {
-        orderSystem.mageLimit -= attributes.GetValue(BaseAttributes::MageLimitIncrease);
+        if (attributes.HasAttribute(BaseAttributes::MageLimitIncrease))
+        {
+            orderSystem->mageLimit -= attributes.GetValue(BaseAttributes::MageLimitIncrease);
+        }
     }
 
     structureManager.RemoveStructure(context.entity);
@@ -0,0 +1,1628 @@
+#include <pch.h>
+#include "CppUnitTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "actors/attributes.hpp"
+#include "ai/BehaviorTrees/behavior_tree.hpp"
+#include "ai/BehaviorTrees/behavior_tree_builder.hpp"
+#include "ai/FiniteStateMachines/finite_state_machine.hpp"
+#include "ai/Utils/generic_factory.hpp"
+#include "ai/ai_behavior_selection_system.hpp"
+#include "ai/grid_navigation_system.hpp"
+#include "ai/navigation_grid.hpp"
+#include "ai/time_slicer.hpp"
+#include "ai/timer_wheel.hpp"
+#include "core/ecs.hpp"
+#include "core/engine.hpp"
+#include "core/fileio.hpp"
+#include "core/simulation_lod.hpp"
+#include "core/transform.hpp"
+#include "physics/physics_components.hpp"
+#include "physics/world.hpp"
+#include "rendering/render_components.hpp"
+#include "tools/log.hpp"
+
+#include "test_helpers.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+
+// Cosmetic state of a unit, like its animation: only updated on the frames its SimulationLOD allows.
+struct Wobble
+{
+    float phase = 0.0f;
+    int updates = 0;
+    bee::SimulationTier lastTier = bee::SimulationTier::Full;
+};
+
+// The joints of a skeleton, posed every frame like bee::Skeleton::Update does.
+struct TestSkeleton
+{
+    std::vector<glm::mat4> local = std::vector<glm::mat4>(40, glm::mat4(1.0f));
+    std::vector<glm::mat4> world = std::vector<glm::mat4>(40, glm::mat4(1.0f));
+
+    void Pose(const float time)
+    {
+        for (size_t joint = 0; joint < local.size(); joint++)
+        {
+            local[joint] = glm::rotate(glm::mat4(1.0f), time + static_cast<float>(joint), glm::vec3(0.0f, 0.0f, 1.0f));
+            world[joint] = joint == 0 ? local[joint] : world[(joint - 1) / 2] * local[joint];
+        }
+    }
+};
+
+// A camera looking at the battle field from above and behind, with the given field of view in degrees.
+void AimCamera(bee::Camera& camera, bee::Transform& transform, const glm::vec3& target, const float fov)
+{
+    transform.Translation = target + glm::vec3(0.0f, -18.0f, 20.0f);
+    camera.Projection = glm::perspective(glm::radians(fov), 16.0f / 9.0f, 0.5f, 600.0f);
+    camera.View = glm::lookAt(transform.Translation, target, glm::vec3(0.0f, 0.0f, 1.0f));
+    camera.VP = camera.Projection * camera.View;
+}
+
+// The enemy a unit of the scripted battle goes after, picked by EngageState.
+struct Engagement
+{
+    bee::Entity target = entt::null;
+    int decisions = 0;
+};
+
+// Picks the closest living enemy as the target and walks up to it. The decision is only as fresh as the last tick of the
+// agent, so units out of view (see SimulationLOD) switch targets a little later.
+class EngageState : public bee::ai::State
+{
+public:
+    void Update(bee::ai::StateMachineContext& context) override
+    {
+        auto& registry = bee::Engine.ECS().Registry;
+        if (registry.get<Health>(context.entity).value <= 0.0f) return;
+        const glm::vec3& position = registry.get<bee::Transform>(context.entity).Translation;
+        const int team = registry.get<AttributesComponent>(context.entity).GetTeam();
+
+        auto& engagement = registry.get<Engagement>(context.entity);
+        engagement.decisions++;
+        engagement.target = entt::null;
+        glm::vec3 targetPosition(0.0f);
+        float closest = std::numeric_limits<float>::max();
+        for (auto [other, health, attributes, transform] : registry.view<Health, AttributesComponent, bee::Transform>().each())
+        {
+            if (attributes.GetTeam() == team || health.value <= 0.0f) continue;
+            const float distance = glm::distance(position, transform.Translation);
+            if (distance >= closest) continue;
+            closest = distance;
+            engagement.target = other;
+            targetPosition = transform.Translation;
+        }
+        if (engagement.target == entt::null) return;
+
+        auto& agent = registry.get<bee::ai::GridAgent>(context.entity);
+        if (glm::distance(agent.goal, glm::vec2(targetPosition)) > 1.0f) agent.SetGoal(glm::vec2(targetPosition));
+    }
+};
+
+struct BattleOutcome
+{
+    std::vector<float> health;
+    int cosmeticUpdates = 0;
+    int tierChanges = 0;
+    std::set<bee::SimulationTier> tiersSeen;
+    int decisions = 0;
+    int steeredAgents = 0;
+    int verticalUpdates = 0;
+};
+
+// Two lines of units walk into each other and fight: every unit goes after the enemy its AI picked and hits it once in
+// reach, the player's units four times as hard. With a panningCamera, a camera moves over the battle, so the units go in
+// and out of view and through the simulation tiers, which slows down their AI and steering.
+BattleOutcome RunScriptedBattle(const bool panningCamera)
+{
+    bee::Engine.InitializeHeadless();
+    auto& ecs = bee::Engine.ECS();
+    auto& registry = ecs.Registry;
+    constexpr int frames = 300;
+    constexpr float dt = 1.0f / 30.0f;
+    constexpr float reach = 1.5f;
+
+    bee::ai::FiniteStateMachine fsm;
+    fsm.AddState<EngageState>(true);
+    fsm.Compile();
+
+    std::vector<bee::Entity> units;
+    for (int i = 0; i < 40; i++)
+    {
+        const bool ally = i % 2 == 0;
+        const glm::vec3 position(ally ? 6.0f : 26.0f, 8.0f + static_cast<float>(i / 2) * 0.8f, 0.0f);
+        const auto unit = BuildTestUnit(fsm, position, 2);
+        registry.get<AttributesComponent>(unit).SetTeam(static_cast<int>(ally ? Team::Ally : Team::Enemy));
+        registry.get<bee::ai::GridAgent>(unit).SetGoal(glm::vec2(ally ? 26.0f : 6.0f, position.y));
+        ecs.CreateComponent<Health>(unit);
+        ecs.CreateComponent<Engagement>(unit);
+        ecs.CreateComponent<Wobble>(unit);
+        units.push_back(unit);
+    }
+
+    BattleOutcome outcome;
+    int frame = 0;
+    if (panningCamera)
+    {
+        // created after the units, so both battles hand out the same entity ids to them
+        const auto camera = ecs.CreateEntity();
+        ecs.CreateComponent<bee::Transform>(camera);
+        ecs.CreateComponent<bee::Camera>(camera);
+        ecs.CreateSystem<TestSystem>("camera", 0,
+                                     [&, camera]
+                                     {
+                                         const float x = 32.0f * static_cast<float>(frame) / static_cast<float>(frames);
+                                         AimCamera(registry.get<bee::Camera>(camera), registry.get<bee::Transform>(camera),
+                                                   glm::vec3(x, 16.0f, 0.0f), 30.0f);
+                                     });
+    }
+    ecs.CreateSystem<bee::SimulationLODSystem>(6.5f, 4);
+    ecs.CreateSystem<TestSystem>("animation", 0,
+                                 [&]
+                                 {
+                                     for (auto [entity, lod, wobble] : registry.view<bee::SimulationLOD, Wobble>().each())
+                                     {
+                                         outcome.tiersSeen.insert(lod.tier);
+                                         if (lod.tier != wobble.lastTier) outcome.tierChanges++;
+                                         wobble.lastTier = lod.tier;
+                                         if (!lod.cosmeticUpdate) continue;
+                                         wobble.phase += lod.cosmeticDeltaTime;
+                                         wobble.updates++;
+                                         outcome.cosmeticUpdates++;
+                                     }
+                                 });
+
+    ecs.CreateSystem<bee::ai::AIBehaviorSelectionSystem>(0.1f);
+    auto& navigation =
+        ecs.CreateSystem<bee::ai::GridNavigationSystem>(0.1f, bee::ai::NavigationGrid(glm::vec2(0.0f), 1, 32, 32));
+    ecs.CreateSystem<bee::physics::World>(0.02f);
+    ecs.CreateSystem<TestSystem>("combat", 0,
+                                 [&]
+                                 {
+                                     for (auto [entity, health, attributes, engagement, transform] :
+                                          registry.view<Health, AttributesComponent, Engagement, bee::Transform>().each())
+                                     {
+                                         if (health.value <= 0.0f || engagement.target == entt::null) continue;
+                                         auto& target = registry.get<Health>(engagement.target);
+                                         const auto& targetTransform = registry.get<bee::Transform>(engagement.target);
+                                         if (target.value <= 0.0f ||
+                                             glm::distance(transform.Translation, targetTransform.Translation) > reach)
+                                             continue;
+                                         const bool ally = attributes.GetTeam() == static_cast<int>(Team::Ally);
+                                         target.value -= (ally ? 100.0f : 25.0f) * dt;
+                                         if (target.value > 0.0f) continue;
+                                         // the fallen stay where they are
+                                         auto& agent = registry.get<bee::ai::GridAgent>(engagement.target);
+                                         agent.path = bee::ai::NavigationPath();
+                                         agent.preferredVelocity = glm::vec2(0.0f);
+                                     }
+                                 });
+
+    for (; frame < frames; frame++)
+    {
+        ecs.UpdateSystems(dt);
+        outcome.steeredAgents += navigation.GetSteeredAgentCount();
+        outcome.verticalUpdates += navigation.GetVerticalUpdateCount();
+    }
+
+    for (const auto unit : units)
+    {
+        outcome.health.push_back(registry.get<Health>(unit).value);
+        outcome.decisions += registry.get<Engagement>(unit).decisions;
+    }
+    bee::Engine.Shutdown();
+    return outcome;
+}
+
+// A state that counts how often it is entered, updated and left, in the blackboard of the state machine.
+class RecordingState : public bee::ai::State
+{
+public:
+    void Initialize(bee::ai::StateMachineContext& context) override { Count(context, "test.initializations"); }
+    void Update(bee::ai::StateMachineContext& context) override { Count(context, "test.updates"); }
+    void End(bee::ai::StateMachineContext& context) override { Count(context, "test.ends"); }
+
+    static int GetCount(const bee::ai::Blackboard& blackboard, const std::string& key)
+    {
+        const int* count = blackboard.TryGet<int>(key);
+        return count == nullptr ? 0 : *count;
+    }
+
+private:
+    static void Count(bee::ai::StateMachineContext& context, const std::string& key)
+    {
+        context.blackboard->SetData(key, GetCount(*context.blackboard, key) + 1);
+    }
+};
+
+// A comparator of a state machine asset: the blackboard key it reads, its type and the value it compares with.
+struct AssetComparator
+{
+    std::string key;
+    std::string type;
+    std::string value;
+};
+
+// A state machine from the fsm assets with every state replaced by a RecordingState, so it runs without the game.
+struct StateMachineAsset
+{
+    std::string name;
+    std::string json;
+    std::vector<AssetComparator> comparators;  // one per key
+    std::vector<std::string> stateNames;       // the states it was made with
+};
+
+// Loads every state machine in the fsm folder. Other json files in there (key bindings...) are skipped. The states
+// are replaced by RecordingStates, or by states that do nothing when the name is changed to "State".
+std::vector<StateMachineAsset> LoadStateMachineAssets()
+{
+    static const bool registered = []
+    {
+        GenericFactory<bee::ai::State>::Instance().RegisterProduct<RecordingState>("RecordingState");
+        GenericFactory<bee::ai::State>::Instance().RegisterProduct<bee::ai::State>("State");
+        return true;
+    }();
+
+    std::vector<StateMachineAsset> assets;
+    const auto directory = bee::Engine.FileIO().GetPath(bee::FileIO::Directory::Asset, "fsm");
+    if (!std::filesystem::exists(directory)) return assets;
+
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+    {
+        if (entry.path().extension() != ".json" && entry.path().extension() != ".anim") continue;
+        std::ifstream is(entry.path());
+        std::stringstream buffer;
+        buffer << is.rdbuf();
+        nlohmann::json json = nlohmann::json::parse(buffer.str(), nullptr, false);
+        if (json.is_discarded() || !json.contains("states") || !json.contains("transition-data")) continue;
+
+        std::vector<std::string> stateNames;
+        for (auto& state : json["states"])
+        {
+            stateNames.push_back(state["name"].get<std::string>());
+            state["name"] = "RecordingState";
+            state["editor-variables"] = nullptr;
+        }
+
+        StateMachineAsset asset{entry.path().filename().string(), json.dump(), {}, stateNames};
+        for (const auto& from : json["transition-data"])
+        {
+            if (!from.contains("transitions")) continue;
+            for (const auto& transition : from["transitions"])
+            {
+                if (!transition.contains("comparators")) continue;
+                for (const auto& text : transition["comparators"])
+                {
+                    std::stringstream stream(text.get<std::string>());
+                    AssetComparator comparator;
+                    int comparison = 0;
+                    stream >> comparator.key >> comparator.type >> comparison >> comparator.value;
+                    const bool known = std::any_of(asset.comparators.begin(), asset.comparators.end(),
+                                                   [&](const AssetComparator& other) { return other.key == comparator.key; });
+                    if (!known) asset.comparators.push_back(comparator);
+                }
+            }
+        }
+        assets.push_back(std::move(asset));
+    }
+    std::sort(assets.begin(), assets.end(),
+              [](const StateMachineAsset& a, const StateMachineAsset& b) { return a.name < b.name; });
+    return assets;
+}
+
+// Sets about half of the keys the comparators read, to values just below, at or just above the ones they compare with.
+void RandomizeBlackboard(bee::ai::Blackboard& blackboard, const std::vector<AssetComparator>& comparators,
+                         std::mt19937& random)
+{
+    std::bernoulli_distribution coin(0.5);
+    std::uniform_int_distribution<int> offset(-1, 1);
+    for (const auto& comparator : comparators)
+    {
+        if (coin(random)) continue;
+        if (comparator.type == "bool")
+            blackboard.SetData(comparator.key, coin(random));
+        else if (comparator.type == "float")
+            blackboard.SetData(comparator.key, std::stof(comparator.value) + 0.5f * static_cast<float>(offset(random)));
+        else if (comparator.type == "double")
+            blackboard.SetData(comparator.key, std::stod(comparator.value) + 0.5 * static_cast<double>(offset(random)));
+        else if (comparator.type == "int")
+            blackboard.SetData(comparator.key, std::stoi(comparator.value) + offset(random));
+        else
+            blackboard.SetData(comparator.key, coin(random) ? comparator.value : comparator.value + "_");
+    }
+}
+
+// Waits for "wait" seconds on a timer counted down through the reference GetData returns, which an event-driven
+// state machine does not see change, so it asks for a wake-up instead.
+class WaitingState : public bee::ai::State
+{
+public:
+    void Initialize(bee::ai::StateMachineContext& context) override
+    {
+        const float wait = context.blackboard->GetData<float>("wait");
+        context.blackboard->SetData("timer", wait);
+        context.WakeUpIn(wait);
+    }
+    void Update(bee::ai::StateMachineContext& context) override
+    {
+        context.blackboard->GetData<float>("timer") -= context.deltaTime;
+    }
+};
+
+// States that do nothing, of as many types as there are numbers.
+template <int N>
+class TypedState : public bee::ai::State
+{
+};
+
+constexpr int TypedStateCount = 5;
+
+template <int... N>
+void RegisterTypedStates(std::integer_sequence<int, N...>)
+{
+    (GenericFactory<bee::ai::State>::Instance().RegisterProduct<TypedState<N>>("TypedState" + std::to_string(N)), ...);
+}
+
+// Loads a state machine asset with the states of every name turned into one of the TypedStates, so some types come
+// back in several states. TypedState<TypedStateCount> is never used.
+std::unique_ptr<bee::ai::FiniteStateMachine> LoadWithTypedStates(const StateMachineAsset& asset)
+{
+    static const bool registered = []
+    {
+        RegisterTypedStates(std::make_integer_sequence<int, TypedStateCount>());
+        return true;
+    }();
+
+    std::vector<std::string> names;
+    nlohmann::json json = nlohmann::json::parse(asset.json);
+    for (size_t state = 0; state < asset.stateNames.size(); state++)
+    {
+        auto name = std::find(names.begin(), names.end(), asset.stateNames[state]);
+        if (name == names.end()) name = names.insert(names.end(), asset.stateNames[state]);
+        json["states"][state]["name"] = "TypedState" + std::to_string(std::distance(names.begin(), name) % TypedStateCount);
+    }
+    std::stringstream stream(json.dump());
+    return bee::ai::FiniteStateMachine::DeserializeFromStringStream(stream);
+}
+
+// How GetStateIDsOfType used to find states: comparing the type of every state, into a new vector on every call.
+template <typename T>
+std::vector<size_t> ScanStateIDsOfType(bee::ai::FiniteStateMachine& fsm, const size_t stateCount)
+{
+    std::vector<size_t> ids{};
+    for (size_t id = 0; id < stateCount; id++)
+        if (fsm.GetStateType(id) == typeid(T)) ids.push_back(id);
+    return ids;
+}
+
+template <int... N>
+void CheckStateTypeIndex(bee::ai::FiniteStateMachine& fsm, const size_t stateCount, std::integer_sequence<int, N...>)
+{
+    const auto check = [&](const auto& indexed, const std::vector<size_t>& scanned, const bool exists)
+    {
+        Assert::IsTrue(indexed == scanned);
+        Assert::AreEqual(!scanned.empty(), exists);
+    };
+    (check(fsm.GetStateIDsOfType<TypedState<N>>(), ScanStateIDsOfType<TypedState<N>>(fsm, stateCount),
+           fsm.StateExists<TypedState<N>>()),
+     ...);
+}
+
+// The team of a fighter.
+struct Side
+{
+    int team = 0;
+};
+
+// How often a fighter hit, only written by the fighter itself.
+struct Fighter
+{
+    int hits = 0;
+};
+
+// Runs at the closest living enemy and hits it once in reach, as a parallel-safe state should: the own Position and
+// Fighter are the only things it writes, other units are read through the context and hits and sparks are deferred.
+class ChaseState : public bee::ai::State
+{
+public:
+    static constexpr float Speed = 3.0f;
+    static constexpr float Reach = 1.0f;
+    static constexpr float Damage = 10.0f;
+
+    ChaseState() { parallelSafe = true; }
+
+    void Update(bee::ai::StateMachineContext& context) override
+    {
+        auto& registry = bee::Engine.ECS().Registry;
+        auto& position = registry.get<Position>(context.entity);
+        const int team = registry.get<Side>(context.entity).team;
+
+        bee::Entity target = entt::null;
+        glm::vec3 targetPosition(0.0f);
+        float closest = std::numeric_limits<float>::max();
+        for (auto [other, side, health] : std::as_const(registry).view<const Side, const Health>().each())
+        {
+            if (side.team == team || health.value <= 0.0f) continue;
+            const auto* otherPosition = context.Read<Position>(other);
+            const float distance = glm::distance(position.value, otherPosition->value);
+            if (distance >= closest) continue;
+            closest = distance;
+            target = other;
+            targetPosition = otherPosition->value;
+        }
+        if (target == entt::null) return;
+
+        if (closest > Reach)
+        {
+            position.value += (targetPosition - position.value) / closest * std::min(Speed * context.deltaTime, closest - Reach * 0.9f);
+            return;
+        }
+
+        auto& fighter = registry.get<Fighter>(context.entity);
+        fighter.hits++;
+        context.Defer(target, [](const bee::Entity entity) { bee::Engine.ECS().Registry.get<Health>(entity).value -= Damage; });
+        if (fighter.hits % 3 != 0) return;
+        context.Defer(context.entity,
+                      [at = position.value](bee::Entity)
+                      {
+                          auto& ecs = bee::Engine.ECS();
+                          const auto spark = ecs.CreateEntity();
+                          ecs.CreateComponent<Position>(spark).value = at;
+                          ecs.CreateComponent<Lifetime>(spark);
+                      });
+    }
+};
+
+// Removes the unit right away, so it can not run in parallel.
+class FallenState : public bee::ai::State
+{
+public:
+    void Initialize(bee::ai::StateMachineContext& context) override { bee::Engine.ECS().DeleteEntity(context.entity); }
+};
+
+// When an agent ticked and with what deltaTime.
+struct SleepLog
+{
+    std::vector<double> ticks;  // the time of the timer wheel at every tick
+    std::vector<float> deltaTimes;
+};
+
+// Logs the tick, then sleeps for blackboard value "sleep" seconds (until woken when infinite).
+class SleepingState : public bee::ai::State
+{
+public:
+    void Update(bee::ai::StateMachineContext& context) override
+    {
+        auto& log = bee::Engine.ECS().Registry.get<SleepLog>(context.entity);
+        log.ticks.push_back(bee::Engine.ECS().GetSystem<bee::ai::AIBehaviorSelectionSystem>().GetTimerWheel().GetTime());
+        log.deltaTimes.push_back(context.deltaTime);
+        context.Suspend(context.blackboard->GetData<float>("sleep"));
+    }
+};
+
+// Waits for an order that never comes: either looking for it on every tick, or suspended until the blackboard changes.
+class WaitForOrderState : public bee::ai::State
+{
+public:
+    explicit WaitForOrderState(const bool suspend) : m_suspend(suspend) {}
+
+    void Initialize(bee::ai::StateMachineContext& context) override
+    {
+        if (m_suspend) context.Suspend();
+    }
+    void Update(bee::ai::StateMachineContext& context) override
+    {
+        const bool* order = context.blackboard->TryGet<bool>("order");
+        if (order != nullptr && *order) context.blackboard->SetData("order", false);
+    }
+
+private:
+    bool m_suspend;
+};
+
+// An action that returns the status in blackboard value "action<script>", and writes what it does to "trace".
+class ScriptedAction : public bee::ai::BehaviorTreeAction
+{
+public:
+    explicit ScriptedAction(const int script) : m_key("action" + std::to_string(script)) {}
+
+    void Initialize(bee::ai::BehaviorTreeContext& context) override { Trace(context, "I"); }
+    bee::ai::Status Tick(bee::ai::BehaviorTreeContext& context) override
+    {
+        Trace(context, "T");
+        return static_cast<bee::ai::Status>(context.blackboard->GetData<int>(m_key));
+    }
+    void End(bee::ai::BehaviorTreeContext& context, bee::ai::Status status) override { Trace(context, "E"); }
+
+private:
+    void Trace(const bee::ai::BehaviorTreeContext& context, const char* step) const
+    {
+        context.blackboard->GetData<std::string>("trace") += fmt::format("{}{}.{} ", step, m_key, GetId());
+    }
+
+    std::string m_key;
+};
+
+constexpr int ActionScripts = 6;
+
+struct ConditionSource
+{
+    bool open = false;
+    bool IsOpen() { return open; }
+};
+
+// Adds a random behavior with random descendants, the same ones for the same state of the random engine.
+void AddRandomBehavior(bee::ai::BehaviorTreeBuilder& builder, std::mt19937& random, ConditionSource& source,
+                       const int depth)
+{
+    const int kind = depth >= 4 ? 8 : std::uniform_int_distribution<int>(0, 9)(random);
+    const bool negation = random() % 2 == 0;
+    const auto addChild = [&] { AddRandomBehavior(builder, random, source, depth + 1); };
+    switch (kind)
+    {
+        case 0:
+        case 1:
+        {
+            if (kind == 0)
+                builder.Sequence();
+            else
+                builder.Selector();
+            const int children = std::uniform_int_distribution<int>(1, 4)(random);
+            for (int child = 0; child < children; child++) addChild();
+            break;
+        }
+        case 2:
+            builder.Repeater(std::uniform_int_distribution<int>(1, 3)(random));
+            addChild();
+            break;
+        case 3:
+            builder.Inverter();
+            addChild();
+            break;
+        case 4:
+            builder.AlwaysSucceed();
+            addChild();
+            break;
+        case 5:
+            builder.UntilFail();
+            addChild();
+            break;
+        case 6:
+            builder.Comparison(bee::ai::Comparator<int>("switch", bee::ai::ComparisonType::LESS_EQUAL,
+                                                        std::uniform_int_distribution<int>(0, 2)(random)),
+                               negation);
+            addChild();
+            break;
+        case 7:
+            builder.Condition(&source, &ConditionSource::IsOpen, negation);
+            addChild();
+            break;
+        default:
+            builder.Action<ScriptedAction>(std::uniform_int_distribution<int>(0, ActionScripts - 1)(random));
+            break;
+    }
+    builder.Back();
+}
+
+std::unique_ptr<bee::ai::BehaviorTree> BuildRandomBehaviorTree(const unsigned seed, ConditionSource& source,
+                                                               const bool compile)
+{
+    std::mt19937 random(seed);
+    bee::ai::BehaviorTreeBuilder builder;
+    builder.Selector();
+    for (int child = 0; child < 3; child++) AddRandomBehavior(builder, random, source, 1);
+    return builder.End(compile);
+}
+
+// Sets what the actions return and what the comparisons and conditions find.
+void RandomizeBehaviorTreeInput(bee::ai::Blackboard& blackboard, ConditionSource& source, std::mt19937& random)
+{
+    static constexpr bee::ai::Status Results[] = {bee::ai::Status::SUCCESS, bee::ai::Status::RUNNING,
+                                                  bee::ai::Status::FAILURE};
+    for (int script = 0; script < ActionScripts; script++)
+        blackboard.SetData("action" + std::to_string(script), static_cast<int>(Results[random() % 3]));
+    blackboard.SetData("switch", static_cast<int>(random() % 3));
+    blackboard.SetData("trace", std::string());
+    source.open = random() % 2 == 0;
+}
+
+// An action that always returns the same status.
+class FixedAction : public bee::ai::BehaviorTreeAction
+{
+public:
+    explicit FixedAction(const bee::ai::Status status) : m_status(status) {}
+    bee::ai::Status Tick(bee::ai::BehaviorTreeContext&) override { return m_status; }
+
+private:
+    bee::ai::Status m_status;
+};
+
+struct FightOutcome
+{
+    std::vector<bool> alive;
+    std::vector<glm::vec3> positions;
+    std::vector<float> health;
+    std::vector<int> hits;
+    std::vector<glm::vec3> sparks;
+    size_t parallelTicks = 0;
+    size_t maxParallelAgents = 0;
+    double milliseconds = 0.0;
+};
+
+// Two lines of fighters, gap apart, run into each other for a number of frames. Every fighter ticks every frame.
+FightOutcome RunFight(const bee::ai::AIBehaviorSelectionSystem::StateMachineExecution execution, const int fighters,
+                      const float gap, const int frames)
+{
+    bee::Engine.InitializeHeadless();
+    auto& ecs = bee::Engine.ECS();
+    auto& registry = ecs.Registry;
+    constexpr float dt = 1.0f / 30.0f;
+
+    bee::ai::FiniteStateMachine fsm;
+    const size_t chase = fsm.AddState<ChaseState>(true);
+    const size_t fallen = fsm.AddState<FallenState>();
+    fsm.AddTransition(chase, fallen, bee::ai::Comparator<float>("health", bee::ai::ComparisonType::LESS_EQUAL, 0.0f));
+    fsm.Compile();
+
+    auto& system = ecs.CreateSystem<bee::ai::AIBehaviorSelectionSystem>(dt, 1);
+    system.SetStateMachineExecution(execution);
+    system.GetSnapshot().Capture<Position>();
+
+    std::vector<bee::Entity> entities;
+    for (int i = 0; i < fighters; i++)
+    {
+        const int team = i % 2;
+        const auto entity = ecs.CreateEntity();
+        ecs.CreateComponent<Position>(entity).value = glm::vec3(team == 0 ? 0.0f : gap, static_cast<float>(i / 2) * 0.5f, 0.0f);
+        ecs.CreateComponent<Side>(entity).team = team;
+        ecs.CreateComponent<Health>(entity);
+        ecs.CreateComponent<Fighter>(entity);
+        ecs.CreateComponent<bee::ai::StateMachineAgent>(entity, fsm).context.entity = entity;
+        entities.push_back(entity);
+    }
+
+    FightOutcome outcome;
+    outcome.milliseconds = MeasureMilliseconds(
+        [&]
+        {
+            for (int frame = 0; frame < frames; frame++)
+            {
+                for (auto [entity, agent, health] : registry.view<bee::ai::StateMachineAgent, Health>().each())
+                    agent.context.blackboard->SetData("health", health.value);
+                ecs.UpdateSystems(dt);
+                ecs.PlaybackCommands();
+                ecs.RemovedDeleted();
+                outcome.parallelTicks += system.GetParallelAgentCount();
+                outcome.maxParallelAgents = std::max(outcome.maxParallelAgents, system.GetParallelAgentCount());
+            }
+        });
+
+    for (const auto entity : entities)
+    {
+        const bool alive = registry.valid(entity);
+        outcome.alive.push_back(alive);
+        outcome.positions.push_back(alive ? registry.get<Position>(entity).value : glm::vec3(0.0f));
+        outcome.health.push_back(alive ? registry.get<Health>(entity).value : 0.0f);
+        outcome.hits.push_back(alive ? registry.get<Fighter>(entity).hits : 0);
+    }
+    for (auto [entity, position, lifetime] : registry.view<Position, Lifetime>().each()) outcome.sparks.push_back(position.value);
+    bee::Engine.Shutdown();
+    return outcome;
+}
+
+}  // namespace
+
+namespace UnitTests
+{
+TEST_CLASS(AITests)
+{
+public:
+    TEST_METHOD(TimeSlicerKeepsEveryAgentsRate)
+    {
+        constexpr int agentCount = 120;
+        constexpr float period = 0.1f;
+        bee::ai::TimeSlicer slicer(period);
+        std::vector<bee::ai::TimeSlice> slices(agentCount);
+        std::vector<int> ticks(agentCount, 0);
+        std::vector<double> tickedTime(agentCount, 0.0);
+
+        // frame times between 144 and 30 frames per second
+        std::mt19937 random(39);
+        std::uniform_real_distribution<float> frameTime(1.0f / 144.0f, 1.0f / 30.0f);
+        double time = 0.0;
+        int mostTicksInAFrame = 0;
+        while (time < 10.0)
+        {
+            const float dt = frameTime(random);
+            time += dt;
+            slicer.Advance(dt);
+            int ticksThisFrame = 0;
+            for (int i = 0; i < agentCount; i++)
+            {
+                float agentDt = 0.0f;
+                if (!slicer.Tick(static_cast<bee::Entity>(i), slices[i], agentDt, slices[i].priority)) continue;
+                ticks[i]++;
+                tickedTime[i] += agentDt;
+                ticksThisFrame++;
+            }
+            mostTicksInAFrame = std::max(mostTicksInAFrame, ticksThisFrame);
+        }
+
+        // every agent ticks once per period and is handed the time that passed, however the frames fell
+        const int expectedTicks = static_cast<int>(time / period);
+        for (int i = 0; i < agentCount; i++)
+        {
+            Assert::IsTrue(std::abs(ticks[i] - expectedTicks) <= 1);
+            Assert::IsTrue(std::abs(tickedTime[i] - time) <= period);
+        }
+        // a frame of 1/30 s covers two of the six buckets, never all of them
+        Assert::IsTrue(mostTicksInAFrame < agentCount / 2);
+
+        // an agent that got an order ticks on the next frame, its neighbours wait for their bucket
+        slicer.Advance(0.001f);
+        float agentDt = 0.0f;
+        slices[5].Prioritize();
+        Assert::IsTrue(slicer.Tick(static_cast<bee::Entity>(5), slices[5], agentDt, slices[5].priority));
+        Assert::IsFalse(slices[5].priority);
+        Assert::IsFalse(slicer.Tick(static_cast<bee::Entity>(6), slices[6], agentDt, slices[6].priority));
+
+        // an agent that decides every third period, as one out of view does, is handed the three periods at once
+        bee::ai::TimeSlice slow;
+        int slowTicks = 0;
+        double slowTime = 0.0;
+        for (int frame = 0; frame < 600; frame++)
+        {
+            slicer.Advance(1.0f / 60.0f);
+            if (!slicer.Tick(static_cast<bee::Entity>(7), slow, agentDt, false, 3)) continue;
+            slowTicks++;
+            if (slowTicks > 1) slowTime += agentDt;
+        }
+        Assert::IsTrue(std::abs(slowTicks - 100 / 3) <= 1);
+        Assert::IsTrue(std::abs(slowTime / (slowTicks - 1) - 3.0 * period) < 0.25 * period);
+    }
+
+    TEST_METHOD(TimeSlicedAgentsFrameTimeBenchmark)
+    {
+        // the same agent work at 60 frames per second, all of it every sixth frame or a sixth of it every frame
+        constexpr int agentCount = 3000;
+        constexpr int frameCount = 120;
+        constexpr float dt = 1.0f / 60.0f;
+        const auto think = [](int agent)
+        {
+            float value = static_cast<float>(agent);
+            for (int i = 0; i < 200; i++) value = std::sqrt(value + static_cast<float>(i));
+            return value;
+        };
+
+        const auto run = [&](int bucketCount)
+        {
+            bee::ai::TimeSlicer slicer(0.1f, bucketCount);
+            std::vector<bee::ai::TimeSlice> slices(agentCount);
+            std::vector<double> frameTimes;
+            float sink = 0.0f;
+            for (int frame = 0; frame < frameCount; frame++)
+            {
+                frameTimes.push_back(MeasureMilliseconds(
+                    [&]
+                    {
+                        slicer.Advance(dt);
+                        for (int i = 0; i < agentCount; i++)
+                        {
+                            float agentDt = 0.0f;
+                            if (slicer.Tick(static_cast<bee::Entity>(i), slices[i], agentDt, false)) sink += think(i) * agentDt;
+                        }
+                    }));
+            }
+            Assert::IsTrue(sink > 0.0f);
+
+            double mean = 0.0;
+            for (const double frameTime : frameTimes) mean += frameTime;
+            mean /= frameTimes.size();
+            double variance = 0.0;
+            for (const double frameTime : frameTimes) variance += (frameTime - mean) * (frameTime - mean);
+            variance /= frameTimes.size();
+            return std::make_pair(*std::max_element(frameTimes.begin(), frameTimes.end()), std::sqrt(variance));
+        };
+
+        const auto [allAtOnceWorst, allAtOnceDeviation] = run(1);
+        const auto [slicedWorst, slicedDeviation] = run(0);
+        Logger::WriteMessage(fmt::format("{} agents, all at once: worst frame {:.3f} ms, deviation {:.3f} ms; "
+                                         "time sliced: worst frame {:.3f} ms, deviation {:.3f} ms\n",
+                                         agentCount, allAtOnceWorst, allAtOnceDeviation, slicedWorst, slicedDeviation)
+                                 .c_str());
+    }
+
+    TEST_METHOD(SimulationLODKeepsBattleOutcome)
+    {
+        // without a camera every unit is simulated fully
+        const BattleOutcome full = RunScriptedBattle(false);
+        const BattleOutcome panned = RunScriptedBattle(true);
+        Assert::AreEqual(size_t(1), full.tiersSeen.size());
+        Assert::AreEqual(3, static_cast<int>(panned.tiersSeen.size()));
+        Assert::IsTrue(panned.tierChanges > 0);
+        Assert::IsTrue(panned.cosmeticUpdates < full.cosmeticUpdates);
+
+        // out of view, the units decided, steered and followed the terrain less often
+        Assert::IsTrue(panned.decisions < full.decisions);
+        Assert::IsTrue(panned.steeredAgents < full.steeredAgents);
+        Assert::IsTrue(panned.verticalUpdates < full.verticalUpdates);
+
+        // but the battle ended the same way, wherever the camera was looking: the player's units won without losses
+        // and took about as much damage
+        float fullHealth = 0.0f;
+        float pannedHealth = 0.0f;
+        for (size_t unit = 0; unit < full.health.size(); unit++)
+        {
+            const bool ally = unit % 2 == 0;
+            Assert::AreEqual(ally, full.health[unit] > 0.0f);
+            Assert::AreEqual(ally, panned.health[unit] > 0.0f);
+            if (!ally) continue;
+            fullHealth += full.health[unit];
+            pannedHealth += panned.health[unit];
+        }
+        const float fullDamage = 100.0f * static_cast<float>(full.health.size() / 2) - fullHealth;
+        Assert::IsTrue(fullDamage > 0.0f);
+        Assert::IsTrue(std::abs(fullHealth - pannedHealth) <= 0.25f * fullDamage);
+        Logger::WriteMessage(fmt::format("cosmetic updates: {} with every unit fully simulated, {} with the camera panning "
+                                         "over the battle ({} tier changes); AI decisions: {} and {}; steering: {} and {}; "
+                                         "health left of the player's units: {:.1f} and {:.1f}\n",
+                                         full.cosmeticUpdates, panned.cosmeticUpdates, panned.tierChanges, full.decisions,
+                                         panned.decisions, full.steeredAgents, panned.steeredAgents, fullHealth,
+                                         pannedHealth)
+                                 .c_str());
+    }
+
+    TEST_METHOD(SimulationLODZoomedInBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+
+        // an army spread over a 96 by 96 map, and the camera zoomed in on a corner of it
+        constexpr int units = 2000;
+        constexpr int frames = 60;
+        constexpr float dt = 1.0f / 60.0f;
+        std::mt19937 random(40);
+        std::uniform_real_distribution<float> coordinate(0.0f, 96.0f);
+        for (int unit = 0; unit < units; unit++)
+        {
+            const auto entity = ecs.CreateEntity();
+            ecs.CreateComponent<bee::Transform>(entity).Translation = glm::vec3(coordinate(random), coordinate(random), 0.0f);
+            ecs.CreateComponent<bee::SimulationLOD>(entity);
+            ecs.CreateComponent<TestSkeleton>(entity);
+        }
+        const auto camera = ecs.CreateEntity();
+        AimCamera(ecs.CreateComponent<bee::Camera>(camera), ecs.CreateComponent<bee::Transform>(camera),
+                  glm::vec3(12.0f, 12.0f, 0.0f), 10.0f);
+        bee::SimulationLODSystem lodSystem;
+
+        float time = 0.0f;
+        const double everyFrameTime = MeasureAverageMilliseconds(
+            frames,
+            [&]
+            {
+                for (auto [entity, skeleton] : registry.view<TestSkeleton>().each()) skeleton.Pose(time);
+                time += dt;
+            });
+        const double lodTime = MeasureAverageMilliseconds(
+            frames,
+            [&]
+            {
+                lodSystem.Update(dt);
+                for (auto [entity, lod, skeleton] : registry.view<bee::SimulationLOD, TestSkeleton>().each())
+                    if (lod.cosmeticUpdate) skeleton.Pose(time);
+                time += dt;
+            });
+
+        Logger::WriteMessage(fmt::format("{} skeletons, {} full, {} reduced, {} dormant: posing all of them every frame "
+                                         "{:.3f} ms, by level of detail {:.3f} ms per frame ({:.1f}x)\n",
+                                         units, lodSystem.GetCount(bee::SimulationTier::Full),
+                                         lodSystem.GetCount(bee::SimulationTier::Reduced),
+                                         lodSystem.GetCount(bee::SimulationTier::Dormant), everyFrameTime, lodTime,
+                                         everyFrameTime / lodTime)
+                                 .c_str());
+        Assert::IsTrue(lodSystem.GetCount(bee::SimulationTier::Dormant) > units / 2);
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(CompiledStateMachinesMatchInterpretedOnes)
+    {
+        bee::Engine.InitializeHeadless();
+        const auto assets = LoadStateMachineAssets();
+        Assert::IsFalse(assets.empty(), L"No state machines found in the assets folder.");
+
+        std::mt19937 random(41);
+        for (const auto& asset : assets)
+        {
+            std::stringstream compiledStream(asset.json);
+            std::stringstream interpretedStream(asset.json);
+            const auto compiled = bee::ai::FiniteStateMachine::DeserializeFromStringStream(compiledStream);
+            const auto interpreted = bee::ai::FiniteStateMachine::DeserializeFromStringStream(interpretedStream, false);
+            Assert::IsTrue(compiled->IsCompiled());
+            Assert::IsFalse(interpreted->IsCompiled());
+
+            // both read the same blackboard values, which are sometimes wiped so keys go missing and come back
+            bee::ai::StateMachineContext compiledContext;
+            bee::ai::StateMachineContext interpretedContext;
+            std::set<size_t> statesVisited;
+            for (int step = 0; step < 2000; step++)
+            {
+                if (step % 97 == 0)
+                {
+                    compiledContext.blackboard->Clear();
+                    interpretedContext.blackboard->Clear();
+                }
+                const auto seed = random();
+                std::mt19937 compiledRandom(seed);
+                std::mt19937 interpretedRandom(seed);
+                RandomizeBlackboard(*compiledContext.blackboard, asset.comparators, compiledRandom);
+                RandomizeBlackboard(*interpretedContext.blackboard, asset.comparators, interpretedRandom);
+
+                compiled->Execute(compiledContext);
+                interpreted->Execute(interpretedContext);
+
+                Assert::IsTrue(compiledContext.GetCurrentState() == interpretedContext.GetCurrentState());
+                for (const std::string key : {"test.initializations", "test.updates", "test.ends"})
+                {
+                    Assert::AreEqual(RecordingState::GetCount(*interpretedContext.blackboard, key),
+                                     RecordingState::GetCount(*compiledContext.blackboard, key));
+                }
+                statesVisited.insert(compiledContext.GetCurrentState().value());
+            }
+            Logger::WriteMessage(fmt::format("{}: {} comparator keys, visited {} states\n", asset.name,
+                                             asset.comparators.size(), statesVisited.size())
+                                     .c_str());
+        }
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(CompiledStateMachineBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        const auto assets = LoadStateMachineAssets();
+        const auto asset = std::find_if(assets.begin(), assets.end(),
+                                        [](const StateMachineAsset& a) { return a.name == "melee_default_fsm.json"; });
+        Assert::IsTrue(asset != assets.end(), L"melee_default_fsm.json not found in the assets folder.");
+
+        // an army of state machines, whose blackboards change every few frames as they would in a match
+        constexpr int agents = 2000;
+        constexpr int frames = 100;
+        // states that do nothing, so the time goes to the transitions
+        std::string json = asset->json;
+        for (size_t at = json.find("RecordingState"); at != std::string::npos; at = json.find("RecordingState", at))
+            json.replace(at, std::string("RecordingState").size(), "State");
+
+        const auto run = [&](const bool compile)
+        {
+            std::stringstream stream(json);
+            const auto fsm = bee::ai::FiniteStateMachine::DeserializeFromStringStream(stream, compile);
+            std::vector<bee::ai::StateMachineContext> contexts(agents);
+            std::mt19937 random(41);
+            double time = 0.0;
+            for (int frame = 0; frame < frames; frame++)
+            {
+                if (frame % 10 == 0)
+                    for (auto& context : contexts) RandomizeBlackboard(*context.blackboard, asset->comparators, random);
+                time += MeasureMilliseconds(
+                    [&]
+                    {
+                        for (auto& context : contexts) fsm->Execute(context);
+                    });
+            }
+            return time;
+        };
+
+        const double interpretedTime = run(false);
+        const double compiledTime = run(true);
+        Logger::WriteMessage(fmt::format("{} state machines for {} frames: {:.3f} ms interpreted, {:.3f} ms compiled\n",
+                                         agents, frames, interpretedTime, compiledTime)
+                                 .c_str());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(StateTypeIndexMatchesStates)
+    {
+        bee::Engine.InitializeHeadless();
+        const auto assets = LoadStateMachineAssets();
+        Assert::IsFalse(assets.empty(), L"No state machines found in the assets folder.");
+
+        constexpr auto types = std::make_integer_sequence<int, TypedStateCount + 1>();
+        for (const auto& asset : assets)
+        {
+            const auto fsm = LoadWithTypedStates(asset);
+            size_t stateCount = asset.stateNames.size();
+            CheckStateTypeIndex(*fsm, stateCount, types);
+
+            // forcing a state goes to the first one of the type
+            bee::ai::StateMachineAgent agent(*fsm);
+            agent.SetStateOfType<TypedState<0>>();
+            Assert::IsTrue(agent.context.GetCurrentState() == std::optional<size_t>(0));
+            agent.SetStateOfType<TypedState<TypedStateCount>>();
+            Assert::IsTrue(agent.context.GetCurrentState() == std::optional<size_t>(0));
+
+            // the index follows states that are added and removed afterwards
+            fsm->AddState<TypedState<TypedStateCount>>();
+            stateCount++;
+            CheckStateTypeIndex(*fsm, stateCount, types);
+            fsm->RemoveState(0);
+            stateCount--;
+            CheckStateTypeIndex(*fsm, stateCount, types);
+            Assert::AreEqual(stateCount - 1, fsm->GetStateIDsOfType<TypedState<TypedStateCount>>().front());
+        }
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(StateTypeIndexOrderBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        const auto assets = LoadStateMachineAssets();
+        const auto asset = std::find_if(assets.begin(), assets.end(),
+                                        [](const StateMachineAsset& a) { return a.name == "melee_default_fsm.json"; });
+        Assert::IsTrue(asset != assets.end(), L"melee_default_fsm.json not found in the assets folder.");
+
+        // an attack order to a selection of melee units, which try a ranged attack first as the order system does
+        using RangedAttack = TypedState<TypedStateCount>;
+        using MeleeAttack = TypedState<3>;
+        constexpr int units = 200;
+        constexpr int orders = 500;
+        const auto fsm = LoadWithTypedStates(*asset);
+        const size_t stateCount = asset->stateNames.size();
+        std::vector<bee::ai::StateMachineAgent> agents;
+        agents.reserve(units);
+        for (int unit = 0; unit < units; unit++) agents.emplace_back(*fsm);
+
+        const double scanTime = MeasureMilliseconds(
+            [&]
+            {
+                for (int order = 0; order < orders; order++)
+                {
+                    for (auto& agent : agents)
+                    {
+                        if (!ScanStateIDsOfType<RangedAttack>(*fsm, stateCount).empty())
+                            fsm->SetCurrentState(ScanStateIDsOfType<RangedAttack>(*fsm, stateCount)[0], agent.context);
+                        else if (!ScanStateIDsOfType<MeleeAttack>(*fsm, stateCount).empty())
+                            fsm->SetCurrentState(ScanStateIDsOfType<MeleeAttack>(*fsm, stateCount)[0], agent.context);
+                    }
+                }
+            });
+        const double indexTime = MeasureMilliseconds(
+            [&]
+            {
+                for (int order = 0; order < orders; order++)
+                {
+                    for (auto& agent : agents)
+                    {
+                        if (agent.fsm.StateExists<RangedAttack>())
+                            agent.SetStateOfType<RangedAttack>();
+                        else if (agent.fsm.StateExists<MeleeAttack>())
+                            agent.SetStateOfType<MeleeAttack>();
+                    }
+                }
+            });
+
+        for (const auto& agent : agents)
+            Assert::AreEqual(fsm->GetStateIDsOfType<MeleeAttack>().front(), agent.context.GetCurrentState().value());
+        Logger::WriteMessage(fmt::format("{} orders to {} units: {:.3f} ms scanning the states, {:.3f} ms with the index\n",
+                                         orders, units, scanTime, indexTime)
+                                 .c_str());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(ParallelStateMachinesMatchSerialOnes)
+    {
+        using Execution = bee::ai::AIBehaviorSelectionSystem::StateMachineExecution;
+        const FightOutcome serial = RunFight(Execution::Serial, 200, 6.0f, 150);
+        const FightOutcome parallel = RunFight(Execution::Parallel, 200, 6.0f, 150);
+
+        // the fight happened: units ran in parallel, hit, spawned sparks and fell, which runs them on their own
+        Assert::IsTrue(serial.maxParallelAgents > 0);
+        Assert::IsFalse(serial.sparks.empty());
+        Assert::IsTrue(std::count(serial.alive.begin(), serial.alive.end(), false) > 0);
+        Assert::IsTrue(std::count(serial.alive.begin(), serial.alive.end(), true) > 0);
+
+        Assert::IsTrue(serial.alive == parallel.alive);
+        Assert::IsTrue(serial.positions == parallel.positions);
+        Assert::IsTrue(serial.health == parallel.health);
+        Assert::IsTrue(serial.hits == parallel.hits);
+        Assert::IsTrue(serial.sparks == parallel.sparks);
+        Assert::AreEqual(serial.parallelTicks, parallel.parallelTicks);
+    }
+
+    TEST_METHOD(ParallelStateMachinesBenchmark)
+    {
+        // far enough apart to only run at each other, so every agent scans all enemies every frame
+        using Execution = bee::ai::AIBehaviorSelectionSystem::StateMachineExecution;
+        constexpr int fighters = 1200;
+        constexpr int frames = 20;
+        const FightOutcome serial = RunFight(Execution::Serial, fighters, 40.0f, frames);
+        const FightOutcome parallel = RunFight(Execution::Parallel, fighters, 40.0f, frames);
+
+        const unsigned threads = std::thread::hardware_concurrency();
+        Logger::WriteMessage(fmt::format("{} state machine agents on {} hardware threads: serial {:.3f} ms, parallel "
+                                         "{:.3f} ms per frame ({:.1f}x)\n",
+                                         fighters, threads, serial.milliseconds / frames, parallel.milliseconds / frames,
+                                         serial.milliseconds / parallel.milliseconds)
+                                 .c_str());
+        Assert::AreEqual(static_cast<size_t>(fighters * frames), parallel.parallelTicks);
+        Assert::IsTrue(serial.positions == parallel.positions);
+    }
+
+    TEST_METHOD(CompiledBehaviorTreesMatchObjectTrees)
+    {
+        std::mt19937 random(44);
+        size_t largestTree = 0;
+        for (unsigned seed = 0; seed < 200; seed++)
+        {
+            ConditionSource source;
+            const auto objectTree = BuildRandomBehaviorTree(seed, source, false);
+            const auto compiledTree = BuildRandomBehaviorTree(seed, source, true);
+            Assert::IsFalse(objectTree->IsCompiled());
+            Assert::IsTrue(compiledTree->IsCompiled());
+            const auto& behaviors = compiledTree->GetCompiledBehaviors();
+            largestTree = std::max(largestTree, behaviors.size());
+
+            bee::ai::BehaviorTreeContext objectContext;
+            bee::ai::BehaviorTreeContext compiledContext;
+            for (int tick = 0; tick < 50; tick++)
+            {
+                const auto input = random();
+                std::mt19937 objectRandom(input);
+                std::mt19937 compiledRandom(input);
+                RandomizeBehaviorTreeInput(*objectContext.blackboard, source, objectRandom);
+                RandomizeBehaviorTreeInput(*compiledContext.blackboard, source, compiledRandom);
+
+                objectTree->Execute(objectContext);
+                compiledTree->Execute(compiledContext);
+
+                // the same actions were called in the same order, and every behavior ended up with the same status
+                Assert::AreEqual(objectContext.blackboard->GetData<std::string>("trace"),
+                                 compiledContext.blackboard->GetData<std::string>("trace"));
+                Assert::AreEqual(behaviors.size(), compiledContext.compiledStatuses.size());
+                for (size_t index = 0; index < behaviors.size(); index++)
+                {
+                    const auto status = objectContext.statuses.find(behaviors[index].id);
+                    const auto objectStatus = status != objectContext.statuses.end() ? status->second : bee::ai::Status::INVALID;
+                    Assert::IsTrue(objectStatus == compiledContext.compiledStatuses[index]);
+
+                    // what the editor preview shows, by id in both forms
+                    Assert::IsTrue(objectStatus == objectTree->GetStatus(objectContext, behaviors[index].id));
+                    Assert::IsTrue(objectStatus == compiledTree->GetStatus(compiledContext, behaviors[index].id));
+                }
+            }
+        }
+        Logger::WriteMessage(fmt::format("200 random trees of up to {} behaviors\n", largestTree).c_str());
+    }
+
+    TEST_METHOD(CompiledBehaviorTreeBenchmark)
+    {
+        // a typical unit tree: pick a branch by the mode the unit is in, each branch a few steps long
+        using bee::ai::Status;
+        const auto build = [](const bool compile)
+        {
+            bee::ai::BehaviorTreeBuilder builder;
+            builder.Selector();
+            for (int mode = 0; mode < 3; mode++)
+            {
+                builder.Comparison(bee::ai::Comparator<int>("mode", bee::ai::ComparisonType::EQUAL, mode)).Sequence();
+                builder.Action<FixedAction>(Status::SUCCESS).Back();
+                builder.Inverter().Action<FixedAction>(Status::FAILURE).Back().Back();
+                builder.Action<FixedAction>(Status::SUCCESS).Back();
+                builder.Action<FixedAction>(Status::RUNNING).Back();
+                builder.Back().Back();
+            }
+            builder.Sequence().Action<FixedAction>(Status::SUCCESS).Back().Action<FixedAction>(Status::RUNNING).Back().Back();
+            return builder.End(compile);
+        };
+
+        constexpr int agents = 4000;
+        constexpr int frames = 100;
+        const auto run = [&](const bool compile)
+        {
+            const auto tree = build(compile);
+            Assert::AreEqual(compile, tree->IsCompiled());
+            std::vector<bee::ai::BehaviorTreeContext> contexts(agents);
+            for (int agent = 0; agent < agents; agent++) contexts[agent].blackboard->SetData("mode", agent % 4);
+            return MeasureMilliseconds(
+                [&]
+                {
+                    for (int frame = 0; frame < frames; frame++)
+                        for (auto& context : contexts) tree->Execute(context);
+                });
+        };
+
+        const double objectTime = run(false);
+        const double compiledTime = run(true);
+        Logger::WriteMessage(fmt::format("{} behavior trees for {} frames: {:.3f} ms as objects, {:.3f} ms compiled\n",
+                                         agents, frames, objectTime, compiledTime)
+                                 .c_str());
+    }
+
+    TEST_METHOD(EventDrivenStateMachinesMatchPolling)
+    {
+        bee::Engine.InitializeHeadless();
+        const auto assets = LoadStateMachineAssets();
+        Assert::IsFalse(assets.empty(), L"No state machines found in the assets folder.");
+
+        using Evaluation = bee::ai::FiniteStateMachine::TransitionEvaluation;
+        std::mt19937 random(45);
+        for (const auto& asset : assets)
+        {
+            std::stringstream pollingStream(asset.json);
+            std::stringstream eventStream(asset.json);
+            const auto polling = bee::ai::FiniteStateMachine::DeserializeFromStringStream(pollingStream);
+            const auto eventDriven = bee::ai::FiniteStateMachine::DeserializeFromStringStream(eventStream);
+            eventDriven->SetTransitionEvaluation(Evaluation::EventDriven);
+
+            // the blackboard changes now and then, sometimes to the values it already has, and is sometimes wiped
+            bee::ai::StateMachineContext pollingContext;
+            bee::ai::StateMachineContext eventContext;
+            int transitions = 0;
+            for (int step = 0; step < 2000; step++)
+            {
+                if (step % 211 == 0)
+                {
+                    pollingContext.blackboard->Clear();
+                    eventContext.blackboard->Clear();
+                }
+                if (random() % 4 == 0)
+                {
+                    const auto seed = random();
+                    std::mt19937 pollingRandom(seed);
+                    std::mt19937 eventRandom(seed);
+                    RandomizeBlackboard(*pollingContext.blackboard, asset.comparators, pollingRandom);
+                    RandomizeBlackboard(*eventContext.blackboard, asset.comparators, eventRandom);
+                }
+
+                const auto before = pollingContext.GetCurrentState();
+                polling->Execute(pollingContext);
+                eventDriven->Execute(eventContext);
+                if (pollingContext.GetCurrentState() != before) transitions++;
+
+                Assert::IsTrue(pollingContext.GetCurrentState() == eventContext.GetCurrentState());
+                for (const std::string key : {"test.initializations", "test.updates", "test.ends"})
+                {
+                    Assert::AreEqual(RecordingState::GetCount(*pollingContext.blackboard, key),
+                                     RecordingState::GetCount(*eventContext.blackboard, key));
+                }
+            }
+            Logger::WriteMessage(fmt::format("{}: {} transitions\n", asset.name, transitions).c_str());
+        }
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(EventDrivenStateMachineWakeUps)
+    {
+        // waiting runs out on a timer, done goes back to waiting when told to
+        using Evaluation = bee::ai::FiniteStateMachine::TransitionEvaluation;
+        const auto build = [](const Evaluation evaluation)
+        {
+            auto fsm = std::make_unique<bee::ai::FiniteStateMachine>();
+            const size_t waiting = fsm->AddState<WaitingState>(true);
+            const size_t done = fsm->AddState<bee::ai::State>();
+            fsm->AddTransition(waiting, done, bee::ai::Comparator<float>("timer", bee::ai::ComparisonType::LESS_EQUAL, 0.0f));
+            fsm->AddTransition(done, waiting, bee::ai::Comparator<bool>("again", bee::ai::ComparisonType::EQUAL, true));
+            fsm->Compile();
+            fsm->SetTransitionEvaluation(evaluation);
+            return fsm;
+        };
+        const auto polling = build(Evaluation::Polling);
+        const auto eventDriven = build(Evaluation::EventDriven);
+
+        bee::ai::StateMachineContext pollingContext;
+        bee::ai::StateMachineContext eventContext;
+        std::mt19937 random(46);
+        std::uniform_real_distribution<float> deltaTime(1.0f / 60.0f, 1.0f / 20.0f);
+        std::uniform_real_distribution<float> wait(0.0f, 0.5f);
+        int waits = 0;
+        for (int step = 0; step < 3000; step++)
+        {
+            const float dt = deltaTime(random);
+            const float nextWait = wait(random);
+            const bool again = random() % 8 == 0;
+            for (auto* context : {&pollingContext, &eventContext})
+            {
+                context->deltaTime = dt;
+                context->blackboard->SetData("wait", nextWait);
+                context->blackboard->SetData("again", again);
+            }
+
+            const auto before = pollingContext.GetCurrentState();
+            polling->Execute(pollingContext);
+            eventDriven->Execute(eventContext);
+            if (before != pollingContext.GetCurrentState() && pollingContext.GetCurrentState() == 1) waits++;
+            Assert::IsTrue(pollingContext.GetCurrentState() == eventContext.GetCurrentState());
+        }
+        Assert::IsTrue(waits > 100);
+    }
+
+    TEST_METHOD(EventDrivenStateMachineBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        const auto assets = LoadStateMachineAssets();
+        const auto asset = std::find_if(assets.begin(), assets.end(),
+                                        [](const StateMachineAsset& a) { return a.name == "melee_default_fsm.json"; });
+        Assert::IsTrue(asset != assets.end(), L"melee_default_fsm.json not found in the assets folder.");
+
+        // a mostly idle army: every frame a few units get an order or a target, the rest wait for one
+        constexpr int agents = 4000;
+        constexpr int frames = 200;
+        constexpr int changesPerFrame = agents / 100;
+        std::string json = asset->json;
+        for (size_t at = json.find("RecordingState"); at != std::string::npos; at = json.find("RecordingState", at))
+            json.replace(at, std::string("RecordingState").size(), "State");
+
+        using Evaluation = bee::ai::FiniteStateMachine::TransitionEvaluation;
+        std::vector<size_t> finalStates[2];
+        const auto run = [&](const Evaluation evaluation)
+        {
+            std::stringstream stream(json);
+            const auto fsm = bee::ai::FiniteStateMachine::DeserializeFromStringStream(stream);
+            fsm->SetTransitionEvaluation(evaluation);
+            std::vector<bee::ai::StateMachineContext> contexts(agents);
+            std::mt19937 random(47);
+            for (auto& context : contexts) RandomizeBlackboard(*context.blackboard, asset->comparators, random);
+
+            const double time = MeasureMilliseconds(
+                [&]
+                {
+                    for (int frame = 0; frame < frames; frame++)
+                    {
+                        for (int change = 0; change < changesPerFrame; change++)
+                            RandomizeBlackboard(*contexts[random() % agents].blackboard, asset->comparators, random);
+                        for (auto& context : contexts) fsm->Execute(context);
+                    }
+                });
+            for (const auto& context : contexts)
+                finalStates[static_cast<int>(evaluation)].push_back(context.GetCurrentState().value());
+            return time;
+        };
+
+        const double pollingTime = run(Evaluation::Polling);
+        const double eventTime = run(Evaluation::EventDriven);
+        Logger::WriteMessage(fmt::format("{} idle state machines for {} frames, {} blackboard changes per frame: {:.3f} ms "
+                                         "polling, {:.3f} ms event driven\n",
+                                         agents, frames, changesPerFrame, pollingTime, eventTime)
+                                 .c_str());
+        Assert::IsTrue(finalStates[0] == finalStates[1]);
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(TimerWheelExpiresOnTime)
+    {
+        // timers from a frame to hours away, over frames of every length and the odd jump far ahead
+        bee::ai::TimerWheel wheel;
+        std::mt19937 random(48);
+        std::uniform_real_distribution<float> frame(1.0f / 240.0f, 1.0f / 15.0f);
+        std::uniform_real_distribution<float> jump(0.0f, 2000.0f);
+        std::uniform_real_distribution<float> delay(0.0f, 1.0f);
+
+        constexpr int timers = 3000;
+        std::vector<double> deadlines(timers, std::numeric_limits<double>::infinity());
+        std::vector<bool> expired(timers, false);
+        double time = 0.0;
+        const auto schedule = [&](const int timer)
+        {
+            // a third within seconds, a third within minutes, the rest up to a day
+            const float scale = timer % 3 == 0 ? 5.0f : timer % 3 == 1 ? 300.0f : 86400.0f;
+            const float seconds = delay(random) * scale;
+            wheel.Schedule(static_cast<bee::Entity>(timer), seconds);
+            deadlines[timer] = time + static_cast<double>(seconds);
+        };
+        for (int timer = 0; timer < timers; timer++) schedule(timer);
+
+        std::vector<bee::Entity> due;
+        int cancelled = 0;
+        int rescheduled = 0;
+        for (int step = 0; step < 20000 && wheel.GetCount() > 0; step++)
+        {
+            const float dt = random() % 100 == 0 ? jump(random) : frame(random);
+            const double before = time;
+            time += dt;
+            due.clear();
+            wheel.Advance(dt, due);
+
+            // every timer expires on the first frame that reaches its deadline
+            for (const auto entity : due)
+            {
+                const auto timer = static_cast<int>(entt::to_integral(entity));
+                Assert::IsFalse(expired[timer]);
+                Assert::IsTrue(deadlines[timer] <= time && deadlines[timer] > before);
+                expired[timer] = true;
+            }
+            for (int timer = 0; timer < timers; timer++)
+                if (!expired[timer] && deadlines[timer] <= time) Assert::Fail(L"A timer did not expire on time.");
+
+            // cancel or move some of the timers that are still running
+            const int timer = static_cast<int>(random() % timers);
+            if (expired[timer] || !wheel.IsScheduled(static_cast<bee::Entity>(timer))) continue;
+            if (random() % 2 == 0)
+            {
+                Assert::IsTrue(wheel.Cancel(static_cast<bee::Entity>(timer)));
+                deadlines[timer] = std::numeric_limits<double>::infinity();
+                cancelled++;
+            }
+            else
+            {
+                schedule(timer);
+                rescheduled++;
+            }
+        }
+
+        Assert::AreEqual(static_cast<size_t>(0), wheel.GetCount());
+        Assert::AreEqual(timers - cancelled, static_cast<int>(std::count(expired.begin(), expired.end(), true)));
+        Logger::WriteMessage(fmt::format("{} timers over {:.0f} s: {} cancelled, {} moved\n", timers, time, cancelled,
+                                         rescheduled)
+                                 .c_str());
+    }
+
+    TEST_METHOD(SuspendedAgentsSleepUntilWoken)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+
+        bee::ai::FiniteStateMachine fsm;
+        fsm.AddState<SleepingState>(true);
+        fsm.Compile();
+        // a period shorter than any frame, so awake agents tick on every frame
+        auto& system = ecs.CreateSystem<bee::ai::AIBehaviorSelectionSystem>(0.001f, 1);
+
+        // sleepers for a while, and sleepers until something wakes them
+        std::mt19937 random(49);
+        std::uniform_real_distribution<float> sleep(0.05f, 2.0f);
+        std::vector<bee::Entity> timed;
+        std::vector<bee::Entity> forever;
+        for (int i = 0; i < 300; i++)
+        {
+            const auto entity = ecs.CreateEntity();
+            ecs.CreateComponent<SleepLog>(entity);
+            auto& agent = ecs.CreateComponent<bee::ai::StateMachineAgent>(entity, fsm);
+            agent.context.entity = entity;
+            const bool wakesOnItsOwn = i % 3 != 0;
+            agent.context.blackboard->SetData("sleep", wakesOnItsOwn ? sleep(random) : std::numeric_limits<float>::infinity());
+            (wakesOnItsOwn ? timed : forever).push_back(entity);
+        }
+
+        std::uniform_real_distribution<float> frame(1.0f / 120.0f, 1.0f / 15.0f);
+        std::vector<double> frameTimes;
+        std::vector<bee::Entity> deleted;
+        double time = 0.0;
+        for (int step = 0; step < 600; step++)
+        {
+            if (step == 300)
+            {
+                // a blackboard change wakes half of the sleepers without a timer, Wake a quarter
+                for (size_t i = 0; i < forever.size(); i++)
+                {
+                    if (i % 4 < 2)
+                        registry.get<bee::ai::StateMachineAgent>(forever[i]).context.blackboard->SetData("poke", true);
+                    else if (i % 4 == 2)
+                        system.Wake(forever[i]);
+                }
+            }
+            if (step == 400)
+            {
+                // deleting sleeping agents cancels their timers
+                const size_t scheduled = system.GetTimerWheel().GetCount();
+                const size_t suspended = system.GetSuspendedAgentCount();
+                size_t deletedScheduled = 0;
+                for (size_t i = 0; i < timed.size(); i += 2)
+                {
+                    auto& agent = registry.get<bee::ai::StateMachineAgent>(timed[i]);
+                    if (agent.suspension.suspended) deletedScheduled++;
+                    ecs.DeleteEntity(timed[i]);
+                    deleted.push_back(timed[i]);
+                }
+                ecs.RemovedDeleted();
+                Assert::AreEqual(scheduled - deletedScheduled, system.GetTimerWheel().GetCount());
+                Assert::AreEqual(suspended - deletedScheduled, system.GetSuspendedAgentCount());
+            }
+
+            const float dt = frame(random);
+            time += dt;
+            ecs.UpdateSystems(dt);
+            ecs.PlaybackCommands();
+            ecs.RemovedDeleted();
+            frameTimes.push_back(time);
+            Assert::AreEqual(time, system.GetTimerWheel().GetTime());
+        }
+
+        // every timed sleeper woke on the first frame that reached the end of its sleep, with the time it slept
+        int wakeUps = 0;
+        for (const auto entity : timed)
+        {
+            if (!registry.valid(entity)) continue;
+            const auto& log = registry.get<SleepLog>(entity);
+            const float slept = registry.get<bee::ai::StateMachineAgent>(entity).context.blackboard->GetData<float>("sleep");
+            Assert::AreEqual(frameTimes.front(), log.ticks.front());
+            for (size_t tick = 1; tick < log.ticks.size(); tick++)
+            {
+                const double end = log.ticks[tick - 1] + static_cast<double>(slept);
+                const auto frameIndex = std::find(frameTimes.begin(), frameTimes.end(), log.ticks[tick]) - frameTimes.begin();
+                Assert::IsTrue(log.ticks[tick] >= end);
+                Assert::IsTrue(frameTimes[frameIndex - 1] < end);
+                Assert::IsTrue(std::abs(log.deltaTimes[tick] - (log.ticks[tick] - log.ticks[tick - 1])) < 1e-4);
+                wakeUps++;
+            }
+            Assert::IsTrue(frameTimes.back() < log.ticks.back() + static_cast<double>(slept));
+        }
+        Assert::IsTrue(wakeUps > 100);
+
+        // the others only ticked again when woken
+        for (size_t i = 0; i < forever.size(); i++)
+        {
+            const auto& log = registry.get<SleepLog>(forever[i]);
+            Assert::AreEqual(i % 4 < 3 ? static_cast<size_t>(2) : static_cast<size_t>(1), log.ticks.size());
+            if (log.ticks.size() == 2) Assert::AreEqual(frameTimes[300], log.ticks[1]);
+        }
+        for (const auto entity : deleted) Assert::IsFalse(registry.valid(entity));
+
+        size_t suspended = 0;
+        for (auto [entity, agent] : registry.view<bee::ai::StateMachineAgent>().each()) suspended += agent.suspension.suspended;
+        Assert::AreEqual(suspended, system.GetSuspendedAgentCount());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(SuspendedAgentsBenchmark)
+    {
+        // an army that is mostly waiting for orders, next to a few busy units
+        constexpr int agents = 20000;
+        constexpr int frames = 100;
+        constexpr float dt = 1.0f / 60.0f;
+        const auto run = [&](const bool suspend)
+        {
+            bee::Engine.InitializeHeadless();
+            auto& ecs = bee::Engine.ECS();
+            bee::ai::FiniteStateMachine waiting;
+            waiting.AddState<WaitForOrderState>(true, suspend);
+            waiting.Compile();
+            bee::ai::FiniteStateMachine busy;
+            busy.AddState<RecordingState>(true);
+            busy.Compile();
+            auto& system = ecs.CreateSystem<bee::ai::AIBehaviorSelectionSystem>(0.001f, 1);
+
+            for (int i = 0; i < agents; i++)
+            {
+                const auto entity = ecs.CreateEntity();
+                ecs.CreateComponent<bee::ai::StateMachineAgent>(entity, i % 10 == 0 ? busy : waiting).context.entity = entity;
+            }
+            const double time = MeasureMilliseconds(
+                [&]
+                {
+                    for (int frame = 0; frame < frames; frame++) ecs.UpdateSystems(dt);
+                });
+            const size_t suspended = system.GetSuspendedAgentCount();
+            bee::Engine.Shutdown();
+            return std::make_pair(time, suspended);
+        };
+
+        const auto [pollingTime, pollingSuspended] = run(false);
+        const auto [suspendedTime, suspended] = run(true);
+        Logger::WriteMessage(fmt::format("{} agents, {} of them waiting, for {} frames: {:.3f} ms polling, {:.3f} ms "
+                                         "suspended\n",
+                                         agents, suspended, frames, pollingTime, suspendedTime)
+                                 .c_str());
+        Assert::AreEqual(static_cast<size_t>(0), pollingSuspended);
+        Assert::AreEqual(static_cast<size_t>(agents - agents / 10), suspended);
+    }
+};
+}  // namespace UnitTests
@@ -0,0 +1,784 @@
+#include <pch.h>
+#include "CppUnitTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <glm/gtx/norm.hpp>
+
+#include "actors/attributes.hpp"
+#include "actors/buff_system.hpp"
+#include "actors/influence_map_system.hpp"
+#include "actors/props/resource_system.hpp"
+#include "actors/structures/structure_manager_system.hpp"
+#include "actors/targeting_system.hpp"
+#include "actors/units/unit_manager_system.hpp"
+#include "actors/visibility_system.hpp"
+#include "ai/influence_map.hpp"
+#include "core/ecs.hpp"
+#include "core/engine.hpp"
+#include "core/transform.hpp"
+#include "rendering/render_components.hpp"
+#include "tools/log.hpp"
+#include "tools/visibility_grid.hpp"
+
+#include "test_helpers.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+
+// How OffensiveMove (with structures) and OffensiveIdleState (without) picked a target before the TargetingSystem: the
+// closest enemy within interception range, by looking at every one of them.
+bee::Entity ScanForTarget(const entt::registry& registry, const bee::Entity entity, const bool structures)
+{
+    const glm::vec3 position = registry.get<bee::Transform>(entity).Translation;
+    const auto range = registry.get<AttributesComponent>(entity).GetValue(BaseAttributes::InterceptionRange);
+    bee::Entity closest = entt::null;
+    float minDist = std::numeric_limits<float>::max();
+    const auto scan = [&](const auto& view, const bool excludeRange)
+    {
+        for (const auto candidate : view)
+        {
+            const float distance2 = glm::distance2(view.template get<bee::Transform>(candidate).Translation, position);
+            if (excludeRange ? distance2 >= glm::pow(range, 2) : distance2 > glm::pow(range, 2)) continue;
+            if (minDist <= distance2) continue;
+            minDist = distance2;
+            closest = candidate;
+        }
+    };
+
+    if (registry.all_of<AllyUnit>(entity))
+    {
+        scan(registry.view<EnemyUnit, bee::Transform>(), true);
+        return closest;
+    }
+    scan(registry.view<AllyUnit, bee::Transform>(), false);
+    if (structures) scan(registry.view<AllyStructure, bee::Transform>(), false);
+    return closest;
+}
+
+// The scores of all enemies in range, which the TargetingSystem should find with its grid.
+std::map<bee::Entity, float> ScoreTargets(const entt::registry& registry, const bee::Entity entity, const bool structures,
+                                          const TargetScoring& scoring, const std::map<bee::Entity, int>& attackers)
+{
+    const glm::vec3 position = registry.get<bee::Transform>(entity).Translation;
+    const auto range = static_cast<float>(registry.get<AttributesComponent>(entity).GetValue(BaseAttributes::InterceptionRange));
+    std::map<bee::Entity, float> scores;
+    const auto score = [&](const auto& view, const bool structure)
+    {
+        for (const auto candidate : view)
+        {
+            TargetCandidate scored;
+            scored.entity = candidate;
+            scored.distance2 = glm::distance2(view.template get<bee::Transform>(candidate).Translation, position);
+            if (scored.distance2 > range * range) continue;
+            const auto& attributes = registry.get<AttributesComponent>(candidate);
+            const auto value = [&](const BaseAttributes type)
+            { return attributes.HasAttribute(type) ? static_cast<float>(attributes.GetValue(type)) : 0.0f; };
+            scored.hitPoints = value(BaseAttributes::HitPoints);
+            const float cooldown = value(BaseAttributes::AttackCooldown);
+            scored.damagePerSecond = cooldown > 0.0f ? value(BaseAttributes::Damage) / cooldown : value(BaseAttributes::Damage);
+            const auto attacker = attackers.find(candidate);
+            scored.attackers = attacker != attackers.end() ? attacker->second : 0;
+            scored.structure = structure;
+            scores[candidate] = scoring(scored);
+        }
+    };
+
+    if (registry.all_of<AllyUnit>(entity))
+    {
+        score(registry.view<EnemyUnit, bee::Transform>(), false);
+        return scores;
+    }
+    score(registry.view<AllyUnit, bee::Transform>(), false);
+    if (structures) score(registry.view<AllyStructure, bee::Transform>(), true);
+    return scores;
+}
+
+// Whether the target has the best of the scores, or there is no target when nothing scored. Enemies with the same
+// score are as good a pick.
+bool HasBestScore(const std::map<bee::Entity, float>& scores, const bee::Entity target)
+{
+    if (scores.empty()) return target == entt::null;
+    float best = -std::numeric_limits<float>::infinity();
+    for (const auto& [candidate, score] : scores) best = std::max(best, score);
+    const auto picked = scores.find(target);
+    return picked != scores.end() && picked->second == best;
+}
+
+// Puts an aura of the attribute at the position, as the StructureManager does for the structures that buff.
+bee::Entity CreateAura(const glm::vec3& position, const BaseAttributes type, const double range, const double value)
+{
+    auto& ecs = bee::Engine.ECS();
+    const auto entity = ecs.CreateEntity();
+    ecs.CreateComponent<bee::Transform>(entity).Translation = position;
+    auto& attributes = ecs.CreateComponent<AttributesComponent>(entity);
+    attributes.SetAttribute(BaseAttributes::BuffRange, range);
+    attributes.SetAttribute(BaseAttributes::BuffValue, value);
+    auto& buffStructure = ecs.CreateComponent<BuffStructure>(entity);
+    buffStructure.buffType = type;
+    buffStructure.buffModifier = StatModifier(ModifierType::Additive, value);
+    ecs.CreateComponent<AllyStructure>(entity);
+    return entity;
+}
+
+// Puts an ally unit at the position, with the attributes the auras buff.
+bee::Entity CreateBuffable(const glm::vec3& position)
+{
+    auto& ecs = bee::Engine.ECS();
+    const auto entity = ecs.CreateEntity();
+    ecs.CreateComponent<bee::Transform>(entity).Translation = position;
+    auto& attributes = ecs.CreateComponent<AttributesComponent>(entity);
+    attributes.SetAttribute(BaseAttributes::Range, 5.0);
+    attributes.SetAttribute(BaseAttributes::InterceptionRange, 8.0);
+    attributes.SetAttribute(BaseAttributes::HitPoints, 100.0);
+    ecs.CreateComponent<AllyUnit>(entity);
+    return entity;
+}
+
+// How the BuffSystem used to find the units in the auras, every aura against every ally unit.
+size_t ScanAuras(entt::registry& registry)
+{
+    size_t inside = 0;
+    const auto units = registry.view<AllyUnit, bee::Transform, AttributesComponent>();
+    for (const auto& [aura, buffStructure, transform, attributes] :
+         registry.view<BuffStructure, bee::Transform, AttributesComponent>().each())
+    {
+        const double range = attributes.GetValue(BaseAttributes::BuffRange);
+        for (const auto unit : units)
+        {
+            const auto& unitTransform = units.get<bee::Transform>(unit);
+            if (glm::distance2(unitTransform.Translation, transform.Translation) <= glm::pow(range, 2)) inside++;
+        }
+    }
+    return inside;
+}
+
+// Gives the actor the same attack as every other soldier, so only their numbers decide how strong a group is.
+void MakeSoldier(const bee::Entity entity)
+{
+    auto& attributes = bee::Engine.ECS().Registry.get<AttributesComponent>(entity);
+    attributes.SetAttribute(BaseAttributes::Damage, 10.0);
+    attributes.SetAttribute(BaseAttributes::AttackCooldown, 1.0);
+    attributes.SetAttribute(BaseAttributes::InterceptionRange, 2.0);
+}
+
+bee::Entity CreateResource(const glm::vec3& position, const int value)
+{
+    auto& ecs = bee::Engine.ECS();
+    const auto entity = ecs.CreateEntity();
+    ecs.CreateComponent<bee::Transform>(entity).Translation = position;
+    auto& resource = ecs.CreateComponent<PropResourceComponent>(entity);
+    resource.type = GameResourceType::Wood;
+    resource.resourceGain = value;
+    return entity;
+}
+
+// Every layer of every cell of the map, to compare maps with.
+std::vector<float> ReadInfluence(const bee::ai::InfluenceMap& map)
+{
+    std::vector<float> values;
+    for (int cell = 0; cell < map.GetCellCount(); cell++)
+    {
+        for (int layer = 0; layer < static_cast<int>(bee::ai::InfluenceLayer::Count); layer++)
+            values.push_back(map.Get(static_cast<bee::ai::InfluenceLayer>(layer), cell));
+        values.push_back(map.IsInSight(cell) ? 1.0f : 0.0f);
+    }
+    return values;
+}
+
+// How many observers see every cell of both teams, to compare the VisibilitySystem with one built from scratch.
+std::vector<int> ReadObservers(const VisibilitySystem& visibility)
+{
+    std::vector<int> observers;
+    for (const auto team : {Team::Ally, Team::Enemy})
+    {
+        const auto& grid = visibility.GetGrid(team);
+        for (int cell = 0; cell < grid.GetCellCount(); cell++)
+        {
+            Assert::AreEqual(grid.GetObserverCount(cell) > 0, grid.IsVisible(cell));
+            observers.push_back(grid.GetObserverCount(cell));
+        }
+    }
+    return observers;
+}
+
+}  // namespace
+
+namespace UnitTests
+{
+TEST_CLASS(ActorTests)
+{
+public:
+    TEST_METHOD(TargetingMatchesCombatStateRules)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+        std::mt19937 random(47);
+        std::uniform_real_distribution<float> battlefield(-30.0f, 30.0f);
+        std::uniform_real_distribution<float> height(0.0f, 2.0f);
+
+        // a battle, and a skirmish at an outpost far away that makes the grid grow its cells
+        std::vector<bee::Entity> units;
+        for (int i = 0; i < 840; i++)
+        {
+            const bool outpost = i % 20 == 0;
+            const glm::vec3 position = glm::vec3(battlefield(random), battlefield(random), height(random)) +
+                                       (outpost ? glm::vec3(2000.0f, -1500.0f, 0.0f) : glm::vec3(0.0f));
+            const bool structure = i % 21 == 0;
+            const auto entity = CreateCombatant(position, structure || i % 2 == 0 ? Team::Ally : Team::Enemy, structure, random);
+            if (!structure) units.push_back(entity);
+        }
+
+        auto& targeting = ecs.CreateSystem<TargetingSystem>();
+        const auto check = [&](const char* when)
+        {
+            int targets = 0;
+            int alive = 0;
+            for (const auto entity : units)
+            {
+                if (!registry.valid(entity)) continue;
+                alive++;
+                const auto& target = registry.get<CombatTarget>(entity);
+                Assert::IsTrue(ScanForTarget(registry, entity, false) == target.unit);
+                Assert::IsTrue(ScanForTarget(registry, entity, true) == target.unitOrStructure);
+                targets += target.unitOrStructure != entt::null;
+            }
+            Assert::AreEqual(targets, targeting.GetTargetingCount());
+            Logger::WriteMessage(fmt::format("{}: {} of {} units have a target\n", when, targets, alive).c_str());
+        };
+        targeting.Run();
+        check("first run");
+
+        // the targets only change once a period has passed
+        std::uniform_real_distribution<float> step(-3.0f, 3.0f);
+        for (const auto entity : units) registry.get<bee::Transform>(entity).Translation += glm::vec3(step(random), step(random), 0.0f);
+        for (size_t i = 0; i < units.size(); i += 7) ecs.DeleteEntity(units[i]);
+        ecs.RemovedDeleted();
+        std::map<bee::Entity, bee::Entity> before;
+        for (const auto entity : units)
+            if (registry.valid(entity)) before[entity] = registry.get<CombatTarget>(entity).unitOrStructure;
+        targeting.Update(targeting.GetPeriod() * 0.5f);
+        for (const auto& [entity, target] : before) Assert::IsTrue(registry.get<CombatTarget>(entity).unitOrStructure == target);
+        targeting.Update(targeting.GetPeriod() * 0.6f);
+        check("after moving and losing units");
+
+        // other scorings pick the best of the enemies in range as well
+        const auto checkScoring = [&](const char* name, const TargetScoring& scoring)
+        {
+            std::map<bee::Entity, int> attackers;
+            for (const auto& [entity, target] : registry.view<CombatTarget>().each())
+                if (target.unitOrStructure != entt::null) attackers[target.unitOrStructure]++;
+            targeting.SetScoring(scoring);
+            targeting.Run();
+            for (const auto entity : units)
+            {
+                if (!registry.valid(entity)) continue;
+                const auto& target = registry.get<CombatTarget>(entity);
+                Assert::IsTrue(HasBestScore(ScoreTargets(registry, entity, false, scoring, attackers), target.unit));
+                Assert::IsTrue(HasBestScore(ScoreTargets(registry, entity, true, scoring, attackers), target.unitOrStructure));
+            }
+            Logger::WriteMessage(fmt::format("{} scoring matches\n", name).c_str());
+        };
+        checkScoring("Threat", TargetScorings::Threat());
+        checkScoring("Focus fire", TargetScorings::FocusFire());
+        checkScoring("Focus fire, again", TargetScorings::FocusFire());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(TargetingBenchmark)
+    {
+        // 500 against 500 in the thick of it, with the towers of the allies in between
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+        std::mt19937 random(500);
+        const auto units = CreateArmies(1000, glm::vec2(-40.0f, -25.0f), glm::vec2(40.0f, 25.0f), random);
+        std::uniform_real_distribution<float> x(-40.0f, 40.0f);
+        std::uniform_real_distribution<float> y(-25.0f, 25.0f);
+        for (int i = 0; i < 20; i++) CreateCombatant(glm::vec3(x(random), y(random), 0.0f), Team::Ally, true, random);
+
+        constexpr int runs = 20;
+        auto& targeting = ecs.CreateSystem<TargetingSystem>();
+        size_t found = 0;
+        const double scanTime = MeasureAverageMilliseconds(
+            runs,
+            [&]
+            {
+                for (const auto entity : units) found += ScanForTarget(registry, entity, true) != entt::null;
+            });
+        const double systemTime = MeasureAverageMilliseconds(runs, [&] { targeting.Run(); });
+
+        Logger::WriteMessage(fmt::format("500 vs 500, {} units with a target: {:.3f} ms for every unit to scan every enemy, "
+                                         "{:.3f} ms through the targeting system\n",
+                                         found / runs, scanTime, systemTime)
+                                 .c_str());
+        Assert::AreEqual(found / runs, static_cast<size_t>(targeting.GetTargetingCount()));
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(AurasBuffTheStrongestOfEveryAttribute)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+        const auto weak = CreateAura(glm::vec3(3.0f, 0.0f, 0.0f), BaseAttributes::Range, 10.0, 2.0);
+        const auto strong = CreateAura(glm::vec3(-3.0f, 0.0f, 0.0f), BaseAttributes::Range, 10.0, 4.0);
+        const auto health = CreateAura(glm::vec3(0.0f, 3.0f, 0.0f), BaseAttributes::HitPoints, 10.0, 50.0);
+        const auto unit = CreateBuffable(glm::vec3(0.0f));
+        auto& buffs = ecs.CreateSystem<BuffSystem>(0.1f, 0.5f);
+        const auto range = [&] { return registry.get<AttributesComponent>(unit).GetValue(BaseAttributes::Range); };
+        const auto hitPoints = [&] { return registry.get<AttributesComponent>(unit).GetValue(BaseAttributes::HitPoints); };
+
+        // auras of the same attribute do not stack, those of different ones do
+        buffs.Tick();
+        Assert::AreEqual(3, buffs.GetEnterCount());
+        Assert::AreEqual(9.0, range());
+        Assert::AreEqual(12.0, registry.get<AttributesComponent>(unit).GetValue(BaseAttributes::InterceptionRange));
+        Assert::AreEqual(150.0, hitPoints());
+        Assert::AreEqual(static_cast<size_t>(3), registry.get<AuraBuffs>(unit).auras.size());
+        Assert::AreEqual(static_cast<size_t>(2), registry.get<AuraBuffs>(unit).applied.size());
+
+        // staying in the auras changes nothing, and nothing happens before a period has passed
+        buffs.Tick();
+        buffs.Update(0.05f);
+        Assert::AreEqual(0, buffs.GetEnterCount());
+        Assert::AreEqual(0, buffs.GetExitCount());
+        Assert::AreEqual(9.0, range());
+
+        // leaving the strongest aura gets the unit the buff of the next one, which it leaves later than it would enter
+        registry.get<bee::Transform>(unit).Translation = glm::vec3(13.3f, 0.0f, 0.0f);
+        buffs.Update(0.05f);
+        Assert::AreEqual(2, buffs.GetExitCount());
+        Assert::AreEqual(7.0, range());
+        Assert::AreEqual(100.0, hitPoints());
+        const auto newcomer = CreateBuffable(glm::vec3(13.3f, 0.0f, 0.0f));
+        for (int tick = 0; tick < 10; tick++)
+        {
+            registry.get<bee::Transform>(unit).Translation.x = tick % 2 == 0 ? 12.8f : 13.4f;
+            buffs.Tick();
+            Assert::AreEqual(0, buffs.GetEnterCount());
+            Assert::AreEqual(0, buffs.GetExitCount());
+            Assert::AreEqual(7.0, range());
+        }
+        Assert::AreEqual(5.0, registry.get<AttributesComponent>(newcomer).GetValue(BaseAttributes::Range));
+        registry.get<bee::Transform>(unit).Translation.x = 14.0f;
+        buffs.Tick();
+        Assert::AreEqual(5.0, range());
+        Assert::AreEqual(8.0, registry.get<AttributesComponent>(unit).GetValue(BaseAttributes::InterceptionRange));
+
+        // auras that go away take their buff with them right away
+        registry.get<bee::Transform>(unit).Translation = glm::vec3(0.0f);
+        buffs.Tick();
+        Assert::AreEqual(9.0, range());
+        registry.remove<BuffStructure>(strong);
+        Assert::AreEqual(7.0, range());
+        ecs.DeleteEntity(weak);
+        ecs.RemovedDeleted();
+        Assert::AreEqual(5.0, range());
+        Assert::AreEqual(150.0, hitPoints());
+        Assert::AreEqual(static_cast<size_t>(1), registry.get<AuraBuffs>(unit).auras.size());
+
+        // and units that go away leave their auras
+        ecs.DeleteEntity(unit);
+        ecs.RemovedDeleted();
+        Assert::IsTrue(registry.get<BuffStructure>(health).members.empty());
+        buffs.Tick();
+        Assert::AreEqual(0, buffs.GetExitCount());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(AuraBenchmark)
+    {
+        // a big base, with the army standing around between the towers
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+        std::mt19937 random(48);
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<double> range(8.0, 15.0);
+        const BaseAttributes types[] = {BaseAttributes::Range, BaseAttributes::HitPoints, BaseAttributes::AttackCooldown};
+        for (int i = 0; i < 60; i++)
+            CreateAura(glm::vec3(position(random), position(random), 0.0f), types[i % 3], range(random), 1.0 + i % 4);
+        for (int i = 0; i < 2000; i++) CreateBuffable(glm::vec3(position(random), position(random), 0.0f));
+
+        constexpr int ticks = 20;
+        auto& buffs = ecs.CreateSystem<BuffSystem>();
+        buffs.Tick();
+        size_t inside = 0;
+        const double scanTime = MeasureAverageMilliseconds(ticks, [&] { inside += ScanAuras(registry); });
+        const double systemTime = MeasureAverageMilliseconds(ticks, [&] { buffs.Tick(); });
+
+        size_t members = 0;
+        for (const auto& [aura, buffStructure] : registry.view<BuffStructure>().each()) members += buffStructure.members.size();
+        Logger::WriteMessage(fmt::format("60 auras, 2000 units, {} in an aura: {:.3f} ms for every aura to check every unit, "
+                                         "{:.3f} ms through the buff system\n",
+                                         members, scanTime, systemTime)
+                                 .c_str());
+        Assert::AreEqual(inside / ticks, members);
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(InfluenceMapStampsAndQueries)
+    {
+        using bee::ai::InfluenceLayer;
+        bee::ai::InfluenceMap map;
+        map.Resize(glm::vec2(-20.0f), 1.0f, 40, 40);
+        Assert::AreEqual(-1, map.GetCell(glm::vec2(25.0f, 0.0f)));
+        Assert::AreEqual(-1, map.GetCell(glm::vec2(0.0f, -20.5f)));
+        const int center = map.GetCell(glm::vec2(0.5f));
+        Assert::IsTrue(map.GetCellCenter(center) == glm::vec2(0.5f));
+
+        // stamps fall off with the distance, and come off again exactly, in whatever order
+        map.Stamp(InfluenceLayer::AllyThreat, center, 3, 10.0f);
+        Assert::AreEqual(10.0f, map.Get(InfluenceLayer::AllyThreat, center));
+        Assert::AreEqual(7.5f, map.Get(InfluenceLayer::AllyThreat, center + 1));
+        Assert::AreEqual(0.0f, map.Get(InfluenceLayer::AllyThreat, center + 4));
+        std::mt19937 random(49);
+        std::uniform_int_distribution<int> cell(0, map.GetCellCount() - 1);
+        std::uniform_real_distribution<float> value(0.1f, 40.0f);
+        std::vector<std::tuple<int, int, float>> stamps;
+        for (int i = 0; i < 500; i++) stamps.emplace_back(cell(random), i % 6, value(random));
+        for (const auto& [at, radius, amount] : stamps) map.Stamp(InfluenceLayer::AllyThreat, at, radius, amount);
+        std::shuffle(stamps.begin(), stamps.end(), random);
+        for (const auto& [at, radius, amount] : stamps) map.Stamp(InfluenceLayer::AllyThreat, at, radius, -amount);
+        map.Stamp(InfluenceLayer::AllyThreat, center, 3, -10.0f);
+        for (int at = 0; at < map.GetCellCount(); at++) Assert::AreEqual(0.0f, map.Get(InfluenceLayer::AllyThreat, at));
+
+        // a big group and a lone unit, with resources by the group and far from it
+        for (int i = 0; i < 4; i++)
+        {
+            const int at = map.GetCell(glm::vec2(-10.0f + static_cast<float>(i % 2), -10.0f + static_cast<float>(i / 2)));
+            map.Stamp(InfluenceLayer::AllyDensity, at, 0, 1.0f);
+            map.Stamp(InfluenceLayer::AllyThreat, at, 2, 10.0f);
+        }
+        const int lone = map.GetCell(glm::vec2(10.0f, 10.0f));
+        map.Stamp(InfluenceLayer::AllyDensity, lone, 0, 1.0f);
+        map.Stamp(InfluenceLayer::AllyThreat, lone, 2, 10.0f);
+        Assert::IsTrue(map.FindWeakestCluster(InfluenceLayer::AllyDensity, InfluenceLayer::AllyThreat) ==
+                       map.GetCellCenter(lone));
+        Assert::IsFalse(map.FindWeakestCluster(InfluenceLayer::EnemyDensity, InfluenceLayer::EnemyThreat).has_value());
+
+        const int nearGroup = map.GetCell(glm::vec2(-9.0f, -9.0f));
+        const int farAway = map.GetCell(glm::vec2(15.0f, -15.0f));
+        map.Stamp(InfluenceLayer::Resources, nearGroup, 0, 50.0f);
+        map.Stamp(InfluenceLayer::Resources, farAway, 0, 50.0f);
+        Assert::IsTrue(map.FindSafestResource(InfluenceLayer::AllyThreat, glm::vec2(-10.0f)) == map.GetCellCenter(farAway));
+        Assert::IsTrue(map.FindSafestResource(InfluenceLayer::EnemyThreat, glm::vec2(-10.0f)) == map.GetCellCenter(nearGroup));
+
+        // what is in sight has no age, what was never seen an infinite one
+        map.See(center, 2, 1, 0.0f);
+        map.See(center, 2, 1, 1.0f);
+        Assert::AreEqual(0.0f, map.GetExploredAge(center + 2, 4.0f));
+        Assert::IsTrue(std::isinf(map.GetExploredAge(center + 3, 4.0f)));
+        map.See(center, 2, -1, 2.0f);
+        Assert::AreEqual(0.0f, map.GetExploredAge(center, 4.0f));
+        map.See(center, 2, -1, 3.0f);
+        Assert::AreEqual(1.0f, map.GetExploredAge(center, 4.0f));
+        const auto unexplored = map.FindLeastExplored(glm::vec2(0.5f), 4.0f);
+        Assert::IsTrue(unexplored.has_value());
+        Assert::IsTrue(std::isinf(map.GetExploredAge(map.GetCell(*unexplored), 4.0f)));
+        Assert::IsTrue(glm::distance(*unexplored, glm::vec2(0.5f)) < 3.0f);
+    }
+
+    TEST_METHOD(InfluenceMapFollowsActors)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+        std::mt19937 random(49);
+        auto& influence = ecs.CreateSystem<InfluenceMapSystem>(0.5f, 3.0f);
+        influence.SetBounds(glm::vec2(-40.0f), 0.5f, 160, 160);
+        const auto& map = influence.GetMap();
+
+        // a group of the player, a lone unit of the player, and an enemy scout; wood by the group and far from it
+        for (int i = 0; i < 4; i++)
+            MakeSoldier(CreateCombatant(glm::vec3(-10.0f + 0.3f * static_cast<float>(i), -10.0f, 0.0f), Team::Ally, false, random));
+        const auto lone = CreateCombatant(glm::vec3(10.0f, 10.0f, 0.0f), Team::Ally, false, random);
+        MakeSoldier(lone);
+        const auto scout = CreateCombatant(glm::vec3(10.0f, -10.0f, 0.0f), Team::Enemy, false, random);
+        CreateResource(glm::vec3(-9.0f, -9.0f, 0.0f), 50);
+        CreateResource(glm::vec3(12.0f, -10.0f, 0.0f), 50);
+        influence.Sync();
+        Assert::AreEqual(8, influence.GetRestampCount());
+        Assert::IsTrue(glm::distance(*influence.FindWeakestCluster(Team::Ally), glm::vec2(10.0f)) < map.GetCellSize());
+        Assert::IsTrue(glm::distance(*influence.FindSafestResource(Team::Ally, glm::vec2(0.0f)), glm::vec2(12.0f, -10.0f)) <
+                       map.GetCellSize());
+        const int lonePlace = map.GetCell(glm::vec2(10.0f));
+        Assert::AreEqual(1.0f, map.Get(bee::ai::InfluenceLayer::AllyDensity, lonePlace));
+
+        // units that die are taken off right away, and where the scout was ages once it has left
+        ecs.DeleteEntity(lone);
+        ecs.RemovedDeleted();
+        Assert::AreEqual(0.0f, map.Get(bee::ai::InfluenceLayer::AllyDensity, lonePlace));
+        Assert::AreEqual(0.0f, map.Get(bee::ai::InfluenceLayer::AllyThreat, lonePlace));
+        const int scoutPlace = map.GetCell(glm::vec2(10.0f, -10.0f));
+        registry.get<bee::Transform>(scout).Translation = glm::vec3(-20.0f, 20.0f, 0.0f);
+        influence.Update(0.25f);
+        Assert::AreEqual(0.0f, map.GetExploredAge(scoutPlace, influence.GetTime()));
+        influence.Update(0.25f);
+        Assert::AreEqual(1, influence.GetRestampCount());
+        influence.Update(0.5f);
+        Assert::AreEqual(0.5f, map.GetExploredAge(scoutPlace, influence.GetTime()));
+        Assert::AreEqual(0, influence.GetRestampCount());
+
+        // however the units move and die, the map is what it would be when built from scratch
+        const auto units = CreateArmies(400, glm::vec2(-35.0f), glm::vec2(35.0f), random, 25);
+        for (int round = 0; round < 5; round++)
+        {
+            FightRound(units, round, 3, 1.0f, 37, random);
+            influence.Sync();
+            const int restamps = influence.GetRestampCount();
+            const auto incremental = ReadInfluence(map);
+            influence.SetBounds(glm::vec2(-40.0f), 0.5f, 160, 160);
+            influence.Sync();
+            Assert::IsTrue(incremental == ReadInfluence(map));
+            Logger::WriteMessage(fmt::format("round {}: restamped {} of {} sources\n", round, restamps,
+                                             influence.GetRestampCount())
+                                     .c_str());
+        }
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(InfluenceMapBenchmark)
+    {
+        // 1000 against 1000 on a map of 200 by 200, with an army of 400 marching while the rest stand around
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        std::mt19937 random(2000);
+        const auto combatants = CreateArmies(2000, glm::vec2(-95.0f), glm::vec2(95.0f), random);
+        std::uniform_real_distribution<float> position(-95.0f, 95.0f);
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+        std::vector<MarchingUnit> units;
+        for (size_t i = 0; i < combatants.size(); i += 5)
+            units.push_back({combatants[i], glm::vec3(direction(random), direction(random), 0.0f) * 0.6f});
+        for (int i = 0; i < 100; i++) CreateResource(glm::vec3(position(random), position(random), 0.0f), 50);
+
+        constexpr int syncs = 20;
+        auto& influence = ecs.CreateSystem<InfluenceMapSystem>();
+        influence.SetBounds(glm::vec2(-100.0f), 1.0f, 200, 200);
+        influence.Sync();
+        int restamps = 0;
+        const double incrementalTime = MeasureAverageMilliseconds(
+            syncs,
+            [&]
+            {
+                March(units, 95.0f);
+                influence.Sync();
+                restamps += influence.GetRestampCount();
+            });
+        const double rebuildTime = MeasureAverageMilliseconds(
+            syncs,
+            [&]
+            {
+                March(units, 95.0f);
+                influence.SetBounds(glm::vec2(-100.0f), 1.0f, 200, 200);
+                influence.Sync();
+            });
+        std::optional<glm::vec2> weakest;
+        const double queryTime =
+            MeasureAverageMilliseconds(syncs, [&] { weakest = influence.FindWeakestCluster(Team::Ally); });
+
+        Logger::WriteMessage(fmt::format("2000 units, {} of them moved to another cell per sync: {:.3f} ms to update the "
+                                         "map, {:.3f} ms to build it again, {:.3f} ms for the weakest cluster\n",
+                                         restamps / syncs, incrementalTime, rebuildTime, queryTime)
+                                 .c_str());
+        Assert::IsTrue(weakest.has_value());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(VisibilityGridCountsObservers)
+    {
+        bee::VisibilityGrid grid;
+        grid.Resize(glm::vec2(-20.0f), 1.0f, 40, 40);
+        const int center = grid.GetCell(glm::vec2(0.5f));
+        Assert::AreEqual(-1, grid.GetCell(glm::vec2(20.5f, 0.0f)));
+        Assert::IsFalse(grid.IsVisible(glm::vec2(30.0f)));
+
+        // a cell stays visible while any observer sees it, and explored afterwards
+        grid.See(center, 3, 1);
+        grid.See(center, 3, 1);
+        Assert::AreEqual(2, grid.GetObserverCount(center + 3));
+        Assert::IsFalse(grid.IsVisible(center + 4));
+        grid.See(center, 3, -1);
+        Assert::IsTrue(grid.IsVisible(center - 3 * grid.GetWidth()));
+        grid.See(center, 3, -1);
+        Assert::IsFalse(grid.IsVisible(center));
+        Assert::IsTrue(grid.IsExplored(center + 3));
+        Assert::IsFalse(grid.IsExplored(center + 4));
+
+        // stamps come off exactly, in whatever order and wherever they are cut off by the edges
+        std::mt19937 random(50);
+        std::uniform_int_distribution<int> cell(0, grid.GetCellCount() - 1);
+        std::vector<std::pair<int, int>> stamps;
+        for (int i = 0; i < 500; i++) stamps.emplace_back(cell(random), i % 12);
+        for (const auto& [at, radius] : stamps) grid.See(at, radius, 1);
+        Assert::IsTrue(grid.GetVisibleCellCount() > 0);
+        std::shuffle(stamps.begin(), stamps.end(), random);
+        for (const auto& [at, radius] : stamps) grid.See(at, radius, -1);
+        Assert::AreEqual(0, grid.GetVisibleCellCount());
+        for (int at = 0; at < grid.GetCellCount(); at++) Assert::AreEqual(0, grid.GetObserverCount(at));
+        for (const auto bits : grid.GetVisibleBits()) Assert::AreEqual(uint64_t(0), bits);
+
+        // a cliff two cells east of the center: what is on it and behind it is hidden, and the cliff sees down
+        std::vector<float> heights(grid.GetCellCount(), 0.0f);
+        for (int y = -1; y <= 1; y++) heights[center + 2 + y * grid.GetWidth()] = 5.0f;
+        grid.SetHeights(heights);
+        Assert::IsTrue(grid.HasLineOfSight());
+        grid.See(center, 6, 1);
+        Assert::IsTrue(grid.IsVisible(center + 1));
+        Assert::IsFalse(grid.IsVisible(center + 2));
+        Assert::IsFalse(grid.IsVisible(center + 4));
+        Assert::IsTrue(grid.IsVisible(center - 4));
+        Assert::IsTrue(grid.IsVisible(center + 4 + 4 * grid.GetWidth()));
+        grid.See(center + 2, 6, 1);
+        Assert::IsTrue(grid.IsVisible(center + 4));
+        grid.See(center + 2, 6, -1);
+        grid.See(center, 6, -1);
+        Assert::AreEqual(0, grid.GetVisibleCellCount());
+    }
+
+    TEST_METHOD(VisibilityFollowsMovementAndDeath)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+        std::mt19937 random(50);
+        auto& visibility = ecs.CreateSystem<VisibilitySystem>(0.1f, 3.0f, false);
+        visibility.SetBounds(glm::vec2(-40.0f), 1.0f, 80, 80);
+        const auto& sight = visibility.GetGrid(Team::Ally);
+
+        // a scout of the player between an enemy unit with a mesh on a child and an enemy structure
+        const auto scout = CreateCombatant(glm::vec3(0.0f), Team::Ally, false, random);
+        MakeSoldier(scout);
+        const auto enemy = CreateCombatant(glm::vec3(20.0f, 0.0f, 0.0f), Team::Enemy, false, random);
+        MakeSoldier(enemy);
+        const auto mesh = ecs.CreateEntity();
+        ecs.CreateComponent<bee::Transform>(mesh);
+        registry.get<bee::Hierarchy>(mesh).SetParent(enemy);
+        const auto structure = ecs.CreateEntity();
+        ecs.CreateComponent<bee::Transform>(structure).Translation = glm::vec3(-20.0f, 0.0f, 0.0f);
+        ecs.CreateComponent<EnemyStructure>(structure);
+        visibility.Sync();
+        Assert::AreEqual(3, visibility.GetRestampCount());
+        Assert::AreEqual(2, visibility.GetHiddenCount());
+        Assert::IsTrue(registry.all_of<bee::Hidden>(enemy));
+        Assert::IsTrue(registry.all_of<bee::Hidden>(mesh));
+        Assert::IsTrue(registry.all_of<bee::Hidden>(structure));
+        Assert::IsTrue(visibility.IsVisible(Team::Enemy, glm::vec2(20.0f, 2.0f)));
+        Assert::IsFalse(visibility.IsVisible(Team::Ally, glm::vec2(20.0f, 2.0f)));
+
+        // walking up to the enemy shows it, walking away hides it again, while the structure stays once explored
+        registry.get<bee::Transform>(scout).Translation = glm::vec3(18.0f, 0.0f, 0.0f);
+        visibility.Update(0.1f);
+        Assert::AreEqual(1, visibility.GetRestampCount());
+        Assert::IsFalse(registry.all_of<bee::Hidden>(enemy));
+        Assert::IsFalse(registry.all_of<bee::Hidden>(mesh));
+        registry.get<bee::Transform>(scout).Translation = glm::vec3(-18.0f, 0.0f, 0.0f);
+        visibility.Update(0.1f);
+        Assert::IsTrue(registry.all_of<bee::Hidden>(enemy));
+        Assert::IsFalse(registry.all_of<bee::Hidden>(structure));
+
+        // a child attached to the hidden enemy, like a hover circle, is hidden on the next sync
+        const auto circle = ecs.CreateEntity();
+        ecs.CreateComponent<bee::Transform>(circle);
+        registry.get<bee::Hierarchy>(circle).SetParent(enemy);
+        Assert::IsFalse(registry.all_of<bee::Hidden>(circle));
+        registry.get<bee::Transform>(scout).Translation = glm::vec3(0.0f);
+        visibility.Update(0.1f);
+        Assert::IsTrue(registry.all_of<bee::Hidden>(circle));
+        Assert::IsFalse(registry.all_of<bee::Hidden>(structure));
+        Assert::AreEqual(1, visibility.GetHiddenCount());
+
+        // a scout that dies sees nothing any more right away, what it saw stays explored
+        ecs.DeleteEntity(scout);
+        ecs.RemovedDeleted();
+        Assert::AreEqual(0, sight.GetVisibleCellCount());
+        Assert::IsTrue(sight.IsExplored(glm::vec2(0.0f)));
+
+        // however the units move and die, every cell is seen by as many observers as when built from scratch
+        const auto units = CreateArmies(300, glm::vec2(-38.0f), glm::vec2(38.0f), random);
+        for (int round = 0; round < 5; round++)
+        {
+            FightRound(units, round, 2, 1.5f, 29, random);
+            visibility.Sync();
+            const int restamps = visibility.GetRestampCount();
+            const auto incremental = ReadObservers(visibility);
+            const auto enemies = registry.view<EnemyUnit, bee::Transform>();
+            for (const auto entity : enemies)
+            {
+                const glm::vec2 position(enemies.get<bee::Transform>(entity).Translation);
+                Assert::AreEqual(!sight.IsVisible(position), registry.all_of<bee::Hidden>(entity));
+            }
+            visibility.SetBounds(glm::vec2(-40.0f), 1.0f, 80, 80);
+            visibility.Sync();
+            Assert::IsTrue(incremental == ReadObservers(visibility));
+            Logger::WriteMessage(fmt::format("round {}: restamped {} of {} observers\n", round, restamps,
+                                             visibility.GetRestampCount())
+                                     .c_str());
+        }
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(VisibilityBenchmark)
+    {
+        // 300 against 300 all on the move, over hills on a map of 200 by 200
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+        std::mt19937 random(600);
+        std::uniform_real_distribution<float> direction(-1.0f, 1.0f);
+        std::vector<MarchingUnit> units;
+        for (const auto entity : CreateArmies(600, glm::vec2(-95.0f), glm::vec2(95.0f), random))
+            units.push_back({entity, glm::vec3(direction(random), direction(random), 0.0f) * 0.25f});
+        std::vector<float> heights;
+        for (int y = 0; y < 200; y++)
+            for (int x = 0; x < 200; x++) heights.push_back(std::floor(2.0f + std::sin(x * 0.1f) + std::cos(y * 0.13f)));
+
+        constexpr int syncs = 20;
+        auto& visibility = ecs.CreateSystem<VisibilitySystem>();
+        visibility.SetBounds(glm::vec2(-100.0f), 1.0f, 200, 200, heights);
+        visibility.Sync();
+        int restamps = 0;
+        const double incrementalTime = MeasureAverageMilliseconds(
+            syncs,
+            [&]
+            {
+                March(units, 95.0f);
+                visibility.Sync();
+                restamps += visibility.GetRestampCount();
+            });
+        const double rebuildTime = MeasureAverageMilliseconds(
+            syncs,
+            [&]
+            {
+                March(units, 95.0f);
+                visibility.SetBounds(glm::vec2(-100.0f), 1.0f, 200, 200, heights);
+                visibility.Sync();
+            });
+        int hidden = 0;
+        const double queryTime = MeasureMilliseconds(
+            [&]
+            {
+                for (const auto& [entity, velocity] : units)
+                    if (!visibility.IsVisible(Team::Ally, glm::vec2(registry.get<bee::Transform>(entity).Translation))) hidden++;
+            });
+
+        Logger::WriteMessage(fmt::format("600 observers, {} of them moved to another cell per sync: {:.3f} ms to update "
+                                         "the fog, {:.3f} ms to build it again, {:.3f} ms to look up every unit\n",
+                                         restamps / syncs, incrementalTime, rebuildTime, queryTime)
+                                 .c_str());
+        Assert::IsTrue(hidden > 0);
+        bee::Engine.Shutdown();
+    }
+};
+}  // namespace UnitTests
@@ -0,0 +1,1181 @@
+#include <pch.h>
+#include "CppUnitTest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "actors/actor_wrapper.hpp"
+#include "actors/attributes.hpp"
+#include "actors/buff_system.hpp"
+#include "actors/projectile_system/projectile_system.hpp"
+#include "actors/targeting_system.hpp"
+#include "actors/units/unit_manager_system.hpp"
+#include "ai/ai_behavior_selection_system.hpp"
+#include "ai/FiniteStateMachines/finite_state_machine.hpp"
+#include "ai/grid_navigation_system.hpp"
+#include "ai/navigation_grid.hpp"
+#include "core/ecs.hpp"
+#include "core/engine.hpp"
+#include "core/prefab.hpp"
+#include "core/simulation_lod.hpp"
+#include "core/transform.hpp"
+#include "level_editor/terrain_system.hpp"
+#include "particle_system/particle_system.hpp"
+#include "physics/physics_components.hpp"
+#include "physics/world.hpp"
+#include "rendering/render_components.hpp"
+#include "tools/frame_arena.hpp"
+#include "tools/log.hpp"
+
+#include "test_helpers.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+
+// The layout bee::Transform had before the world matrix moved to bee::WorldTransform, the links to bee::Hierarchy and
+// the name was interned.
+struct LegacyTransform
+{
+    glm::vec3 Translation = glm::vec3(0.0f);
+    glm::vec3 TranslationWorld = glm::vec3(0.0f);
+    glm::mat4 WorldMatrix = glm::mat4(1.0f);
+    glm::vec3 Scale = glm::vec3(1.0f);
+    glm::quat Rotation = glm::identity<glm::quat>();
+    std::string Name = {};
+    bee::Entity parent = entt::null, first = entt::null, next = entt::null;
+};
+
+// Systems to look up: a base class with two implementations, and one that is never created.
+class SteeringSystem : public bee::System
+{
+};
+
+class FlockingSystem : public SteeringSystem
+{
+public:
+    explicit FlockingSystem(int priority) { Priority = priority; }
+};
+
+class AvoidanceSystem : public SteeringSystem
+{
+public:
+    explicit AvoidanceSystem(int priority) { Priority = priority; }
+};
+
+class MissingSystem : public bee::System
+{
+};
+
+// Systems that only take up room in the list.
+template <int N>
+class FillerSystem : public bee::System
+{
+public:
+    FillerSystem() { Priority = 100 - N; }
+};
+
+template <int... N>
+void CreateFillerSystems(bee::EntityComponentSystem& ecs, std::integer_sequence<int, N...>)
+{
+    (ecs.CreateSystem<FillerSystem<N>>(), ...);
+}
+
+// Walks up to the target the TargetingSystem picked, like the combat states of the game do.
+class ChaseState : public bee::ai::State
+{
+public:
+    void Update(bee::ai::StateMachineContext& context) override
+    {
+        auto& registry = bee::Engine.ECS().Registry;
+        const auto target = registry.get<CombatTarget>(context.entity).unit;
+        if (!registry.valid(target)) return;
+        const glm::vec2 position(registry.get<bee::Transform>(target).Translation);
+        auto& agent = registry.get<bee::ai::GridAgent>(context.entity);
+        if (glm::distance(agent.goal, position) > 1.0f) agent.SetGoal(position);
+    }
+};
+
+// How GetSystem used to find a system.
+template <typename T>
+T* FindSystemLinear(const std::vector<bee::System*>& systems)
+{
+    for (auto* system : systems)
+        if (T* found = dynamic_cast<T*>(system)) return found;
+    return nullptr;
+}
+
+// What the hierarchy should look like: the children of every entity, in order, and its parent.
+struct HierarchyModel
+{
+    std::map<bee::Entity, std::vector<bee::Entity>> children;
+    std::map<bee::Entity, bee::Entity> parents;
+
+    bool IsDescendant(bee::Entity entity, const bee::Entity ancestor) const
+    {
+        for (; entity != entt::null; entity = parents.at(entity))
+            if (entity == ancestor) return true;
+        return false;
+    }
+
+    void Detach(const bee::Entity entity)
+    {
+        const auto parent = parents[entity];
+        if (parent == entt::null) return;
+        auto& siblings = children[parent];
+        siblings.erase(std::find(siblings.begin(), siblings.end(), entity));
+        parents[entity] = entt::null;
+    }
+
+    void Subtree(const bee::Entity entity, std::vector<bee::Entity>& subtree) const
+    {
+        subtree.push_back(entity);
+        for (const auto child : children.at(entity)) Subtree(child, subtree);
+    }
+};
+
+// Walks the sibling lists of every entity both ways and compares them to the model.
+void CheckHierarchy(const HierarchyModel& model, entt::registry& registry)
+{
+    for (const auto& [entity, children] : model.children)
+    {
+        Assert::IsTrue(registry.valid(entity));
+        auto& hierarchy = registry.get<bee::Hierarchy>(entity);
+        Assert::IsTrue(hierarchy.GetParent() == model.parents.at(entity));
+
+        std::vector<bee::Entity> forward, backward, iterated;
+        for (auto child = hierarchy.FirstChild(); child != entt::null; child = registry.get<bee::Hierarchy>(child).GetNextChild())
+            forward.push_back(child);
+        for (auto child = hierarchy.LastChild(); child != entt::null; child = registry.get<bee::Hierarchy>(child).GetPreviousChild())
+            backward.insert(backward.begin(), child);
+        for (const auto child : hierarchy) iterated.push_back(child);
+        Assert::IsTrue(forward == children);
+        Assert::IsTrue(backward == children);
+        Assert::IsTrue(iterated == children);
+    }
+}
+
+std::vector<bee::Entity> Children(entt::registry& registry, const bee::Entity entity)
+{
+    std::vector<bee::Entity> children;
+    for (auto child = registry.get<bee::Hierarchy>(entity).FirstChild(); child != entt::null;
+         child = registry.get<bee::Hierarchy>(child).GetNextChild())
+        children.push_back(child);
+    return children;
+}
+
+// Walks two hierarchies side by side, checking that the entities have the same components and transforms.
+void CheckSameHierarchy(entt::registry& registry, const bee::Entity a, const bee::Entity b)
+{
+    for (auto [id, storage] : registry.storage()) Assert::AreEqual(storage.contains(a), storage.contains(b));
+
+    const auto& transformA = registry.get<bee::Transform>(a);
+    const auto& transformB = registry.get<bee::Transform>(b);
+    Assert::IsTrue(transformA.Name == transformB.Name);
+    Assert::IsTrue(transformA.Translation == transformB.Translation);
+    Assert::IsTrue(transformA.Scale == transformB.Scale);
+    Assert::IsTrue(transformA.Rotation == transformB.Rotation);
+
+    const auto childrenA = Children(registry, a);
+    const auto childrenB = Children(registry, b);
+    Assert::AreEqual(childrenA.size(), childrenB.size());
+    for (size_t i = 0; i < childrenA.size(); i++) CheckSameHierarchy(registry, childrenA[i], childrenB[i]);
+}
+
+// The unit manager with a melee template named Warrior, on a flat terrain below a camera, as SpawnUnit needs to place
+// units.
+UnitManager& CreateWarriorTemplate()
+{
+    auto& ecs = bee::Engine.ECS();
+    ecs.CreateSystem<lvle::TerrainSystem>();
+    const auto camera = ecs.CreateEntity();
+    ecs.CreateComponent<bee::Transform>(camera).Translation = glm::vec3(8.0f, 8.0f, 30.0f);
+    ecs.CreateComponent<bee::Camera>(camera);
+
+    auto& unitManager = ecs.CreateSystem<UnitManager>();
+    UnitTemplate warrior(UnitTemplatePresets::AllyMeleeUnit);
+    warrior.name = "Warrior";
+    warrior.fsmPath = "fsm/melee_default_fsm.json";
+    unitManager.AddNewUnitTemplate(warrior);
+    return unitManager;
+}
+
+}  // namespace
+
+namespace UnitTests
+{
+TEST_CLASS(ECSTests)
+{
+public:
+    TEST_METHOD(SchedulerKeepsOrderOfUndeclaredSystems)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        ecs.SetScheduling(bee::EntityComponentSystem::Scheduling::Parallel);
+
+        std::vector<std::string> order;
+        std::mutex orderMutex;
+        const auto record = [&](const std::string& name)
+        {
+            return [&, name]
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                std::lock_guard<std::mutex> lock(orderMutex);
+                order.push_back(name);
+            };
+        };
+
+        // undeclared systems act as barriers, the declared ones between them may run in any order
+        ecs.CreateSystem<TestSystem>("first", 50, record("first"));
+        ecs.CreateSystem<TestSystem>("readerA", 40, record("readerA")).Reading<Position>();
+        ecs.CreateSystem<TestSystem>("readerB", 39, record("readerB")).Reading<Position>();
+        ecs.CreateSystem<TestSystem>("second", 30, record("second"));
+        ecs.CreateSystem<TestSystem>("writer", 20, record("writer")).Writing<Position>();
+        ecs.CreateSystem<TestSystem>("reader", 10, record("reader")).Reading<Position>();
+
+        for (int frame = 0; frame < 10; frame++)
+        {
+            order.clear();
+            ecs.UpdateSystems(1.0f / 60.0f);
+            Assert::AreEqual(static_cast<size_t>(6), order.size());
+            Assert::AreEqual(std::string("first"), order[0]);
+            Assert::IsTrue((order[1] == "readerA" && order[2] == "readerB") || (order[1] == "readerB" && order[2] == "readerA"));
+            Assert::AreEqual(std::string("second"), order[3]);
+            Assert::AreEqual(std::string("writer"), order[4]);
+            Assert::AreEqual(std::string("reader"), order[5]);
+        }
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(SchedulerNeverOverlapsConflictingSystems)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        ecs.SetScheduling(bee::EntityComponentSystem::Scheduling::Parallel);
+
+        Trace trace;
+        const auto writer = [&]
+        {
+            if (++trace.writersOfPosition > 1) trace.overlapped = true;
+            trace.Work(std::chrono::microseconds(500));
+            --trace.writersOfPosition;
+        };
+        const auto other = [&] { trace.Work(std::chrono::microseconds(500)); };
+
+        ecs.CreateSystem<TestSystem>("movement", 10, writer).Writing<Position>().Reading<Velocity>();
+        ecs.CreateSystem<TestSystem>("separation", 9, writer).Writing<Position>();
+        ecs.CreateSystem<TestSystem>("lifetime", 8, other).Writing<Lifetime>();
+        ecs.CreateSystem<TestSystem>("health", 7, other).Writing<Health>();
+        ecs.CreateSystem<TestSystem>("steering", 6, writer).Writing<Velocity, Position>();
+
+        for (int frame = 0; frame < 50; frame++) ecs.UpdateSystems(1.0f / 60.0f);
+        Assert::IsFalse(trace.overlapped.load());
+        Assert::IsTrue(trace.maxConcurrent.load() > 1);
+
+        // serial scheduling never overlaps anything
+        trace.maxConcurrent = 0;
+        ecs.SetScheduling(bee::EntityComponentSystem::Scheduling::Serial);
+        for (int frame = 0; frame < 5; frame++) ecs.UpdateSystems(1.0f / 60.0f);
+        Assert::AreEqual(1, trace.maxConcurrent.load());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(SchedulerReportsAccessViolations)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        // the checks also run when scheduling serially, which keeps the violations below from racing
+        const auto entity = ecs.CreateEntity();
+        ecs.CreateComponent<Position>(entity);
+        ecs.CreateComponent<Velocity>(entity);
+
+        ecs.CreateSystem<TestSystem>("honest", 10,
+                                     [&]
+                                     {
+                                         for (auto [e, position, velocity] : ecs.View<Position, const Velocity>().each())
+                                             position.value += velocity.value;
+                                     })
+            .Writing<Position>()
+            .Reading<Velocity>();
+        ecs.CreateSystem<TestSystem>("sneaky", 9,
+                                     [&]
+                                     {
+                                         for (auto [e, velocity] : ecs.View<Velocity>().each()) velocity.value *= 2.0f;
+                                         ecs.CreateComponent<Health>(ecs.CreateEntity());
+                                     })
+            .Reading<Velocity>();
+        ecs.CreateSystem<TestSystem>("undeclared", 8, [&] { ecs.CreateComponent<Lifetime>(ecs.CreateEntity()); });
+
+        ecs.UpdateSystems(1.0f / 60.0f);
+        const auto violations = ecs.GetAccessViolations();
+        for (const auto& violation : violations) Logger::WriteMessage((violation + "\n").c_str());
+
+#ifdef _DEBUG
+        // writing Velocity, creating an entity and adding Health; undeclared systems are not checked
+        Assert::AreEqual(static_cast<size_t>(3), violations.size());
+        for (const auto& violation : violations) Assert::IsTrue(violation.find("sneaky") != std::string::npos);
+#else
+        Assert::IsTrue(violations.empty());
+#endif
+        ecs.ClearAccessViolations();
+        Assert::IsTrue(ecs.GetAccessViolations().empty());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(SchedulerFrameTimeBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+
+        // the systems Starcraft::Init creates, minus those that need the resources of a level
+        ecs.CreateSystem<bee::ParticleSystem>();
+        ecs.CreateSystem<bee::SimulationLODSystem>();
+        ecs.CreateSystem<bee::ai::GridNavigationSystem>(0.1f, bee::ai::NavigationGrid(glm::vec2(0.0f), 1, 64, 64));
+        ecs.CreateSystem<bee::physics::World>(0.02f);
+        ecs.CreateSystem<ProjectileSystem>();
+        bee::actors::CreateActorSystems();
+        auto& ai = ecs.CreateSystem<bee::ai::AIBehaviorSelectionSystem>(1.0f / 6.0f);
+        ai.StatesRead<CombatTarget>();
+        ai.StatesWrite<bee::ai::GridAgent>();
+        ecs.CreateSystem<BuffSystem>();
+
+        // none of them may hold up the frame by running alone
+        for (auto* system : ecs.GetSystems<bee::System>())
+        {
+            const std::wstring title(system->Title.begin(), system->Title.end());
+            Assert::IsTrue(system->GetAccess().Declared, title.c_str());
+        }
+
+        bee::ai::FiniteStateMachine fsm;
+        fsm.AddState<ChaseState>(true);
+        fsm.Compile();
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> y(4.0f, 60.0f);
+        for (int i = 0; i < 400; i++)
+        {
+            const bool ally = i % 2 == 0;
+            const auto unit = BuildTestUnit(fsm, glm::vec3(ally ? 20.0f : 44.0f, y(random), 0.0f), 6);
+            auto& attributes = registry.get<AttributesComponent>(unit);
+            attributes.SetTeam(static_cast<int>(ally ? Team::Ally : Team::Enemy));
+            attributes.SetAttribute(BaseAttributes::HitPoints, 100.0);
+            attributes.SetAttribute(BaseAttributes::InterceptionRange, 30.0);
+            ecs.CreateComponent<CombatTarget>(unit);
+            if (ally) continue;
+            registry.remove<AllyUnit>(unit);
+            ecs.CreateComponent<EnemyUnit>(unit);
+        }
+
+        constexpr int frames = 100;
+        const auto frame = [&]
+        {
+            ecs.UpdateSystems(1.0f / 60.0f);
+            ecs.PlaybackCommands();
+            ecs.RemovedDeleted();
+            bee::ResetFrameArenas();
+        };
+        const double serialTime = MeasureAverageMilliseconds(frames, frame);
+        ecs.SetScheduling(bee::EntityComponentSystem::Scheduling::Parallel);
+        const double parallelTime = MeasureAverageMilliseconds(frames, frame);
+
+        Logger::WriteMessage(fmt::format("{} frames, average frame time: serial {:.3f} ms, parallel {:.3f} ms ({} threads)\n",
+                                         frames, serialTime, parallelTime, std::thread::hardware_concurrency())
+                                 .c_str());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(GetSystemFindsDerivedSystems)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+
+        Assert::IsNull(ecs.TryGetSystem<SteeringSystem>());
+        auto& flocking = ecs.CreateSystem<FlockingSystem>(10);
+        Assert::IsTrue(&ecs.GetSystem<FlockingSystem>() == &flocking);
+        Assert::IsTrue(ecs.TryGetSystem<SteeringSystem>() == &flocking);
+        Assert::IsTrue(ecs.TryGetSystem<bee::System>() == &flocking);
+        Assert::IsNull(ecs.TryGetSystem<AvoidanceSystem>());
+        Assert::IsNull(ecs.TryGetSystem<MissingSystem>());
+
+        // a base type finds the first match in priority order, also when it was looked up before
+        auto& avoidance = ecs.CreateSystem<AvoidanceSystem>(20);
+        Assert::IsTrue(ecs.TryGetSystem<SteeringSystem>() == &avoidance);
+        Assert::IsTrue(&ecs.GetSystem<AvoidanceSystem>() == &avoidance);
+        Assert::IsTrue(&ecs.GetSystem<FlockingSystem>() == &flocking);
+        const auto steering = ecs.GetSystems<SteeringSystem>();
+        Assert::AreEqual(static_cast<size_t>(2), steering.size());
+
+        // removing systems forgets them
+        ecs.RemoveSystems<AvoidanceSystem>();
+        Assert::IsNull(ecs.TryGetSystem<AvoidanceSystem>());
+        Assert::IsTrue(ecs.TryGetSystem<SteeringSystem>() == &flocking);
+        ecs.RemoveSystems<SteeringSystem>();
+        Assert::IsNull(ecs.TryGetSystem<SteeringSystem>());
+        Assert::IsNull(ecs.TryGetSystem<FlockingSystem>());
+
+        // systems with the same priority keep the order they were created in
+        std::vector<std::string> order;
+        ecs.CreateSystem<TestSystem>("a", 0, [&] { order.push_back("a"); });
+        ecs.CreateSystem<TestSystem>("b", 1, [&] { order.push_back("b"); });
+        ecs.CreateSystem<TestSystem>("c", 0, [&] { order.push_back("c"); });
+        ecs.UpdateSystems(1.0f / 60.0f);
+        Assert::IsTrue(order == std::vector<std::string>{"b", "a", "c"});
+        Assert::AreEqual(std::string("b"), ecs.GetSystem<TestSystem>().Title);
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(GetSystemBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+
+        // about as many systems as the game has, with the ones looked up at the back
+        CreateFillerSystems(ecs, std::make_integer_sequence<int, 40>{});
+        ecs.CreateSystem<FlockingSystem>(-10);
+        ecs.CreateSystem<AvoidanceSystem>(-20);
+        const auto systems = ecs.GetSystems<bee::System>();
+
+        constexpr int lookups = 1000000;
+        size_t linearFound = 0, cachedFound = 0;
+        const double linearTime = MeasureAverageMilliseconds(
+            lookups,
+            [&]
+            {
+                linearFound += FindSystemLinear<AvoidanceSystem>(systems) != nullptr;
+                linearFound += FindSystemLinear<MissingSystem>(systems) != nullptr;
+            });
+        const double cachedTime = MeasureAverageMilliseconds(
+            lookups,
+            [&]
+            {
+                cachedFound += ecs.TryGetSystem<AvoidanceSystem>() != nullptr;
+                cachedFound += ecs.TryGetSystem<MissingSystem>() != nullptr;
+            });
+        Assert::AreEqual(linearFound, cachedFound);
+
+        Logger::WriteMessage(fmt::format("{} lookups of a present and a missing system among {}: dynamic_cast scan {:.2f} ns, "
+                                         "cached {:.2f} ns per lookup\n",
+                                         lookups, systems.size(), linearTime * 1e6 / 2.0, cachedTime * 1e6 / 2.0)
+                                 .c_str());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(TransformKeepsWorldTransformAlongside)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        const auto entity = ecs.CreateEntity();
+        auto& transform = ecs.CreateComponent<bee::Transform>(entity);
+        Assert::IsTrue(ecs.Registry.all_of<bee::WorldTransform, bee::Hierarchy>(entity));
+
+        // names with the same text share their storage
+        transform.Name = "Particle Emitter ";
+        const bee::InternedString sameName = std::string("Particle Emitter ");
+        Assert::IsTrue(transform.Name == sameName);
+        Assert::IsTrue(&transform.Name.String() == &sameName.String());
+        Assert::IsTrue(transform.Name == "Particle Emitter ");
+        transform.Name += "2";
+        Assert::AreEqual(std::string("Particle Emitter 2"), transform.Name.String());
+
+        ecs.Registry.remove<bee::Transform>(entity);
+        Assert::IsFalse(ecs.Registry.any_of<bee::WorldTransform, bee::Hierarchy>(entity));
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(WorldTransformsFollowTheHierarchy)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+
+        // a unit with a model, a bone of the model and a prop that is not attached to anything
+        const auto unit = ecs.CreateEntity();
+        ecs.CreateComponent<bee::Transform>(unit, glm::vec3(4.0f, -2.0f, 1.0f), glm::vec3(2.0f),
+                                            glm::angleAxis(glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f)));
+        const auto model = ecs.CreateEntity();
+        ecs.CreateComponent<bee::Transform>(model).Translation = glm::vec3(0.0f, 0.0f, 0.5f);
+        registry.get<bee::Hierarchy>(model).SetParent(unit);
+        const auto bone = ecs.CreateEntity();
+        ecs.CreateComponent<bee::Transform>(bone).Translation = glm::vec3(1.0f, 0.0f, 0.0f);
+        registry.get<bee::Hierarchy>(bone).SetParent(model);
+        const auto prop = ecs.CreateEntity();
+        ecs.CreateComponent<bee::Transform>(prop).Translation = glm::vec3(7.0f, 7.0f, 0.0f);
+
+        const auto check = [&]
+        {
+            const auto& unitTransform = registry.get<bee::Transform>(unit);
+            const glm::mat4 unitWorld = unitTransform.Local();
+            const glm::mat4 modelWorld = unitWorld * registry.get<bee::Transform>(model).Local();
+            const glm::mat4 boneWorld = modelWorld * registry.get<bee::Transform>(bone).Local();
+            for (const auto& [entity, expected] : {std::pair(unit, unitWorld), std::pair(model, modelWorld), std::pair(bone, boneWorld)})
+            {
+                const auto& world = registry.get<bee::WorldTransform>(entity);
+                for (int column = 0; column < 4; column++)
+                    Assert::IsTrue(glm::length(world.WorldMatrix[column] - expected[column]) < 1e-5f);
+                Assert::IsTrue(glm::length(world.TranslationWorld - glm::vec3(expected[3])) < 1e-5f);
+            }
+            Assert::IsTrue(registry.get<bee::WorldTransform>(prop).TranslationWorld == glm::vec3(7.0f, 7.0f, 0.0f));
+        };
+
+        // worked out before the systems run, without a renderer
+        ecs.UpdateSystems(1.0f / 60.0f);
+        check();
+        Assert::IsTrue(glm::length(registry.get<bee::WorldTransform>(bone).TranslationWorld - glm::vec3(4.0f, 0.0f, 2.0f)) < 1e-5f);
+
+        // the children follow when the unit moves, and the bone follows the model when it is moved to the prop
+        registry.get<bee::Transform>(unit).Translation = glm::vec3(-3.0f, 5.0f, 0.0f);
+        registry.get<bee::Hierarchy>(model).SetParent(prop);
+        ecs.UpdateWorldTransforms();
+        Assert::IsTrue(glm::length(registry.get<bee::WorldTransform>(bone).TranslationWorld - glm::vec3(8.0f, 7.0f, 0.5f)) < 1e-5f);
+        registry.get<bee::Hierarchy>(prop).RemoveChild(model);
+        ecs.UpdateWorldTransforms();
+        Assert::IsTrue(glm::length(registry.get<bee::WorldTransform>(bone).TranslationWorld - glm::vec3(1.0f, 0.0f, 0.5f)) < 1e-5f);
+        registry.get<bee::Hierarchy>(model).SetParent(unit);
+        ecs.UpdateWorldTransforms();
+        check();
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(TransformMemoryReport)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+
+        Logger::WriteMessage(fmt::format("Transform {} bytes, Hierarchy {} bytes, WorldTransform {} bytes, previous Transform layout {} bytes\n",
+                                         sizeof(bee::Transform), sizeof(bee::Hierarchy), sizeof(bee::WorldTransform), sizeof(LegacyTransform))
+                                 .c_str());
+        Assert::IsTrue(sizeof(bee::Transform) * 2 < sizeof(LegacyTransform));
+
+        // what a scene full of particles costs, names included (they do not fit the small string buffer)
+        const std::string name = "Particle Emitter ";
+        for (const int count : {1000, 10000, 100000})
+        {
+            ecs.Registry.clear();
+            for (int i = 0; i < count; i++) ecs.CreateComponent<bee::Transform>(ecs.CreateEntity()).Name = name;
+            const size_t hot = ecs.Registry.storage<bee::Transform>().size() * sizeof(bee::Transform);
+            const size_t world = ecs.Registry.storage<bee::WorldTransform>().size() * sizeof(bee::WorldTransform);
+            const size_t legacy = count * (sizeof(LegacyTransform) + (name.size() >= sizeof(std::string) ? name.size() + 1 : 0));
+            Logger::WriteMessage(fmt::format("{:>7} entities: Transform {:>6} KiB + WorldTransform {:>6} KiB, previously {:>6} KiB\n",
+                                             count, hot / 1024, world / 1024, legacy / 1024)
+                                     .c_str());
+        }
+        Logger::WriteMessage(fmt::format("{} interned names, {} bytes\n", bee::InternedString::GetInternedCount(),
+                                         bee::InternedString::GetInternedBytes())
+                                 .c_str());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(TransformIterationBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+
+        constexpr int count = 100000;
+        for (int i = 0; i < count; i++)
+        {
+            const auto entity = ecs.CreateEntity();
+            const glm::vec3 position(static_cast<float>(i % 100), 0.0f, static_cast<float>(i / 100));
+            ecs.CreateComponent<bee::Transform>(entity).Translation = position;
+            ecs.CreateComponent<LegacyTransform>(entity).Translation = position;
+            ecs.CreateComponent<Velocity>(entity);
+        }
+
+        // what movement and target scans do: read or move positions, nothing else
+        constexpr int frames = 50;
+        glm::vec3 hotSum(0.0f), legacySum(0.0f);
+        const double hotTime = MeasureAverageMilliseconds(
+            frames,
+            [&]
+            {
+                for (auto [e, transform, velocity] : ecs.Registry.view<bee::Transform, const Velocity>().each())
+                    transform.Translation += velocity.value * 0.016f;
+                for (auto [e, transform] : ecs.Registry.view<const bee::Transform>().each()) hotSum += transform.Translation;
+            });
+        const double legacyTime = MeasureAverageMilliseconds(
+            frames,
+            [&]
+            {
+                for (auto [e, transform, velocity] : ecs.Registry.view<LegacyTransform, const Velocity>().each())
+                    transform.Translation += velocity.value * 0.016f;
+                for (auto [e, transform] : ecs.Registry.view<const LegacyTransform>().each()) legacySum += transform.Translation;
+            });
+        Assert::IsTrue(glm::length(hotSum - legacySum) <= 1e-4f * glm::length(legacySum));
+
+        Logger::WriteMessage(fmt::format("{} entities, {} frames of moving and summing positions: Transform {:.3f} ms, previous layout {:.3f} ms per frame\n",
+                                         count, frames, hotTime, legacyTime)
+                                 .c_str());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(HierarchyStaysConsistentUnderRandomEdits)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+
+        HierarchyModel model;
+        std::vector<bee::Entity> entities;
+        std::mt19937 random(42);
+        for (int step = 0; step < 20000; step++)
+        {
+            const int operation = random() % 10;
+            if (operation < 4 || entities.size() < 3)
+            {
+                // create, under a random parent most of the time
+                const auto entity = ecs.CreateEntity();
+                ecs.CreateComponent<bee::Transform>(entity);
+                model.children[entity];
+                model.parents[entity] = entt::null;
+                if (!entities.empty() && random() % 3 != 0)
+                {
+                    const auto parent = entities[random() % entities.size()];
+                    registry.get<bee::Hierarchy>(entity).SetParent(parent);
+                    model.children[parent].push_back(entity);
+                    model.parents[entity] = parent;
+                }
+                entities.push_back(entity);
+            }
+            else if (operation < 7)
+            {
+                // move to another parent, which may be the same one
+                const auto entity = entities[random() % entities.size()];
+                const auto parent = entities[random() % entities.size()];
+                if (model.IsDescendant(parent, entity)) continue;
+                registry.get<bee::Hierarchy>(entity).SetParent(parent);
+                model.Detach(entity);
+                model.children[parent].push_back(entity);
+                model.parents[entity] = parent;
+            }
+            else if (operation < 9)
+            {
+                const auto entity = entities[random() % entities.size()];
+                if (model.parents[entity] == entt::null) continue;
+                registry.get<bee::Hierarchy>(model.parents[entity]).RemoveChild(entity);
+                model.Detach(entity);
+            }
+            else if (random() % 4 == 0)
+            {
+                // delete one or two subtrees
+                std::vector<bee::Entity> subtree;
+                const auto entity = entities[random() % entities.size()];
+                model.Subtree(entity, subtree);
+                ecs.DeleteEntity(entity);
+                const auto other = entities[random() % entities.size()];
+                if (!model.IsDescendant(other, entity) && !model.IsDescendant(entity, other))
+                {
+                    model.Subtree(other, subtree);
+                    ecs.DeleteEntity(other);
+                }
+                ecs.RemovedDeleted();
+
+                const std::set<bee::Entity> deleted(subtree.begin(), subtree.end());
+                for (const auto removed : deleted)
+                {
+                    Assert::IsFalse(registry.valid(removed));
+                    if (deleted.count(model.parents[removed]) == 0) model.Detach(removed);
+                }
+                for (const auto removed : deleted)
+                {
+                    model.children.erase(removed);
+                    model.parents.erase(removed);
+                }
+                entities.erase(std::remove_if(entities.begin(), entities.end(), [&](const bee::Entity e) { return deleted.count(e) > 0; }),
+                               entities.end());
+            }
+
+            if (step % 100 == 0) CheckHierarchy(model, registry);
+        }
+        CheckHierarchy(model, registry);
+        Logger::WriteMessage(fmt::format("{} entities left after the random edits\n", entities.size()).c_str());
+
+        // a copied transform is not part of the hierarchy of the original
+        const auto child = *std::find_if(entities.begin(), entities.end(), [&](const bee::Entity e) { return model.parents[e] != entt::null; });
+        const bee::Transform original = registry.get<bee::Transform>(child);
+        const auto copy = ecs.CreateEntity();
+        ecs.CreateComponent<bee::Transform>(copy, original);
+        Assert::IsFalse(registry.get<bee::Hierarchy>(copy).HasParent());
+        Assert::IsTrue(registry.get<bee::Hierarchy>(copy).FirstChild() == entt::null);
+        CheckHierarchy(model, registry);
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(HierarchySpawnDespawnBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+
+        // units like Model::Instantiate makes them: a root with a skeleton of nested nodes and some wide joints
+        constexpr int units = 500;
+        constexpr int nodesPerUnit = 200;
+        const auto spawn = [&]
+        {
+            std::vector<bee::Entity> roots;
+            for (int unit = 0; unit < units; unit++)
+            {
+                std::vector<bee::Entity> nodes;
+                nodes.push_back(ecs.CreateEntity());
+                ecs.CreateComponent<bee::Transform>(nodes.back());
+                for (int node = 1; node < nodesPerUnit; node++)
+                {
+                    const auto entity = ecs.CreateEntity();
+                    ecs.CreateComponent<bee::Transform>(entity);
+                    ecs.Registry.get<bee::Hierarchy>(entity).SetParent(nodes[node % 8 == 0 ? node / 2 : node / 8 * 8 / 2]);
+                    nodes.push_back(entity);
+                }
+                roots.push_back(nodes.front());
+            }
+            return roots;
+        };
+
+        std::vector<bee::Entity> roots;
+        const double spawnTime = MeasureMilliseconds([&] { roots = spawn(); });
+        const double despawnTime = MeasureMilliseconds(
+            [&]
+            {
+                for (const auto root : roots) ecs.DeleteEntity(root);
+                ecs.RemovedDeleted();
+            });
+        Assert::IsTrue(ecs.Registry.view<bee::Transform>().empty());
+
+        // despawning part of a hierarchy unlinks the part from what stays
+        roots = spawn();
+        const double partialTime = MeasureMilliseconds(
+            [&]
+            {
+                for (const auto root : roots) ecs.DeleteEntity(ecs.Registry.get<bee::Hierarchy>(root).FirstChild());
+                ecs.RemovedDeleted();
+            });
+        for (const auto root : roots)
+            for (const auto child : ecs.Registry.get<bee::Hierarchy>(root)) Assert::IsTrue(ecs.Registry.valid(child));
+
+        Logger::WriteMessage(fmt::format("{} units of {} nodes: spawn {:.3f} ms, despawn {:.3f} ms, despawn of the first subtree {:.3f} ms\n",
+                                         units, nodesPerUnit, spawnTime, despawnTime, partialTime)
+                                 .c_str());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(PrefabCopiesMatchBuiltUnits)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& registry = ecs.Registry;
+        auto& unitManager = CreateWarriorTemplate();
+        const glm::vec3 position(4.0f, 5.0f, 0.0f);
+
+        for (const Team team : {Team::Ally, Team::Enemy})
+        {
+            // the first unit of the team is built and recorded, the prefab does not depend on it
+            const auto first = unitManager.SpawnUnit("Warrior", glm::vec3(10.0f, 12.0f, 0.0f), team).value();
+            ecs.DeleteEntity(first);
+            ecs.RemovedDeleted();
+
+            const auto copy = unitManager.SpawnUnit("Warrior", position, team).value();
+            const auto built = unitManager.BuildUnit("Warrior", position, team);
+            CheckSameHierarchy(registry, built, copy);
+
+            const auto& builtAgent = registry.get<bee::ai::StateMachineAgent>(built);
+            const auto& agent = registry.get<bee::ai::StateMachineAgent>(copy);
+            Assert::IsTrue(agent.context.entity == copy);
+            Assert::IsTrue(&agent.fsm == &builtAgent.fsm);
+            Assert::IsTrue(agent.context.blackboard != nullptr && agent.context.blackboard != builtAgent.context.blackboard);
+
+            const auto& builtAttributes = registry.get<AttributesComponent>(built);
+            const auto& attributes = registry.get<AttributesComponent>(copy);
+            Assert::AreEqual(std::string("Warrior"), attributes.GetEntityType());
+            Assert::AreEqual(static_cast<int>(team), attributes.GetTeam());
+            Assert::AreEqual(builtAttributes.GetValue(BaseAttributes::HitPoints), attributes.GetValue(BaseAttributes::HitPoints));
+            Assert::AreEqual(builtAttributes.GetValue(BaseAttributes::MovementSpeed),
+                             attributes.GetValue(BaseAttributes::MovementSpeed));
+
+            // what differs between units of the template is redone for the copy
+            Assert::IsTrue(registry.get<bee::physics::Body>(copy).GetPosition() == registry.get<bee::physics::Body>(built).GetPosition());
+            Assert::AreEqual(registry.get<bee::ai::GridAgent>(built).verticalPosition,
+                             registry.get<bee::ai::GridAgent>(copy).verticalPosition);
+            Assert::AreEqual(registry.get<bee::physics::DiskCollider>(built).radius,
+                             registry.get<bee::physics::DiskCollider>(copy).radius);
+        }
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(PrefabSpawnBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& unitManager = CreateWarriorTemplate();
+
+        // a wave of enemies, headless so without their models
+        constexpr int units = 2000;
+        const auto position = [](const int unit)
+        { return glm::vec3(static_cast<float>(unit % 16), static_cast<float>(unit / 16 % 16), 0.0f); };
+
+        const double buildTime = MeasureMilliseconds(
+            [&]
+            {
+                for (int unit = 0; unit < units; unit++) unitManager.BuildUnit("Warrior", position(unit), Team::Enemy);
+            });
+
+        // the first spawn records the prefab
+        unitManager.SpawnUnit("Warrior", position(0), Team::Enemy);
+        std::vector<bee::Entity> copies;
+        const double prefabTime = MeasureMilliseconds(
+            [&]
+            {
+                for (int unit = 0; unit < units; unit++)
+                    copies.push_back(unitManager.SpawnUnit("Warrior", position(unit), Team::Enemy).value());
+            });
+        Assert::AreEqual(static_cast<size_t>(units), copies.size());
+
+        Logger::WriteMessage(fmt::format("{} units: built in {:.3f} ms, spawned from the prefab in {:.3f} ms ({:.2f}x)\n", units,
+                                         buildTime, prefabTime, buildTime / prefabTime)
+                                 .c_str());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(CommandBufferPlaysBackInSortKeyOrder)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        const auto entity = ecs.CreateEntity();
+        ecs.CreateComponent<Health>(entity);
+
+        // every thread records part of the work, the key of the last item wins no matter which thread recorded it
+        constexpr int items = 1000;
+        constexpr int threadCount = 4;
+        for (int round = 0; round < 5; round++)
+        {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < threadCount; t++)
+            {
+                threads.emplace_back(
+                    [&, t]
+                    {
+                        auto& commands = ecs.Commands();
+                        for (int i = t; i < items; i += threadCount)
+                        {
+                            commands.SetSortKey(i);
+                            commands.Replace<Health>(entity, static_cast<float>(i));
+                        }
+                    });
+            }
+            for (auto& thread : threads) thread.join();
+
+            Assert::AreEqual(100.0f, ecs.Registry.get<Health>(entity).value);
+            ecs.PlaybackCommands();
+            Assert::AreEqual(static_cast<float>(items - 1), ecs.Registry.get<Health>(entity).value);
+        }
+
+        // equal keys keep the order of recording
+        auto& commands = ecs.Commands();
+        commands.Replace<Health>(entity, 1.0f);
+        commands.Remove<Health>(entity);
+        commands.Emplace<Health>(entity, 2.0f);
+        commands.Emplace<Health>(entity, 3.0f);  // dropped, Health was added by the command before
+        Assert::AreEqual(static_cast<size_t>(4), commands.GetCommandCount());
+        ecs.PlaybackCommands();
+        Assert::IsTrue(commands.IsEmpty());
+        Assert::AreEqual(2.0f, ecs.Registry.get<Health>(entity).value);
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(CommandBufferRemapsTemporaryEntities)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& commands = ecs.Commands();
+
+        const auto parent = commands.Create();
+        const auto child = commands.Create();
+        Assert::IsTrue(bee::EntityCommandBuffer::IsTemporary(parent));
+        Assert::IsTrue(parent != child);
+        Assert::IsFalse(ecs.Registry.valid(parent));
+
+        commands.Emplace<Position>(parent, glm::vec3(1.0f, 2.0f, 3.0f));
+        commands.Emplace<Velocity>(child);
+        commands.Emplace<Lifetime>(child, 5.0f);
+        // a component that owns memory, moved out of the arena on playback
+        commands.Emplace<std::vector<int>>(child, std::vector<int>(100, 7));
+        Assert::IsTrue(ecs.Registry.view<Position>().empty());
+
+        ecs.PlaybackCommands();
+        std::vector<bee::Entity> created;
+        for (const auto entity : ecs.Registry.view<Position>()) created.push_back(entity);
+        Assert::AreEqual(static_cast<size_t>(1), created.size());
+        Assert::IsFalse(bee::EntityCommandBuffer::IsTemporary(created[0]));
+        Assert::IsTrue(ecs.Registry.get<Position>(created[0]).value == glm::vec3(1.0f, 2.0f, 3.0f));
+
+        auto lifetimes = ecs.Registry.view<Lifetime>();
+        Assert::AreEqual(static_cast<size_t>(1), lifetimes.size());
+        const auto realChild = *lifetimes.begin();
+        Assert::AreEqual(5.0f, ecs.Registry.get<Lifetime>(realChild).remaining);
+        Assert::IsTrue(ecs.Registry.all_of<Velocity>(realChild));
+        Assert::AreEqual(static_cast<size_t>(100), ecs.Registry.get<std::vector<int>>(realChild).size());
+
+        // temporary handles are per recording, the next frame starts over
+        const auto next = commands.Create();
+        commands.Emplace<Health>(next);
+        ecs.PlaybackCommands();
+        Assert::IsFalse(ecs.Registry.all_of<Health>(created[0]));
+        Assert::IsFalse(ecs.Registry.all_of<Health>(realChild));
+        Assert::AreEqual(static_cast<size_t>(1), ecs.Registry.view<Health>().size());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(CommandBufferDropsCommandsForDeletedEntities)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& commands = ecs.Commands();
+
+        const auto parent = ecs.CreateEntity();
+        ecs.CreateComponent<bee::Transform>(parent);
+        const auto child = ecs.CreateEntity();
+        ecs.CreateComponent<bee::Transform>(child);
+        ecs.Registry.get<bee::Hierarchy>(child).SetParent(parent);
+        ecs.CreateComponent<Health>(child);
+
+        // destroying marks the hierarchy for deletion, later commands for it are dropped
+        commands.Destroy(parent);
+        commands.Emplace<Position>(parent);
+        commands.Remove<Health>(child);
+        // an entity created and destroyed in the same playback never gets its components
+        const auto temporary = commands.Create();
+        commands.Destroy(temporary);
+        commands.Emplace<Lifetime>(temporary);
+        ecs.PlaybackCommands();
+
+        Assert::IsTrue(ecs.Registry.all_of<bee::Delete>(parent));
+        Assert::IsTrue(ecs.Registry.all_of<bee::Delete>(child));
+        Assert::IsFalse(ecs.Registry.all_of<Position>(parent));
+        Assert::IsTrue(ecs.Registry.all_of<Health>(child));
+        Assert::IsTrue(ecs.Registry.view<Lifetime>().empty());
+
+        // commands for entities that are gone by playback are dropped too
+        ecs.RemovedDeleted();
+        commands.Emplace<Position>(parent);
+        commands.Destroy(child);
+        ecs.PlaybackCommands();
+        Assert::IsFalse(ecs.Registry.valid(parent));
+        Assert::IsTrue(ecs.Registry.view<Position>().empty());
+
+        // commands that are cleared are never played back
+        const auto entity = ecs.CreateEntity();
+        commands.Emplace<Position>(entity);
+        commands.Clear();
+        ecs.PlaybackCommands();
+        Assert::IsFalse(ecs.Registry.all_of<Position>(entity));
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(CommandBufferCallsRunOnPlayback)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+        auto& commands = ecs.Commands();
+
+        const auto entity = ecs.CreateEntity();
+        ecs.CreateComponent<Health>(entity);
+        const auto gone = ecs.CreateEntity();
+        int calls = 0;
+        commands.Call(entity,
+                      [&calls](const bee::Entity target)
+                      {
+                          bee::Engine.ECS().Registry.get<Health>(target).value -= 1.0f;
+                          calls++;
+                      });
+        // a call for an entity that is deleted by then is dropped, but what it captured is still destroyed
+        const auto captured = std::make_shared<int>(0);
+        commands.Call(gone, [captured, &calls](bee::Entity) { calls += 10; });
+        ecs.DeleteEntity(gone);
+        Assert::AreEqual(2L, captured.use_count());
+        Assert::AreEqual(100.0f, ecs.Registry.get<Health>(entity).value);
+
+        ecs.PlaybackCommands();
+        Assert::AreEqual(1, calls);
+        Assert::AreEqual(99.0f, ecs.Registry.get<Health>(entity).value);
+        Assert::AreEqual(1L, captured.use_count());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(CommandBufferContentionBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        auto& ecs = bee::Engine.ECS();
+
+        // spawning projectiles from parallel code, once through the mutex of the factory and once deferred
+        constexpr int threadCount = 4;
+        constexpr int spawnsPerThread = 25000;
+        const auto spawnOnThreads = [&](const std::function<void()>& spawn)
+        {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < threadCount; t++)
+                threads.emplace_back(
+                    [&]
+                    {
+                        for (int i = 0; i < spawnsPerThread; i++) spawn();
+                    });
+            for (auto& thread : threads) thread.join();
+        };
+
+        bee::ThreadSafeEntityFactory factory(
+            [&]() -> bee::Entity
+            {
+                const auto entity = ecs.CreateEntity();
+                ecs.CreateComponent<Position>(entity);
+                ecs.CreateComponent<Lifetime>(entity, 2.0f);
+                return entity;
+            });
+        const double factoryTime = MeasureMilliseconds([&] { spawnOnThreads([&] { factory.CreateEntity(); }); });
+        Assert::AreEqual(static_cast<size_t>(threadCount * spawnsPerThread), ecs.Registry.view<Lifetime>().size());
+        ecs.Registry.clear();
+
+        double recordTime = 0.0, playbackTime = 0.0;
+        for (int round = 0; round < 2; round++)  // the second round reuses the arenas
+        {
+            recordTime = MeasureMilliseconds(
+                [&]
+                {
+                    spawnOnThreads(
+                        [&]
+                        {
+                            auto& commands = ecs.Commands();
+                            const auto entity = commands.Create();
+                            commands.Emplace<Position>(entity);
+                            commands.Emplace<Lifetime>(entity, 2.0f);
+                        });
+                });
+            playbackTime = MeasureMilliseconds([&] { ecs.PlaybackCommands(); });
+            Assert::AreEqual(static_cast<size_t>(threadCount * spawnsPerThread), ecs.Registry.view<Lifetime>().size());
+            ecs.Registry.clear();
+        }
+
+        Logger::WriteMessage(fmt::format("{} spawns on {} threads: factory {:.3f} ms, command buffers {:.3f} ms recording + {:.3f} ms playback\n",
+                                         threadCount * spawnsPerThread, threadCount, factoryTime, recordTime, playbackTime)
+                                 .c_str());
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(LinearArenaRewindsAndReusesChunks)
+    {
+        bee::LinearArena arena(1024);
+
+        // freeing the last allocation gives its space back
+        void* first = arena.Allocate(16, 16);
+        Assert::AreEqual(size_t(0), reinterpret_cast<uintptr_t>(first) % 16);
+        arena.Deallocate(first, 16);
+        Assert::AreEqual(size_t(0), arena.GetStatistics().bytesUsed);
+        Assert::IsTrue(arena.Allocate(16, 16) == first);
+
+        {
+            bee::ArenaScope scope(arena);
+            for (int i = 0; i < 100; i++) arena.Allocate(100, 8);
+            Assert::IsTrue(arena.GetStatistics().heapAllocations > 1);
+        }
+        Assert::AreEqual(size_t(16), arena.GetStatistics().bytesUsed);
+
+        // after a reset the frame fits in one chunk, so the same frame again does not touch the heap
+        for (int i = 0; i < 100; i++) arena.Allocate(100, 8);
+        const size_t highWaterMark = arena.GetStatistics().highWaterMark;
+        arena.Reset();
+        Assert::AreEqual(size_t(0), arena.GetStatistics().bytesUsed);
+        Assert::IsTrue(arena.GetStatistics().capacity >= highWaterMark);
+        const size_t heapAllocations = arena.GetStatistics().heapAllocations;
+        for (int i = 0; i < 100; i++) arena.Allocate(100, 8);
+        Assert::AreEqual(heapAllocations, arena.GetStatistics().heapAllocations);
+        Assert::AreEqual(size_t(100), arena.GetStatistics().allocations);
+
+        std::vector<int, bee::ArenaAllocator<int>> numbers{bee::ArenaAllocator<int>(arena)};
+        for (int i = 0; i < 10000; i++) numbers.push_back(i);
+        Assert::AreEqual(9999, numbers.back());
+    }
+
+    TEST_METHOD(FrameArenasArePerThreadAndResetLazily)
+    {
+        bee::ResetFrameArenas();
+        bee::LinearArena* workerArena = nullptr;
+        std::thread worker(
+            [&]
+            {
+                workerArena = &bee::FrameArena();
+                workerArena->Allocate(64, 8);
+            });
+        worker.join();
+        Assert::IsTrue(workerArena != &bee::FrameArena());
+        Assert::IsTrue(workerArena->GetStatistics().bytesUsed > 0);
+
+        // the arena of an exited thread goes to the next thread, which sees it reset for the new frame
+        bee::ResetFrameArenas();
+        size_t bytesUsed = 1;
+        std::thread nextWorker(
+            [&]
+            {
+                if (&bee::FrameArena() == workerArena) bytesUsed = workerArena->GetStatistics().bytesUsed;
+            });
+        nextWorker.join();
+        Assert::AreEqual(size_t(0), bytesUsed);
+    }
+
+    TEST_METHOD(PathfindingFrameArenaBenchmark)
+    {
+        // the navigation system computes paths on worker threads every frame, A* keeps its search lists in the frame
+        // arena of the thread
+        const bee::ai::NavigationGrid grid(glm::vec2(0.0f), 1, 96, 96);
+        constexpr int threadCount = 4;
+        constexpr int pathsPerThread = 16;
+        constexpr int frameCount = 6;
+
+        bee::ResetFrameArenas();
+        const size_t heapBefore = bee::GetFrameArenaStatistics().heapAllocations;
+        size_t heapAfterWarmUp = 0;
+        double frameTime = 0.0;
+        for (int frame = 0; frame < frameCount; frame++)
+        {
+            std::atomic<size_t> pathLength = 0;
+            frameTime = MeasureMilliseconds(
+                [&]
+                {
+                    std::vector<std::thread> threads;
+                    for (int t = 0; t < threadCount; t++)
+                        threads.emplace_back(
+                            [&]
+                            {
+                                // every thread searches the same paths, so every arena needs the same space
+                                for (int i = 0; i < pathsPerThread; i++)
+                                {
+                                    const float offset = static_cast<float>(i * 5);
+                                    const auto path = grid.ComputePath(glm::vec2(offset, 0.0f), glm::vec2(95.0f - offset, 95.0f));
+                                    pathLength += path.GetPoints().size();
+                                }
+                            });
+                    for (auto& thread : threads) thread.join();
+                });
+            Assert::IsTrue(pathLength > 0);
+
+            const auto statistics = bee::GetFrameArenaStatistics();
+            Assert::AreEqual(size_t(0), statistics.bytesUsed);  // every search released its lists
+            if (frame == 2) heapAfterWarmUp = statistics.heapAllocations;
+            Logger::WriteMessage(fmt::format("frame {}: {} arena allocations, {} arena chunks from the heap in total, "
+                                             "high water mark {} KiB, {:.3f} ms\n",
+                                             frame, statistics.allocations, statistics.heapAllocations - heapBefore,
+                                             statistics.highWaterMark / 1024, frameTime)
+                                     .c_str());
+            bee::ResetFrameArenas();
+        }
+
+        // the threads of later frames get the arenas of the threads before them, which were resized to fit a frame the
+        // first time they were reset
+        Assert::AreEqual(heapAfterWarmUp, bee::GetFrameArenaStatistics().heapAllocations);
+    }
+};
+}  // namespace UnitTests
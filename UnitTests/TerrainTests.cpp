@@ -0,0 +1,940 @@
+#include <pch.h>
+#include "CppUnitTest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include <cereal/archives/json.hpp>
+
+#include "core/engine.hpp"
+#include "core/fileio.hpp"
+#include "level_editor/level_editor_components.hpp"
+#include "level_editor/terrain_binary.hpp"
+#include "level_editor/terrain_colliders.hpp"
+#include "level_editor/terrain_mesh.hpp"
+#include "level_editor/terrain_raycast.hpp"
+#include "tools/log.hpp"
+#include "tools/thread_pool.hpp"
+
+#include "test_helpers.hpp"
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace
+{
+
+// Builds the same grid as TerrainSystem::CreatePlane, with some hills on it.
+void MakeTerrain(lvle::TerrainDataComponent& data, int width, int height, float step, unsigned seed)
+{
+    data = lvle::TerrainDataComponent{};
+    data.m_width = width;
+    data.m_height = height;
+    data.m_step = step;
+
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> noise(-0.5f, 0.5f);
+    data.ResizeVertices((width + 1) * (height + 1));
+    int vertex = 0;
+    for (int y = -height / 2; y <= height / 2; y++)
+    {
+        for (int x = -width / 2; x <= width / 2; x++)
+        {
+            data.m_positions[vertex] = glm::vec3(x * step, y * step, 4.0f * std::sin(x * 0.3f) * std::cos(y * 0.2f) + noise(rng));
+            data.m_normals[vertex] = glm::vec3(0.0f, 0.0f, 1.0f);
+            data.m_uvs[vertex] = glm::vec2((x + width / 2) * 0.125f, (y + height / 2) * 0.125f);
+            vertex++;
+        }
+    }
+
+    const int vWidth = width + 1;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            const int index = x + y * vWidth;
+            data.m_indices.insert(data.m_indices.end(), {static_cast<DWORD>(index + vWidth + 1), static_cast<DWORD>(index),
+                                                         static_cast<DWORD>(index + 1), static_cast<DWORD>(index),
+                                                         static_cast<DWORD>(index + vWidth + 1), static_cast<DWORD>(index + vWidth)});
+            lvle::tile tile;
+            tile.index = x + y * width;
+            data.m_tiles.push_back(tile);
+        }
+    }
+}
+
+// Loads every terrain in the levels folder. Other json files in there (templates, lights...) are skipped.
+std::vector<std::pair<std::string, lvle::TerrainDataComponent>> LoadAllLevels()
+{
+    std::vector<std::pair<std::string, lvle::TerrainDataComponent>> levels;
+    const auto directory = bee::Engine.FileIO().GetPath(bee::FileIO::Directory::Terrain, "");
+    if (!std::filesystem::exists(directory)) return levels;
+
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+    {
+        if (entry.path().extension() != ".json") continue;
+        try
+        {
+            lvle::TerrainDataComponent data{};
+            std::ifstream is(entry.path());
+            cereal::JSONInputArchive archive(is);
+            archive(CEREAL_NVP(data));
+            if (data.m_width > 0 && data.m_height > 0) levels.emplace_back(entry.path().stem().string(), std::move(data));
+        }
+        catch (const cereal::Exception&)
+        {
+        }
+    }
+    return levels;
+}
+
+// A square brush dab around the center, like the terraform and texture brushes do. Returns the touched vertices.
+lvle::TerrainRect ApplyBrush(lvle::TerrainDataComponent& data, const glm::ivec2& center, const int radius, const bool paint,
+                             std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> change(-0.5f, 0.5f);
+    lvle::TerrainRect touched;
+    for (int y = center.y - radius; y <= center.y + radius; y++)
+    {
+        for (int x = center.x - radius; x <= center.x + radius; x++)
+        {
+            if (x < 0 || y < 0 || x > data.m_width || y > data.m_height) continue;
+            const int index = x + y * (data.m_width + 1);
+            if (paint)
+                data.m_materialWeights[index][1] = std::clamp(data.m_materialWeights[index][1] + 0.1f, 0.0f, 1.0f);
+            else
+                data.m_positions[index].z += change(rng);
+            touched.Include(glm::ivec2(x, y));
+        }
+    }
+    return touched;
+}
+
+void RebuildAll(lvle::TerrainDataComponent& data, lvle::TerrainChunkedMesh& mesh)
+{
+    lvle::UpdateTerrainNormals(data, lvle::TerrainRect::Whole(data));
+    lvle::UpdateTerrainTangents(data, lvle::TerrainRect::Whole(data));
+    mesh.Build(data);
+}
+
+bool SameBits(const glm::vec3& a, const glm::vec3& b) { return std::memcmp(&a, &b, sizeof(glm::vec3)) == 0; }
+
+// The terrain layout before the vertex attributes were split into streams, kept to compare against.
+struct LegacyVertex
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f);
+    glm::vec2 uv = glm::vec2(0.0f);
+    glm::vec3 tangent = glm::vec3(0.0f);
+    glm::vec3 bitangent = glm::vec3(0.0f);
+    int cliffLevel = 0;
+    std::vector<float> materialWeights = {1, 0, 0, 0};
+};
+
+struct LegacyTile
+{
+    int index;
+    int tileFlags;
+    int area;
+    std::vector<std::reference_wrapper<LegacyVertex>> vertices;
+    glm::vec3 centralPos;
+};
+
+std::vector<LegacyVertex> MakeLegacyVertices(const lvle::TerrainDataComponent& data)
+{
+    std::vector<LegacyVertex> vertices(data.GetVertexCount());
+    for (int i = 0; i < data.GetVertexCount(); i++)
+    {
+        vertices[i].position = data.m_positions[i];
+        vertices[i].normal = data.m_normals[i];
+        vertices[i].uv = data.m_uvs[i];
+        vertices[i].tangent = data.m_tangents[i];
+        vertices[i].bitangent = data.m_bitangents[i];
+        vertices[i].cliffLevel = data.m_cliffLevels[i];
+        vertices[i].materialWeights.assign(data.m_materialWeights[i].begin(), data.m_materialWeights[i].end());
+    }
+    return vertices;
+}
+
+template <typename T>
+bool SameStream(const std::vector<T>& a, const std::vector<T>& b)
+{
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+// Compares everything a level file stores, bit for bit.
+bool SameLevel(const lvle::TerrainDataComponent& a, const lvle::TerrainDataComponent& b)
+{
+    if (a.m_width != b.m_width || a.m_height != b.m_height || a.m_step != b.m_step) return false;
+    if (!SameStream(a.m_indices, b.m_indices) || !SameStream(a.m_positions, b.m_positions) ||
+        !SameStream(a.m_normals, b.m_normals) || !SameStream(a.m_uvs, b.m_uvs) || !SameStream(a.m_tangents, b.m_tangents) ||
+        !SameStream(a.m_bitangents, b.m_bitangents) || !SameStream(a.m_cliffLevels, b.m_cliffLevels) ||
+        !SameStream(a.m_materialWeights, b.m_materialWeights) || !SameStream(a.m_areaPresets, b.m_areaPresets))
+        return false;
+    if (a.m_materialPaths != b.m_materialPaths || a.m_tiles.size() != b.m_tiles.size()) return false;
+    for (size_t i = 0; i < a.m_tiles.size(); i++)
+    {
+        const auto& tileA = a.m_tiles[i];
+        const auto& tileB = b.m_tiles[i];
+        if (tileA.index != tileB.index || tileA.tileFlags != tileB.tileFlags || tileA.area != tileB.area ||
+            !SameBits(tileA.centralPos, tileB.centralPos))
+            return false;
+    }
+    return true;
+}
+
+// The collider extraction TerrainSystem::CalculateTerrainColliders used before: a recursive flood fill per group, the
+// outer edges of every tile, then a walk along the edges that keeps the corners. Kept to compare against.
+struct LegacyColliders
+{
+    int width = 0, height = 0;
+    std::vector<int> tiles;  // 1 for blocked tiles that are not in a group yet
+
+    void FindGroup(std::vector<int>& group, const int tile)
+    {
+        if (tiles[tile] != 1) return;
+        group.push_back(tile);
+        tiles[tile] = 0;
+        const int x = tile % width, y = tile / width;
+        if (y + 1 < height) FindGroup(group, tile + width);
+        if (y > 0) FindGroup(group, tile - width);
+        if (x > 0) FindGroup(group, tile - 1);
+        if (x + 1 < width) FindGroup(group, tile + 1);
+    }
+
+    std::vector<std::pair<int, int>> FindEdges(const std::vector<int>& group) const
+    {
+        std::vector<std::pair<int, int>> edges;
+        const auto inGroup = [&](const int x, const int y)
+        {
+            return x >= 0 && x < width && y >= 0 && y < height &&
+                   std::find(group.begin(), group.end(), x + y * width) != group.end();
+        };
+        for (const int tile : group)
+        {
+            const int x = tile % width, y = tile / width;
+            const int a = x + y * (width + 1), b = a + 1, c = a + width + 2, d = a + width + 1;
+            if (!inGroup(x, y + 1)) edges.emplace_back(c, d);
+            if (!inGroup(x, y - 1)) edges.emplace_back(a, b);
+            if (!inGroup(x - 1, y)) edges.emplace_back(d, a);
+            if (!inGroup(x + 1, y)) edges.emplace_back(b, c);
+        }
+        return edges;
+    }
+
+    // Empty if the walk does not find its way back, which can happen where the group touches itself diagonally.
+    std::vector<int> FindCorners(const std::vector<std::pair<int, int>>& edges) const
+    {
+        std::vector<int> corners = {edges[0].first};
+        int current = edges[0].second, previousStep = 1;
+        for (size_t step = 0; step < edges.size() && current != edges[0].first; step++)
+        {
+            const auto it = std::find_if(edges.begin(), edges.end(), [current](const auto& edge) { return edge.first == current; });
+            if (it == edges.end()) return {};
+            if (it->second - it->first != previousStep) corners.push_back(it->first);
+            previousStep = it->second - it->first;
+            current = it->second;
+        }
+        if (current != edges[0].first) return {};
+        return corners;
+    }
+
+    // Also returns if the outline of each group touches itself, the walk is ambiguous there.
+    std::vector<std::vector<int>> Extract(const std::vector<uint8_t>& blocked, std::vector<bool>& pinched)
+    {
+        tiles.assign(blocked.begin(), blocked.end());
+        std::vector<std::vector<int>> polygons;
+        for (int tile = 0; tile < width * height; tile++)
+        {
+            std::vector<int> group;
+            FindGroup(group, tile);
+            if (group.empty()) continue;
+            const auto edges = FindEdges(group);
+            std::vector<int> starts;
+            for (const auto& edge : edges) starts.push_back(edge.first);
+            std::sort(starts.begin(), starts.end());
+            pinched.push_back(std::adjacent_find(starts.begin(), starts.end()) != starts.end());
+            polygons.push_back(FindCorners(edges));
+        }
+        return polygons;
+    }
+};
+
+// Blobs of blocked tiles with some gaps in them, so there are holes and diagonal contacts.
+std::vector<uint8_t> MakeBlockedTiles(const int width, const int height, const unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> column(0, width - 1), row(0, height - 1), radius(1, 6);
+    std::vector<uint8_t> blocked(width * height, 0);
+    const int blobs = width * height / 60;
+    for (int i = 0; i < blobs; i++)
+    {
+        const int cx = column(rng), cy = row(rng), r = radius(rng);
+        for (int y = std::max(cy - r, 0); y <= std::min(cy + r, height - 1); y++)
+            for (int x = std::max(cx - r, 0); x <= std::min(cx + r, width - 1); x++)
+                if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= r * r && rng() % 5 != 0) blocked[x + y * width] = 1;
+    }
+    return blocked;
+}
+
+lvle::TerrainDataComponent MakeBlockedTerrain(const int width, const int height, const std::vector<uint8_t>& blocked)
+{
+    lvle::TerrainDataComponent data{};
+    data.m_width = width;
+    data.m_height = height;
+    data.m_tiles.resize(width * height);
+    for (int i = 0; i < width * height; i++)
+    {
+        data.m_tiles[i].index = i;
+        data.m_tiles[i].tileFlags = blocked[i] ? lvle::TileFlags::NoGroundTraverse : lvle::TileFlags::Traversible;
+    }
+    return data;
+}
+
+// The tiles of the group plus the holes in it that are closed off, also diagonally.
+int CountCoveredTiles(const std::vector<int>& labels, const int width, const int height, const int group)
+{
+    // flood the outside over a grid with a free border around the terrain
+    const int paddedWidth = width + 2, paddedHeight = height + 2;
+    std::vector<uint8_t> reached(paddedWidth * paddedHeight, 0);
+    const auto inGroup = [&](const int x, const int y)
+    { return x >= 1 && x <= width && y >= 1 && y <= height && labels[(x - 1) + (y - 1) * width] == group; };
+
+    std::vector<int> open = {0};
+    reached[0] = 1;
+    while (!open.empty())
+    {
+        const int cell = open.back();
+        open.pop_back();
+        const int x = cell % paddedWidth, y = cell / paddedWidth;
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                const int nx = x + dx, ny = y + dy;
+                if (nx < 0 || ny < 0 || nx >= paddedWidth || ny >= paddedHeight) continue;
+                if (reached[nx + ny * paddedWidth] || inGroup(nx, ny)) continue;
+                reached[nx + ny * paddedWidth] = 1;
+                open.push_back(nx + ny * paddedWidth);
+            }
+        }
+    }
+    return static_cast<int>(std::count(reached.begin(), reached.end(), 0));
+}
+
+}  // namespace
+
+namespace UnitTests
+{
+TEST_CLASS(TerrainTests)
+{
+public:
+    TEST_METHOD(TerrainRaycastMatchesBruteForce)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+        for (const int size : {16, 32, 50, 128})
+        {
+            lvle::TerrainDataComponent data;
+            MakeTerrain(data, size, size, 1.0f, size);
+            lvle::TerrainRaycaster raycaster;
+
+            for (int i = 0; i < 2000; i++)
+            {
+                // camera-like rays, straight down rays, and rays from outside the terrain
+                glm::vec3 start(unit(rng) * size, unit(rng) * size, 10.0f + (unit(rng) + 1.0f) * 30.0f);
+                glm::vec3 dir(unit(rng), unit(rng), -std::abs(unit(rng)) - 0.05f);
+                if (i % 5 == 0) dir = glm::vec3(0.0f, 0.0f, -1.0f);
+                if (i % 7 == 0)
+                {
+                    start = glm::vec3(unit(rng) * size * 2.0f, unit(rng) * size * 2.0f, unit(rng) * 10.0f);
+                    dir = glm::vec3(unit(rng), unit(rng), unit(rng) * 0.3f);
+                }
+
+                lvle::TerrainRayHit expected, actual;
+                const bool expectedHit = lvle::RaycastTerrainBruteForce(data, start, dir, expected);
+                const bool actualHit = raycaster.Raycast(data, start, dir, actual);
+                Assert::AreEqual(expectedHit, actualHit);
+                if (!expectedHit) continue;
+                Assert::AreEqual(expected.triangle, actual.triangle);
+                Assert::AreEqual(expected.position.x, actual.position.x);
+                Assert::AreEqual(expected.position.y, actual.position.y);
+                Assert::AreEqual(expected.position.z, actual.position.z);
+            }
+        }
+    }
+
+    TEST_METHOD(TerrainDirtyRegionMatchesFullRebuild)
+    {
+        for (const int size : {16, 32, 50, 128})
+        {
+            lvle::TerrainDataComponent data;
+            MakeTerrain(data, size, size, 1.0f, size);
+            lvle::TerrainChunkedMesh mesh;
+            RebuildAll(data, mesh);
+            Assert::AreEqual(data.m_indices.size(), mesh.GetIndices().size());
+
+            std::mt19937 rng(size);
+            std::uniform_int_distribution<int> coordinate(0, size);
+            std::vector<lvle::TerrainChunkedMesh::VertexRange> ranges;
+            for (int stroke = 0; stroke < 100; stroke++)
+            {
+                // brushes along the edges and across chunk borders included
+                const glm::ivec2 center(coordinate(rng), coordinate(rng));
+                const auto touched = ApplyBrush(data, center, 1 + stroke % 5, stroke % 3 == 0, rng);
+                const auto region = touched.Expanded(1, data);
+                lvle::UpdateTerrainNormals(data, region);
+                lvle::UpdateTerrainTangents(data, region);
+                mesh.UpdateRegion(data, region, ranges);
+                Assert::IsFalse(ranges.empty());
+
+                auto expectedData = data;
+                lvle::TerrainChunkedMesh expectedMesh;
+                RebuildAll(expectedData, expectedMesh);
+                for (int i = 0; i < data.GetVertexCount(); i++)
+                {
+                    Assert::IsTrue(SameBits(expectedData.m_normals[i], data.m_normals[i]));
+                    Assert::IsTrue(SameBits(expectedData.m_tangents[i], data.m_tangents[i]));
+                    Assert::IsTrue(SameBits(expectedData.m_bitangents[i], data.m_bitangents[i]));
+                }
+                const auto& expected = expectedMesh.GetVertices();
+                const auto& actual = mesh.GetVertices();
+                Assert::AreEqual(expected.size(), actual.size());
+                Assert::AreEqual(0, std::memcmp(expected.data(), actual.data(), expected.size() * sizeof(Vertex)));
+            }
+        }
+    }
+
+    TEST_METHOD(TerrainRaycastAfterRefit)
+    {
+        lvle::TerrainDataComponent data;
+        MakeTerrain(data, 64, 64, 1.0f, 3);
+        lvle::TerrainRaycaster raycaster;
+        raycaster.Build(data);
+
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        for (int stroke = 0; stroke < 50; stroke++)
+        {
+            // big height changes, so stale height ranges would make rays miss
+            const auto touched = ApplyBrush(data, glm::ivec2(stroke * 7 % 65, stroke * 13 % 65), 3, false, rng);
+            for (int y = touched.min.y; y <= touched.max.y; y++)
+                for (int x = touched.min.x; x <= touched.max.x; x++) data.m_positions[x + y * 65].z += 5.0f;
+            raycaster.Refit(data, touched);
+
+            for (int i = 0; i < 100; i++)
+            {
+                const glm::vec3 start(unit(rng) * 32.0f, unit(rng) * 32.0f, 50.0f);
+                const glm::vec3 dir(unit(rng) * 0.5f, unit(rng) * 0.5f, -1.0f);
+                lvle::TerrainRayHit expected, actual;
+                const bool expectedHit = lvle::RaycastTerrainBruteForce(data, start, dir, expected);
+                Assert::AreEqual(expectedHit, raycaster.Raycast(data, start, dir, actual));
+                if (expectedHit) Assert::AreEqual(expected.triangle, actual.triangle);
+            }
+        }
+    }
+
+    TEST_METHOD(TerrainBrushStrokeBenchmark)
+    {
+        // a stroke is a brush of radius 3 dragged over the terrain for 60 frames
+        constexpr int frames = 60;
+        for (const int size : {32, 512})
+        {
+            lvle::TerrainDataComponent data;
+            MakeTerrain(data, size, size, 1.0f, 11);
+            lvle::TerrainChunkedMesh mesh;
+            RebuildAll(data, mesh);
+            std::mt19937 rng(11);
+
+            const double fullTime = MeasureMilliseconds(
+                [&]
+                {
+                    for (int frame = 0; frame < frames; frame++)
+                    {
+                        ApplyBrush(data, glm::ivec2(size / 4 + frame * size / (2 * frames), size / 2), 3, false, rng);
+                        RebuildAll(data, mesh);
+                    }
+                });
+
+            std::vector<lvle::TerrainChunkedMesh::VertexRange> ranges;
+            size_t uploadedVertices = 0;
+            const double dirtyTime = MeasureMilliseconds(
+                [&]
+                {
+                    for (int frame = 0; frame < frames; frame++)
+                    {
+                        const auto touched =
+                            ApplyBrush(data, glm::ivec2(size / 4 + frame * size / (2 * frames), size / 2), 3, false, rng);
+                        const auto region = touched.Expanded(1, data);
+                        lvle::UpdateTerrainNormals(data, region);
+                        lvle::UpdateTerrainTangents(data, region);
+                        mesh.UpdateRegion(data, region, ranges);
+                        for (const auto& range : ranges) uploadedVertices += range.count;
+                    }
+                });
+
+            Logger::WriteMessage(fmt::format("{}x{} terrain, {} frame stroke: full rebuild {:.3f} ms ({} vertices per frame), "
+                                             "dirty region {:.3f} ms ({} vertices per frame)\n",
+                                             size, size, frames, fullTime, mesh.GetVertices().size(), dirtyTime,
+                                             uploadedVertices / frames)
+                                     .c_str());
+        }
+    }
+
+    TEST_METHOD(TerrainVertexStreamsRoundTrip)
+    {
+        lvle::TerrainDataComponent data;
+        MakeTerrain(data, 16, 16, 2.0f, 5);
+        std::mt19937 rng(5);
+        for (int i = 0; i < 20; i++) ApplyBrush(data, glm::ivec2(i % 17, i * 3 % 17), 2, i % 2 == 0, rng);
+        for (int i = 0; i < data.GetVertexCount(); i++) data.m_cliffLevels[i] = i % 3;
+
+        // level files store whole vertices, loading splits them into streams again
+        std::stringstream stream;
+        {
+            cereal::JSONOutputArchive archive(stream);
+            archive(CEREAL_NVP(data));
+        }
+        lvle::TerrainDataComponent loaded;
+        {
+            cereal::JSONInputArchive archive(stream);
+            archive(cereal::make_nvp("data", loaded));
+        }
+
+        Assert::AreEqual(data.GetVertexCount(), loaded.GetVertexCount());
+        for (int i = 0; i < data.GetVertexCount(); i++)
+        {
+            Assert::IsTrue(data.m_positions[i] == loaded.m_positions[i]);
+            Assert::IsTrue(data.m_uvs[i] == loaded.m_uvs[i]);
+            Assert::AreEqual(data.m_cliffLevels[i], loaded.m_cliffLevels[i]);
+            Assert::IsTrue(data.m_materialWeights[i] == loaded.m_materialWeights[i]);
+
+            const lvle::TVertex vertex = data.GetVertex(i);
+            loaded.SetVertex(i, lvle::TVertex{});
+            loaded.SetVertex(i, vertex);
+            Assert::IsTrue(loaded.m_positions[i] == data.m_positions[i]);
+        }
+    }
+
+    TEST_METHOD(TerrainVertexKeepsLevelFileLayout)
+    {
+        // the weights are a list in the level files, as when they were a std::vector
+        lvle::TVertex vertex;
+        vertex.materialWeights = {0.25f, 0.5f, 0.25f, 0.0f};
+        std::stringstream stream;
+        {
+            cereal::JSONOutputArchive archive(stream);
+            archive(CEREAL_NVP(vertex));
+        }
+        const std::string json = stream.str();
+        Assert::IsTrue(json.find("\"materialWeights\": [") != std::string::npos);
+
+        lvle::TVertex loaded;
+        {
+            cereal::JSONInputArchive archive(stream);
+            archive(cereal::make_nvp("vertex", loaded));
+        }
+        Assert::IsTrue(vertex.materialWeights == loaded.materialWeights);
+    }
+
+    TEST_METHOD(TerrainTileCornersMatchIndices)
+    {
+        for (const int size : {2, 16, 50})
+        {
+            lvle::TerrainDataComponent data;
+            MakeTerrain(data, size, size, 1.0f, 1);
+            for (int tile = 0; tile < static_cast<int>(data.m_tiles.size()); tile++)
+            {
+                // CAB ACD, see TerrainSystem::CreatePlane
+                const auto corners = data.GetTileVertexIndices(tile);
+                Assert::AreEqual(static_cast<DWORD>(corners[0]), data.m_indices[tile * 6 + 1]);
+                Assert::AreEqual(static_cast<DWORD>(corners[1]), data.m_indices[tile * 6 + 2]);
+                Assert::AreEqual(static_cast<DWORD>(corners[2]), data.m_indices[tile * 6]);
+                Assert::AreEqual(static_cast<DWORD>(corners[3]), data.m_indices[tile * 6 + 5]);
+            }
+        }
+    }
+
+    TEST_METHOD(TerrainMemoryReport)
+    {
+        bee::Engine.InitializeHeadless();
+        auto levels = LoadAllLevels();
+        bee::Engine.Shutdown();
+
+        lvle::TerrainDataComponent large;
+        MakeTerrain(large, 512, 512, 1.0f, 1);
+        levels.emplace_back("generated", std::move(large));
+
+        for (const auto& [name, data] : levels)
+        {
+            const size_t vertices = data.GetVertexCount();
+            const size_t tiles = data.m_tiles.size();
+
+            // every legacy vertex owns a heap block with its four weights
+            const size_t legacyBytes = vertices * (sizeof(LegacyVertex) + 4 * sizeof(float)) + tiles * sizeof(LegacyTile);
+            const size_t legacyAllocations = vertices + 2;
+            const size_t streamBytes = vertices * (sizeof(glm::vec3) * 4 + sizeof(glm::vec2) + sizeof(int) +
+                                                   sizeof(lvle::MaterialWeights)) +
+                                       tiles * sizeof(lvle::tile);
+            const size_t streamAllocations = 8;
+
+            Assert::IsTrue(streamBytes < legacyBytes);
+            Logger::WriteMessage(fmt::format("{} ({}x{}): vertices + tiles {:.1f} KiB in {} allocations before, {:.1f} KiB in {} "
+                                             "allocations after\n",
+                                             name, data.m_width, data.m_height, legacyBytes / 1024.0, legacyAllocations,
+                                             streamBytes / 1024.0, streamAllocations)
+                                     .c_str());
+        }
+    }
+
+    TEST_METHOD(TerrainIterationBenchmark)
+    {
+        lvle::TerrainDataComponent data;
+        MakeTerrain(data, 512, 512, 1.0f, 1);
+        const auto legacy = MakeLegacyVertices(data);
+        constexpr int passes = 20;
+
+        // a pass reads the heights and one material weight of every vertex, like the height and paint queries do
+        float legacySum = 0.0f, streamSum = 0.0f;
+        const double legacyTime = MeasureMilliseconds(
+            [&]
+            {
+                for (int pass = 0; pass < passes; pass++)
+                    for (const auto& vertex : legacy) legacySum += vertex.position.z * vertex.materialWeights[0];
+            });
+        const double streamTime = MeasureMilliseconds(
+            [&]
+            {
+                for (int pass = 0; pass < passes; pass++)
+                    for (int i = 0; i < data.GetVertexCount(); i++) streamSum += data.m_positions[i].z * data.m_materialWeights[i][0];
+            });
+        Assert::AreEqual(legacySum, streamSum);
+
+        // copying all vertices, like TerrainSystem::UpdateTerrainDataComponent does
+        auto vertexData = data;
+        vertexData.m_indices.clear();
+        vertexData.m_tiles.clear();
+        size_t copied = 0;
+        const double legacyCopyTime = MeasureMilliseconds(
+            [&]
+            {
+                for (int pass = 0; pass < passes; pass++)
+                {
+                    auto copy = legacy;
+                    copied += copy.size();
+                }
+            });
+        const double streamCopyTime = MeasureMilliseconds(
+            [&]
+            {
+                for (int pass = 0; pass < passes; pass++)
+                {
+                    auto copy = vertexData;
+                    copied += copy.GetVertexCount();
+                }
+            });
+
+        Logger::WriteMessage(fmt::format("512x512 terrain, {} passes: iterate {:.3f} ms before, {:.3f} ms after; copy {:.3f} ms "
+                                         "before, {:.3f} ms after ({} vertices copied)\n",
+                                         passes, legacyTime, streamTime, legacyCopyTime, streamCopyTime, copied)
+                                 .c_str());
+    }
+
+    TEST_METHOD(TerrainBinaryRoundTrip)
+    {
+        lvle::TerrainDataComponent data;
+        MakeTerrain(data, 40, 24, 1.5f, 11);
+        lvle::UpdateTerrainNormals(data, lvle::TerrainRect::Whole(data));
+        lvle::UpdateTerrainTangents(data, lvle::TerrainRect::Whole(data));
+        std::mt19937 rng(3);
+        for (auto& tile : data.m_tiles)
+        {
+            tile.tileFlags = static_cast<int>(rng() % 8);
+            tile.area = static_cast<int>(rng() % 3);
+            tile.centralPos = glm::vec3(static_cast<float>(tile.index), 0.5f, -1.0f);
+        }
+        data.m_areaPresets.resize(3);
+        data.m_areaPresets[2].color[1] = 0.25f;
+        data.m_materialPaths.push_back("materials/TerrainSnow.pepimat");
+        data.m_smallGridPoints = {glm::vec2(-0.75f, -0.75f), glm::vec2(0.0f, 0.0f), glm::vec2(0.75f, 0.75f)};
+
+        const std::vector<char> bytes = lvle::WriteTerrainBinary(data);
+        lvle::TerrainDataComponent loaded{};
+        Assert::IsTrue(lvle::ReadTerrainBinary(bytes.data(), bytes.size(), loaded));
+        Assert::IsTrue(SameLevel(data, loaded));
+        Assert::IsTrue(SameStream(data.m_smallGridPoints, loaded.m_smallGridPoints));
+
+        // json -> binary -> json gives the same file
+        std::stringstream before, after;
+        {
+            cereal::JSONOutputArchive archive(before);
+            archive(CEREAL_NVP(data));
+        }
+        {
+            cereal::JSONOutputArchive archive(after);
+            archive(cereal::make_nvp("data", loaded));
+        }
+        Assert::AreEqual(before.str(), after.str());
+    }
+
+    TEST_METHOD(TerrainBinaryRejectsInvalidFiles)
+    {
+        lvle::TerrainDataComponent data;
+        MakeTerrain(data, 8, 8, 1.0f, 5);
+        const std::vector<char> bytes = lvle::WriteTerrainBinary(data);
+
+        lvle::TerrainDataComponent loaded{};
+        loaded.m_width = 123;
+        Assert::IsFalse(lvle::ReadTerrainBinary(nullptr, 0, loaded));
+        Assert::IsFalse(lvle::ReadTerrainBinary(bytes.data(), 16, loaded));
+        Assert::IsFalse(lvle::ReadTerrainBinary(bytes.data(), bytes.size() / 2, loaded));
+
+        auto corrupt = bytes;
+        corrupt[0] = 'X';  // magic
+        Assert::IsFalse(lvle::ReadTerrainBinary(corrupt.data(), corrupt.size(), loaded));
+
+        corrupt = bytes;
+        const uint32_t version = lvle::TerrainBinaryVersion + 1;
+        std::memcpy(corrupt.data() + 4, &version, sizeof(version));
+        Assert::IsFalse(lvle::ReadTerrainBinary(corrupt.data(), corrupt.size(), loaded));
+
+        corrupt = bytes;
+        const int32_t width = data.m_width + 2;  // the streams no longer match the dimensions
+        std::memcpy(corrupt.data() + 12, &width, sizeof(width));
+        Assert::IsFalse(lvle::ReadTerrainBinary(corrupt.data(), corrupt.size(), loaded));
+
+        // failed reads leave the terrain alone
+        Assert::AreEqual(123, loaded.m_width);
+    }
+
+    TEST_METHOD(TerrainBinaryLoadBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        const auto levels = LoadAllLevels();
+        Assert::IsFalse(levels.empty(), L"No levels found in the assets folder.");
+
+        constexpr int loads = 20;
+        for (const auto& [name, level] : levels)
+        {
+            // work on a copy, so the level files in the assets folder are not touched
+            const std::string copy = name + "_binary_test";
+            Assert::IsTrue(lvle::SaveTerrainJson(level, copy));
+            Assert::IsTrue(lvle::ConvertLevelToBinary(copy));
+
+            lvle::TerrainDataComponent fromBinary{}, fromMapped{}, fromJson{};
+            Assert::IsTrue(lvle::LoadTerrainBinary(copy, fromBinary, false));
+            Assert::IsTrue(lvle::LoadTerrainBinary(copy, fromMapped, true));
+            Assert::IsTrue(SameLevel(level, fromBinary));
+            Assert::IsTrue(SameLevel(level, fromMapped));
+
+            const double jsonTime = MeasureMilliseconds(
+                [&]
+                {
+                    for (int i = 0; i < loads; i++) lvle::LoadTerrainJson(copy, fromJson);
+                });
+            const double binaryTime = MeasureMilliseconds(
+                [&]
+                {
+                    for (int i = 0; i < loads; i++) lvle::LoadTerrainBinary(copy, fromBinary, false);
+                });
+            const double mappedTime = MeasureMilliseconds(
+                [&]
+                {
+                    for (int i = 0; i < loads; i++) lvle::LoadTerrainBinary(copy, fromMapped, true);
+                });
+
+            // and back to json
+            Assert::IsTrue(lvle::ConvertLevelToJson(copy));
+            lvle::TerrainDataComponent converted{};
+            Assert::IsTrue(lvle::LoadTerrainJson(copy, converted));
+            Assert::IsTrue(SameLevel(level, converted));
+
+            std::filesystem::remove(bee::Engine.FileIO().GetPath(bee::FileIO::Directory::Terrain, copy + ".json"));
+            std::filesystem::remove(
+                bee::Engine.FileIO().GetPath(bee::FileIO::Directory::Terrain, copy + lvle::TerrainBinaryExtension));
+
+            Logger::WriteMessage(fmt::format("{} ({}x{}), average of {} loads: json {:.3f} ms, binary {:.3f} ms, memory mapped "
+                                             "{:.3f} ms\n",
+                                             name, level.m_width, level.m_height, loads, jsonTime / loads, binaryTime / loads,
+                                             mappedTime / loads)
+                                     .c_str());
+        }
+        bee::Engine.Shutdown();
+    }
+
+    TEST_METHOD(TerrainCollidersMatchCurrentOutput)
+    {
+        bee::Engine.InitializeHeadless();
+        auto levels = LoadAllLevels();
+        bee::Engine.Shutdown();
+        Assert::IsFalse(levels.empty(), L"No levels found in the assets folder.");
+
+        for (const auto& [name, data] : levels)
+        {
+            std::vector<uint8_t> blocked(data.m_tiles.size());
+            for (size_t i = 0; i < blocked.size(); i++)
+                blocked[i] = (data.m_tiles[i].tileFlags & lvle::TileFlags::NoGroundTraverse) != 0;
+
+            LegacyColliders legacy{data.m_width, data.m_height};
+            std::vector<bool> pinched;
+            const auto before = legacy.Extract(blocked, pinched);
+            const auto after = lvle::ExtractTerrainColliders(data, 0.0f);
+            Assert::AreEqual(before.size(), after.size());
+
+            double areaBefore = 0.0, areaAfter = 0.0;
+            int skipped = 0;
+            for (size_t i = 0; i < before.size(); i++)
+            {
+                if (pinched[i])
+                {
+                    skipped++;
+                    continue;
+                }
+                Assert::AreEqual(lvle::ColliderPolygonArea(before[i], data.m_width), lvle::ColliderPolygonArea(after[i], data.m_width));
+                areaBefore += lvle::ColliderPolygonArea(before[i], data.m_width);
+                areaAfter += lvle::ColliderPolygonArea(after[i], data.m_width);
+            }
+            Logger::WriteMessage(fmt::format("{}: {} colliders, covered area {} tiles before, {} after ({} groups touching "
+                                             "themselves diagonally not compared)\n",
+                                             name, after.size(), areaBefore, areaAfter, skipped)
+                                     .c_str());
+        }
+    }
+
+    TEST_METHOD(TerrainCollidersCoverTilesAndHoles)
+    {
+        bee::ThreadPool pool(4);
+        for (unsigned seed = 0; seed < 20; seed++)
+        {
+            const int width = 20 + seed * 5, height = 16 + seed * 3;
+            const auto blocked = MakeBlockedTiles(width, height, seed);
+            const auto data = MakeBlockedTerrain(width, height, blocked);
+
+            std::vector<int> labels;
+            const auto groups = lvle::LabelBlockedTiles(blocked, width, height, labels, &pool);
+            const auto polygons = lvle::ExtractTerrainColliders(data, 0.0f, &pool);
+            Assert::AreEqual(groups.size(), polygons.size());
+            for (size_t i = 0; i < groups.size(); i++)
+            {
+                Assert::AreEqual(static_cast<double>(CountCoveredTiles(labels, width, height, groups[i])),
+                                 lvle::ColliderPolygonArea(polygons[i], width));
+            }
+
+            // the result does not depend on how the work was split
+            Assert::IsTrue(polygons == lvle::ExtractTerrainColliders(data, 0.0f));
+        }
+    }
+
+    TEST_METHOD(TerrainColliderSimplification)
+    {
+        const int width = 256, height = 256;
+        const float tolerance = 0.75f;
+        const auto data = MakeBlockedTerrain(width, height, MakeBlockedTiles(width, height, 99));
+        const auto exact = lvle::ExtractTerrainColliders(data, 0.0f);
+        const auto simplified = lvle::ExtractTerrainColliders(data, tolerance);
+        Assert::AreEqual(exact.size(), simplified.size());
+
+        size_t cornersBefore = 0, cornersAfter = 0;
+        for (size_t i = 0; i < exact.size(); i++)
+        {
+            cornersBefore += exact[i].size();
+            cornersAfter += simplified[i].size();
+            Assert::IsTrue(simplified[i].size() <= exact[i].size());
+            Assert::IsTrue(lvle::ColliderPolygonArea(simplified[i], width) > 0.0);
+
+            // every removed corner is within the tolerance, so the area can not change by more than that along the outline
+            double perimeter = 0.0;
+            for (size_t j = 0; j < exact[i].size(); j++)
+            {
+                const int a = exact[i][j], b = exact[i][(j + 1) % exact[i].size()];
+                perimeter += std::abs(a % (width + 1) - b % (width + 1)) + std::abs(a / (width + 1) - b / (width + 1));
+            }
+            const double areaChange =
+                std::abs(lvle::ColliderPolygonArea(simplified[i], width) - lvle::ColliderPolygonArea(exact[i], width));
+            Assert::IsTrue(areaChange <= perimeter * tolerance);
+        }
+        Assert::IsTrue(cornersAfter < cornersBefore);
+        Logger::WriteMessage(
+            fmt::format("{} colliders, {} corners before simplification, {} after\n", exact.size(), cornersBefore, cornersAfter)
+                .c_str());
+    }
+
+    TEST_METHOD(TerrainColliderBenchmark)
+    {
+        const int legacySize = 64, size = 2048;  // the recursive version overflows the stack on big maps
+        const auto smallBlocked = MakeBlockedTiles(legacySize, legacySize, 5);
+        const auto small = MakeBlockedTerrain(legacySize, legacySize, smallBlocked);
+        const auto large = MakeBlockedTerrain(size, size, MakeBlockedTiles(size, size, 5));
+        bee::ThreadPool pool(4);
+
+        LegacyColliders legacy{legacySize, legacySize};
+        std::vector<bool> pinched;
+        const double legacyTime = MeasureMilliseconds([&] { legacy.Extract(smallBlocked, pinched); });
+        const double smallTime = MeasureMilliseconds([&] { lvle::ExtractTerrainColliders(small, 0.75f, &pool); });
+
+        std::vector<std::vector<int>> serial, parallel;
+        const double serialTime = MeasureMilliseconds([&] { serial = lvle::ExtractTerrainColliders(large, 0.75f); });
+        const double parallelTime = MeasureMilliseconds([&] { parallel = lvle::ExtractTerrainColliders(large, 0.75f, &pool); });
+        Assert::IsTrue(serial == parallel);
+
+        Logger::WriteMessage(fmt::format("{0}x{0}: recursive {1:.3f} ms, union-find {2:.3f} ms\n{3}x{3} ({4} colliders): "
+                                         "union-find {5:.3f} ms on one thread, {6:.3f} ms on {7} threads\n",
+                                         legacySize, legacyTime, smallTime, size, parallel.size(), serialTime, parallelTime,
+                                         pool.NumberOfThreads())
+                                 .c_str());
+    }
+
+    TEST_METHOD(TerrainRaycastBenchmark)
+    {
+        bee::Engine.InitializeHeadless();
+        auto levels = LoadAllLevels();
+        bee::Engine.Shutdown();
+        Assert::IsFalse(levels.empty(), L"No levels found in the assets folder.");
+
+        const auto& largest = *std::max_element(levels.begin(), levels.end(), [](const auto& a, const auto& b)
+                                                 { return a.second.m_tiles.size() < b.second.m_tiles.size(); });
+        const auto& data = largest.second;
+
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        const float halfWidth = data.m_width * data.m_step * 0.5f;
+        const float halfHeight = data.m_height * data.m_step * 0.5f;
+        std::vector<std::pair<glm::vec3, glm::vec3>> rays;
+        for (int i = 0; i < 1000; i++)
+            rays.emplace_back(glm::vec3(unit(rng) * halfWidth, unit(rng) * halfHeight, 30.0f),
+                              glm::vec3(unit(rng) * 0.5f, unit(rng) * 0.5f, -1.0f));
+
+        lvle::TerrainRaycaster raycaster;
+        raycaster.Build(data);
+        int bruteForceHits = 0, acceleratedHits = 0;
+        const double bruteForceTime = MeasureMilliseconds(
+            [&]
+            {
+                for (const auto& [start, dir] : rays)
+                {
+                    lvle::TerrainRayHit hit;
+                    bruteForceHits += lvle::RaycastTerrainBruteForce(data, start, dir, hit);
+                }
+            });
+        const double acceleratedTime = MeasureMilliseconds(
+            [&]
+            {
+                for (const auto& [start, dir] : rays)
+                {
+                    lvle::TerrainRayHit hit;
+                    acceleratedHits += raycaster.Raycast(data, start, dir, hit);
+                }
+            });
+
+        Assert::AreEqual(bruteForceHits, acceleratedHits);
+        Logger::WriteMessage(fmt::format("{} ({}x{}), {} rays: brute force {:.3f} ms, grid traversal {:.3f} ms\n", largest.first,
+                                         data.m_width, data.m_height, rays.size(), bruteForceTime, acceleratedTime)
+                                 .c_str());
+    }
+};
+}  // namespace UnitTests
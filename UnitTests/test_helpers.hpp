@@ -0,0 +1,254 @@
+#pragma once
+
+// What the tests share: timing the benchmarks, the components and systems the scheduler and AI tests run on, and
+// putting units on the field.
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "actors/attributes.hpp"
+#include "actors/structures/structure_manager_system.hpp"
+#include "actors/units/unit_manager_system.hpp"
+#include "ai/FiniteStateMachines/finite_state_machine.hpp"
+#include "ai/grid_navigation_system.hpp"
+#include "core/ecs.hpp"
+#include "core/engine.hpp"
+#include "core/simulation_lod.hpp"
+#include "core/transform.hpp"
+#include "physics/physics_components.hpp"
+#include "rendering/render_components.hpp"
+#include "tools/log.hpp"
+
+template <typename F>
+double MeasureMilliseconds(F&& function)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+    function();
+    const auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Runs the function the number of times, and returns how long a run took on average.
+template <typename F>
+double MeasureAverageMilliseconds(const int runs, F&& function)
+{
+    return MeasureMilliseconds(
+               [&]
+               {
+                   for (int run = 0; run < runs; run++) function();
+               }) /
+           runs;
+}
+
+struct Position
+{
+    glm::vec3 value = glm::vec3(0.0f);
+};
+
+struct Velocity
+{
+    glm::vec3 value = glm::vec3(1.0f);
+};
+
+struct Lifetime
+{
+    float remaining = 10.0f;
+};
+
+struct Health
+{
+    float value = 100.0f;
+};
+
+// A system that runs a callback, with the access and priority it is made with.
+class TestSystem : public bee::System
+{
+public:
+    TestSystem(const std::string& title, int priority, std::function<void()> update)
+        : m_update(std::move(update))
+    {
+        Title = title;
+        Priority = priority;
+    }
+
+    template <typename... T>
+    TestSystem& Reading()
+    {
+        Reads<T...>();
+        return *this;
+    }
+
+    template <typename... T>
+    TestSystem& Writing()
+    {
+        Writes<T...>();
+        return *this;
+    }
+
+    void Update(float) override { m_update(); }
+
+private:
+    std::function<void()> m_update;
+};
+
+// Records whether systems that should not overlap ever did, and how many systems ran at once.
+struct Trace
+{
+    std::atomic<int> writersOfPosition = 0;
+    std::atomic<bool> overlapped = false;
+    std::atomic<int> maxConcurrent = 0;
+    std::atomic<int> running = 0;
+
+    void Work(const std::chrono::microseconds duration)
+    {
+        const int now = ++running;
+        int previous = maxConcurrent.load();
+        while (now > previous && !maxConcurrent.compare_exchange_weak(previous, now))
+        {
+        }
+        std::this_thread::sleep_for(duration);
+        --running;
+    }
+};
+
+// Puts a unit together like UnitManager::BuildUnit does, minus what needs the resources of a level: a root with the
+// gameplay components, a model with a tree of nodes, some of them rendered, and a prop that follows a bone.
+inline bee::Entity BuildTestUnit(bee::ai::FiniteStateMachine& fsm, const glm::vec3& position, const int nodes)
+{
+    auto& ecs = bee::Engine.ECS();
+    const auto unit = ecs.CreateEntity();
+    auto& transform = ecs.CreateComponent<bee::Transform>(unit);
+    transform.Name = "Warrior";
+    transform.Translation = position;
+    transform.Scale = glm::vec3(0.8f);
+
+    auto& attributes = ecs.CreateComponent<AttributesComponent>(unit);
+    attributes.SetEntityType("Warrior");
+    attributes.SetTeam(static_cast<int>(Team::Ally));
+    auto& agent = ecs.CreateComponent<bee::ai::StateMachineAgent>(unit, fsm);
+    agent.context.entity = unit;
+    ecs.CreateComponent<bee::ai::GridAgent>(unit, 0.5f, 3.0f, 0.85f).verticalPosition = position.z;
+    ecs.CreateComponent<bee::SimulationLOD>(unit);
+    ecs.CreateComponent<bee::physics::Body>(unit, bee::physics::Body::Type::Dynamic, 1.0f, 0.0f).SetPosition(position);
+    ecs.CreateComponent<bee::physics::DiskCollider>(unit, 0.4f);
+    ecs.CreateComponent<AllyUnit>(unit);
+    ecs.CreateComponent<bee::physics::Interactable>(unit);
+
+    const auto model = ecs.CreateEntity();
+    auto& modelTransform = ecs.CreateComponent<bee::Transform>(model);
+    modelTransform.Name = "Warrior";
+    ecs.Registry.get<bee::Hierarchy>(model).SetParent(unit);
+    ecs.CreateComponent<UnitModelTag>(model).unitType = "Warrior";
+
+    std::vector<bee::Entity> modelNodes = {model};
+    for (int node = 0; node < nodes; node++)
+    {
+        const auto entity = ecs.CreateEntity();
+        auto& nodeTransform = ecs.CreateComponent<bee::Transform>(entity);
+        nodeTransform.Name = fmt::format("j_node_{}", node);
+        nodeTransform.Translation = glm::vec3(0.0f, 0.0f, 0.1f * static_cast<float>(node));
+        ecs.Registry.get<bee::Hierarchy>(entity).SetParent(modelNodes[node / 3]);
+        if (node % 4 == 0) ecs.CreateComponent<bee::MeshRenderer>(entity);
+        modelNodes.push_back(entity);
+    }
+
+    const auto prop = ecs.CreateEntity();
+    ecs.CreateComponent<bee::Transform>(prop).Name = "Spear";
+    const auto propMesh = ecs.CreateEntity();
+    ecs.CreateComponent<bee::Transform>(propMesh);
+    ecs.Registry.get<bee::Hierarchy>(propMesh).SetParent(prop);
+    ecs.CreateComponent<bee::MeshRenderer>(propMesh);
+    ecs.CreateComponent<UnitPropTagL>(model, prop, 7);
+    return unit;
+}
+
+// Puts a unit or structure of the team at the position, with attributes for the TargetingSystem to look at.
+inline bee::Entity CreateCombatant(const glm::vec3& position, const Team team, const bool structure, std::mt19937& random)
+{
+    auto& ecs = bee::Engine.ECS();
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const auto entity = ecs.CreateEntity();
+    ecs.CreateComponent<bee::Transform>(entity).Translation = position;
+    auto& attributes = ecs.CreateComponent<AttributesComponent>(entity);
+    attributes.SetTeam(static_cast<int>(team));
+    attributes.SetAttribute(BaseAttributes::HitPoints, 50.0 + 250.0 * unit(random));
+    if (structure)
+    {
+        ecs.CreateComponent<AllyStructure>(entity);
+        return entity;
+    }
+    attributes.SetAttribute(BaseAttributes::InterceptionRange, 2.0 + 10.0 * unit(random));
+    attributes.SetAttribute(BaseAttributes::Damage, 5.0 + 20.0 * unit(random));
+    attributes.SetAttribute(BaseAttributes::AttackCooldown, 0.5 + 2.0 * unit(random));
+    if (team == Team::Ally)
+        ecs.CreateComponent<AllyUnit>(entity);
+    else
+        ecs.CreateComponent<EnemyUnit>(entity);
+    return entity;
+}
+
+// Two armies mixed over the area between min and max: every other combatant is of the player, and with structureEvery
+// set, every so many of them is a structure instead of a unit.
+inline std::vector<bee::Entity> CreateArmies(const int count, const glm::vec2& min, const glm::vec2& max,
+                                             std::mt19937& random, const int structureEvery = 0)
+{
+    std::uniform_real_distribution<float> x(min.x, max.x);
+    std::uniform_real_distribution<float> y(min.y, max.y);
+    std::vector<bee::Entity> combatants;
+    for (int i = 0; i < count; i++)
+    {
+        const float px = x(random);
+        const float py = y(random);
+        const bool structure = structureEvery > 0 && i % structureEvery == 0;
+        combatants.push_back(CreateCombatant(glm::vec3(px, py, 0.0f), i % 2 == 0 ? Team::Ally : Team::Enemy, structure, random));
+    }
+    return combatants;
+}
+
+// A unit that walks on in a straight line, and turns around at the edge of the field.
+struct MarchingUnit
+{
+    bee::Entity entity = entt::null;
+    glm::vec3 velocity = glm::vec3(0.0f);
+};
+
+inline void March(std::vector<MarchingUnit>& units, const float edge)
+{
+    auto& registry = bee::Engine.ECS().Registry;
+    for (auto& [entity, velocity] : units)
+    {
+        auto& translation = registry.get<bee::Transform>(entity).Translation;
+        translation += velocity;
+        if (std::abs(translation.x) > edge) velocity.x = -velocity.x;
+        if (std::abs(translation.y) > edge) velocity.y = -velocity.y;
+    }
+}
+
+// A round of a battle: from the round on, every moveEvery-th unit takes a random step and every deleteEvery-th one
+// dies. Units that died in an earlier round are skipped.
+inline void FightRound(const std::vector<bee::Entity>& units, const int round, const int moveEvery, const float stepSize,
+                       const int deleteEvery, std::mt19937& random)
+{
+    auto& ecs = bee::Engine.ECS();
+    std::uniform_real_distribution<float> step(-stepSize, stepSize);
+    for (size_t i = round; i < units.size(); i += moveEvery)
+    {
+        if (!ecs.Registry.valid(units[i])) continue;
+        const float dx = step(random);
+        const float dy = step(random);
+        ecs.Registry.get<bee::Transform>(units[i]).Translation += glm::vec3(dx, dy, 0.0f);
+    }
+    for (size_t i = round; i < units.size(); i += deleteEvery)
+        if (ecs.Registry.valid(units[i])) ecs.DeleteEntity(units[i]);
+    ecs.RemovedDeleted();
+}